@@ -0,0 +1,95 @@
+/**
+ * @file ActionAcl.h
+ * @brief Per-peer roles and allowed-action bitmaps for master-gated UDP actions.
+ * @details The registered master may send every action. Other peers get a role
+ *          granted by the master; each peer entry carries a 256-bit bitmap (one bit
+ *          per action byte), copied from the role default at grant time or given
+ *          explicitly, so dispatch is one table lookup and one bit test.
+ *          Peers without an entry are guests. Denials are counted per role.
+ *          The owner serialises the calls; nothing here allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class PeerRole : uint8_t
+{
+    GUEST = 0,    ///< No grant: master-gated actions are denied
+    OBSERVER = 1, ///< Telemetry queries only
+    STUDENT = 2,  ///< Telemetry plus a whitelist of safe actions
+    MASTER = 3    ///< The registered master (not grantable)
+};
+
+/**
+ * @brief 256-bit set of action bytes.
+ */
+struct ActionMask
+{
+    uint32_t words[8] = {};
+
+    bool test(uint8_t action) const { return (words[action >> 5] >> (action & 31)) & 1u; }
+    void set(uint8_t action) { words[action >> 5] |= 1u << (action & 31); }
+    void setAll();
+
+    /** @brief Build a mask from a list of action bytes. */
+    static ActionMask of(const uint8_t *actions, size_t count);
+
+    /** @brief Wire form: 32 bytes, bit n of byte n / 8 is action byte 8 * (n / 8) + n % 8. */
+    void toBytes(uint8_t out[32]) const;
+    static ActionMask fromBytes(const uint8_t in[32]);
+
+    /** @brief 64 hex digits of the wire form (plus terminator). */
+    void toHex(char out[65]) const;
+};
+
+class ActionAcl
+{
+public:
+    static constexpr uint8_t MAX_PEERS = 8;
+    static constexpr uint8_t ROLE_COUNT = 4;
+
+    struct Peer
+    {
+        uint32_t ipv4 = 0; ///< 0 = free slot
+        PeerRole role = PeerRole::GUEST;
+        ActionMask mask;
+        uint32_t denied = 0;
+    };
+
+    static const char *roleName(PeerRole role);
+
+    /** @brief Default bitmap given to a role at grant time. */
+    void setRoleMask(PeerRole role, const ActionMask &mask);
+    const ActionMask &roleMask(PeerRole role) const;
+
+    /**
+     * @brief Give a peer a role; GUEST revokes.
+     * @param mask Allowed actions, nullptr for the role default
+     * @return false if role is MASTER, ipv4 is 0 or the table is full
+     */
+    bool grant(uint32_t ipv4, PeerRole role, const ActionMask *mask = nullptr);
+
+    /** @brief Revoke every grant (new master session). Denial counters are kept. */
+    void clear();
+
+    PeerRole roleOf(uint32_t ipv4) const;
+
+    /**
+     * @brief Dispatch check; a denial is counted against the peer's role.
+     * @param is_master The sender is the registered master (always allowed)
+     */
+    bool allowed(uint32_t ipv4, bool is_master, uint8_t action);
+
+    uint32_t denials(PeerRole role) const { return denials_[static_cast<uint8_t>(role) & 3]; }
+
+    /** @brief Copy the granted peers. @return Number of entries filled */
+    uint8_t peers(Peer out[], uint8_t max_count) const;
+
+private:
+    Peer peers_[MAX_PEERS];
+    ActionMask role_masks_[ROLE_COUNT];
+    uint32_t denials_[ROLE_COUNT] = {};
+
+    int8_t find(uint32_t ipv4) const;
+};
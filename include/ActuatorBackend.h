@@ -0,0 +1,251 @@
+/**
+ * @file ActuatorBackend.h
+ * @brief Compile-time actuator driver policies for ServoService.
+ * @details ServoService drives exactly one expansion board, chosen at build time:
+ *          - DFR1216Backend (default): UNIHIKER K10 expansion board, 6 servo outputs
+ *            and 4 motors, register shadow merged into spans by the DFR1216 driver
+ *            (a virtual board with -DDFR1216_SIMULATED, see DFR1216_Sim.h)
+ *          - DFR0548Backend (-DSERVO_DRIVER_DFR0548): micro:bit driver board, PCA9685
+ *            with 8 servo outputs and 4 motors; each commit is written as a single
+ *            auto-increment burst covering every changed output
+ *          Both expose the same non-virtual interface, so the commit path compiles
+ *          to direct calls on the selected driver. Servo pulses are in µs, motor
+ *          duties are per half-bridge (motor * 2 + A/B) from 0 to 65535.
+ *          Emergency stops do not go through the batch: each backend compiles an
+ *          ActuatorStopImage (all motors off, continuous servos at their stop
+ *          pulse) ahead of time and writes it straight to the bus on demand.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "DFR1216/DFR1216_Sim.h"
+#include "DFR0558/DFR0548.h"
+
+/**
+ * @brief Prebuilt emergency-stop register writes: a few contiguous blocks, one bus
+ *        transaction each, laid out back to back in data[].
+ */
+struct ActuatorStopImage
+{
+    static constexpr uint8_t MAX_BLOCKS = 5;
+    static constexpr uint8_t MAX_BYTES = 64;
+
+    struct Block
+    {
+        uint8_t reg;    ///< First register
+        uint8_t offset; ///< Position of the block in data[]
+        uint8_t len;    ///< Register count
+    };
+
+    Block blocks[MAX_BLOCKS] = {};
+    uint8_t count = 0;
+    uint8_t used = 0; ///< Bytes of data[] in use
+    uint8_t data[MAX_BYTES] = {};
+
+    void clear()
+    {
+        count = 0;
+        used = 0;
+    }
+
+    /** @return false if the image is full (the block is not added) */
+    bool add(uint8_t reg, const uint8_t *bytes, uint8_t len)
+    {
+        if (count >= MAX_BLOCKS || len > MAX_BYTES - used)
+            return false;
+        blocks[count++] = {reg, used, len};
+        memcpy(&data[used], bytes, len);
+        used += len;
+        return true;
+    }
+};
+
+class DFR1216Backend
+{
+public:
+    static constexpr const char *NAME = "DFR1216";
+
+    bool begin() { return controller_.begin(); }
+
+    void configure(uint16_t motor_period_us)
+    {
+        controller_.setMotorPeriod(eMotor1_2, motor_period_us);
+        controller_.setMotorPeriod(eMotor3_4, motor_period_us);
+    }
+
+    void beginUpdate() { controller_.beginUpdate(); }
+    uint8_t endUpdate() { return controller_.endUpdate(); }
+
+    void setServoPulse(uint8_t channel, uint16_t pulse_us)
+    {
+        controller_.setServoPulse(static_cast<eServoNumber_t>(channel), pulse_us);
+    }
+
+    void setMotorDuty(uint8_t half_bridge, uint16_t duty)
+    {
+        controller_.setMotorDuty(static_cast<eMotorNumber_t>(half_bridge), duty);
+    }
+
+    /**
+     * @brief Compile the emergency-stop image: one block zeroing the 16 motor duty
+     *        registers, plus one block per run of neighbouring stopped servo channels
+     *        (the servo period registers sit in between, so they stay separate).
+     * @param servo_mask    Bit n: servo channel n gets its stop pulse
+     * @param stop_pulse_us Stop pulse per servo channel
+     */
+    static void buildStopImage(uint8_t servo_mask, const uint16_t *stop_pulse_us, ActuatorStopImage &image)
+    {
+        static const uint8_t motors_off[I2C_SERVO01_PERIOD_H - I2C_MOTOR1_Z_DUTY_H] = {};
+        image.clear();
+        image.add(I2C_MOTOR1_Z_DUTY_H, motors_off, sizeof(motors_off));
+        uint8_t channel = 0;
+        while (channel < SERVO_OUTPUTS)
+        {
+            if (!(servo_mask & (1u << channel)))
+            {
+                channel++;
+                continue;
+            }
+            const uint8_t first = channel;
+            uint8_t bytes[SERVO_OUTPUTS * 2];
+            uint8_t len = 0;
+            for (; channel < SERVO_OUTPUTS && (servo_mask & (1u << channel)); channel++)
+            {
+                bytes[len++] = static_cast<uint8_t>(stop_pulse_us[channel] >> 8);
+                bytes[len++] = static_cast<uint8_t>(stop_pulse_us[channel] & 0xFF);
+            }
+            image.add(I2C_SERVO0_DUTY_H + first * 2, bytes, len);
+        }
+    }
+
+    /** @brief Write the image now (priority bus access, no shadow). @return 0x00 on success */
+    uint8_t emergencyStop(const ActuatorStopImage &image)
+    {
+        uint8_t result = 0;
+        for (uint8_t i = 0; i < image.count; i++)
+            result |= controller_.emergencyWrite(image.blocks[i].reg, &image.data[image.blocks[i].offset], image.blocks[i].len);
+        return result;
+    }
+
+    /** @brief Rewrite registers that drifted from the shadow. @return Registers repaired */
+    uint8_t verify() { return controller_.verifyShadow(); }
+
+    uint8_t getBattery() { return controller_.getBattery(); }
+    sShadowStats_t getStats() { return controller_.getShadowStats(); }
+
+private:
+    static constexpr uint8_t SERVO_OUTPUTS = 6;
+
+    DFR1216_Transport controller_; ///< DFR1216_Sim with -DDFR1216_SIMULATED
+};
+
+class DFR0548Backend
+{
+public:
+    static constexpr const char *NAME = "DFR0548";
+    static constexpr uint32_t FRAME_US = 20000; ///< One PWM frame at DFR0548_PWM_FREQUENCY
+
+    bool begin() { return controller_.begin(DFR0548_DEFAULT_I2C_ADDR); }
+
+    /** @brief The PCA9685 has one frequency for all outputs: motors share the 50 Hz servo frame. */
+    void configure(uint16_t /*motor_period_us*/) {}
+
+    void beginUpdate() { controller_.beginUpdate(); }
+    uint8_t endUpdate() { return controller_.endUpdate(); }
+
+    void setServoPulse(uint8_t channel, uint16_t pulse_us)
+    {
+        if (channel >= DFR0548_MAX_CHANNELS)
+            return;
+        const uint16_t ticks = static_cast<uint16_t>((pulse_us * 4096UL + FRAME_US / 2) / FRAME_US);
+        controller_.stagePWM(DFR0548_SERVO_PCA_BASE + channel, 0, ticks);
+    }
+
+    void setMotorDuty(uint8_t half_bridge, uint16_t duty)
+    {
+        const uint8_t output = DFR0548_MOTOR_PCA_BASE + half_bridge;
+        if (duty == 0)
+            controller_.stagePWM(output, 0, PCA9685_FULL_ON_OFF);
+        else if (duty == 0xFFFF)
+            controller_.stagePWM(output, PCA9685_FULL_ON_OFF, 0);
+        else
+            controller_.stagePWM(output, 0, duty >> 4);
+    }
+
+    /**
+     * @brief Compile the emergency-stop image: one block turning the 8 motor outputs
+     *        fully off, plus one block per run of neighbouring stopped servo channels.
+     * @param servo_mask    Bit n: servo channel n gets its stop pulse
+     * @param stop_pulse_us Stop pulse per servo channel
+     */
+    static void buildStopImage(uint8_t servo_mask, const uint16_t *stop_pulse_us, ActuatorStopImage &image)
+    {
+        uint8_t motors_off[(DFR0548_SERVO_PCA_BASE - DFR0548_MOTOR_PCA_BASE) * 4];
+        for (uint8_t i = 0; i < sizeof(motors_off); i += 4)
+        {
+            motors_off[i] = 0;
+            motors_off[i + 1] = 0;
+            motors_off[i + 2] = static_cast<uint8_t>(PCA9685_FULL_ON_OFF & 0xFF);
+            motors_off[i + 3] = static_cast<uint8_t>(PCA9685_FULL_ON_OFF >> 8);
+        }
+        image.clear();
+        image.add(PCA9685_LED0_ON_L + 4 * DFR0548_MOTOR_PCA_BASE, motors_off, sizeof(motors_off));
+        uint8_t channel = 0;
+        while (channel < DFR0548_MAX_CHANNELS)
+        {
+            if (!(servo_mask & (1u << channel)))
+            {
+                channel++;
+                continue;
+            }
+            const uint8_t first = channel;
+            uint8_t bytes[DFR0548_MAX_CHANNELS * 4];
+            uint8_t len = 0;
+            for (; channel < DFR0548_MAX_CHANNELS && (servo_mask & (1u << channel)); channel++)
+            {
+                const uint16_t ticks = static_cast<uint16_t>((stop_pulse_us[channel] * 4096UL + FRAME_US / 2) / FRAME_US);
+                bytes[len++] = 0;
+                bytes[len++] = 0;
+                bytes[len++] = static_cast<uint8_t>(ticks & 0xFF);
+                bytes[len++] = static_cast<uint8_t>(ticks >> 8);
+            }
+            image.add(PCA9685_LED0_ON_L + 4 * (DFR0548_SERVO_PCA_BASE + first), bytes, len);
+        }
+    }
+
+    /** @brief Write the image now (priority bus access, output image untouched). @return 0x00 on success */
+    uint8_t emergencyStop(const ActuatorStopImage &image)
+    {
+        uint8_t result = 0;
+        for (uint8_t i = 0; i < image.count; i++)
+            result |= controller_.emergencyWrite(image.blocks[i].reg, &image.data[image.blocks[i].offset], image.blocks[i].len);
+        return result;
+    }
+
+    /** @brief Restore every output if the chip was reset. @return Outputs restored */
+    uint8_t verify() { return controller_.verifyOutputs(); }
+
+    /** @brief The DFR0548 has no battery gauge. */
+    uint8_t getBattery() { return 0; }
+
+    /** @brief Burst counters in the DFR1216 shadow-stats layout (merged = bridged outputs). */
+    sShadowStats_t getStats()
+    {
+        const PCA9685BurstStats burst = controller_.getBurstStats();
+        sShadowStats_t stats = {};
+        stats.writesRequested = burst.writesRequested;
+        stats.writesSkipped = burst.writesSkipped;
+        stats.writesMerged = burst.channelsBridged;
+        stats.spansFlushed = burst.bursts;
+        stats.flushErrors = burst.burstErrors;
+        stats.verifyReads = burst.verifyReads;
+        stats.verifyErrors = burst.verifyErrors;
+        stats.registersRepaired = burst.channelsRestored;
+        stats.flushesOvertaken = burst.burstsOvertaken;
+        return stats;
+    }
+
+private:
+    DFR0548_Controller controller_;
+};
@@ -20,6 +20,10 @@
 #define PCA9685_LED0_OFF_L 0x08
 #define PCA9685_LED0_OFF_H 0x09
 #define PCA9685_RESTART 0x80
+#define PCA9685_MODE1_AI 0x20    // Register auto-increment
+#define PCA9685_MODE1_SLEEP 0x10 // Oscillator off (power-on default)
+#define PCA9685_FULL_ON_OFF 0x1000 // Bit 12 of an ON/OFF count: output fully on/off
+#define PCA9685_CHANNELS 16
 
 // DFR0548 Constants
 #define DFR0548_DEFAULT_I2C_ADDR 0x40
@@ -34,6 +38,10 @@
 #define DFR0548_SERVO_NEUTRAL_PULSE 307 // ~1.5ms
 #define DFR0548_PWM_FREQUENCY 50.0f     // 50Hz for servos
 
+// Board wiring of the PCA9685 outputs: M1..M4 half-bridges (A/B) on 0..7, S1..S8 on 8..15
+#define DFR0548_MOTOR_PCA_BASE 0
+#define DFR0548_SERVO_PCA_BASE 8
+
 // Servo Types
 enum ServoType
 {
@@ -41,6 +49,21 @@ enum ServoType
     SERVO_TYPE_CONTINUOUS = 1 // Continuous rotation servo (360° with speed control)
 };
 
+// Counters of the batched (auto-increment) PWM writes
+struct PCA9685BurstStats
+{
+    uint32_t writesRequested;  // Channel updates staged by stagePWM()
+    uint32_t writesSkipped;    // Updates dropped because the channel already held the value
+    uint32_t channelsBridged;  // Clean channels rewritten to keep a burst contiguous
+    uint32_t bursts;           // I2C transactions issued by endUpdate()
+    uint32_t burstBytes;       // Register bytes carried by those transactions
+    uint32_t burstErrors;      // Bursts that failed (channels stay dirty)
+    uint32_t verifyReads;      // MODE1 read-backs issued by verifyOutputs()
+    uint32_t verifyErrors;     // Read-backs that failed
+    uint32_t channelsRestored; // Channels rewritten after the chip was found reset
+    uint32_t burstsOvertaken;  // Bursts dropped because an emergency write landed first
+};
+
 // Servo Configuration Structure
 struct ServoConfig
 {
@@ -60,10 +83,20 @@ private:
     bool _initialized;                         // Initialization status
     ServoConfig _servos[DFR0548_MAX_CHANNELS]; // Configuration for each servo channel
 
+    // Batched output state: LEDn_ON_L..LEDn_OFF_H image of all 16 channels
+    uint8_t _ledImage[PCA9685_CHANNELS * 4];
+    uint16_t _ledDirty;      // Bit n: channel n differs from the chip
+    uint8_t _batchDepth;
+    volatile uint32_t _stopEpoch; // Bumped by every emergencyWrite()
+    uint32_t _batchEpoch;         // _stopEpoch when the outermost batch was opened
+    PCA9685BurstStats _burstStats;
+
     // Private helper functions
     void writeRegister(uint8_t reg, uint8_t value);
     uint8_t readRegister(uint8_t reg);
+    bool writeBurst(uint8_t reg, const uint8_t *data, uint8_t len);
     void reset();
+    void resetImage();
 
 public:
     // Constructor
@@ -106,6 +139,24 @@ public:
     void setPin(uint8_t channel, uint16_t val, bool invert = false); // Set pin PWM value
     uint16_t getPWM(uint8_t channel);                                // Get current PWM setting
 
+    // ===== BATCHED PWM UPDATES (AUTO-INCREMENT) =====
+    // Between beginUpdate() and endUpdate() channel values are only staged; the outermost
+    // endUpdate() writes every changed channel in ONE auto-increment transaction, from the
+    // lowest to the highest dirty channel (clean channels in between are resent unchanged).
+    // The PCA9685 latches outputs on STOP, so all channels of a commit change together.
+    // Channels are raw PCA9685 outputs 0-15. Not thread safe: one task owns the batch, and
+    // outputs driven here must not also be driven through setPWM()/setAngle().
+    void beginUpdate();
+    void stagePWM(uint8_t pcaChannel, uint16_t on, uint16_t off); // Stage one output (unchanged values are skipped)
+    uint8_t endUpdate();                                          // 0x00 success, 0xff failure or overtaken by an emergencyWrite() (channels stay dirty)
+    uint8_t verifyOutputs();                                      // Re-init and rewrite all outputs if the chip was reset; returns channels restored
+    PCA9685BurstStats getBurstStats();
+    // Write raw LEDn registers at once, bypassing the image (emergency stop). Call it from a task of
+    // the highest priority, so it is the next owner of the bus; one immediate retry. An open batch is
+    // not written (it would undo the stop): stage the same values afterwards so the image catches up.
+    // 0x00 success, 0xff failure
+    uint8_t emergencyWrite(uint8_t reg, const uint8_t *data, uint8_t len);
+
     // ===== DIAGNOSTIC AND STATUS FUNCTIONS =====
     bool isConnected();                            // Check if PCA9685 is responding
     std::string getChannelStatus(uint8_t channel); // Get servo status for channel
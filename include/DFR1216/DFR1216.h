@@ -105,6 +105,83 @@ typedef struct
   uint8_t state;
 } sDhtData_t;
 
+/**
+ * @brief Result of one non-blocking sensor poll.
+ */
+typedef enum
+{
+  eSensorPending,   ///< Conversion still running: poll again later
+  eSensorReady,     ///< Conversion complete, value collected
+  eSensorModeError, ///< The port is not configured for this sensor type
+  eSensorNoDevice,  ///< Conversion complete but no sensor answered (DS18B20 reads 0xffff)
+  eSensorBusError,  ///< The I2C read failed
+} eSensorPoll_t;
+
+/**
+ * @brief Counters of the actuator register shadow cache.
+ */
+typedef struct
+{
+  uint32_t writesRequested;   ///< Word writes requested by setters
+  uint32_t writesSkipped;     ///< Writes dropped because the shadow already held the value
+  uint32_t writesMerged;      ///< Dirty words that shared a bus transaction with another word
+  uint32_t spansFlushed;      ///< I2C write transactions issued by flushShadow()
+  uint32_t flushErrors;       ///< Spans that still failed after RETRY_COUNT attempts
+  uint32_t verifyReads;       ///< Read-back transactions issued by verifyShadow()
+  uint32_t verifyErrors;      ///< Read-back transactions that failed
+  uint32_t registersRepaired; ///< Words found drifted from the shadow and rewritten
+  uint32_t flushesOvertaken;  ///< Flushes abandoned because an emergency write landed first
+} sShadowStats_t;
+
+#define BUS_HIST_BUCKETS 16 ///> Transaction duration buckets: n covers [2^n, 2^(n+1)) us
+
+/**
+ * @brief Register classes of the I2C bus statistics.
+ */
+typedef enum
+{
+  eRegActuator = 0, ///< Motor/servo periods and duties (0x00-0x23)
+  eRegIR,           ///< IR send/receive (0x24-0x28, 0x88-0x8f)
+  eRegSR04,         ///< Ultrasonic ranging (0x29-0x2b)
+  eRegGPIO,         ///< IO mode, write and read (0x2c-0x44)
+  eRegADC,          ///< ADC conversions (0x45-0x56)
+  eRegDHT,          ///< DHT11/22 (0x57-0x74)
+  eReg18B20,        ///< DS18B20 (0x75-0x86)
+  eRegBattery,      ///< Battery level (0x87)
+  eRegWS2812,       ///< RGB LEDs (0x90-0x9f)
+  eRegControl,      ///< Sensor reset and anything else
+  eRegClassCount
+} eRegClass_t;
+
+/**
+ * @brief Transaction counters of one register class.
+ */
+typedef struct
+{
+  uint32_t writes;   ///< Write transactions issued
+  uint32_t reads;    ///< Read transactions issued (address write + request)
+  uint32_t retries;  ///< Repeated attempts (bus error, or sensor data not ready yet)
+  uint32_t nacks;    ///< Transactions NACKed by the board (address or data)
+  uint32_t errors;   ///< Other failed transactions (timeout, bus error, short read)
+  uint32_t failures; ///< Operations abandoned after RETRY_COUNT attempts
+} sBusClassStats_t;
+
+/**
+ * @brief Statistics of the shared DFR1216 I2C bus (all driver instances).
+ */
+typedef struct
+{
+  sBusClassStats_t classes[eRegClassCount];
+  uint32_t durationHist[BUS_HIST_BUCKETS]; ///< Bus time per transaction (mutex wait excluded); bucket 0 also holds 0 us
+  uint32_t durationMaxUs;
+  uint64_t durationSumUs;
+  uint32_t transactions;
+  uint32_t mutexAcquisitions; ///< Bus mutex takes by a transaction
+  uint32_t mutexContended;    ///< Takes that found the mutex held and had to wait
+  uint64_t mutexWaitSumUs;
+  uint32_t mutexWaitMaxUs;
+} sBusStats_t;
+
 #define I2C_MOTOR12_PERIOD_H 0X00
 #define I2C_MOTOR34_PERIOD_H 0x02
 #define I2C_MOTOR1_Z_DUTY_H 0X04
@@ -143,6 +220,29 @@ typedef struct
 #define RETRY_COUNT 3
 #define I2C_RETRY_DELAY_MS 5  ///> Delay between I2C retries (ms)
 #define TEMP_LEN 32
+#define SHADOW_REG_BASE 0x00     ///> First register mirrored by the shadow cache (I2C_MOTOR12_PERIOD_H)
+#define SHADOW_REG_LEN 0x24      ///> Mirrored bytes: motor/servo periods and duties (0x00..0x23)
+#define SHADOW_WORDS (SHADOW_REG_LEN / 2)
+#define SHADOW_MERGE_GAP 1       ///> Clean (but known) words bridged when merging two dirty spans
+#define SHADOW_VERIFY_CHUNK 12   ///> Bytes read back per verify transaction
+#define SHADOW_BOARDS 2          ///> Boards (bus addresses) with a register shadow
+
+/**
+ * @brief Register shadow of one board, shared by every driver instance on its address.
+ */
+typedef struct
+{
+  uint8_t addr;                 ///< Bus address of the board, 0 = free slot
+  uint8_t regs[SHADOW_REG_LEN]; ///< Last value written (or to be written) per register
+  uint32_t valid;               ///< Bit n set: word n holds a known value
+  uint32_t dirty;               ///< Bit n set: word n differs from the device
+  uint8_t batchDepth;
+  uint8_t verifyCursor;
+  volatile uint32_t stopEpoch;  ///< Bumped by every emergencyWrite()
+  uint32_t batchEpoch;          ///< stopEpoch when the outermost batch was opened
+  sShadowStats_t stats;
+  SemaphoreHandle_t mutex;      ///< Recursive; created by the first resetShadow()
+} sShadowState_t;
 
 /// Servo 360 PWM pulse-width constants (microseconds)
 /// Tune these to match your specific servo's dead-band and full-speed points.
@@ -163,7 +263,11 @@ constexpr uint16_t SERVO270_MAX_US    = 3470;
 class DFR1216
 {
 public:
-  DFR1216();
+  /**
+   * @param addr: bus address of the board. Instances on the same address share one
+   *              register shadow, so a write through one of them is known to the others
+   */
+  DFR1216(uint8_t addr = 0x33);
   ~DFR1216();
   /**
    * @fn: getBattery
@@ -237,7 +341,7 @@ public:
   uint16_t getADCValue(eIONumber_t number);
 
   /**
-   * @fn: getDHTValuecan you
+   * @fn: getDHTValue
    * @brief: Get the DHT value
    * @param number: io number
    * @return: sDhtData_t dhtData
@@ -254,6 +358,105 @@ public:
    */
   float get18b20Value(eIONumber_t number);
 
+  /*
+   * Non-blocking sensor access. The blocking getters above trigger a conversion
+   * and sleep 30-50 ms in the calling task; the split form lets a scheduler
+   * start a conversion, do other work (the bus is free meanwhile) and poll once
+   * the conversion time has elapsed. A poll is a single status+data read: on
+   * eSensorReady the value has been collected into the output argument, on
+   * eSensorPending it is left untouched. Polls do not retry.
+   */
+
+  /**
+   * @fn: startDHT
+   * @brief: Trigger a DHT11/DHT22 conversion (about 30 ms)
+   * @param number: io number
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t startDHT(eIONumber_t number);
+
+  /**
+   * @fn: pollDHT
+   * @brief: Collect a DHT conversion started by startDHT()
+   * @param number: io number
+   * @param dhtData: receives temperature/humidity when ready
+   * @return: eSensorPoll_t
+   */
+  eSensorPoll_t pollDHT(eIONumber_t number, sDhtData_t *dhtData);
+
+  /**
+   * @fn: start18b20
+   * @brief: Trigger a DS18B20 conversion (about 50 ms)
+   * @param number: io number
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t start18b20(eIONumber_t number);
+
+  /**
+   * @fn: poll18b20
+   * @brief: Collect a DS18B20 conversion started by start18b20()
+   * @param number: io number
+   * @param temperature: receives the temperature when ready
+   * @return: eSensorPoll_t
+   */
+  eSensorPoll_t poll18b20(eIONumber_t number, float *temperature);
+
+  /**
+   * @fn: startSr04
+   * @brief: Trigger an ultrasonic measurement (about 30 ms)
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t startSr04(void);
+
+  /**
+   * @fn: pollSr04
+   * @brief: Collect a measurement started by startSr04()
+   * @param distance: receives the distance when ready
+   * @return: eSensorPoll_t
+   */
+  eSensorPoll_t pollSr04(int16_t *distance);
+
+  /**
+   * @fn: pollADC
+   * @brief: Read the latest ADC conversion (the coprocessor converts continuously,
+   *         so there is no start step)
+   * @param number: io number
+   * @param adcValue: receives the value (0-4095) when ready
+   * @return: eSensorPoll_t
+   */
+  eSensorPoll_t pollADC(eIONumber_t number, uint16_t *adcValue);
+
+  /**
+   * @fn: readADCBlock
+   * @brief: Read several ADC ports in one transaction. The ADC registers of
+   *         C0-C5 are contiguous (3 bytes each), so the span from the lowest to
+   *         the highest requested port is read as a single burst (at most 18 bytes)
+   * @param mask: bit n requests port Cn
+   * @param adcValues: array of 6, entry n receives Cn's value (0-4095) when ready
+   * @param readyMask: receives the requested ports whose value was collected
+   * @param modeErrorMask: optional, receives the requested ports not in ADC mode
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t readADCBlock(uint8_t mask, uint16_t *adcValues, uint8_t *readyMask, uint8_t *modeErrorMask = NULL);
+
+  /**
+   * @fn: getGpioStates
+   * @brief: Read the input level of every port (C0-C5) in one transaction
+   * @param levels: receives bit n = level of Cn
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t getGpioStates(uint8_t *levels);
+
   /**
    * @fn: setMotorPeriod
    * @brief: Set the motor period
@@ -293,6 +496,35 @@ public:
    */
   void setServo360(eServoNumber_t number, eServo360Direction_t direction, uint8_t speed);
 
+  /**
+   * @fn: setServoPulse
+   * @brief Set the raw servo pulse width
+   * @param number: servo number
+   * @param pulseUs: pulse width in microseconds
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t setServoPulse(eServoNumber_t number, uint16_t pulseUs);
+
+  /**
+   * @fn: servo360Pulse
+   * @brief Pulse width used by setServo360 for a direction/speed pair
+   * @param direction
+   * @param speed (0-100)
+   * @return: uint16_t pulse width in microseconds
+   */
+  static uint16_t servo360Pulse(eServo360Direction_t direction, uint8_t speed);
+
+  /**
+   * @fn: servoAnglePulse
+   * @brief Pulse width used by setServoAngle for an absolute angle
+   * @param angle: servo angle
+   * @param maxAngle: servo max angle (180 or 270)
+   * @return: uint16_t pulse width in microseconds
+   */
+  static uint16_t servoAnglePulse(uint16_t angle, uint16_t maxAngle);
+
   /**
    * @fn: getSr04Distance
    * @brief: get sr04 distance
@@ -304,9 +536,183 @@ public:
    */
   int16_t getSr04Distance(void);
 
+  /**
+   * @fn: beginUpdate
+   * @brief: Open a batch: period/duty writes are only staged in the shadow until
+   *         the matching endUpdate(). Batches nest and hold the shadow lock, so
+   *         a batch issued by one task is never interleaved with another's.
+   * @return: NULL
+   */
+  void beginUpdate(void);
+
+  /**
+   * @fn: endUpdate
+   * @brief: Close a batch; the outermost endUpdate() flushes the dirty spans.
+   *         If an emergencyWrite() landed since the batch was opened, the values
+   *         staged before it are not written (they would undo the stop): the
+   *         words stay dirty until the caller stages again and flushes.
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure or overtaken (dirty words are kept and retried on next flush)
+   */
+  uint8_t endUpdate(void);
+
+  /**
+   * @fn: flushShadow
+   * @brief: Write every dirty word, merging neighbouring words into one transaction
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t flushShadow(void);
+
+  /**
+   * @fn: verifyShadow
+   * @brief: Read back part of the mirrored block and rewrite words that drifted
+   *         (e.g. the coprocessor reset after a brownout). Successive calls walk
+   *         the block round-robin.
+   * @param maxBytes: bytes to verify in this call (SHADOW_REG_LEN = full pass)
+   * @return: uint8_t number of words repaired
+   */
+  uint8_t verifyShadow(uint8_t maxBytes = SHADOW_REG_LEN);
+
+  /**
+   * @fn: resetShadow
+   * @brief: Forget every cached value; the next write of each word goes to the bus.
+   * @return: NULL
+   */
+  void resetShadow(void);
+
+  /**
+   * @fn: rewriteShadow
+   * @brief: Mark every known word dirty, so the next flush writes it again. Call after
+   *         the coprocessor has been reset: the values other users of the board set
+   *         are still wanted, the board just lost them.
+   * @return: NULL
+   */
+  void rewriteShadow(void);
+
+  /**
+   * @fn: readShadow
+   * @brief: Get the cached value of a mirrored word without touching the bus
+   * @param reg: register address of the high byte (even, < SHADOW_REG_LEN)
+   * @param value: receives the cached value
+   * @return: true if the word is known, false otherwise
+   */
+  bool readShadow(uint8_t reg, uint16_t *value);
+
+  /**
+   * @fn: emergencyWrite
+   * @brief: Write a block of registers straight to the bus: the shadow lock, the
+   *         retry delays and the debug output are bypassed. Call it from a task of
+   *         the highest priority: bus waiters are queued by priority, so it is the
+   *         next owner and the current owner inherits its priority. One immediate
+   *         retry. Open batches are marked overtaken (see endUpdate()). The shadow
+   *         is not updated: stage the same values through the normal path so it
+   *         catches up on the next flush.
+   * @param reg: first register
+   * @param data: register values
+   * @param len: number of registers
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t emergencyWrite(uint8_t reg, const uint8_t *data, uint8_t len);
+
+  /**
+   * @fn: getShadowStats
+   * @brief: Get a copy of the shadow cache counters (every instance on this board)
+   * @return: sShadowStats_t counters
+   */
+  sShadowStats_t getShadowStats(void);
+
+  /**
+   * @fn: getBusStats
+   * @brief: Get a copy of the I2C bus statistics (shared by every DFR1216 instance)
+   * @return: sBusStats_t statistics
+   */
+  static sBusStats_t getBusStats(void);
+
+  /**
+   * @fn: resetBusStats
+   * @brief: Zero the I2C bus statistics
+   * @return: NULL
+   */
+  static void resetBusStats(void);
+
+  /**
+   * @fn: regClass
+   * @brief: Register class of a register address
+   * @param reg: register address
+   * @return: eRegClass_t class
+   */
+  static eRegClass_t regClass(uint8_t reg);
+
+  /**
+   * @fn: regClassName
+   * @brief: Short lowercase name of a register class ("actuator", "adc", ...)
+   * @return: const char* name
+   */
+  static const char *regClassName(eRegClass_t regClass);
+
+protected:
+  /**
+   * @fn: attachShadow
+   * @brief: Create the shadow lock of the board on first use (called by begin());
+   *         what other instances on the board cached is kept
+   * @return: NULL
+   */
+  void attachShadow(void);
+
+  /**
+   * @fn: writeWord
+   * @brief: Stage a 16-bit big-endian register pair through the shadow cache.
+   *         Unchanged values are skipped; outside a batch the word is flushed at once.
+   * @param reg: register address of the high byte
+   * @param value: value to write
+   * @return: uint8_t result
+   * @retval: 0x00 is success
+   * @retval: 0xff is failure
+   */
+  uint8_t writeWord(uint8_t reg, uint16_t value);
+
+  /**
+   * @fn: recordTransaction
+   * @brief: Account one bus transaction (called by the transport, bus mutex held)
+   * @param reg: register address
+   * @param read: true for a read transaction
+   * @param error: 0 on success, else the TwoWire error (2/3 = NACK, 0xff = short read)
+   * @param busUs: time on the bus, mutex wait excluded
+   * @return: NULL
+   */
+  static void recordTransaction(uint8_t reg, bool read, uint8_t error, uint32_t busUs);
+
+  /**
+   * @fn: recordMutexWait
+   * @brief: Account one bus mutex acquisition
+   * @param contended: true if the mutex was held by another task
+   * @param waitUs: time spent waiting for it
+   * @return: NULL
+   */
+  static void recordMutexWait(bool contended, uint32_t waitUs);
+
 private:
   virtual uint8_t writeReg(uint8_t reg, uint8_t *data, uint8_t len) = 0;
   virtual int16_t readReg(uint8_t reg, uint8_t *data, uint8_t len) = 0;
+
+  uint8_t __writeRetry(uint8_t reg, uint8_t *data, uint8_t len);
+  int16_t __readRetry(uint8_t reg, uint8_t *data, uint8_t len);
+  static void __noteRetry(uint8_t reg);
+  static void __noteFailure(uint8_t reg);
+  void __lockShadow(void);
+  void __unlockShadow(void);
+  uint8_t __flushSpans(uint32_t epoch);
+
+  sShadowState_t *__sh;              ///< Shadow of this board, nullptr = none left (write through)
+
+  static sShadowState_t __shadows[SHADOW_BOARDS];
+  static sBusStats_t __busStats;
+  static portMUX_TYPE __busStatsLock;
 };
 
 class DFR1216_I2C : public DFR1216
@@ -323,5 +729,8 @@ private:
   TwoWire *__pWire;
   uint8_t __I2C_addr;
   static SemaphoreHandle_t __i2c_mutex;  ///< Shared recursive mutex for I2C bus access
+
+  void __lockBus(void);
+  void __unlockBus(void);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+/**
+ * @file DFR1216Sensors.h
+ * @brief Background sampler for the DFR1216 sensor ports.
+ * @details Each port (C0-C5, plus the dedicated SR04 connector) can be assigned a
+ *          sensor type and a sampling period. step() is driven by one task: it
+ *          starts a conversion when a port is due, leaves the bus alone while the
+ *          coprocessor converts, then polls and collects the value. Conversions on
+ *          different ports overlap, and the bus is free for actuator writes between
+ *          polls. Callers never touch the bus: read() returns the latest completed
+ *          value with the millis() timestamp it was collected at.
+ *          ADC and digital-input ports are not sampled one by one: a scan job reads
+ *          all of them in one burst per register block (ADC values, input levels)
+ *          at the shortest period configured among them, and appends every scan
+ *          to a ring buffer that readers can page through by sequence number.
+ *          configure() may be called from any task; the change is applied (and the
+ *          port mode written) by the next step().
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include "DFR1216/DFR1216.h"
+#include "SeqLock.h"
+
+class DFR1216SensorScheduler
+{
+public:
+    enum class Kind : uint8_t
+    {
+        NONE = 0,
+        ADC = 1,
+        DHT11 = 2,
+        DHT22 = 3,
+        DS18B20 = 4,
+        SR04 = 5,
+        DIN = 6 ///< Digital input level
+    };
+
+    static constexpr uint8_t IO_PORTS = 6;        ///< C0-C5
+    static constexpr uint8_t SR04_PORT = IO_PORTS; ///< Dedicated ultrasonic connector
+    static constexpr uint8_t PORTS = IO_PORTS + 1;
+    static constexpr uint32_t MIN_PERIOD_MS = 20;
+    static constexpr uint32_t MAX_PERIOD_MS = 60000;
+    static constexpr uint32_t POLL_INTERVAL_MS = 10;  ///< Re-poll delay while a conversion is pending
+    static constexpr uint32_t TIMEOUT_MS = 150;       ///< Extra time after the nominal conversion before giving up
+    static constexpr uint32_t IDLE_WAKE_MS = 500;     ///< step() period when no port is configured
+    static constexpr uint16_t SCAN_RING = 64;         ///< Scans kept for readScans()
+
+    /** @brief Latest completed reading of one port. */
+    struct Reading
+    {
+        Kind kind = Kind::NONE;
+        uint8_t status = eSensorPending; ///< eSensorPoll_t of the last attempt (eSensorPending after a timeout)
+        float value = 0;                 ///< ADC raw (0-4095), temperature (°C), SR04 distance or input level
+        float humidity = 0;              ///< DHT only (%RH)
+        uint32_t timestamp_ms = 0;       ///< millis() when value was collected (0 = never)
+        uint32_t conversion_ms = 0;      ///< Start-to-collect time of the last reading
+        uint32_t count = 0;              ///< Readings collected
+        uint32_t failures = 0;           ///< Conversions abandoned (mode/bus error, no device, timeout)
+    };
+
+    /** @brief One ADC/digital-input scan (all scanned ports sampled together). */
+    struct ScanFrame
+    {
+        uint32_t sequence = 0;     ///< Scan number, starting at 0
+        uint32_t timestamp_ms = 0; ///< millis() of the scan
+        uint16_t adc[IO_PORTS] = {}; ///< Entry n valid if adc_mask bit n is set
+        uint8_t adc_mask = 0;      ///< ADC ports collected in this scan
+        uint8_t din_mask = 0;      ///< Digital-input ports collected in this scan
+        uint8_t din_levels = 0;    ///< Bit n: level of port n
+        uint8_t transactions = 0;  ///< Bus transactions used by the scan
+        uint32_t bus_us = 0;       ///< Time spent in the scan's bus transactions
+    };
+
+    /** @brief Scan job counters. */
+    struct ScanStats
+    {
+        uint32_t period_ms = 0; ///< Current scan period (0 = no ADC/digital port)
+        uint32_t scans = 0;
+        uint32_t errors = 0;    ///< Block reads that failed
+        uint32_t bus_us_max = 0;
+        uint64_t bus_us_sum = 0;
+    };
+
+    explicit DFR1216SensorScheduler(DFR1216 &device) : device_(device) {}
+
+    /**
+     * @brief Assign a sensor type and sampling period to a port.
+     * @param port      0-5 for C0-C5, SR04_PORT for the ultrasonic connector
+     * @param kind      Sensor type (SR04 only on SR04_PORT, never on C0-C5)
+     * @param period_ms Sampling period (0 = default for the type), clamped to MIN/MAX_PERIOD_MS
+     * @return false if the port/kind combination is invalid
+     */
+    bool configure(uint8_t port, Kind kind, uint32_t period_ms = 0);
+
+    Kind kind(uint8_t port) const;
+    uint32_t period(uint8_t port) const;
+
+    /** @brief Latest reading of a port (lock-free, callable from any task). */
+    Reading read(uint8_t port) const { return readings_[port < PORTS ? port : 0].read(); }
+
+    /**
+     * @brief Copy scans from the ring, oldest first.
+     * @param from_sequence First scan wanted; older scans already overwritten are skipped
+     * @param out           Destination
+     * @param max_frames    Capacity of @p out
+     * @param lost          Optional: receives the number of scans skipped because they were overwritten
+     * @return Number of frames copied; continue from out[n-1].sequence + 1
+     */
+    uint16_t readScans(uint32_t from_sequence, ScanFrame *out, uint16_t max_frames, uint32_t *lost = nullptr) const;
+
+    /** @brief Sequence number the next scan will get. */
+    uint32_t nextScanSequence() const { return scan_head_.load(std::memory_order_acquire); }
+
+    ScanStats scanStats() const { return scan_stats_.read(); }
+
+    /**
+     * @brief Advance every port's state machine.
+     * @param now_ms Current millis()
+     * @return Milliseconds until the next port needs attention
+     */
+    uint32_t step(uint32_t now_ms);
+
+    static uint32_t conversionTime(Kind kind);
+    static uint32_t defaultPeriod(Kind kind);
+    static const char *kindName(Kind kind);
+    static bool kindFromName(const char *name, Kind &kind);
+    static bool isScanned(Kind kind) { return kind == Kind::ADC || kind == Kind::DIN; }
+
+private:
+    enum class Phase : uint8_t
+    {
+        IDLE,
+        CONVERTING
+    };
+
+    struct Port
+    {
+        Kind kind = Kind::NONE;
+        Phase phase = Phase::IDLE;
+        uint32_t period_ms = 0;
+        uint32_t due_ms = 0;     ///< IDLE: next start; CONVERTING: next poll
+        uint32_t started_ms = 0;
+        uint32_t deadline_ms = 0;
+    };
+
+    void applyConfiguration(uint8_t port, uint32_t now_ms);
+    bool start(uint8_t port);
+    eSensorPoll_t poll(uint8_t port, Reading &reading);
+    void finish(uint8_t port, uint32_t now_ms, eSensorPoll_t status, const Reading *collected);
+    void scan(uint32_t now_ms);
+
+    DFR1216 &device_;
+    Port ports_[PORTS];                          ///< Owned by the step() task
+    SeqLock<Reading> readings_[PORTS];
+    std::atomic<uint32_t> requested_[PORTS]{};    ///< kind << 24 | period_ms
+    std::atomic<uint32_t> reconfigure_{0};        ///< Bit n: port n has a pending configure()
+    uint32_t scan_period_ms_ = 0;                  ///< Shortest period of the scanned ports (0 = none)
+    uint32_t scan_due_ms_ = 0;
+    SeqLock<ScanFrame> scan_ring_[SCAN_RING];
+    std::atomic<uint32_t> scan_head_{0};           ///< Scans written so far
+    SeqLock<ScanStats> scan_stats_;
+};
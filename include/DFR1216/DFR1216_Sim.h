@@ -0,0 +1,158 @@
+/*!
+ * @file DFR1216_Sim.h
+ * @brief Virtual DFR1216 board: register file, I2C timing and sensor conversions in software
+ * @details Build with -DDFR1216_SIMULATED (env unihiker_k10_sim) to run ServoService and
+ *          DFR1216Service without the expansion board: DFR1216_Transport then names this
+ *          class instead of DFR1216_I2C. Like the physical board, the model is shared by
+ *          every instance:
+ *          - register file: 256 bytes, writes land as sent and reads return the content
+ *          - timing: a transaction holds the bus for its wire time at the simulated clock
+ *            (START, address, register, data at 9 clocks per byte, STOP; a read is a
+ *            pointer write followed by a read) plus a fixed per-transaction overhead.
+ *            In realtime mode the caller busy-waits that long with the bus mutex held,
+ *            so contention and latency behave as on the board
+ *          - sensors: ADC ports sample continuously once in ADC mode; DHT, DS18B20 and
+ *            SR04 conversions complete after their conversion time (SR04: plus the echo
+ *            time of the distance). Values come from the static setters
+ *          - faults: NACK the next n transactions, or each one with a seeded probability
+ *          - a write to I2C_RESET_SENSOR (or brownout()) clears the register file, so
+ *            verifyShadow() has something to repair
+ *          Transactions go through recordTransaction()/recordMutexWait() like the real
+ *          transport, so getBusStats() is filled the same way. getSimStats() adds the
+ *          modelled wire time and the bus utilisation since the last reset.
+ * @copyright MIT License
+ */
+#ifndef __DFROBOT__UNIHIKEREXPANSION_SIM__H__
+#define __DFROBOT__UNIHIKEREXPANSION_SIM__H__
+#include "DFR1216/DFR1216.h"
+
+/**
+ * @brief Simulation parameters (shared by every DFR1216_Sim).
+ */
+typedef struct
+{
+  uint32_t clockHz;             ///< Simulated SCL frequency
+  uint16_t overheadUs;          ///< Driver cost added to every transaction (0 = wire time only)
+  bool realtime;                ///< Hold the bus for the modelled time; false = account only
+  uint32_t adcConversionUs;     ///< Mode change to first ADC value
+  uint32_t dhtConversionUs;     ///< DHT11/22 start to data ready
+  uint32_t ds18b20ConversionUs; ///< DS18B20 start to data ready
+  uint32_t sr04BaseUs;          ///< SR04 start to data ready, echo time excluded
+  uint16_t nackRatePermille;    ///< Probability that a transaction is NACKed (1/1000)
+  uint32_t seed;                ///< Seed of the NACK generator
+} sSimConfig_t;
+
+/**
+ * @brief Counters of the simulated bus.
+ */
+typedef struct
+{
+  uint32_t transactions;
+  uint32_t writes;
+  uint32_t reads;
+  uint64_t wireBytes;           ///< Bytes on the wire: addresses, registers and data
+  uint32_t nacksInjected;
+  uint64_t busyUs;              ///< Modelled bus time (wire time + overhead)
+  uint32_t windowUs;            ///< Time since the counters were reset
+  uint16_t utilisationPermille; ///< busyUs / windowUs
+} sSimStats_t;
+
+class DFR1216_Sim : public DFR1216
+{
+public:
+  DFR1216_Sim(uint8_t addr = 0x33);
+
+  /**
+   * @fn: begin
+   * @brief: Power up the virtual board (register file cleared, like the real reset).
+   *         Only the first call, whatever the instance: the others attach their shadow
+   * @return: true
+   */
+  bool begin(void);
+
+  /**
+   * @fn: configure
+   * @brief: Replace the simulation parameters (see defaultConfig())
+   */
+  static void configure(const sSimConfig_t &config);
+  static sSimConfig_t getConfig(void);
+  static sSimConfig_t defaultConfig(void);
+
+  /**
+   * @fn: injectNacks
+   * @brief: NACK the next @p count transactions, whatever the NACK rate
+   */
+  static void injectNacks(uint32_t count);
+
+  /**
+   * @fn: brownout
+   * @brief: Lose the register file, as after a coprocessor reset
+   */
+  static void brownout(void);
+
+  static void setAnalog(eIONumber_t number, uint16_t value);
+  static void setInput(eIONumber_t number, bool level);
+  static void setDht(eIONumber_t number, float temperature, float humidity);
+  /** @brief DS18B20 temperature; present = false reads back as "no device" */
+  static void set18b20(eIONumber_t number, float temperature, bool present = true);
+  static void setSr04Distance(int16_t distance);
+  static void setBattery(uint8_t level);
+
+  /**
+   * @fn: wireTimeUs
+   * @brief: Modelled bus time of one transaction at the configured clock, overhead included
+   * @param len: data bytes
+   * @param read: true for a read (pointer write + read)
+   */
+  static uint32_t wireTimeUs(uint8_t len, bool read);
+
+  static sSimStats_t getSimStats(void);
+  static void resetSimStats(void);
+
+protected:
+  virtual uint8_t writeReg(uint8_t reg, uint8_t *data, uint8_t len);
+  virtual int16_t readReg(uint8_t reg, uint8_t *data, uint8_t len);
+
+private:
+  uint8_t __I2C_addr;
+
+  static void __lockBus(void);
+  static void __unlockBus(void);
+  static bool __nackNext(void);
+  static void __powerOnReset(uint32_t now);
+  static void __applyWrite(uint8_t reg, const uint8_t *data, uint8_t len, uint32_t now);
+  static void __refreshSensors(uint32_t now);
+  static void __holdBus(uint32_t busUs, uint32_t wireBytes, bool read, bool nacked);
+
+  static SemaphoreHandle_t __busMutex; ///< Recursive, stands for the shared I2C bus
+  static portMUX_TYPE __simLock;       ///< Guards the model below
+  static sSimConfig_t __config;
+  static uint8_t __regs[256];
+  static uint32_t __modeSince[6];      ///< micros() of the last mode change per port
+  static uint32_t __dhtStart[6];       ///< micros() of the last DHT start
+  static uint32_t __ds18b20Start[6];
+  static uint32_t __sr04Start;
+  static uint8_t __dhtActive;          ///< Bit n: a DHT conversion was started on port n
+  static uint8_t __ds18b20Active;
+  static bool __sr04Active;
+  static uint16_t __analog[6];
+  static uint8_t __inputs;             ///< Bit n: input level of port n
+  static int16_t __dhtHundredths[6][2]; ///< Temperature and humidity in 1/100
+  static int16_t __ds18b20Sixteenths[6];
+  static uint8_t __ds18b20Present;     ///< Bit n: a DS18B20 answers on port n
+  static int16_t __sr04Distance;
+  static uint8_t __battery;
+  static uint32_t __nackPending;
+  static uint32_t __random;
+  static sSimStats_t __stats;
+  static uint32_t __statsSince;
+};
+
+/// Transport used by ServoService and DFR1216Service for the expansion board
+#ifdef DFR1216_SIMULATED
+typedef DFR1216_Sim DFR1216_Transport;
+#else
+typedef DFR1216_I2C DFR1216_Transport;
+#endif
+
+#endif
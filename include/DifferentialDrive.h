@@ -0,0 +1,107 @@
+/**
+ * @file DifferentialDrive.h
+ * @brief Fixed-point twist (linear, angular) to left/right wheel command mixer.
+ * @details Linear and angular commands are in 1/1000 of full wheel speed; a
+ *          positive angular command turns counter-clockwise (right wheel faster).
+ *          - mixing: left = linear - angular, right = linear + angular; when a wheel
+ *            saturates both are scaled by the same factor, so the turn radius is
+ *            kept and only the speed drops
+ *          - acceleration limit: the wheel pair moves toward its target along a
+ *            straight line in wheel space, at most accel_limit per second on the
+ *            wheel that has the farthest to go (the curvature holds during ramps)
+ *          - deadband compensation: a non-zero wheel command starts just above the
+ *            motor deadband, so the first units of a command already move the robot
+ *          - inversion and motor mapping are applied last, per wheel
+ *          One instance is owned by the actuator commit task and stepped at the
+ *          control rate; no floating point is used.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct DriveConfig
+{
+    uint8_t left_motor = 0;    ///< Motor index (0-3) of the left wheel
+    uint8_t right_motor = 1;   ///< Motor index (0-3) of the right wheel
+    bool invert_left = false;  ///< Left motor turns backward for a positive duty
+    bool invert_right = false; ///< Right motor turns backward for a positive duty
+    uint16_t deadband = 0;     ///< Duty (1/1000) below which the motors do not turn (0-500)
+    uint16_t accel_limit = 0;  ///< Wheel command change per second (1/1000 of full speed per s, 0 = none)
+
+    /** @brief "left:right:invert_left:invert_right:deadband:accel_limit" (SettingsService format). */
+    std::string toString() const;
+
+    /** @brief Parse toString() output. @return false if malformed (config unchanged). */
+    bool fromString(const char *text);
+
+    /** @brief Check ranges. @param error Set to a short reason on failure */
+    bool validate(std::string &error) const;
+};
+
+class DifferentialDrive
+{
+public:
+    static constexpr int32_t FULL_SCALE = 1000;
+
+    /**
+     * @brief Saturation-preserving mix of a twist into wheel commands.
+     * @param linear  Forward command (-1000..1000)
+     * @param angular Counter-clockwise command (-1000..1000)
+     */
+    static void mix(int32_t linear, int32_t angular, int32_t &left, int32_t &right);
+
+    /**
+     * @brief Map a wheel command to a signed motor duty (1/1000) outside the deadband.
+     */
+    static int32_t compensate(int32_t wheel, uint16_t deadband);
+
+    /**
+     * @brief Inverse of compensate(): wheel command that produced a duty.
+     */
+    static int32_t uncompensate(int32_t duty, uint16_t deadband);
+
+    void configure(const DriveConfig &config) { config_ = config; }
+    const DriveConfig &config() const { return config_; }
+
+    /** @brief Place the wheels on known commands (no ramp), e.g. when taking over the motors. */
+    void reset(int32_t left, int32_t right);
+
+    /** @brief New twist target; the wheels ramp to it in step(). */
+    void setTarget(int32_t linear, int32_t angular);
+
+    /**
+     * @brief Advance the wheel commands by one control period.
+     * @param dt_us Elapsed time since the previous step in µs
+     * @return true if the wheel commands changed
+     */
+    bool step(uint32_t dt_us);
+
+    /**
+     * @brief Pull forward wheel commands back to at most @p max (obstacle reflex).
+     * @details Both wheels are scaled by the factor that brings the faster forward
+     *          one to @p max, so the curvature is kept. The target is kept, so the
+     *          ramp resumes from the limited commands once the limit is lifted
+     *          instead of jumping back.
+     * @return true if a wheel command was lowered
+     */
+    bool limitForward(int32_t max);
+
+    int32_t left() const { return left_; }
+    int32_t right() const { return right_; }
+    int32_t targetLeft() const { return target_left_; }
+    int32_t targetRight() const { return target_right_; }
+
+    /** @brief Signed duty (1/1000) of the left motor: compensated and inverted. */
+    int32_t leftDuty() const;
+    /** @brief Signed duty (1/1000) of the right motor: compensated and inverted. */
+    int32_t rightDuty() const;
+
+private:
+    DriveConfig config_;
+    int32_t left_ = 0;
+    int32_t right_ = 0;
+    int32_t target_left_ = 0;
+    int32_t target_right_ = 0;
+    int64_t step_rem_ = 0; ///< Sub-unit remainder of accel_limit * dt
+};
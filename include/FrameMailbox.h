@@ -0,0 +1,61 @@
+/**
+ * @file FrameMailbox.h
+ * @brief Single-slot mailbox holding the latest camera frame, with generation numbers.
+ * @details The producer posts every camera frame: the new one replaces the one in
+ *          the slot, which is handed back to the producer to release (counted as
+ *          dropped, nobody took it). Each post increments the generation; a consumer
+ *          takes the frame only if its generation is newer than the last one it
+ *          saw, and owns it from then on (the slot is empty until the next post).
+ *          Frames never pile up, whatever the consumers do, and a consumer never
+ *          gets a frame older than the one it already had.
+ *          Statistics: posts, takes, drops and the capture-to-take age of the
+ *          frames taken. Frames are opaque pointers with their capture time;
+ *          timestamps are microseconds of the owner's clock. The owner serialises
+ *          the calls (and does the waiting); nothing here allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+
+class FrameMailbox
+{
+public:
+    struct Stats
+    {
+        uint32_t generation = 0;  ///< Frames posted, also the generation of the latest one
+        uint32_t taken = 0;
+        uint32_t dropped = 0;     ///< Replaced or cleared before anyone took them
+        uint32_t age_us_min = 0;  ///< Capture to take, frames taken
+        uint32_t age_us_avg = 0;
+        uint32_t age_us_max = 0;
+        uint32_t age_us_last = 0;
+        bool full = false;        ///< A frame is waiting in the slot
+    };
+
+    /**
+     * @brief Put the latest frame in the slot.
+     * @return The frame it replaces, for the caller to release; nullptr if the slot was empty
+     */
+    void *post(void *frame, int64_t capture_us);
+
+    /**
+     * @brief Take the frame if it is newer than generation.
+     * @param generation Last generation the consumer saw; updated when a frame is returned
+     * @return The frame (now owned by the caller), nullptr if none newer is waiting
+     */
+    void *take(uint32_t &generation, int64_t now_us);
+
+    /** @brief Empty the slot. @return The frame it held (counted as dropped), for the caller to release */
+    void *clear();
+
+    uint32_t generation() const { return stats_.generation; }
+
+    /** @brief Statistics with the averages computed. */
+    Stats stats() const;
+
+private:
+    void *frame_ = nullptr;
+    int64_t capture_us_ = 0;
+    uint64_t age_sum_us_ = 0;
+    Stats stats_;
+};
@@ -0,0 +1,114 @@
+/**
+ * @file FrameTransport.h
+ * @brief Camera frames over datagrams: subscribed peers and JPEG fragmentation.
+ * @details A peer (UDP address, or WebSocket bridge client) subscribes for a lease
+ *          of LEASE_US and renews it by subscribing again; it may cap its frame
+ *          rate. Each JPEG is cut into fragments of at most MAX_DATAGRAM bytes:
+ *
+ *            [action][version][frame_id:2][index:2][count:2][frame_len:4][capture_us:8][payload]
+ *
+ *          little-endian, HEADER_SIZE bytes of header, fragment i carrying bytes
+ *          i * MAX_PAYLOAD onwards of the frame. Nothing is retransmitted: a peer
+ *          drops a frame it did not get every fragment of, and the sender stops
+ *          sending a frame to a peer at its first failed send (counted as aborted).
+ *          Timestamps are microseconds of the owner's clock; the owner serialises
+ *          the calls. Nothing allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct FramePeer
+{
+    uint32_t ipv4 = 0;              ///< Sender address (network order as IPAddress stores it), 0: free slot
+    uint16_t port = 0;
+    uint32_t ws_client = 0;         ///< WebSocket bridge client id, 0 for a UDP peer
+    uint32_t min_interval_us = 0;   ///< From the requested frame rate, 0: every frame
+    int64_t expires_us = 0;
+    int64_t last_sent_us = 0;
+    uint32_t frames_sent = 0;       ///< Every fragment handed to the network
+    uint32_t frames_aborted = 0;    ///< Cut short by a failed send: the peer drops them
+    uint32_t frames_skipped = 0;    ///< Not sent to keep under the requested frame rate
+    uint32_t fragments_sent = 0;
+};
+
+class FrameTransport
+{
+public:
+    static constexpr uint8_t MAX_PEERS = 4;
+    static constexpr uint32_t LEASE_US = 5000000;
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 20;
+    static constexpr size_t MAX_DATAGRAM = 1400;   ///< Under the 1472-byte UDP payload of a 1500 MTU
+    static constexpr size_t MAX_PAYLOAD = MAX_DATAGRAM - HEADER_SIZE;
+
+    struct Header
+    {
+        uint8_t action = 0;
+        uint8_t version = 0;
+        uint16_t frame_id = 0;
+        uint16_t index = 0;
+        uint16_t count = 0;
+        uint32_t frame_len = 0;
+        uint64_t capture_us = 0;
+    };
+
+    /** @brief A peer a frame is due to, copied out so it can be sent to outside the owner's lock. */
+    struct Target
+    {
+        uint8_t slot = 0;
+        uint32_t ipv4 = 0;
+        uint16_t port = 0;
+        uint32_t ws_client = 0;
+    };
+
+    /**
+     * @brief Subscribe a peer, or renew its lease and frame rate.
+     * @param max_fps Frame rate cap, 0 for every frame
+     * @return false when every slot is taken
+     */
+    bool subscribe(uint32_t ipv4, uint16_t port, uint32_t ws_client, uint8_t max_fps, int64_t now_us);
+
+    /** @return false if the peer was not subscribed */
+    bool unsubscribe(uint32_t ipv4, uint16_t port, uint32_t ws_client);
+
+    /** @brief Drop the peers whose lease ended. @return peers left */
+    uint8_t expire(int64_t now_us);
+
+    void clear();
+
+    uint8_t peers() const;
+
+    /** @brief The subscribed peer, nullptr if none. */
+    const FramePeer *find(uint32_t ipv4, uint16_t port, uint32_t ws_client) const;
+
+    /**
+     * @brief Peers a new frame is due to (frame rate cap applied, skips counted).
+     * @return Number of targets filled
+     */
+    uint8_t due(int64_t now_us, Target out[MAX_PEERS]);
+
+    /** @brief Outcome of sending a frame to a target (ignored if its slot changed hands). */
+    void sent(const Target &target, bool complete, uint16_t fragments);
+
+    const FramePeer &peer(uint8_t slot) const { return peers_[slot]; }
+
+    /** @brief Fragments a frame of frame_len bytes is cut into. */
+    static uint16_t fragmentCount(size_t frame_len);
+
+    /**
+     * @brief Write fragment index of a frame into out (MAX_DATAGRAM bytes).
+     * @return Datagram length, 0 when index is past the last fragment
+     */
+    static size_t buildFragment(uint8_t action, uint16_t frame_id, uint64_t capture_us,
+                                const uint8_t *frame, size_t frame_len, uint16_t index, uint8_t *out);
+
+    /** @brief Decode a fragment header. @return false if too short or inconsistent */
+    static bool parseHeader(const uint8_t *datagram, size_t len, Header &header);
+
+private:
+    FramePeer peers_[MAX_PEERS];
+
+    int8_t slotOf(uint32_t ipv4, uint16_t port, uint32_t ws_client) const;
+};
@@ -0,0 +1,82 @@
+/**
+ * @file HeartbeatWatchdog.h
+ * @brief Deadline bookkeeping of the master heartbeat watchdog.
+ * @details Every accepted heartbeat moves the deadline to now + timeout; the owner
+ *          arms a one-shot timer for that deadline and calls expire() when it fires.
+ *          A callback can be overtaken by a heartbeat (it was already dispatched when
+ *          the timer was re-armed): expire() then sees a deadline in the future and
+ *          refuses the stop, the re-armed timer covers the new deadline.
+ *          The stop fires once per timeout; the next heartbeat ends the timeout.
+ *          recordStop() measures deadline to stop completed, i.e. timer lateness plus
+ *          the stop path itself, into a log2 histogram; recordFailedStop() counts a
+ *          stop that did not reach the bus, outside the latency.
+ *          The class knows nothing about real time: timestamps are microseconds of
+ *          the owner's clock (esp_timer_get_time() on target, a simulated clock on a
+ *          host), and the owner serialises the calls.
+ */
+#pragma once
+
+#include <stdint.h>
+
+class HeartbeatWatchdog
+{
+public:
+    struct Stats
+    {
+        static constexpr uint8_t HIST_BUCKETS = 16;
+        uint32_t heartbeats = 0;        ///< Heartbeats accepted (timer re-armed)
+        uint32_t expiries = 0;          ///< Timeouts that triggered the stop
+        uint32_t stale_expiries = 0;    ///< Timer callbacks overtaken by a heartbeat or a reset
+        uint32_t restores = 0;          ///< Heartbeats that ended a timeout
+        uint32_t failed_stops = 0;      ///< Granted stops whose write did not reach the bus
+        uint32_t timer_late_max_us = 0; ///< Worst deadline to callback delay
+        uint32_t latency_min_us = 0;    ///< Deadline to stop completed
+        uint32_t latency_max_us = 0;
+        uint32_t latency_avg_us = 0;
+        uint32_t latency_last_us = 0;
+        uint32_t hist[HIST_BUCKETS] = {}; ///< Bucket n: latency in [2^n, 2^(n+1)) us, bucket 0 also holds 0
+    };
+
+    explicit HeartbeatWatchdog(uint32_t timeout_us = 50000) : timeout_us_(timeout_us) {}
+
+    uint32_t timeout() const { return timeout_us_; }
+
+    /** @brief New session (master registered or cleared): disarmed, not timed out. Stats are kept. */
+    void reset();
+
+    /**
+     * @brief Accept a heartbeat; the deadline becomes now_us + timeout().
+     * @return true if the heartbeat ended a timeout (link restored)
+     */
+    bool feed(uint64_t now_us);
+
+    /**
+     * @brief Timer callback.
+     * @return true if the stop must run now: armed, deadline reached and not already
+     *         timed out. A stale callback returns false.
+     */
+    bool expire(uint64_t now_us);
+
+    /** @brief Record completion of the stop granted by expire(). */
+    void recordStop(uint64_t now_us);
+
+    /** @brief Record that the stop granted by expire() failed to reach the bus. */
+    void recordFailedStop() { stats_.failed_stops++; }
+
+    bool armed() const { return armed_; }
+    bool timedOut() const { return timed_out_; }
+    uint64_t deadline() const { return deadline_us_; }
+
+    const Stats &stats() const { return stats_; }
+    void resetStats();
+
+private:
+    uint32_t timeout_us_;
+    uint64_t deadline_us_ = 0;
+    uint64_t expired_deadline_us_ = 0; ///< Deadline of the last granted stop
+    uint64_t latency_sum_us_ = 0;
+    uint32_t stop_count_ = 0; ///< Stops recorded (latency average divisor)
+    bool armed_ = false;
+    bool timed_out_ = false;
+    Stats stats_;
+};
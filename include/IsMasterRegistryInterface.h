@@ -1,5 +1,6 @@
 #pragma once
 
+#include <IPAddress.h>
 #include <string>
 
 /**
@@ -20,6 +21,32 @@ struct IsMasterRegistryInterface
      */
     virtual bool isMaster(const std::string &ip) const = 0;
 
+    /**
+     * @brief Same check on a binary address, for per-packet and per-request paths.
+     * @details The default formats the address and calls isMaster(); registries that
+     *          store the address in binary override it to avoid the String allocation.
+     * @param ip Sender address (UDP packet or HTTP client)
+     * @return true if ip matches the registered master IP
+     */
+    virtual bool isMasterAddress(const IPAddress &ip) const
+    {
+        return isMaster(ip.toString().c_str());
+    }
+
+    /**
+     * @brief Check whether a peer may send a master-gated action.
+     * @details The default allows the master only; registries with peer roles
+     *          (AmakerBotService) also allow the actions granted to the sender.
+     * @param action Action byte of the request
+     * @param ip     Sender address
+     * @return true if the action may run
+     */
+    virtual bool isActionAllowed(uint8_t action, const IPAddress &ip) const
+    {
+        (void)action;
+        return isMasterAddress(ip);
+    }
+
     /**
      * @brief Return the currently registered master IP address.
      * @return Master IP string, empty if no master is registered
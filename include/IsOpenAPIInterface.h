@@ -352,8 +352,7 @@ protected:
      */
     bool checkIsRequestFromMaster(AsyncWebServerRequest *request, const IsMasterRegistryInterface *masterRegistry)
     {
-        std::string ip = request->client()->remoteIP().toString().c_str();
-        if (!masterRegistry || !masterRegistry->isMaster(ip))
+        if (!masterRegistry || !masterRegistry->isMasterAddress(request->client()->remoteIP()))
         {
             request->send(403, RoutesConsts::mime_json,
                           getResultJsonString(RoutesConsts::result_err,
@@ -0,0 +1,104 @@
+/**
+ * @file JpegBufferPool.h
+ * @brief Fixed pool of size-classed JPEG frame buffers.
+ * @details All buffers are allocated once by begin() (the owner passes the allocator,
+ *          PSRAM on the device) and each slot embeds its JpegFrame, so encoding and
+ *          fanning out a frame no longer touches the heap. take() hands out the
+ *          smallest free slot able to hold the expected size, or the largest free
+ *          one when none fits: the encoder writes into it directly and reports an
+ *          overflow when the JPEG did not fit after all.
+ *          Statistics: slots in use and their high-water mark, per class and in
+ *          total, takes, exhaustions (no slot of the wanted class free, and no slot
+ *          free at all), overflows and frames the owner had to allocate elsewhere.
+ *          The owner serialises the calls.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "JpegFanout.h"
+
+struct JpegPoolClass
+{
+    uint32_t size;  ///< Buffer bytes
+    uint8_t count;  ///< Buffers of this size
+};
+
+class JpegBufferPool
+{
+public:
+    static constexpr uint8_t MAX_CLASSES = 4;
+    static constexpr uint8_t MAX_SLOTS = 16;
+
+    typedef void *(*AllocFn)(size_t size);
+    typedef void (*FreeFn)(void *ptr);
+
+    struct ClassStats
+    {
+        uint32_t size = 0;
+        uint8_t count = 0;
+        uint8_t in_use = 0;
+        uint8_t high_water = 0;
+        uint32_t takes = 0;
+        uint32_t exhausted = 0;  ///< Wanted this class, all its buffers were in use
+    };
+
+    struct Stats
+    {
+        uint8_t classes = 0;
+        uint8_t slots = 0;
+        uint8_t in_use = 0;
+        uint8_t high_water = 0;
+        uint32_t bytes = 0;      ///< Total buffer bytes
+        uint32_t takes = 0;
+        uint32_t exhausted = 0;  ///< No buffer free at all: the frame was skipped
+        uint32_t overflows = 0;  ///< The JPEG did not fit the buffer taken for it
+        uint32_t fallbacks = 0;  ///< Frames the owner allocated outside the pool
+        ClassStats cls[MAX_CLASSES];
+    };
+
+    JpegBufferPool() = default;
+    JpegBufferPool(const JpegBufferPool &) = delete;
+    JpegBufferPool &operator=(const JpegBufferPool &) = delete;
+    ~JpegBufferPool() { end(); }
+
+    /**
+     * @brief Allocate every buffer.
+     * @param classes Size classes, by increasing size, MAX_SLOTS buffers at most in total
+     * @return false (nothing kept) on bad classes or allocation failure
+     */
+    bool begin(const JpegPoolClass *classes, uint8_t count, AllocFn alloc, FreeFn dealloc);
+
+    /** @brief Free every buffer. @return false (nothing freed) while a buffer is in use */
+    bool end();
+
+    bool ready() const { return slots_ != 0; }
+
+    /** @brief Largest buffer size, 0 if not ready. */
+    uint32_t largest() const;
+
+    /**
+     * @brief Take a free buffer for a JPEG of about expected bytes.
+     * @return Frame with data / capacity set and len 0, nullptr if every buffer is in use
+     */
+    JpegFrame *take(size_t expected);
+
+    /** @brief Put back a frame from take(); its data buffer is kept for the next take. */
+    void give(JpegFrame *frame);
+
+    /** @brief The frame came from this pool. */
+    bool owns(const JpegFrame *frame) const;
+
+    void overflowed() { stats_.overflows++; }
+    void fellBack() { stats_.fallbacks++; }
+
+    const Stats &stats() const { return stats_; }
+
+private:
+    JpegFrame frames_[MAX_SLOTS];
+    uint8_t class_of_[MAX_SLOTS] = {};
+    bool busy_[MAX_SLOTS] = {};
+    uint8_t slots_ = 0;
+    FreeFn dealloc_ = nullptr;
+    Stats stats_;
+};
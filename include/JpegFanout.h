@@ -0,0 +1,106 @@
+/**
+ * @file JpegFanout.h
+ * @brief Refcounted fan-out of the latest encoded camera frame.
+ * @details One encoder consumes each camera frame once and publishes the JPEG here;
+ *          every consumer (stream clients, snapshot, ...) acquires the latest frame
+ *          at its own pace and releases it when done. A frame holds one reference
+ *          for the hub while it is the latest, plus one per consumer still sending
+ *          it, and is freed by whoever drops the last reference: publish() and
+ *          release() return the frame to free instead of freeing it, so the owner
+ *          can call them under a spinlock and free outside.
+ *          Consumers that fall behind skip straight to the newest frame; the frames
+ *          they never saw are counted as skipped, and frames replaced before anyone
+ *          acquired them as superseded. Consumers serve their bytes straight out of
+ *          the frame (data and the preformatted part header) and report what they
+ *          copied, so the copy cost per delivered frame can be watched.
+ *          The owner serialises the calls; nothing here allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct JpegFrame
+{
+    uint8_t *data = nullptr;
+    size_t len = 0;
+    uint32_t capacity = 0;   ///< Bytes available at data (pooled buffers)
+    uint32_t seq = 0;        ///< Publication number, from 1
+    int64_t capture_us = 0;  ///< Camera capture timestamp (µs)
+    uint32_t encode_us = 0;  ///< Time spent producing the JPEG
+    uint32_t copied = 0;     ///< Bytes copied to produce the frame (JPEG passed through)
+    char part_header[72] = {};    ///< MJPEG multipart part header, formatted once for every stream client
+    uint8_t part_header_len = 0;
+    uint16_t refs = 0;       ///< Guarded by the owner of the JpegFanout
+    bool acquired = false;   ///< Acquired by at least one consumer
+};
+
+class JpegFanout
+{
+public:
+    struct Stats
+    {
+        uint32_t encoded = 0;     ///< Frames published
+        uint32_t delivered = 0;   ///< Frames fully handed to a consumer (one count per consumer)
+        uint32_t skipped = 0;     ///< Frames a consumer never saw because it was behind
+        uint32_t superseded = 0;  ///< Frames replaced before any consumer acquired them
+        uint64_t copied_bytes = 0; ///< Bytes copied by the encoder and the consumers
+        uint32_t encode_us_min = 0;
+        uint32_t encode_us_avg = 0;
+        uint32_t encode_us_max = 0;
+        uint32_t encode_us_last = 0;
+        uint32_t last_size = 0;   ///< Bytes of the latest frame
+        uint16_t live = 0;        ///< Frames published and not yet freed
+        uint8_t subscribers = 0;
+    };
+
+    /** @brief A consumer wants frames: the encoder runs while there is at least one. */
+    void subscribe();
+    void unsubscribe();
+    uint8_t subscribers() const { return stats_.subscribers; }
+
+    /**
+     * @brief Make frame the latest (the hub takes one reference).
+     * @return The previous latest frame if nobody references it any more (caller frees it),
+     *         nullptr otherwise
+     */
+    JpegFrame *publish(JpegFrame *frame);
+
+    /**
+     * @brief Take a reference to the latest frame if it is newer than after_seq.
+     * @param after_seq Sequence of the last frame this consumer got, 0 for none
+     * @return nullptr if there is no newer frame yet
+     */
+    JpegFrame *acquire(uint32_t after_seq);
+
+    /**
+     * @brief Drop a consumer reference.
+     * @return frame if it is no longer referenced (caller frees it), nullptr otherwise
+     */
+    JpegFrame *release(JpegFrame *frame);
+
+    /**
+     * @brief A consumer finished sending a frame.
+     * @param previous_seq Sequence of the consumer's previous frame, 0 for its first
+     * @param copied       Bytes the consumer copied to send it
+     */
+    void delivered(uint32_t previous_seq, uint32_t seq, size_t copied);
+
+    /**
+     * @brief Drop the hub reference to the latest frame (camera stopped or resized).
+     * @return The frame if nobody else references it (caller frees it), nullptr otherwise
+     */
+    JpegFrame *clear();
+
+    uint32_t latestSeq() const { return latest_ ? latest_->seq : 0; }
+
+    const Stats &stats() const { return stats_; }
+
+private:
+    JpegFrame *latest_ = nullptr;
+    uint32_t next_seq_ = 1;
+    uint64_t encode_us_sum_ = 0;
+    Stats stats_;
+
+    JpegFrame *unref(JpegFrame *frame);
+};
@@ -0,0 +1,82 @@
+/**
+ * @file KeyframeTimeline.h
+ * @brief Multi-channel keyframe timeline (servos and DC motors) with fixed-point interpolation.
+ * @details A timeline is uploaded as JSON:
+ * @code
+ * {"id":1,"interpolation":"cubic","loop":true,
+ *  "tracks":[{"servo":0,"keys":[[0,0],[400,30],[800,0]]},
+ *            {"motor":1,"keys":[[0,0],[800,60]]}]}
+ * @endcode
+ *          - each key is [time_ms, value]; times are strictly increasing within a track
+ *          - servo value: centre-zero angle (angular servos) or speed -100..100 (rotational)
+ *          - motor value: speed -100..100, motors are numbered 1-4
+ *          - interpolation: "linear" (default) or "cubic" (Catmull-Rom, passes through every key)
+ *          Values are kept in milli-units so sampling needs no floating point.
+ */
+#pragma once
+
+#include <ArduinoJson.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class KeyframeTimeline
+{
+public:
+    enum class Target : uint8_t
+    {
+        SERVO = 0,
+        MOTOR = 1
+    };
+
+    enum class Interpolation : uint8_t
+    {
+        LINEAR = 0,
+        CUBIC = 1
+    };
+
+    struct Keyframe
+    {
+        uint32_t time_ms;
+        int32_t value; ///< milli-degrees or milli-percent
+    };
+
+    struct Track
+    {
+        Target target;
+        uint8_t channel; ///< Servo channel 0-7, or motor index 0-3
+        std::vector<Keyframe> keys;
+    };
+
+    static constexpr uint8_t MAX_TRACKS = 12;      ///< 8 servo channels + 4 motors
+    static constexpr uint16_t MAX_KEYFRAMES = 256; ///< Per track
+
+    /**
+     * @brief Validate and compile a JSON timeline.
+     * @param root  Parsed JSON document root
+     * @param error Set to a short reason when parsing fails
+     * @return true if the timeline is valid (previous content is replaced)
+     */
+    bool parse(JsonVariantConst root, std::string &error);
+
+    /**
+     * @brief Value of a track at a given time (held before the first and after the last key).
+     * @return Interpolated value in milli-units
+     */
+    int32_t sample(const Track &track, uint32_t time_ms) const;
+
+    void clear();
+    bool empty() const { return tracks_.empty(); }
+    uint8_t id() const { return id_; }
+    bool loop() const { return loop_; }
+    Interpolation interpolation() const { return interpolation_; }
+    uint32_t durationMs() const { return duration_ms_; }
+    const std::vector<Track> &tracks() const { return tracks_; }
+
+private:
+    std::vector<Track> tracks_;
+    uint32_t duration_ms_ = 0;
+    uint8_t id_ = 0;
+    bool loop_ = false;
+    Interpolation interpolation_ = Interpolation::LINEAR;
+};
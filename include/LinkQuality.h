@@ -0,0 +1,120 @@
+/**
+ * @file LinkQuality.h
+ * @brief Streaming link statistics of one master session (heartbeat and ping).
+ * @details Fed by the master's heartbeats and pings, the model keeps, per session:
+ *          - the heartbeat inter-arrival gaps: min / average / longest, a linear
+ *            histogram and an interarrival jitter (RFC 3550 estimator, gain 1/16)
+ *          - the heartbeats lost, duplicated or reordered, estimated from the
+ *            optional 16-bit heartbeat counter sent by the master (a jump back by
+ *            more than REORDER_WINDOW or forward by more than MAX_LOSS_RUN is taken
+ *            as a counter restart)
+ *          - near-timeouts: gaps of at least near_timeout_pct of the watchdog
+ *            timeout that still arrived in time
+ *          - the ping round trip time reported by the master (the device only sees
+ *            one leg of a ping)
+ *          - a quality score (0-1000): EWMA (gain 1/8) of a per-heartbeat sample
+ *            that is 1000 up to half the timeout and falls linearly to 0 at the
+ *            timeout; a lost heartbeat or a timeout counts as a 0 sample
+ *          With derating enabled, speedScale() turns a quality below derate_below
+ *          into a wheel speed scale, linear from min_scale (quality 0) to full scale.
+ *          Timestamps are microseconds of the owner's clock; the owner serialises
+ *          the calls. No floating point, nothing allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct LinkConfig
+{
+    bool derate = false;            ///< Scale the wheel speed down when the quality drops
+    uint8_t near_timeout_pct = 80;  ///< Gap (% of the watchdog timeout) counted as a near-timeout
+    uint16_t derate_below = 700;    ///< Quality (0-1000) under which the speed is scaled down
+    uint16_t min_scale = 300;       ///< Speed scale (1/1000) at quality 0
+
+    /** @brief "derate:near_timeout_pct:derate_below:min_scale" (SettingsService format). */
+    std::string toString() const;
+
+    /** @brief Parse toString() output. @return false if malformed (config unchanged). */
+    bool fromString(const char *text);
+
+    /** @brief Check ranges. @param error Set to a short reason on failure */
+    bool validate(std::string &error) const;
+};
+
+class LinkQuality
+{
+public:
+    static constexpr uint16_t FULL_SCALE = 1000;
+    static constexpr uint8_t HIST_BUCKETS = 16;
+    static constexpr uint32_t HIST_WIDTH_US = 5000; ///< Gap histogram bucket width
+    static constexpr uint16_t REORDER_WINDOW = 64;  ///< Older counters are a counter restart, not a late heartbeat
+    static constexpr uint16_t MAX_LOSS_RUN = 4096;  ///< Longer counter jumps are a counter restart, not a loss
+
+    struct Stats
+    {
+        uint32_t heartbeats = 0;    ///< Heartbeats received (duplicates and late ones excluded)
+        uint32_t lost = 0;          ///< Counter gaps not filled by a late heartbeat
+        uint32_t duplicates = 0;
+        uint32_t reordered = 0;     ///< Heartbeats older than the latest counter
+        uint32_t gap_min_us = 0;
+        uint32_t gap_avg_us = 0;
+        uint32_t gap_max_us = 0;    ///< Longest gap of the session
+        uint32_t jitter_us = 0;
+        uint32_t near_timeouts = 0;
+        uint32_t timeouts = 0;
+        uint32_t rtt_reports = 0;
+        uint32_t rtt_min_us = 0;
+        uint32_t rtt_avg_us = 0;
+        uint32_t rtt_max_us = 0;
+        uint32_t rtt_last_us = 0;
+        uint16_t quality = FULL_SCALE;
+        uint32_t hist[HIST_BUCKETS] = {}; ///< Bucket n: gap in [n, n+1) * HIST_WIDTH_US, last bucket open-ended
+
+        /** @brief lost / (heartbeats + lost), in 1/1000. */
+        uint16_t lossPermille() const;
+    };
+
+    explicit LinkQuality(uint32_t timeout_us = 50000) : timeout_us_(timeout_us) {}
+
+    void configure(const LinkConfig &config) { config_ = config; }
+    const LinkConfig &config() const { return config_; }
+
+    /** @brief New master session: every statistic restarts, the configuration is kept. */
+    void reset();
+
+    /**
+     * @brief Account a heartbeat.
+     * @param has_seq The heartbeat carries the master's counter
+     * @param seq     Counter, incremented by one per heartbeat sent (wraps)
+     */
+    void onHeartbeat(uint64_t now_us, bool has_seq = false, uint16_t seq = 0);
+
+    /** @brief Round trip time of a ping, as measured by the master. */
+    void onPing(uint32_t rtt_us);
+
+    /** @brief The watchdog timed out: the quality drops to 0. */
+    void onTimeout();
+
+    /** @brief Wheel speed scale (1/1000) for the current quality; full scale unless derating. */
+    uint16_t speedScale() const;
+
+    const Stats &stats() const { return stats_; }
+
+private:
+    uint32_t timeout_us_;
+    LinkConfig config_;
+    Stats stats_;
+    uint64_t last_us_ = 0;
+    uint64_t gap_sum_us_ = 0;
+    uint64_t rtt_sum_us_ = 0;
+    uint32_t gaps_ = 0;
+    uint32_t prev_gap_us_ = 0;
+    uint32_t jitter_q4_ = 0;  ///< Jitter * 16
+    uint32_t quality_q8_ = static_cast<uint32_t>(FULL_SCALE) << 8; ///< Quality * 256
+    uint16_t last_seq_ = 0;
+    bool has_last_ = false;
+    bool has_seq_ = false;
+
+    void sample(uint32_t value);
+};
@@ -0,0 +1,71 @@
+/**
+ * @file MotionProfile.h
+ * @brief Fixed-point online motion profile generator (trapezoidal or S-curve).
+ * @details One instance per actuator channel. All state is kept in integer
+ *          milli-units (1/1000 degree, 1/1000 degree/s, ...) so stepping at the
+ *          control rate needs no floating point. The profile is re-planned on
+ *          every step, which means the target can change mid-move without
+ *          stopping first.
+ *          - max_jerk == 0 : trapezoidal velocity profile (bounded acceleration)
+ *          - max_jerk  > 0 : S-curve profile (acceleration ramps at max_jerk)
+ */
+#pragma once
+
+#include <stdint.h>
+
+class MotionProfile
+{
+public:
+    /**
+     * @brief Set the motion limits (0 velocity or acceleration disables the profile).
+     * @param max_velocity     Maximum velocity in degree/s
+     * @param max_acceleration Maximum acceleration in degree/s²
+     * @param max_jerk         Maximum jerk in degree/s³ (0 = trapezoidal profile)
+     */
+    void setLimits(uint16_t max_velocity, uint16_t max_acceleration, uint16_t max_jerk);
+
+    /**
+     * @brief Place the profile at rest on a known position.
+     * @param position_mdeg Position in 1/1000 degree
+     */
+    void reset(int32_t position_mdeg);
+
+    /**
+     * @brief Start (or re-plan) a move toward a new target from the current state.
+     * @param target_mdeg Target position in 1/1000 degree
+     */
+    void setTarget(int32_t target_mdeg);
+
+    /**
+     * @brief Advance the profile by one control period.
+     * @param dt_us Elapsed time since the previous step in µs
+     * @return true on the step where the target is reached
+     */
+    bool step(uint32_t dt_us);
+
+    bool isEnabled() const { return max_velocity_ > 0 && max_acceleration_ > 0; }
+    bool isMoving() const { return moving_; }
+    bool hasPosition() const { return has_position_; }
+    int32_t position() const { return position_; }
+    int32_t target() const { return target_; }
+    int32_t velocity() const { return velocity_; }
+
+private:
+    static constexpr int32_t SETTLE_MDEG = 50; ///< Snap to target when closer than this at low speed
+
+    int32_t position_ = 0;     ///< 1/1000 degree
+    int32_t velocity_ = 0;     ///< 1/1000 degree/s
+    int32_t acceleration_ = 0; ///< 1/1000 degree/s² (S-curve only)
+    int32_t target_ = 0;
+    int64_t position_rem_ = 0; ///< Sub-milli-degree remainder of velocity * dt
+    int64_t velocity_rem_ = 0; ///< Sub-unit remainder of acceleration * dt
+
+    int32_t max_velocity_ = 0;
+    int32_t max_acceleration_ = 0;
+    int32_t max_jerk_ = 0;
+
+    bool moving_ = false;
+    bool has_position_ = false;
+
+    void settle();
+};
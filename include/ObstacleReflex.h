@@ -0,0 +1,93 @@
+/**
+ * @file ObstacleReflex.h
+ * @brief Range-based forward speed cap for the wheel motors (obstacle reflex).
+ * @details The reflex turns the latest forward range into the highest forward
+ *          duty the wheel motors may receive:
+ *          - at or below stop_distance no forward motion is allowed
+ *          - above it the allowed duty grows linearly and reaches full scale
+ *            speed_margin cm further, i.e. the robot trips when
+ *            range < stop_distance + speed_margin * forward duty / 1000,
+ *            so the faster it drives, the earlier it brakes
+ *          - once it intervenes, the cap is computed hysteresis cm closer than
+ *            the measured range, so it does not chatter at the boundary
+ *          - a missing or stale reading blocks forward motion (fail safe)
+ *          Reverse motion is never limited. The cap does not rewrite commands:
+ *          both wheels are scaled by the same factor until the faster forward one
+ *          is at the cap (so a turn keeps its curvature), and get their commanded
+ *          duty back as soon as the range allows it.
+ *          One instance is owned by the actuator commit task and updated once per
+ *          control period; no floating point is used.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct ReflexConfig
+{
+    bool enabled = false;
+    uint8_t port = 6;            ///< DFR1216 sensor port: 6 = SR04 connector, 0-5 = analog IR sensor (ADC)
+    uint16_t stop_distance = 15; ///< cm: forward motion is blocked at or below this range
+    uint16_t speed_margin = 40;  ///< cm of extra clearance needed at full forward duty (0 = stop_distance only)
+    uint16_t hysteresis = 5;     ///< cm the range must clear by before an intervention is lifted
+    uint16_t max_age_ms = 250;   ///< Readings older than this count as missing
+    uint16_t ir_scale = 30000;   ///< ADC port: range (cm) = ir_scale / ADC counts
+
+    /** @brief "enabled:port:stop_distance:speed_margin:hysteresis:max_age_ms:ir_scale" (SettingsService format). */
+    std::string toString() const;
+
+    /** @brief Parse toString() output. @return false if malformed (config unchanged). */
+    bool fromString(const char *text);
+
+    /** @brief Check ranges. @param error Set to a short reason on failure */
+    bool validate(std::string &error) const;
+};
+
+class ObstacleReflex
+{
+public:
+    enum class State : uint8_t
+    {
+        CLEAR = 0,    ///< Commands pass unchanged
+        LIMITING = 1, ///< Forward duty capped below what is commanded
+        BLOCKED = 2,  ///< No forward motion allowed (range at or below stop_distance)
+        NO_SENSOR = 3 ///< Reading missing or stale: forward motion blocked
+    };
+
+    static constexpr int32_t FULL_SCALE = 1000;
+    static constexpr int32_t NO_RANGE = -1;         ///< update(): no valid reading
+    static constexpr int32_t OUT_OF_RANGE = 0x7FFF; ///< update(): nothing within sensor range
+
+    /**
+     * @brief Highest forward duty (0-1000) allowed at a range.
+     */
+    static int32_t forwardCap(const ReflexConfig &config, int32_t range_cm);
+
+    /**
+     * @brief Range of an analog IR sensor, whose output falls with distance.
+     * @return cm, OUT_OF_RANGE for a reading too low to resolve
+     */
+    static int32_t irRange(uint16_t adc, uint16_t ir_scale);
+
+    static const char *stateName(State state);
+
+    /** @brief New configuration; the reflex restarts from CLEAR. */
+    void configure(const ReflexConfig &config);
+    const ReflexConfig &config() const { return config_; }
+
+    /**
+     * @brief Evaluate one control period.
+     * @param range_cm        Latest range, NO_RANGE or OUT_OF_RANGE
+     * @param forward_request Fastest forward duty commanded to a wheel (1/1000)
+     * @return true if the state changed
+     */
+    bool update(int32_t range_cm, int32_t forward_request);
+
+    State state() const { return state_; }
+    int32_t cap() const { return cap_; }
+
+private:
+    ReflexConfig config_;
+    State state_ = State::CLEAR;
+    int32_t cap_ = FULL_SCALE;
+};
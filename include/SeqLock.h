@@ -0,0 +1,69 @@
+/**
+ * @file SeqLock.h
+ * @brief Sequence lock for a small, trivially copyable state block.
+ * @details Writers bump the sequence to an odd value, update the block and bump it
+ *          back to even; readers copy the block and retry if the sequence was odd or
+ *          changed meanwhile. Readers never block a writer and never take a lock.
+ *          Writers must be serialised by the caller (on the ESP32: inside a
+ *          portENTER_CRITICAL section, so a writer cannot be preempted half-way and
+ *          readers only ever retry for the few cycles a write lasts).
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() = default;
+    explicit SeqLock(const T &initial) : data_(initial) {}
+
+    /**
+     * @brief Apply @p update to the block as one published change.
+     * @param update Callable taking a T& (must not throw)
+     */
+    template <typename Fn>
+    void write(Fn &&update)
+    {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        update(data_);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consistent copy of the block.
+     * @param retries Optional: incremented once per torn copy that had to be retried
+     */
+    T read(uint32_t *retries = nullptr) const
+    {
+        T copy;
+        for (;;)
+        {
+            const uint32_t before = sequence_.load(std::memory_order_acquire);
+            if (!(before & 1))
+            {
+                memcpy(static_cast<void *>(&copy), static_cast<const void *>(&data_), sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == before)
+                    return copy;
+            }
+            if (retries)
+                ++*retries;
+        }
+    }
+
+    /** @brief Number of completed writes. */
+    uint32_t version() const { return sequence_.load(std::memory_order_acquire) >> 1; }
+
+private:
+    std::atomic<uint32_t> sequence_{0};
+    T data_{};
+};
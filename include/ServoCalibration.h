@@ -0,0 +1,91 @@
+/**
+ * @file ServoCalibration.h
+ * @brief Per-channel servo calibration and the pulse lookup table compiled from it.
+ * @details A calibration describes one physical servo unit:
+ *          - angular servos: pulse at each end of travel and a centre trim
+ *            (negative and positive half-travels are mapped separately, so trim
+ *            moves the centre without moving the endpoints)
+ *          - continuous servos: full-speed forward/backward pulses, stop trim,
+ *            deadband (the first non-zero speed starts just outside it) and an
+ *            "expo" speed curve, 0 = linear to 100 = cubic, for finer low speeds
+ *          Fields left at 0 take the DFR1216 defaults, so an empty calibration
+ *          reproduces DFR1216::servoAnglePulse / DFR1216::servo360Pulse.
+ *          ServoPulseTable::compile() evaluates the model once per degree (or per
+ *          speed step) so the control path only reads the table.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct ServoCalibration
+{
+    uint16_t min_us = 0;      ///< Angular: pulse at -travel/2; continuous: full speed forward (0 = default)
+    uint16_t max_us = 0;      ///< Angular: pulse at +travel/2; continuous: full speed backward (0 = default)
+    int16_t trim_us = 0;      ///< Offset of the centre (angular) or stop (continuous) pulse
+    uint16_t deadband_us = 0; ///< Continuous: half-width of the no-motion band around stop
+    uint8_t expo = 0;         ///< Continuous: speed curve, 0 (linear) to 100 (cubic)
+
+    /** @brief "min:max:trim:deadband:expo" (SettingsService format). */
+    std::string toString() const;
+
+    /** @brief Parse toString() output. @return false if malformed (calibration unchanged). */
+    bool fromString(const char *text);
+};
+
+class ServoPulseTable
+{
+public:
+    enum class Model : uint8_t
+    {
+        NONE = 0,
+        CONTINUOUS = 1,
+        ANGULAR_180 = 2,
+        ANGULAR_270 = 3
+    };
+
+    static constexpr uint16_t PULSE_MIN_US = 400;
+    static constexpr uint16_t PULSE_MAX_US = 3500;
+    static constexpr int16_t TRIM_MAX_US = 300;
+
+    /**
+     * @brief Check a calibration against a model (after defaults are applied).
+     * @param error Set to a short reason on failure
+     */
+    static bool validate(Model model, const ServoCalibration &calibration, std::string &error);
+
+    /**
+     * @brief Evaluate the calibrated model into the table.
+     * @details NONE leaves a table of stop/centre pulses.
+     */
+    void compile(Model model, const ServoCalibration &calibration);
+
+    /**
+     * @brief Pulse for a centre-zero angle in 1/1000 degree (clamped to the travel).
+     * @details Whole degrees are a single read; fractions interpolate two entries.
+     */
+    uint16_t anglePulse(int32_t angle_mdeg) const;
+
+    /** @brief Pulse for a continuous servo speed (-100..100, positive = forward). */
+    uint16_t speedPulse(int8_t speed) const
+    {
+        if (speed < -100)
+            speed = -100;
+        else if (speed > 100)
+            speed = 100;
+        return table_[speed + 100];
+    }
+
+    uint16_t stopPulse() const { return speedPulse(0); }
+    Model model() const { return model_; }
+
+    /** @brief Calibration with the model defaults filled in. */
+    static ServoCalibration effective(Model model, const ServoCalibration &calibration);
+
+private:
+    static constexpr uint16_t TABLE_SIZE = 271; ///< One entry per degree of a 270° servo, or 201 speed steps
+
+    uint16_t table_[TABLE_SIZE] = {};
+    Model model_ = Model::NONE;
+    int32_t half_travel_deg_ = 0;
+};
@@ -0,0 +1,128 @@
+/**
+ * @file StreamRateController.h
+ * @brief Closed-loop JPEG quality / frame-rate / frame-size control of the camera stream.
+ * @details Each stream client reports, per frame it finished sending, the latency from
+ *          capture to its last byte handed to the network: it grows with the client's
+ *          send backlog. Every PERIOD_US the controller compares the worst latency of
+ *          the period with the target:
+ *          - over the target: lower the JPEG quality by QUALITY_STEP; at quality_min,
+ *            skip one more camera frame between two encoded ones; at max_skip, and
+ *            after DOWNSIZE_PERIODS such periods, go one frame size down (max_downsize
+ *            steps at most). When the encode time alone exceeds the target, a lower
+ *            quality barely helps: the frame size goes down first or, when resizing
+ *            is not allowed, one more frame is skipped.
+ *          - under LOW_WATER_PCT of the target for CALM_PERIODS periods: undo one
+ *            step, in the reverse order (frame size, skip, quality).
+ *          A period where frames were encoded but no client finished one counts as
+ *          over the target (every client is stuck). Disabled, it holds quality_max,
+ *          no skip and the configured frame size.
+ *          Timestamps are microseconds of the owner's clock; the owner serialises
+ *          the calls. No floating point, nothing allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct StreamRateConfig
+{
+    bool enabled = true;
+    uint16_t target_ms = 300;   ///< Capture-to-sent latency target
+    uint8_t quality_min = 30;   ///< JPEG quality bounds (1-100, higher is better)
+    uint8_t quality_max = 80;
+    uint8_t max_skip = 3;       ///< Camera frames dropped at most between two encoded ones
+    uint8_t max_downsize = 0;   ///< Frame size steps below the configured one, 0: never resize
+
+    /** @brief "enabled:target_ms:quality_min:quality_max:max_skip:max_downsize". */
+    std::string toString() const;
+
+    /** @brief Parse toString() output. @return false if malformed (config unchanged). */
+    bool fromString(const char *text);
+
+    /** @brief Check ranges. @param error Set to a short reason on failure */
+    bool validate(std::string &error) const;
+};
+
+class StreamRateController
+{
+public:
+    static constexpr uint32_t PERIOD_US = 500000;
+    static constexpr uint8_t QUALITY_STEP = 5;
+    static constexpr uint8_t LOW_WATER_PCT = 60;
+    static constexpr uint8_t CALM_PERIODS = 4;
+    static constexpr uint8_t DOWNSIZE_PERIODS = 6;
+
+    enum Action : uint8_t
+    {
+        HOLD = 0,
+        QUALITY_DOWN,
+        SKIP_UP,
+        SIZE_DOWN,
+        SIZE_UP,
+        SKIP_DOWN,
+        QUALITY_UP,
+    };
+
+    struct State
+    {
+        uint8_t quality = 80;
+        uint8_t skip = 0;
+        uint8_t downsize = 0;        ///< Frame size steps below the configured one
+        uint32_t latency_avg_ms = 0; ///< Last period
+        uint32_t latency_max_ms = 0; ///< Last period, worst client
+        uint32_t encode_avg_us = 0;  ///< Last period
+        uint16_t delivered = 0;      ///< Frames sent in the last period, all clients
+        uint16_t encoded = 0;        ///< Frames encoded in the last period
+        Action last_action = HOLD;
+        uint32_t periods = 0;
+        uint32_t decreases = 0;
+        uint32_t increases = 0;
+        uint32_t rate_skipped = 0;   ///< Camera frames not encoded because of the skip
+    };
+
+    StreamRateController() { reset(); }
+
+    /** @brief New bounds: the state is clamped into them. */
+    void configure(const StreamRateConfig &config);
+    const StreamRateConfig &config() const { return config_; }
+
+    /** @brief Back to the best settings; counters kept. */
+    void reset();
+
+    /** @brief Frame skip gate, called per camera frame. @return true to encode this one */
+    bool shouldEncode();
+
+    void onEncoded(uint32_t encode_us);
+
+    /** @brief A stream client finished sending a frame. */
+    void onDelivered(uint32_t latency_us);
+
+    /**
+     * @brief Run the control step when a period has elapsed.
+     * @return true if quality, skip or frame size changed
+     */
+    bool update(uint64_t now_us);
+
+    uint8_t quality() const { return state_.quality; }
+    uint8_t downsize() const { return state_.downsize; }
+    const State &state() const { return state_; }
+
+    static const char *actionName(Action action);
+
+private:
+    StreamRateConfig config_;
+    State state_;
+    uint64_t period_start_us_ = 0;
+    uint64_t latency_sum_us_ = 0;
+    uint32_t latency_max_us_ = 0;
+    uint64_t encode_sum_us_ = 0;
+    uint16_t delivered_ = 0;
+    uint16_t encoded_ = 0;
+    uint8_t skip_count_ = 0;
+    uint8_t calm_ = 0;
+    uint8_t floor_ = 0;       ///< Consecutive overloaded periods at quality_min and max_skip
+    bool started_ = false;
+
+    Action degrade(bool encode_bound);
+    Action improve();
+};
@@ -0,0 +1,73 @@
+/**
+ * @file TimingWheel.h
+ * @brief Hashed timing wheel for a small, fixed set of one-shot deadlines.
+ * @details Each timer has a fixed id (0..MAX_TIMERS-1) and lives in the slot
+ *          `deadline % SLOTS`, linked through index arrays, so arming, re-arming
+ *          and cancelling are O(1) and never allocate. advance() visits only the
+ *          slots passed since the previous call; entries whose deadline is one or
+ *          more turns away simply stay in their slot.
+ *          The class knows nothing about real time: the owner converts its clock
+ *          to ticks, which keeps it usable with a fake clock. It is not thread
+ *          safe; callers serialise access.
+ */
+#pragma once
+
+#include <stdint.h>
+
+class TimingWheel
+{
+public:
+    static constexpr uint8_t MAX_TIMERS = 16; ///< Timer ids 0-15 (expired ids are returned as a bitmask)
+    static constexpr uint16_t SLOTS = 64;     ///< Power of two
+    static constexpr uint32_t MAX_DELAY_TICKS = 0x7FFFFFFF;
+
+    TimingWheel();
+
+    /**
+     * @brief Arm a timer, or move its deadline if it is already armed.
+     * @param id          Timer id (0..MAX_TIMERS-1)
+     * @param now_tick    Current tick of the owner's clock
+     * @param delay_ticks Delay before expiry (at least one tick)
+     * @return true if the timer was already armed (re-arm)
+     */
+    bool arm(uint8_t id, uint32_t now_tick, uint32_t delay_ticks);
+
+    /**
+     * @brief Disarm a timer.
+     * @return true if the timer was armed
+     */
+    bool cancel(uint8_t id);
+
+    /**
+     * @brief Expire every timer whose deadline is at or before now_tick.
+     * @param now_tick Current tick of the owner's clock
+     * @return Bitmask of the expired timer ids (they are disarmed)
+     */
+    uint32_t advance(uint32_t now_tick);
+
+    bool isArmed(uint8_t id) const { return id < MAX_TIMERS && entries_[id].armed; }
+    uint32_t deadline(uint8_t id) const { return id < MAX_TIMERS ? entries_[id].deadline : 0; }
+    uint8_t armedCount() const { return armed_count_; }
+    uint32_t lastTick() const { return last_tick_; }
+
+private:
+    static constexpr uint8_t NIL = 0xFF;
+    static constexpr uint16_t SLOT_MASK = SLOTS - 1;
+
+    struct Entry
+    {
+        uint32_t deadline = 0;
+        uint8_t prev = NIL;
+        uint8_t next = NIL;
+        bool armed = false;
+    };
+
+    Entry entries_[MAX_TIMERS];
+    uint8_t heads_[SLOTS];
+    uint32_t last_tick_ = 0; ///< Last tick handled by advance()
+    uint8_t armed_count_ = 0;
+    bool started_ = false;    ///< false until the first advance(), which then sweeps every slot
+
+    void link(uint8_t id);
+    void unlink(uint8_t id);
+};
@@ -48,8 +48,9 @@ struct IsUDPMessageHandlerInterface : public virtual IsMasterRegistryInterface
 protected:
     /**
      * @brief Check whether a UDP request originates from the registered master.
-     * @details Compares the sender IP against the master registered in @p masterRegistry.
-     *          If the check fails, fills @p errorResponse with the binary error frame
+     * @details Compares the sender IP against the master registered in @p masterRegistry,
+     *          or against the role granted to the sender for this action
+     *          (IsMasterRegistryInterface::isActionAllowed()). If the check fails, fills @p errorResponse with the binary error frame
      *          `[action][udp_resp_not_master]` ready to be forwarded to the sender.
      *
      * Typical usage inside messageHandler():
@@ -66,7 +67,7 @@ protected:
      * @param remoteIP       Sender IP extracted from the incoming UDP packet
      * @param masterRegistry Pointer to the master registry (e.g. AmakerBotService); if null, check always fails
      * @param errorResponse  Output: filled with `[action][0x06]` when the check fails; unchanged on success
-     * @return true  if remoteIP matches the registered master (proceed with command)
+     * @return true  if remoteIP is the master or its role allows the action (proceed with command)
      * @return false if remoteIP is NOT the master (errorResponse filled, caller must send and return true)
      */
     bool checkUDPIsMaster(uint8_t action,
@@ -74,8 +75,7 @@ protected:
                            const IsMasterRegistryInterface *masterRegistry,
                            std::string &errorResponse)
     {
-        std::string ip = remoteIP.toString().c_str();
-        if (!masterRegistry || !masterRegistry->isMaster(ip))
+        if (!masterRegistry || !masterRegistry->isActionAllowed(action, remoteIP))
         {
             errorResponse.clear();
             errorResponse += static_cast<char>(action);
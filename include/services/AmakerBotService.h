@@ -5,7 +5,12 @@
 #include "isUDPMessageHandlerInterface.h"
 #include "IsMasterRegistryInterface.h"
 #include "services/UDPService.h"
+#include "HeartbeatWatchdog.h"
+#include "ActionAcl.h"
+#include "LinkQuality.h"
+#include <esp_timer.h>
 #include <freertos/semphr.h>
+#include <atomic>
 #include <string>
 
 /**
@@ -15,6 +20,9 @@
  *          to the device screen (MODE_APP_LOG). Clients must provide this exact token
  *          to register as the master controller. Registration locks the master to the
  *          caller's IP address.
+ *          The master identity is one packed 64-bit atomic (IPv4, port, session token),
+ *          so master checks on every packet and request are a single load and compare:
+ *          no mutex, no String.
  *
  * Exposed HTTP routes:
  *   POST /api/amakerbot/v1/register?token=<token>  — register caller as master (if token matches)
@@ -26,13 +34,29 @@
  *   POST /api/amakerbot/v1/display?mode=<mode>     — set display mode (APP_UI|APP_LOG|DEBUG_LOG|ESP_LOG)
  *   GET  /api/amakerbot/v1/name                    — get current bot name
  *   POST /api/amakerbot/v1/name?name=<name>        — set bot name (max 32 chars)
+ *   GET  /api/amakerbot/v1/heartbeat               — heartbeat watchdog state and expiry-to-stop latency
+ *   GET  /api/amakerbot/v1/roles                   — granted peer roles, role defaults and denial counts
+ *   GET  /api/amakerbot/v1/link                    — link statistics of the master session and derating config
+ *   POST /api/amakerbot/v1/link?derate=&near_timeout_pct=&derate_below=&min_scale= — configure (master only)
  *
  * UDP protocol (service_id 0x4):
  *   [0x41]<token>  — register UDP sender IP as master (if token matches);
  *   [0x42]         — clear master (master IP only);
- *   [0x43]         — heartbeat keep-alive; must be sent every ≤50 ms or all motors are stopped
+ *   [0x43][seq:2B optional] — heartbeat keep-alive; must be sent every ≤50 ms or all motors are stopped
+ *   [0x44][id:4B][rtt_us:4B optional] — ping (master only), echoed as [0x44][id]; rtt_us reports the previous ping's RTT
  *   [0x45]         — get bot name; server replies with [0x45][name bytes];
  *   [0x46]<name>   — set bot name (master only); server replies with [0x46][status];
+ *   [0x47][ip:4B][role][mask:32B optional] — grant a role to a peer (master only); replies [echo][status]
+ *   [0x48]         — link statistics (master, or a peer granted 0x48); replies [0x48][version][fields]
+ *
+ * Peer roles: besides the master, peers can be granted OBSERVER (telemetry queries)
+ * or STUDENT (telemetry plus safe actions) by the master. Master-gated UDP actions
+ * of other services are checked against the sender's 256-bit allowed-action bitmap
+ * (isActionAllowed(), through checkUDPIsMaster()). Grants end with the master session.
+ *
+ * Link quality: every master session keeps streaming heartbeat and ping statistics
+ * (see LinkQuality); with derating enabled the wheel speed is scaled down through
+ * ServoService::setSpeedScale() while the quality is low.
  */
 class AmakerBotService : public IsOpenAPIInterface,
                          public IsUDPMessageHandlerInterface
@@ -51,6 +75,41 @@ public:
      */
     bool isMaster(const std::string &ip) const override;
 
+    /**
+     * @brief Check a binary address against the registered master (no lock, no allocation).
+     * @param ip Sender address
+     * @return true if ip matches the current master IP
+     */
+    bool isMasterAddress(const IPAddress &ip) const override;
+
+    /// Packed master identity: IPv4 in bits 63-32, port in 31-16, session token in 15-0; 0 = no master
+    static uint64_t packIdentity(uint32_t ipv4, uint16_t port, uint16_t session)
+    {
+        return (static_cast<uint64_t>(ipv4) << 32) | (static_cast<uint32_t>(port) << 16) | session;
+    }
+    static uint32_t identityIPv4(uint64_t identity) { return static_cast<uint32_t>(identity >> 32); }
+    static uint16_t identityPort(uint64_t identity) { return static_cast<uint16_t>(identity >> 16); }
+    static uint16_t identitySession(uint64_t identity) { return static_cast<uint16_t>(identity); }
+
+    /**
+     * @brief Current packed master identity (see packIdentity()).
+     * @details The session token is drawn at each registration and is never 0; the
+     *          port is the UDP source port of a UDP registration, 0 for HTTP.
+     */
+    uint64_t getMasterIdentity() const { return master_identity_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Master, or a peer whose granted bitmap contains the action; denials are counted per role.
+     */
+    bool isActionAllowed(uint8_t action, const IPAddress &ip) const override;
+
+    /**
+     * @brief Grant a role to a peer (GUEST revokes).
+     * @param mask Allowed actions, nullptr for the role default
+     * @return false if the role cannot be granted or the peer table is full
+     */
+    bool grantRole(const IPAddress &ip, PeerRole role, const ActionMask *mask = nullptr);
+
     /**
      * @brief Return the registered master IP address.
      * @return Master IP string, empty string if no master is registered.
@@ -99,13 +158,26 @@ public:
 
 
     /**
-     * @brief Check whether the master heartbeat has timed out (>50 ms without a
-     *        heartbeat from the registered master) and, if so, stop all motors.
-     * @details Must be called periodically (e.g. every 10 ms from the UDP task).
-     *          The stop is triggered only once per timeout event; it resets
-     *          automatically when the next heartbeat arrives.
+     * @brief Heartbeat watchdog counters and deadline-to-stop latency (see HeartbeatWatchdog).
+     */
+    HeartbeatWatchdog::Stats getHeartbeatStats() const;
+
+    /**
+     * @brief Link statistics of the current master session (see LinkQuality).
+     */
+    LinkQuality::Stats getLinkStats() const;
+
+    LinkConfig getLinkConfig() const;
+
+    /**
+     * @brief Configure near-timeouts and speed derating; applies to the running session.
+     * @param error Reason of the rejection, if any
      */
-    void checkHeartbeatTimeout();
+    bool setLinkConfig(const LinkConfig &config, std::string &error);
+
+    /** @brief Persist / restore the link configuration (key "link"). */
+    bool saveSettings() override;
+    bool loadSettings() override;
 
 private:
     /**
@@ -116,14 +188,15 @@ private:
 
     /**
      * @brief Register a client as master (thread-safe) and log to app_info_logger.
-     * @param ip IP address of the new master
+     * @param ip   IP address of the new master
+     * @param port UDP source port of the registration, 0 for HTTP
      */
-    bool registerMaster(const std::string &ip);
+    bool registerMaster(const IPAddress &ip, uint16_t port);
 
     /**
      * @brief Internal helper — atomically clear master registration and log to app_info_logger.
      */
-    bool unregisterMaster(const std::string &ip);
+    bool unregisterMaster(const IPAddress &ip);
 
     /**
      * @brief Send a UDP reply echoing the original message followed by a status byte.
@@ -135,13 +208,41 @@ private:
     void udp_reply(const std::string &message, UDPResponseStatus status,
                    const IPAddress &remoteIP, uint16_t remotePort);
 
+    /**
+     * @brief Disarm the heartbeat watchdog for a new master session.
+     */
+    void resetHeartbeat();
+
+    /**
+     * @brief esp_timer callback: the heartbeat deadline passed, stop all motors.
+     */
+    static void heartbeatTimerCallback(void *arg);
+
+    /**
+     * @brief ServoService stop task: the heartbeat emergency stop completed.
+     */
+    static void heartbeatStopDone(void *arg, bool written);
+
     std::string server_token_;    // Generated once on init, never changes
-    std::string master_ip_;       // Current master's IP, empty if none
+    std::atomic<uint64_t> master_identity_{0}; // Packed (IPv4, port, session), 0 if no master
     std::string bot_name_;        // Bot name (default: "K10-Bot", protected by master_mutex_)
-    SemaphoreHandle_t master_mutex_ = nullptr;
+    SemaphoreHandle_t master_mutex_ = nullptr; // Guards bot_name_ (the master identity is lock-free)
+
+    // Heartbeat watchdog: one-shot esp_timer re-armed by every accepted heartbeat
+    esp_timer_handle_t heartbeat_timer_ = nullptr;
+    HeartbeatWatchdog heartbeat_;                     ///< Guarded by heartbeat_lock_
+    mutable portMUX_TYPE heartbeat_lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Link statistics of the master session, fed by heartbeats, pings and timeouts
+    LinkQuality link_;                                ///< Guarded by link_lock_
+    mutable portMUX_TYPE link_lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    /**
+     * @brief Restart the link statistics for a new master session (full speed).
+     */
+    void resetLink();
 
-    // Heartbeat watchdog state
-    volatile unsigned long last_heartbeat_ms_ = 0;  ///< millis() of last valid heartbeat
-    volatile bool heartbeat_active_    = false;     ///< true once ≥1 heartbeat received from current master
-    volatile bool heartbeat_timed_out_ = false;     ///< true while in timed-out state (avoids log spam)
+    // Peer roles (mutable: isActionAllowed() counts denials)
+    mutable ActionAcl acl_;                          ///< Guarded by acl_lock_
+    mutable portMUX_TYPE acl_lock_ = portMUX_INITIALIZER_UNLOCKED;
 };
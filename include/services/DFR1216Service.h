@@ -11,7 +11,8 @@
 
 #include "IsOpenAPIInterface.h"
 #include "isUDPMessageHandlerInterface.h"
-#include "DFR1216/DFR1216.h"
+#include "DFR1216/DFR1216_Sim.h"
+#include "DFR1216/DFR1216Sensors.h"
 
 class DFR1216Service : public IsOpenAPIInterface, public IsUDPMessageHandlerInterface
 {
@@ -99,6 +100,22 @@ public:
      */
     bool turnOffAllLEDs();
 
+    /**
+     * @brief Assign a sensor to a port of the background sampler
+     * @param port 0-5 for C0-C5, 6 for the SR04 connector
+     * @param kind Sensor type (NONE stops sampling the port); ADC and DIN ports are
+     *             scanned together at the shortest period configured among them
+     * @param period_ms Sampling period (0 = default for the type)
+     * @return true if the port/type combination is valid
+     */
+    bool configureSensor(uint8_t port, DFR1216SensorScheduler::Kind kind, uint32_t period_ms = 0);
+
+    /**
+     * @brief Latest completed reading of a port (never touches the I2C bus)
+     * @param port 0-5 for C0-C5, 6 for the SR04 connector
+     */
+    DFR1216SensorScheduler::Reading getSensorReading(uint8_t port) const { return sensors.read(port); }
+
     bool saveSettings() override;
     bool loadSettings() override;
 
@@ -117,7 +134,11 @@ public:
 
 private:
 
-    DFR1216_I2C controller;
+    DFR1216_Transport controller; ///< DFR1216_Sim with -DDFR1216_SIMULATED
+    DFR1216SensorScheduler sensors{controller};
+    TaskHandle_t sensor_task_ = nullptr;
+
+    static void sensor_task_fn(void *param);
     
     // LED color storage (RGB values for each LED)
     struct LEDState {
@@ -133,4 +154,9 @@ private:
     void handle_set_led_color(AsyncWebServerRequest *request);
     void handle_turn_off_led(AsyncWebServerRequest *request);
     void handle_get_led_status(AsyncWebServerRequest *request);
+    void handle_get_bus_stats(AsyncWebServerRequest *request);
+    void handle_reset_bus_stats(AsyncWebServerRequest *request);
+    void handle_get_sensors(AsyncWebServerRequest *request);
+    void handle_get_sensor_scans(AsyncWebServerRequest *request);
+    void handle_configure_sensor(AsyncWebServerRequest *request);
 };
@@ -13,6 +13,9 @@
 
 #include "IsOpenAPIInterface.h"
 #include "isUDPMessageHandlerInterface.h"
+#include "ServoCalibration.h"
+#include "DifferentialDrive.h"
+#include "ObstacleReflex.h"
 
 enum ServoConnection
 {
@@ -44,6 +47,110 @@ public:
         int16_t angle;
     };
 
+    /**
+     * @brief Counters of the asynchronous actuator commit task.
+     * @details Latency is measured from the first uncommitted command on a slot
+     *          to the end of the I2C transaction that carried it.
+     */
+    struct CommitStats {
+        uint32_t commands = 0;        ///< Slot updates published by setters
+        uint32_t coalesced = 0;       ///< Updates overwritten before being committed
+        uint32_t commits = 0;         ///< Control periods that wrote to the bus
+        uint32_t slots_committed = 0; ///< Slots carried by those commits
+        uint32_t commit_errors = 0;   ///< Commits whose I2C flush failed
+        uint32_t latency_min_us = 0;
+        uint32_t latency_max_us = 0;
+        uint32_t latency_avg_us = 0;
+        uint32_t latency_last_us = 0;
+    };
+
+    /**
+     * @brief Packed snapshot of the last commanded actuator state.
+     * @details Published as a whole under a sequence lock, so a snapshot never
+     *          mixes two updates (see getActuatorState()).
+     */
+    struct ActuatorState {
+        static constexpr uint8_t SERVOS = 8;
+        static constexpr uint8_t MOTORS = 4;
+        uint8_t attached[SERVOS] = {};                                        ///< ServoConnection per channel
+        int8_t servo_speeds[SERVOS] = {-128, -128, -128, -128, -128, -128, -128, -128}; ///< -128 = never commanded
+        int16_t servo_angles[SERVOS] = {-1, -1, -1, -1, -1, -1, -1, -1};      ///< -1 = never set
+        int8_t motor_speeds[MOTORS] = {-128, -128, -128, -128};               ///< -128 = never commanded
+
+        ServoConnection connection(uint8_t channel) const { return static_cast<ServoConnection>(attached[channel]); }
+    };
+
+    /**
+     * @brief Auto-stop (duration_ms) timing wheel counters.
+     * @details Arm cost is measured in CPU cycles around the locked wheel update.
+     */
+    struct AutoStopStats {
+        uint32_t arms = 0;           ///< Deadlines armed (including re-arms)
+        uint32_t rearms = 0;         ///< Arms that moved an already pending deadline
+        uint32_t cancels = 0;        ///< Pending deadlines cancelled
+        uint32_t expired = 0;        ///< Deadlines that stopped their actuator
+        uint32_t pending = 0;        ///< Deadlines currently armed
+        uint32_t arm_cycles_avg = 0;
+        uint32_t arm_cycles_max = 0;
+    };
+
+    /**
+     * @brief Emergency-stop path counters (see emergencyStop()).
+     * @details Latency runs from the request to the end of the last bus transaction
+     *          of the stop image, stop task wake-up and bus wait included. hist[n] counts stops that took
+     *          2^n to 2^(n+1)-1 µs (the last bucket is open-ended).
+     */
+    struct EmergencyStopStats {
+        static constexpr uint8_t HIST_BUCKETS = 16;
+        uint32_t triggers = 0;
+        uint32_t failures = 0;       ///< Stops whose image write failed (the staged stops still follow)
+        uint8_t transactions = 0;    ///< Bus transactions of the current stop image
+        uint8_t bytes = 0;           ///< Register bytes of the current stop image
+        uint32_t wire_us = 0;        ///< Bus time of the current image at 400 kHz, arbitration excluded
+        uint32_t latency_min_us = 0;
+        uint32_t latency_max_us = 0;
+        uint32_t latency_avg_us = 0;
+        uint32_t latency_last_us = 0;
+        uint32_t hist[HIST_BUCKETS] = {};
+    };
+
+    /**
+     * @brief State of the twist drive (see setTwist()).
+     * @details Wheel commands and duties are in 1/1000 of full scale; duties are
+     *          what the mapped motors receive (deadband-compensated, inverted).
+     */
+    struct DriveStatus {
+        bool engaged = false;      ///< The twist currently drives the mapped motors
+        int16_t linear = 0;        ///< Last commanded twist
+        int16_t angular = 0;
+        int16_t left = 0;          ///< Wheel commands after mixing and ramping
+        int16_t right = 0;
+        int16_t target_left = 0;   ///< Wheel commands the ramp is heading to
+        int16_t target_right = 0;
+        int16_t left_duty = 0;
+        int16_t right_duty = 0;
+        uint32_t twists = 0;       ///< setTwist() calls
+        uint32_t engagements = 0;  ///< Twists that took the motors over
+        uint32_t releases = 0;     ///< Direct motor commands that took them back
+    };
+
+    /**
+     * @brief State of the obstacle reflex (see setObstacleReflex()).
+     */
+    struct ReflexStatus {
+        ObstacleReflex::State state = ObstacleReflex::State::CLEAR;
+        int16_t range = -1;            ///< Last range (cm), -1 = no valid reading
+        int16_t cap = 1000;            ///< Forward duty allowed on the wheel motors (1/1000)
+        int16_t request = 0;           ///< Fastest forward duty commanded to a wheel
+        uint32_t reading_age_ms = 0;   ///< Age of the reading used in the last period
+        uint32_t trips = 0;            ///< CLEAR to LIMITING or BLOCKED
+        uint32_t blocks = 0;           ///< Entries into BLOCKED
+        uint32_t sensor_losses = 0;    ///< Entries into NO_SENSOR
+        uint32_t events = 0;           ///< State changes reported to the event receiver
+        uint32_t last_trip_ms = 0;     ///< millis() of the last trip (0 = never)
+        uint32_t trip_age_max_ms = 0;  ///< Worst age of a tripping reading: sampling delay + control period
+    };
+
     /**
      * @brief Attach a servo model to a channel.
      * @param channel Servo channel (0-7)
@@ -102,9 +209,11 @@ public:
      * @brief Set DC motor speed via DFR1216 expansion board
      * @param motor Motor number (1-4)
      * @param speed Speed value (-100 to +100, negative is reverse)
+     * @param duration_ms Optional auto-stop delay in ms. If > 0 and speed != 0, the motor
+     *                    is stopped automatically after this delay. Any other call cancels it.
      * @return true if successful, false otherwise
      */
-    bool setMotorSpeed(uint8_t motor, int8_t speed);
+    bool setMotorSpeed(uint8_t motor, int8_t speed, uint32_t duration_ms = 0);
 
     /**
      * @brief Set the same speed on all DC motors
@@ -113,6 +222,119 @@ public:
      */
     bool setAllMotorsSpeed(int8_t speed);
 
+    /**
+     * @brief Called by the stop task once an emergency stop has run.
+     * @param arg     Argument given to requestEmergencyStop()
+     * @param written true if the stop image reached the bus
+     */
+    using EmergencyStopDone = void (*)(void *arg, bool written);
+
+    /**
+     * @brief Ask the stop task for an emergency stop (see emergencyStop()).
+     * @details Never blocks: safe from timer callbacks. Requests made before the
+     *          task runs are served by one stop, which calls the last callback given.
+     * @param done Optional completion callback, run on the stop task
+     * @param arg  Passed to done
+     * @return false if the service is not started
+     */
+    bool requestEmergencyStop(EmergencyStopDone done = nullptr, void *arg = nullptr);
+
+    /**
+     * @brief Stop every motor and continuous servo with the shortest bus path.
+     * @details Writes the prebuilt stop image (all motor duties zero, continuous
+     *          servos at their calibrated stop pulse) in one transaction per register
+     *          block. Running at the highest priority, the caller is the next owner of
+     *          the bus. No logging, no heap. The stops are then staged like any
+     *          command so the desired state, the driver cache and the tracked state
+     *          follow; a batch collected before the stop is not written. Also releases
+     *          the twist and stops a playing timeline.
+     * @note  Called by the stop task; other callers should use requestEmergencyStop().
+     * @param requested_us micros() of the request, start of the measured latency
+     * @return true if the image reached the bus
+     */
+    bool emergencyStop(uint32_t requested_us);
+
+    /**
+     * @brief Snapshot of the emergency-stop counters and trigger-to-bus latency.
+     */
+    EmergencyStopStats getEmergencyStopStats() const;
+
+    /**
+     * @brief Drive the two wheel motors from a twist (differential-drive kinematics).
+     * @details The commit task mixes the twist into left/right wheel commands
+     *          (saturation keeps the turn radius), ramps them at the configured
+     *          acceleration limit, compensates the motor deadband, applies the
+     *          wheel mapping and inversion, and commits both motors in one burst.
+     *          Any direct command on a mapped motor releases the twist.
+     * @param linear      Forward command, 1/1000 of full speed (-1000 to +1000)
+     * @param angular     Counter-clockwise turn command, 1/1000 of full speed (-1000 to +1000)
+     * @param duration_ms Optional: ramp back to (0, 0) after this delay (0 = no timeout)
+     * @return true if the values are in range and the service is started
+     */
+    bool setTwist(int16_t linear, int16_t angular, uint32_t duration_ms = 0);
+
+    /**
+     * @brief Replace the wheel mapping, inversion, deadband and acceleration limit.
+     * @details An engaged twist is released and its motors are stopped.
+     * @param error Reason of the rejection, if any
+     */
+    bool setDriveConfig(const DriveConfig &config, std::string &error);
+
+    DriveConfig getDriveConfig() const;
+
+    /**
+     * @brief Snapshot of the twist drive, published by the commit task.
+     */
+    DriveStatus getDriveStatus() const;
+
+    /**
+     * @brief Advance the twist ramp and stage the wheel motor duties.
+     * @note  Called by the actuator commit task once per control period.
+     * @param dt_us Time elapsed since the previous call (µs)
+     */
+    void stepTwist(uint32_t dt_us);
+
+    /**
+     * @brief Configure the obstacle reflex (see ObstacleReflex.h).
+     * @details The range comes from the DFR1216 sensor scheduler: the configured
+     *          port must be sampled there (SR04 on port 6, ADC on 0-5). The cap
+     *          applies to the wheel motors of the drive configuration, whether they
+     *          are driven by setTwist() or by direct motor commands.
+     * @param error Reason of the rejection, if any
+     */
+    bool setObstacleReflex(const ReflexConfig &config, std::string &error);
+
+    ReflexConfig getObstacleReflex() const;
+
+    /**
+     * @brief Snapshot of the obstacle reflex, published by the commit task.
+     */
+    ReflexStatus getObstacleReflexStatus() const;
+
+    /**
+     * @brief Read the range, update the forward cap and re-stage capped wheels.
+     * @note  Called by the actuator commit task once per control period, before
+     *        stepTwist(), so a new cap goes out in the same commit.
+     * @param now_ms Current millis()
+     */
+    void stepObstacleReflex(uint32_t now_ms);
+
+    /**
+     * @brief Scale the duty of the wheel motors (link derating, see AmakerBotService).
+     * @details Applies to both directions, before the obstacle reflex cap; the
+     *          tracked motor speeds keep the commanded values.
+     * @param permille 0-1000, 1000 = commanded speed
+     */
+    void setSpeedScale(uint16_t permille);
+
+    uint16_t getSpeedScale() const;
+
+    /**
+     * @brief Re-stage the wheels when the speed scale changed.
+     * @note  Called by the actuator commit task after stepObstacleReflex().
+     */
+    void stepSpeedScale();
+
     /**
      * @brief Get the last commanded speed for a DC motor
      * @param motor Motor number (1-4)
@@ -141,6 +363,128 @@ public:
      */
     int16_t getServoAngle(uint8_t channel) const;
 
+    /**
+     * @brief Ask the commit task to read back the actuator registers and repair drift
+     *        (e.g. after a brownout) between two commits.
+     * @details The driver batch belongs to the commit task (the DFR0548 backend is not
+     *          thread safe), so the check never runs on the caller's task.
+     * @return Number of registers rewritten by the previous check
+     */
+    uint8_t verifyActuatorRegisters();
+
+    /**
+     * @brief Run the register check asked for by verifyActuatorRegisters(), if any.
+     * @note  Called by the actuator commit task, between two commits.
+     */
+    void verifyRequestedRegisters();
+
+    /**
+     * @brief Push every pending desired-state slot to the DFR1216 in one batch.
+     * @note  Called by the actuator commit task; other callers should use requestCommit().
+     */
+    void commitPending();
+
+    /**
+     * @brief Wake the commit task now instead of at the next control period.
+     */
+    void requestCommit();
+
+    /**
+     * @brief Snapshot of the commit task counters and command-to-wire latency.
+     */
+    CommitStats getCommitStats() const;
+
+    /**
+     * @brief Snapshot of the auto-stop timing wheel counters.
+     */
+    AutoStopStats getAutoStopStats() const;
+
+    /**
+     * @brief Consistent snapshot of servo types, speeds, angles and motor speeds.
+     * @details Wait-free for the caller's purposes: never blocks a writer, retries
+     *          only while a write of a few cycles is in progress on the other core.
+     */
+    ActuatorState getActuatorState() const;
+
+    /**
+     * @brief Replace the calibration of a servo channel and recompile its pulse table.
+     * @param channel     Servo channel (0-7)
+     * @param calibration New calibration (0 fields take the model default)
+     * @param error       Reason of the rejection, if any
+     * @return true if the calibration is valid for the attached servo type
+     */
+    bool setServoCalibration(uint8_t channel, const ServoCalibration &calibration, std::string &error);
+
+    /**
+     * @brief Calibration of a channel with the defaults of its attached type filled in.
+     */
+    ServoCalibration getServoCalibration(uint8_t channel) const;
+
+    /**
+     * @brief Calibration routine: output a raw pulse width on a channel (bypasses the table).
+     * @param channel  Servo channel (0-7)
+     * @param pulse_us Pulse width (400-3500 µs)
+     * @return true if the values are in range
+     */
+    bool calibrationJog(uint8_t channel, uint16_t pulse_us);
+
+    /**
+     * @brief Calibration routine: store the last jog pulse as a calibration point.
+     * @param channel Servo channel (0-7)
+     * @param point   "min", "max", "center" or "deadband"
+     * @param error   Reason of the rejection, if any
+     * @return true if the resulting calibration is valid (table recompiled)
+     */
+    bool captureCalibrationPoint(uint8_t channel, const std::string &point, std::string &error);
+
+    /**
+     * @brief Configure the motion profile of an angular servo channel.
+     * @details Once set, setServoAngle() (and UDP SET_SERVO_ANGLE) only sends the target;
+     *          the commit task moves the servo there at the control rate.
+     * @param channel          Servo channel (0-7)
+     * @param max_velocity     degree/s (0 disables the profile: angles are applied at once)
+     * @param max_acceleration degree/s²
+     * @param max_jerk         degree/s³ (0 = trapezoidal, > 0 = S-curve)
+     * @return true if the channel is valid
+     */
+    bool setMotionProfile(uint8_t channel, uint16_t max_velocity, uint16_t max_acceleration, uint16_t max_jerk = 0);
+
+    /**
+     * @brief Advance every active motion profile and stage the resulting pulses.
+     * @note  Called by the actuator commit task once per control period.
+     * @param dt_us Time elapsed since the previous call (µs)
+     */
+    void stepMotionProfiles(uint32_t dt_us);
+
+    /**
+     * @brief Validate a keyframe timeline and store it in LittleFS under its id.
+     * @param doc   Timeline JSON (see KeyframeTimeline.h for the format)
+     * @param error Reason of the rejection, if any
+     * @return true if stored
+     */
+    bool saveTimeline(const JsonDocument &doc, std::string &error);
+
+    /**
+     * @brief Remove a stored timeline.
+     * @param id Timeline ID (0-255)
+     * @return true if the file existed and was removed
+     */
+    bool deleteTimeline(uint8_t id);
+
+    /**
+     * @brief Play a stored timeline from its first frame (replaces any running one).
+     * @param id            Timeline ID (0-255)
+     * @param loop_override 0 = once, 1 = loop, -1 = use the timeline's own flag
+     * @return true if playback started
+     */
+    bool playTimeline(uint8_t id, int8_t loop_override = -1);
+
+    /**
+     * @brief Stop the running timeline: angular servos hold, motors and continuous servos stop.
+     * @return true unless the player is not set up (service never started)
+     */
+    bool stopTimeline();
+
     // Get servo status
     /**
      * @brief Get the status of a servo channel
@@ -198,14 +542,51 @@ private:
     bool addRouteStopAllMotors(const std::vector<OpenAPIResponse>& standard_responses);
     bool addRouteSetAllMotorsSpeed(const std::vector<OpenAPIResponse>& standard_responses);
     bool addRouteGetBattery();
+    bool addRouteGetDriverStats();
+    bool addRouteGetCommitStats();
+    bool addRouteSetMotionProfile(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteGetMotionStatus();
+    bool addRouteSetTwist(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteSetDriveConfig(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteGetDriveStatus();
+    bool addRouteSetObstacleReflex(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteGetObstacleReflex();
+    bool addRouteSetCalibration(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteGetCalibration();
+    bool addRouteCalibrationJog(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteCalibrationCapture(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteUploadTimeline(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRoutePlayTimeline(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteStopTimeline(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteDeleteTimeline(const std::vector<OpenAPIResponse>& standard_responses);
+    bool addRouteGetTimelineStatus();
+
+    /**
+     * @brief Send the target-reached event to the peer that commanded the move.
+     * @param moving_mask  Channels still following a profile
+     * @param reached_mask Channels that reached their target during this step
+     */
+    void notifyTargetReached(uint8_t moving_mask, uint8_t reached_mask);
+
+    /**
+     * @brief Send an obstacle reflex state change to the peer driving the motors.
+     */
+    void notifyObstacle(const ReflexStatus &status);
 
     // UDP binary helpers
     std::string getAttachedServosMasked(uint8_t mask);
 
     /**
-     * @brief Start or cancel the per-channel auto-stop FreeRTOS timer.
+     * @brief Start, restart or cancel the auto-stop deadline of a servo channel.
      * @param channel     Servo channel (0-7)
      * @param duration_ms Auto-stop delay in ms; 0 cancels any pending stop.
      */
     void scheduleChannelStop(uint8_t channel, uint32_t duration_ms);
+
+    /**
+     * @brief Start, restart or cancel the auto-stop deadline of a DC motor.
+     * @param index       Motor index (0-3)
+     * @param duration_ms Auto-stop delay in ms; 0 cancels any pending stop.
+     */
+    void scheduleMotorStop(uint8_t index, uint32_t duration_ms);
 };
@@ -99,6 +99,13 @@ public:
      */
     bool sendReply(const std::string &message, const IPAddress &remoteIP, uint16_t remotePort);
 
+    /**
+     * @brief Send a datagram that answers no request (pushed data).
+     *        Not counted in the per-action statistics.
+     * @return true if the whole datagram was handed to the network
+     */
+    bool sendTo(const uint8_t *data, size_t len, const IPAddress &remoteIP, uint16_t remotePort);
+
     /**
      * @brief Register a message handler callback
      * @param handler The callback function to register
@@ -1,21 +1,30 @@
 /**
  * @file WebcamService.h
  * @brief Header for webcam service integration with the main application
- * @details Provides webcam initialization, snapshot capture, and HTTP route registration
+ * @details Provides webcam initialization, snapshot capture, and HTTP route registration,
+ *          and pushes frames to subscribed UDP / WebSocket peers (FrameTransport)
  */
 #pragma once
 
 #include "IsServiceInterface.h"
 #include "IsOpenAPIInterface.h"
+#include "isUDPMessageHandlerInterface.h"
 #include "esp_camera.h"
+#include "JpegFanout.h"
+#include "JpegBufferPool.h"
+#include "StreamRateController.h"
+#include "FrameTransport.h"
+#include "FrameMailbox.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <atomic>
 
 /**
  * @class WebcamService
  * @brief Service for managing ESP32 camera operations
  */
-class WebcamService : public IsOpenAPIInterface
+class WebcamService : public IsOpenAPIInterface, public IsUDPMessageHandlerInterface
 {
 public:
     /**
@@ -63,12 +72,146 @@ public:
     bool saveSettings() override;
     bool loadSettings() override;
 
+    /**
+     * @brief Statistics of the shared JPEG encoder
+     * @return Frames encoded versus delivered, skipped and superseded, encode time
+     */
+    JpegFanout::Stats getEncoderStats();
+
+    /** @brief Latest camera frame mailbox: generation, frames taken and dropped, capture-to-take age. */
+    FrameMailbox::Stats getCameraMailboxStats();
+
+    /** @brief Heap allocations and frees made for encoded frames since boot. */
+    uint32_t getFrameHeapOps() const { return frame_heap_ops_.load(std::memory_order_relaxed); }
+
+    /** @brief Statistics of the PSRAM JPEG buffer pool (high-water mark, exhaustion, overflows). */
+    JpegBufferPool::Stats getPoolStats();
+
+    /** @brief Stream rate controller bounds and state (quality, frame skip, frame size steps). */
+    StreamRateController getRateController();
+
+    /** @brief Frame transport peers and their counters. */
+    FrameTransport getFrameTransport();
+
+    /**
+     * @brief Handle the frame transport UDP actions (subscribe, unsubscribe, statistics)
+     * @param message Raw UDP message
+     * @param remoteIP Sender IP address
+     * @param remotePort Sender port
+     * @return true if message was handled, false otherwise
+     */
+    bool messageHandler(const std::string &message,
+                        const IPAddress &remoteIP,
+                        uint16_t remotePort) override;
+
+    IsUDPMessageHandlerInterface *asUDPMessageHandlerInterface() override { return this; }
 
 private:
     bool initialized_;
     framesize_t current_framesize_ = FRAMESIZE_VGA;  // Track current frame size
 
-    volatile bool streaming_active_ = false;
+    // ─── Shared JPEG encoder ─────────────────────────────────────────
+    // One task encodes each camera frame once and publishes it in jpeg_fanout_;
+    // stream clients and snapshots hold references to the frames they send.
+
+    JpegFanout jpeg_fanout_;                                   ///< Guarded by jpeg_lock_
+    portMUX_TYPE jpeg_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t encoder_task_ = nullptr;
+    SemaphoreHandle_t camera_mutex_ = nullptr; ///< Held by the camera frame consumer (one at a time), and by a framesize change
+    std::atomic<uint32_t> frame_heap_ops_{0};                  ///< Counted by encodeFrame() / freeFrame()
+    JpegBufferPool jpeg_pool_;                                 ///< Guarded by jpeg_lock_ (begin() before the encoder runs)
+    uint32_t expected_jpeg_ = 0;                               ///< Size of the last JPEG (encoder task)
+    StreamRateController rate_;                                ///< Guarded by jpeg_lock_
+    uint8_t stream_clients_ = 0;                               ///< Guarded by jpeg_lock_
+    framesize_t base_framesize_ = FRAMESIZE_VGA;               ///< Configured frame size, before the rate controller's steps
+    FrameTransport transport_;                                 ///< Guarded by jpeg_lock_
+    TaskHandle_t transport_task_ = nullptr;
+
+    // ─── Latest camera frame ─────────────────────────────────────────
+    // The camera task hands its frames over a FIFO queue; a small task empties it
+    // into camera_mailbox_, so only the latest frame is ever kept.
+
+    FrameMailbox camera_mailbox_;                              ///< Guarded by mailbox_lock_
+    portMUX_TYPE mailbox_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    SemaphoreHandle_t frame_posted_ = nullptr;                 ///< Given on every post, taken by the waiting consumer
+    TaskHandle_t mailbox_task_ = nullptr;
+    uint32_t snapshot_generation_ = 0;                         ///< Last camera frame taken by captureSnapshot()
+
+    /** @brief Static wrapper for FreeRTOS task creation */
+    static void mailboxTaskStatic(void *param);
+
+    /** @brief Mailbox loop — posts each frame of the camera queue, releasing the frame it replaces */
+    void mailboxLoop();
+
+    /**
+     * @brief Wait for a camera frame newer than generation (caller holds camera_mutex_)
+     * @param generation Last generation seen, updated
+     * @return The frame, to give back with esp_camera_fb_return(); nullptr on timeout
+     */
+    camera_fb_t *takeCameraFrame(uint32_t &generation, uint32_t wait_ms);
+
+    /** @brief Empty the mailbox, releasing the frame it held */
+    void clearCameraMailbox();
+
+    /** @brief Static wrapper for FreeRTOS task creation */
+    static void encoderTaskStatic(void *param);
+
+    /** @brief Encoder loop — waits for subscribers, encodes the newest camera frame, publishes it */
+    void encoderLoop();
+
+    /** @brief Static wrapper for FreeRTOS task creation */
+    static void transportTaskStatic(void *param);
+
+    /** @brief Transport loop — while peers are subscribed, sends each new frame to them as fragments */
+    void transportLoop();
+
+    /**
+     * @brief Send one frame, fragment by fragment, to the peers it is due to (transport task)
+     * @return Peers that were handed every fragment
+     */
+    uint8_t sendFrameFragments(const JpegFrame *frame, uint16_t frame_id,
+                               const FrameTransport::Target *targets, uint8_t count);
+
+    /** @brief Re-register the camera when the rate controller changed its frame size steps (encoder task) */
+    void applyRateFramesize(uint8_t downsize);
+
+    /**
+     * @brief JPEG of a camera frame (copied if already JPEG), nullptr on failure
+     * @details Written into a pool buffer; on the heap only when it fits no buffer
+     *          or there is no pool. nullptr as well when every buffer is in use.
+     */
+    JpegFrame *encodeFrame(camera_fb_t *fb, uint8_t quality);
+
+    /** @brief Encode into a pool buffer. @param overflow Set when the JPEG did not fit */
+    static bool encodeInto(camera_fb_t *fb, uint8_t quality, JpegFrame *frame, bool &overflow);
+
+    /** @brief Encode into heap buffers (the pool fallback) */
+    JpegFrame *encodeToHeap(camera_fb_t *fb, uint8_t quality);
+
+    /** @brief Give a frame returned by the fan-out back to the pool, or free it (no-op on nullptr) */
+    void freeFrame(JpegFrame *frame);
+
+    /**
+     * @brief Register a frame consumer and wake the encoder
+     * @param stream Stream client: its deliveries drive the rate controller
+     */
+    void subscribeFrames(bool stream = false);
+
+    /** @brief Unregister a frame consumer; the last one drops the latest frame, the last stream resets the rate controller */
+    void unsubscribeFrames(bool stream = false);
+
+    /** @brief Reference to the latest frame newer than after_seq, nullptr if none */
+    JpegFrame *acquireFrame(uint32_t after_seq);
+
+    /** @brief Drop a reference taken by acquireFrame() */
+    void releaseFrame(JpegFrame *frame);
+
+    /**
+     * @brief Account a frame fully sent to a consumer, and the bytes it copied
+     * @param capture_us Capture time of a frame sent by a stream client, feeds the
+     *                   rate controller with its latency; 0 for snapshots
+     */
+    void frameDelivered(uint32_t previous_seq, uint32_t seq, size_t copied, int64_t capture_us = 0);
 
     /**
      * @brief Handle snapshot HTTP request
@@ -90,6 +233,21 @@ private:
      * @param request Pointer to AsyncWebServerRequest
      */
     void handleSettings(AsyncWebServerRequest *request);
+    /**
+     * @brief Handle shared JPEG encoder statistics HTTP request
+     * @param request Pointer to AsyncWebServerRequest
+     */
+    void handleEncoderStats(AsyncWebServerRequest *request);
+    /**
+     * @brief Handle stream rate controller state HTTP request
+     * @param request Pointer to AsyncWebServerRequest
+     */
+    void handleRate(AsyncWebServerRequest *request);
+    /**
+     * @brief Handle stream rate controller bounds update HTTP request
+     * @param request Pointer to AsyncWebServerRequest
+     */
+    void handleRateSettings(AsyncWebServerRequest *request);
 
     /**
      * @brief Reinitialize camera with new framesize
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""
+Webcam streaming soak test for K10 Bot
+
+Registers as master over UDP (the webcam routes are master only), keeps the
+heartbeat alive, opens N MJPEG streams for a while and compares the shared
+encoder statistics taken before and after the soak:
+  • heap fragmentation (internal RAM and PSRAM: free, largest block, frag %)
+  • JPEG buffer pool: high-water mark, exhaustion, overflows, heap fallbacks
+  • frames encoded vs delivered, bytes copied and heap operations per frame
+
+Usage:
+    python3 test_webcam_soak.py <robot_ip> [port] <token> [--clients 2] [--minutes 10]
+
+Examples:
+    python3 test_webcam_soak.py 192.168.1.42 24642 A3K9B
+    python3 test_webcam_soak.py 192.168.1.42 24642 A3K9B --clients 3 --minutes 60
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import threading
+import time
+
+# ─── Constants ────────────────────────────────────────────────────────────────
+
+CMD_MASTER_REGISTER = 0x41
+CMD_MASTER_UNREGISTER = 0x42
+CMD_HEARTBEAT = 0x43
+UDP_SUCCESS = 0x01
+UDP_IGNORED = 0x02
+ENCODER_PATH = "/api/webcam/v1/encoder"
+STREAM_PATH = "/api/webcam/v1/stream"
+SAMPLE_PERIOD_S = 30.0
+
+# ─── Colours ──────────────────────────────────────────────────────────────────
+
+class C:
+    BOLD  = '\033[1m'
+    GREEN = '\033[92m'
+    YELLOW= '\033[93m'
+    RED   = '\033[91m'
+    CYAN  = '\033[96m'
+    END   = '\033[0m'
+
+# ─── Master session ───────────────────────────────────────────────────────────
+
+class MasterSession:
+    """Registers as master and sends [0x43] every 25 ms until closed."""
+
+    def __init__(self, ip: str, port: int, token: str):
+        self._addr = (ip, port)
+        self._token = token
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self._sock.settimeout(2.0)
+        self._running = False
+        self._thread: threading.Thread | None = None
+
+    def register(self) -> bool:
+        self._sock.sendto(bytes([CMD_MASTER_REGISTER]) + self._token.encode(), self._addr)
+        try:
+            resp, _ = self._sock.recvfrom(64)
+        except socket.timeout:
+            return False
+        if not resp or resp[0] != CMD_MASTER_REGISTER or resp[-1] not in (UDP_SUCCESS, UDP_IGNORED):
+            return False
+        self._running = True
+        self._thread = threading.Thread(target=self._loop, daemon=True)
+        self._thread.start()
+        return True
+
+    def close(self) -> None:
+        self._running = False
+        if self._thread:
+            self._thread.join(timeout=1.0)
+            self._sock.sendto(bytes([CMD_MASTER_UNREGISTER]), self._addr)
+        self._sock.close()
+
+    def _loop(self) -> None:
+        while self._running:
+            self._sock.sendto(bytes([CMD_HEARTBEAT]), self._addr)
+            time.sleep(0.025)
+
+# ─── Stream client ────────────────────────────────────────────────────────────
+
+class StreamClient(threading.Thread):
+    """Reads an MJPEG stream, counting frames and bytes, until stopped."""
+
+    def __init__(self, ip: str, index: int):
+        super().__init__(daemon=True)
+        self.ip = ip
+        self.index = index
+        self.frames = 0
+        self.bytes = 0
+        self.error = ""
+        self._halt = threading.Event()
+
+    def stop(self) -> None:
+        self._halt.set()
+
+    def run(self) -> None:
+        try:
+            conn = http.client.HTTPConnection(self.ip, 80, timeout=10)
+            conn.request("GET", STREAM_PATH)
+            resp = conn.getresponse()
+            if resp.status != 200:
+                self.error = f"HTTP {resp.status}"
+                return
+            while not self._halt.is_set():
+                line = resp.readline()
+                if not line:
+                    self.error = "stream closed"
+                    return
+                if line.lower().startswith(b"content-length:"):
+                    length = int(line.split(b":", 1)[1])
+                    resp.readline()  # blank line after the part headers
+                    data = resp.read(length)
+                    if len(data) != length:
+                        self.error = "short frame"
+                        return
+                    self.frames += 1
+                    self.bytes += length
+            conn.close()
+        except (OSError, http.client.HTTPException, ValueError) as exc:
+            self.error = str(exc)
+
+# ─── Helpers ──────────────────────────────────────────────────────────────────
+
+def get_encoder_stats(ip: str) -> dict | None:
+    try:
+        conn = http.client.HTTPConnection(ip, 80, timeout=5)
+        conn.request("GET", ENCODER_PATH)
+        resp = conn.getresponse()
+        body = resp.read()
+        conn.close()
+        return json.loads(body) if resp.status == 200 else None
+    except (OSError, http.client.HTTPException, ValueError):
+        return None
+
+
+def print_heap(label: str, stats: dict) -> None:
+    for region in ("internal", "psram"):
+        h = stats.get("heap", {}).get(region, {})
+        print(f"  {label:<7} {region:<9} free {h.get('free', 0):>9}  largest {h.get('largest', 0):>9}"
+              f"  min_free {h.get('min_free', 0):>9}  frag {h.get('frag_pct', 0):>3}%")
+
+
+def print_summary(before: dict, after: dict, clients: list, elapsed: float) -> None:
+    print(f"\n{C.BOLD}{C.CYAN}  Heap fragmentation{C.END}")
+    print_heap("before", before)
+    print_heap("after", after)
+    for region in ("internal", "psram"):
+        b = before.get("heap", {}).get(region, {}).get("frag_pct", 0)
+        a = after.get("heap", {}).get(region, {}).get("frag_pct", 0)
+        colour = C.GREEN if a <= b + 5 else C.YELLOW
+        print(f"  {colour}{region}: {b}% → {a}%{C.END}")
+
+    pool = after.get("pool", {})
+    print(f"\n{C.BOLD}{C.CYAN}  JPEG buffer pool{C.END}")
+    print(f"  ready {pool.get('ready')}  {pool.get('bytes', 0)} bytes in {pool.get('slots', 0)} buffers"
+          f"  high-water {pool.get('high_water', 0)}")
+    print(f"  takes {pool.get('takes', 0)}  exhausted {pool.get('exhausted', 0)}"
+          f"  overflows {pool.get('overflows', 0)}  heap fallbacks {pool.get('fallbacks', 0)}")
+    for cls in pool.get("classes", []):
+        print(f"    {cls['size']:>6} B x{cls['count']}: high-water {cls['high_water']}"
+              f"  takes {cls['takes']}  exhausted {cls['exhausted']}")
+
+    encoded = after.get("encoded", 0) - before.get("encoded", 0)
+    delivered = after.get("delivered", 0) - before.get("delivered", 0)
+    heap_ops = after.get("heap_ops", 0) - before.get("heap_ops", 0)
+    print(f"\n{C.BOLD}{C.CYAN}  Frames ({elapsed:.0f} s){C.END}")
+    print(f"  encoded {encoded} ({encoded / elapsed:.1f} fps)  delivered {delivered}"
+          f"  skipped {after.get('skipped', 0) - before.get('skipped', 0)}")
+    print(f"  heap operations per delivered frame {heap_ops / delivered if delivered else 0:.3f}"
+          f"  bytes copied per frame {after.get('copied_per_frame', 0)}")
+    for c in clients:
+        status = f"{C.RED}{c.error}{C.END}" if c.error else f"{C.GREEN}ok{C.END}"
+        print(f"  client {c.index}: {c.frames} frames ({c.frames / elapsed:.1f} fps),"
+              f" {c.bytes / 1024:.0f} KiB  {status}")
+
+# ─── Main Logic ───────────────────────────────────────────────────────────────
+
+def main() -> int:
+    p = argparse.ArgumentParser(description="K10 Bot webcam streaming soak test")
+    p.add_argument("ip", help="K10 device IP address")
+    p.add_argument("port", type=int, nargs="?", default=24642, help="UDP port (default 24642)")
+    p.add_argument("token", help="5-char registration token shown on device screen at boot")
+    p.add_argument("--clients", type=int, default=2, help="Concurrent MJPEG streams (default 2)")
+    p.add_argument("--minutes", type=float, default=10.0, help="Soak duration (default 10)")
+    args = p.parse_args()
+
+    print(f"{C.BOLD}{C.CYAN}{'─' * 60}")
+    print("  Webcam Streaming Soak Test")
+    print(f"{'─' * 60}{C.END}")
+    print(f"  Target   : {args.ip}")
+    print(f"  Clients  : {args.clients}")
+    print(f"  Duration : {args.minutes} min")
+
+    session = MasterSession(args.ip, args.port, args.token)
+    if not session.register():
+        print(f"{C.RED}  ✗ Master registration failed{C.END}")
+        return 1
+    print(f"{C.GREEN}  ✓ Registered as master{C.END}")
+
+    clients: list[StreamClient] = []
+    try:
+        before = get_encoder_stats(args.ip)
+        if before is None:
+            print(f"{C.RED}  ✗ {ENCODER_PATH} unavailable{C.END}")
+            return 1
+
+        clients = [StreamClient(args.ip, i) for i in range(args.clients)]
+        for c in clients:
+            c.start()
+
+        start = time.monotonic()
+        end = start + args.minutes * 60.0
+        try:
+            while time.monotonic() < end:
+                time.sleep(min(SAMPLE_PERIOD_S, max(0.0, end - time.monotonic())))
+                now = get_encoder_stats(args.ip)
+                if now:
+                    h = now.get("heap", {}).get("internal", {})
+                    pool = now.get("pool", {})
+                    print(f"  {time.monotonic() - start:7.0f} s  encoded {now.get('encoded', 0):>7}"
+                          f"  delivered {now.get('delivered', 0):>7}  pool {pool.get('in_use', 0)}/{pool.get('slots', 0)}"
+                          f" (hw {pool.get('high_water', 0)})  internal frag {h.get('frag_pct', 0)}%")
+        except KeyboardInterrupt:
+            print(f"\n{C.YELLOW}  Interrupted{C.END}")
+        elapsed = max(time.monotonic() - start, 1e-3)
+
+        for c in clients:
+            c.stop()
+        for c in clients:
+            c.join(timeout=12)
+        time.sleep(1.0)  # let the device release the stream frames
+
+        after = get_encoder_stats(args.ip)
+        if after is None:
+            print(f"{C.RED}  ✗ {ENCODER_PATH} unavailable after the soak{C.END}")
+            return 1
+        print_summary(before, after, clients, elapsed)
+        return 0 if all(not c.error for c in clients) else 1
+    finally:
+        session.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
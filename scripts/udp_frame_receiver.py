@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+UDP frame transport receiver and benchmark for K10 Bot
+
+Registers as master over UDP, subscribes to the webcam frame transport (0x61)
+and reassembles the JPEG fragments (0x62) it is pushed. Frames missing a
+fragment are dropped, as the device never retransmits. At the end it reports:
+  • frames complete / incomplete / never seen (frame id gaps), fragment loss
+  • assembly time (first to last fragment of a frame)
+  • capture-to-complete latency, relative to the fastest frame (the device
+    clock is not synchronised: the minimum is taken as the clock offset)
+  • the device side counters of the subscription (0x64) for comparison
+
+Usage:
+    python3 udp_frame_receiver.py <robot_ip> [port] <token> [--seconds 30] [--max-fps 0]
+
+Examples:
+    python3 udp_frame_receiver.py 192.168.1.42 24642 A3K9B
+    python3 udp_frame_receiver.py 192.168.1.42 24642 A3K9B --seconds 120 --max-fps 10 --save last.jpg
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import threading
+import time
+
+# ─── Constants ────────────────────────────────────────────────────────────────
+
+CMD_MASTER_REGISTER = 0x41
+CMD_MASTER_UNREGISTER = 0x42
+CMD_HEARTBEAT = 0x43
+CMD_FRAME_SUBSCRIBE = 0x61
+CMD_FRAME_FRAGMENT = 0x62
+CMD_FRAME_UNSUBSCRIBE = 0x63
+CMD_FRAME_STATS = 0x64
+UDP_SUCCESS = 0x01
+UDP_IGNORED = 0x02
+RESP_OK = 0x00
+FRAGMENT_VERSION = 1
+FRAGMENT_HEADER = struct.Struct("<BBHHHIQ")   # action, version, frame_id, index, count, frame_len, capture_us
+STATS_FORMAT = struct.Struct("<BBBIIII")      # version, peers, subscribed, sent, aborted, fragments, skipped
+PARTIAL_TIMEOUT_S = 0.5                        # incomplete frame given up after this long
+RENEW_PERIOD_S = 2.0                           # lease renewal (lease is 5 s)
+
+# ─── Colours ──────────────────────────────────────────────────────────────────
+
+class C:
+    BOLD  = '\033[1m'
+    GREEN = '\033[92m'
+    YELLOW= '\033[93m'
+    RED   = '\033[91m'
+    CYAN  = '\033[96m'
+    END   = '\033[0m'
+
+# ─── Master session ───────────────────────────────────────────────────────────
+
+class MasterSession:
+    """Registers as master and sends [0x43] every 25 ms until closed."""
+
+    def __init__(self, ip: str, port: int, token: str):
+        self._addr = (ip, port)
+        self._token = token
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self._sock.settimeout(2.0)
+        self._running = False
+        self._thread: threading.Thread | None = None
+
+    def register(self) -> bool:
+        self._sock.sendto(bytes([CMD_MASTER_REGISTER]) + self._token.encode(), self._addr)
+        try:
+            resp, _ = self._sock.recvfrom(64)
+        except socket.timeout:
+            return False
+        if not resp or resp[0] != CMD_MASTER_REGISTER or resp[-1] not in (UDP_SUCCESS, UDP_IGNORED):
+            return False
+        self._running = True
+        self._thread = threading.Thread(target=self._loop, daemon=True)
+        self._thread.start()
+        return True
+
+    def close(self) -> None:
+        self._running = False
+        if self._thread:
+            self._thread.join(timeout=1.0)
+            self._sock.sendto(bytes([CMD_MASTER_UNREGISTER]), self._addr)
+        self._sock.close()
+
+    def _loop(self) -> None:
+        while self._running:
+            self._sock.sendto(bytes([CMD_HEARTBEAT]), self._addr)
+            time.sleep(0.025)
+
+# ─── Reassembler ──────────────────────────────────────────────────────────────
+
+def newer(a: int, b: int) -> bool:
+    """frame_id a is after b (16-bit wrap-around)."""
+    return a != b and ((a - b) & 0xFFFF) < 0x8000
+
+
+class FrameReassembler:
+    """Collects fragments per frame_id; a frame is complete with every fragment.
+
+    A partial frame is dropped when a newer frame completes first or after
+    PARTIAL_TIMEOUT_S. Fragments of a frame already completed or dropped are
+    ignored (late duplicates)."""
+
+    def __init__(self):
+        self._partial: dict[int, dict] = {}
+        self._last_done: int | None = None   # newest frame_id completed or dropped
+        self.fragments = 0
+        self.malformed = 0
+        self.late = 0
+        self.complete = 0
+        self.incomplete = 0
+        self.missing_fragments = 0           # fragments of incomplete frames never received
+        self.never_seen = 0                  # frame id gaps: no fragment at all
+        self.corrupt = 0                     # complete but not a JPEG (SOI/EOI)
+        self.assembly_s: list[float] = []
+        self.latency_raw_us: list[int] = []  # host receive - device capture, unsynchronised clocks
+        self.sizes: list[int] = []
+        self.last_jpeg = b""
+
+    def feed(self, datagram: bytes, now: float) -> bytes | None:
+        """Add one datagram; returns the JPEG when it completes a frame."""
+        self.expire(now)
+        if len(datagram) < FRAGMENT_HEADER.size or datagram[0] != CMD_FRAME_FRAGMENT:
+            self.malformed += 1
+            return None
+        _, version, frame_id, index, count, frame_len, capture_us = FRAGMENT_HEADER.unpack_from(datagram)
+        if version != FRAGMENT_VERSION or count == 0 or index >= count:
+            self.malformed += 1
+            return None
+        self.fragments += 1
+        if self._last_done is not None and not newer(frame_id, self._last_done):
+            self.late += 1
+            return None
+
+        frame = self._partial.get(frame_id)
+        if frame is None:
+            frame = {"count": count, "len": frame_len, "capture_us": capture_us, "first": now, "parts": {}}
+            self._partial[frame_id] = frame
+        frame["parts"][index] = datagram[FRAGMENT_HEADER.size:]
+        if len(frame["parts"]) < frame["count"]:
+            return None
+
+        jpeg = b"".join(frame["parts"][i] for i in range(frame["count"]))
+        del self._partial[frame_id]
+        self._drop_older(frame_id)
+        self._done(frame_id)
+        if len(jpeg) != frame["len"] or not (jpeg.startswith(b"\xff\xd8") and jpeg.endswith(b"\xff\xd9")):
+            self.corrupt += 1
+            return None
+        self.complete += 1
+        self.assembly_s.append(now - frame["first"])
+        self.latency_raw_us.append(int(now * 1e6) - frame["capture_us"])
+        self.sizes.append(len(jpeg))
+        self.last_jpeg = jpeg
+        return jpeg
+
+    def expire(self, now: float) -> None:
+        for frame_id in [f for f, p in self._partial.items() if now - p["first"] > PARTIAL_TIMEOUT_S]:
+            self._drop(frame_id)
+
+    def finish(self) -> None:
+        for frame_id in list(self._partial):
+            self._drop(frame_id)
+
+    def _drop_older(self, frame_id: int) -> None:
+        for older in [f for f in self._partial if newer(frame_id, f)]:
+            self._drop(older)
+
+    def _drop(self, frame_id: int) -> None:
+        frame = self._partial.pop(frame_id)
+        self.incomplete += 1
+        self.missing_fragments += frame["count"] - len(frame["parts"])
+        self._done(frame_id)
+
+    def _done(self, frame_id: int) -> None:
+        if self._last_done is None:
+            self._last_done = frame_id
+        elif newer(frame_id, self._last_done):
+            self.never_seen += ((frame_id - self._last_done) & 0xFFFF) - 1 - self._pending_between(frame_id)
+            self._last_done = frame_id
+
+    def _pending_between(self, frame_id: int) -> int:
+        """Partial frames between the last finished one and frame_id (not gaps)."""
+        return sum(1 for f in self._partial if newer(f, self._last_done) and newer(frame_id, f))
+
+# ─── Helpers ──────────────────────────────────────────────────────────────────
+
+def percentile(values: list[float], pct: float) -> float:
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * pct / 100))]
+
+
+def request(sock: socket.socket, addr: tuple, payload: bytes, timeout: float = 1.0) -> bytes | None:
+    """Send a command and wait for its reply, skipping the fragments received meanwhile."""
+    sock.sendto(payload, addr)
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        sock.settimeout(max(0.01, end - time.monotonic()))
+        try:
+            data, _ = sock.recvfrom(2048)
+        except socket.timeout:
+            break
+        if data and data[0] == payload[0]:
+            return data
+    return None
+
+
+def print_summary(r: FrameReassembler, elapsed: float, device: tuple | None) -> None:
+    expected_fragments = r.fragments + r.missing_fragments
+    print(f"\n{C.BOLD}{C.CYAN}  Frames ({elapsed:.0f} s){C.END}")
+    print(f"  complete {r.complete} ({r.complete / elapsed:.1f} fps)  incomplete {r.incomplete}"
+          f"  never seen {r.never_seen}  corrupt {r.corrupt}")
+    print(f"  fragments {r.fragments}  missing {r.missing_fragments}"
+          f" ({100.0 * r.missing_fragments / expected_fragments if expected_fragments else 0:.2f}%)"
+          f"  late {r.late}  malformed {r.malformed}")
+    if r.sizes:
+        print(f"  JPEG size avg {sum(r.sizes) / len(r.sizes) / 1024:.1f} KiB  max {max(r.sizes) / 1024:.1f} KiB")
+
+    if r.complete:
+        offset = min(r.latency_raw_us)
+        latency_ms = [(v - offset) / 1000.0 for v in r.latency_raw_us]
+        assembly_ms = [v * 1000.0 for v in r.assembly_s]
+        print(f"\n{C.BOLD}{C.CYAN}  Timing (ms){C.END}")
+        print(f"  assembly            p50 {percentile(assembly_ms, 50):7.1f}  p95 {percentile(assembly_ms, 95):7.1f}"
+              f"  max {max(assembly_ms):7.1f}")
+        print(f"  latency over best   p50 {percentile(latency_ms, 50):7.1f}  p95 {percentile(latency_ms, 95):7.1f}"
+              f"  max {max(latency_ms):7.1f}")
+
+    if device:
+        _, peers, subscribed, sent, aborted, fragments, skipped = device
+        print(f"\n{C.BOLD}{C.CYAN}  Device counters (0x64){C.END}")
+        if not subscribed:
+            print(f"{C.YELLOW}  not subscribed any more (lease expired?){C.END}")
+            return
+        print(f"  peers {peers}  frames sent {sent}  aborted {aborted}  skipped (max fps) {skipped}"
+              f"  fragments sent {fragments}")
+        lost = fragments - r.fragments
+        colour = C.GREEN if lost <= 0 else C.YELLOW
+        print(f"  {colour}network lost {max(lost, 0)} of {fragments} fragments"
+              f" ({100.0 * max(lost, 0) / fragments if fragments else 0:.2f}%),"
+              f" frames sent whole {sent} vs complete here {r.complete}{C.END}")
+
+# ─── Main Logic ───────────────────────────────────────────────────────────────
+
+def main() -> int:
+    p = argparse.ArgumentParser(description="K10 Bot UDP frame transport receiver and benchmark")
+    p.add_argument("ip", help="K10 device IP address")
+    p.add_argument("port", type=int, nargs="?", default=24642, help="UDP port (default 24642)")
+    p.add_argument("token", help="5-char registration token shown on device screen at boot")
+    p.add_argument("--seconds", type=float, default=30.0, help="Benchmark duration (default 30)")
+    p.add_argument("--max-fps", type=int, default=0, help="Frame rate cap asked to the device, 0 = every frame")
+    p.add_argument("--save", help="Write the last complete JPEG to this file")
+    args = p.parse_args()
+
+    print(f"{C.BOLD}{C.CYAN}{'─' * 60}")
+    print("  UDP Frame Transport Benchmark")
+    print(f"{'─' * 60}{C.END}")
+    print(f"  Target   : {args.ip}:{args.port}")
+    print(f"  Max fps  : {args.max_fps or 'every frame'}")
+    print(f"  Duration : {args.seconds} s")
+
+    session = MasterSession(args.ip, args.port, args.token)
+    if not session.register():
+        print(f"{C.RED}  ✗ Master registration failed{C.END}")
+        return 1
+    print(f"{C.GREEN}  ✓ Registered as master{C.END}")
+
+    addr = (args.ip, args.port)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    subscribe = bytes([CMD_FRAME_SUBSCRIBE, args.max_fps & 0xFF])
+    reassembler = FrameReassembler()
+    try:
+        resp = request(sock, addr, subscribe)
+        if not resp or len(resp) < 6 or resp[1] != RESP_OK:
+            print(f"{C.RED}  ✗ Subscribe failed: {resp.hex() if resp else 'no reply'}{C.END}")
+            return 1
+        payload_max, lease_ms = struct.unpack_from("<HH", resp, 2)
+        print(f"{C.GREEN}  ✓ Subscribed: {payload_max} B per fragment, lease {lease_ms} ms{C.END}")
+
+        start = time.monotonic()
+        end = start + args.seconds
+        renew = start + RENEW_PERIOD_S
+        report = start + 5.0
+        try:
+            while time.monotonic() < end:
+                now = time.monotonic()
+                if now >= renew:
+                    sock.sendto(subscribe, addr)   # reply arrives among the fragments
+                    renew = now + RENEW_PERIOD_S
+                if now >= report:
+                    print(f"  {now - start:5.0f} s  complete {reassembler.complete:>6}"
+                          f"  incomplete {reassembler.incomplete:>5}  missing fragments {reassembler.missing_fragments:>6}")
+                    report = now + 5.0
+                sock.settimeout(0.1)
+                try:
+                    data, _ = sock.recvfrom(2048)
+                except socket.timeout:
+                    continue
+                if data and data[0] == CMD_FRAME_FRAGMENT:
+                    reassembler.feed(data, time.time())
+        except KeyboardInterrupt:
+            print(f"\n{C.YELLOW}  Interrupted{C.END}")
+        elapsed = max(time.monotonic() - start, 1e-3)
+        reassembler.finish()
+
+        stats = request(sock, addr, bytes([CMD_FRAME_STATS]))
+        device = None
+        if stats and len(stats) >= 2 + STATS_FORMAT.size and stats[1] == RESP_OK:
+            device = STATS_FORMAT.unpack_from(stats, 2)
+        request(sock, addr, bytes([CMD_FRAME_UNSUBSCRIBE]))
+
+        print_summary(reassembler, elapsed, device)
+        if args.save and reassembler.last_jpeg:
+            with open(args.save, "wb") as f:
+                f.write(reassembler.last_jpeg)
+            print(f"\n  Last frame written to {args.save}")
+        return 0 if reassembler.complete else 1
+    finally:
+        sock.close()
+        session.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
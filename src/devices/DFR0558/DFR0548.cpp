@@ -11,8 +11,9 @@
 #include "DFR0558/DFR0548.h"
 
 // Constructor
-DFR0548_Controller::DFR0548_Controller() : _i2cAddr(DFR0548_DEFAULT_I2C_ADDR), _initialized(false)
+DFR0548_Controller::DFR0548_Controller() : _i2cAddr(DFR0548_DEFAULT_I2C_ADDR), _initialized(false), _batchDepth(0), _stopEpoch(0), _batchEpoch(0), _burstStats()
 {
+    resetImage();
     // Initialize all servos with default settings
     for (uint8_t i = 0; i < DFR0548_MAX_CHANNELS; i++)
     {
@@ -38,7 +39,14 @@ bool DFR0548_Controller::init()
     }
 
     reset();
+    // Auto-increment first: setPWMFreq() keeps the MODE1 bits it finds
+    writeRegister(PCA9685_MODE1, readRegister(PCA9685_MODE1) | PCA9685_MODE1_AI);
     setPWMFreq(DFR0548_PWM_FREQUENCY);
+    // Known starting point for the batched API: all 16 outputs off, in one burst
+    resetImage();
+    _ledDirty = 0xFFFF;
+    beginUpdate();
+    endUpdate();
     _initialized = true;
     return true;
 }
@@ -134,8 +142,9 @@ void DFR0548_Controller::setServoAngleLimits(uint8_t channel, uint8_t minAngle,
     if (channel >= DFR0548_MAX_CHANNELS)
         return;
 
+    // Angles map from 0: the lower limit is not stored
+    (void)minAngle;
     _servos[channel].maxAngle = maxAngle;
-    // minAngle is typically 0, so we don't store it separately
 }
 
 // Calibrate servo neutral position
@@ -354,6 +363,111 @@ uint16_t DFR0548_Controller::getPWM(uint8_t channel)
     return (uint16_t)off_h << 8 | off_l;
 }
 
+// ===== BATCHED PWM UPDATES (AUTO-INCREMENT) =====
+
+// Open a batch (batches nest)
+void DFR0548_Controller::beginUpdate()
+{
+    if (_batchDepth == 0)
+        _batchEpoch = _stopEpoch;
+    _batchDepth++;
+}
+
+// Stage one output; outside a batch it is written at once
+void DFR0548_Controller::stagePWM(uint8_t pcaChannel, uint16_t on, uint16_t off)
+{
+    if (pcaChannel >= PCA9685_CHANNELS)
+        return;
+
+    _burstStats.writesRequested++;
+    uint8_t *led = &_ledImage[pcaChannel * 4];
+    const uint8_t bytes[4] = {static_cast<uint8_t>(on & 0xFF), static_cast<uint8_t>(on >> 8),
+                              static_cast<uint8_t>(off & 0xFF), static_cast<uint8_t>(off >> 8)};
+    if (memcmp(led, bytes, sizeof(bytes)) == 0)
+    {
+        _burstStats.writesSkipped++;
+        return;
+    }
+    memcpy(led, bytes, sizeof(bytes));
+    _ledDirty |= static_cast<uint16_t>(1u << pcaChannel);
+
+    if (_batchDepth == 0)
+    {
+        beginUpdate();
+        endUpdate();
+    }
+}
+
+// Close a batch; the outermost call writes the dirty range as one transaction
+uint8_t DFR0548_Controller::endUpdate()
+{
+    if (_batchDepth > 0)
+        _batchDepth--;
+    if (_batchDepth > 0 || _ledDirty == 0)
+        return 0x00;
+    // Values staged before an emergency write must not follow it to the bus
+    if (_stopEpoch != _batchEpoch)
+    {
+        _burstStats.burstsOvertaken++;
+        return 0xff;
+    }
+
+    const uint16_t dirty = _ledDirty;
+    const uint8_t first = static_cast<uint8_t>(__builtin_ctz(dirty));
+    const uint8_t last = static_cast<uint8_t>(31 - __builtin_clz(dirty));
+    const uint8_t channels = last - first + 1;
+    const uint8_t len = channels * 4; // At most 64 bytes + register: fits the Wire buffer
+
+    _burstStats.bursts++;
+    _burstStats.burstBytes += len;
+    if (!writeBurst(PCA9685_LED0_ON_L + 4 * first, &_ledImage[first * 4], len))
+    {
+        _burstStats.burstErrors++;
+        return 0xff;
+    }
+    _burstStats.channelsBridged += channels - __builtin_popcount(dirty);
+    _ledDirty = 0;
+    return 0x00;
+}
+
+// Emergency path: no image update, no batch; the Wire lock queues waiters by priority
+uint8_t DFR0548_Controller::emergencyWrite(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    _stopEpoch++; // Single writer: the stop task
+    bool written = writeBurst(reg, data, len) || writeBurst(reg, data, len);
+    return written ? 0x00 : 0xff;
+}
+
+// After a brownout the chip comes back asleep with auto-increment off and all outputs off
+uint8_t DFR0548_Controller::verifyOutputs()
+{
+    _burstStats.verifyReads++;
+    Wire.beginTransmission(_i2cAddr);
+    Wire.write(PCA9685_MODE1);
+    if (Wire.endTransmission() != 0 || Wire.requestFrom(_i2cAddr, (uint8_t)1) != 1)
+    {
+        _burstStats.verifyErrors++;
+        return 0;
+    }
+    const uint8_t mode = Wire.read();
+    if ((mode & PCA9685_MODE1_AI) && !(mode & PCA9685_MODE1_SLEEP))
+        return 0;
+
+    writeRegister(PCA9685_MODE1, static_cast<uint8_t>((mode & ~PCA9685_RESTART) | PCA9685_MODE1_AI));
+    setPWMFreq(DFR0548_PWM_FREQUENCY);
+    _ledDirty = 0xFFFF;
+    beginUpdate();
+    if (endUpdate() != 0x00)
+        return 0;
+    _burstStats.channelsRestored += PCA9685_CHANNELS;
+    return PCA9685_CHANNELS;
+}
+
+PCA9685BurstStats DFR0548_Controller::getBurstStats()
+{
+    return _burstStats;
+}
+
 // ===== DIAGNOSTIC AND STATUS FUNCTIONS =====
 
 // Check if PCA9685 is responding
@@ -496,9 +610,32 @@ uint8_t DFR0548_Controller::readRegister(uint8_t reg)
     return Wire.read();
 }
 
+// Write consecutive registers in one transaction (MODE1 auto-increment must be set)
+bool DFR0548_Controller::writeBurst(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    Wire.beginTransmission(_i2cAddr);
+    Wire.write(reg);
+    Wire.write(data, len);
+    return Wire.endTransmission() == 0;
+}
+
 // Reset PCA9685
 void DFR0548_Controller::reset()
 {
     writeRegister(PCA9685_MODE1, PCA9685_RESTART);
     delay(10);
 }
+
+// Output image matching the power-on state: every channel fully off
+void DFR0548_Controller::resetImage()
+{
+    for (uint8_t channel = 0; channel < PCA9685_CHANNELS; channel++)
+    {
+        uint8_t *led = &_ledImage[channel * 4];
+        led[0] = 0;
+        led[1] = 0;
+        led[2] = 0;
+        led[3] = PCA9685_FULL_ON_OFF >> 8;
+    }
+    _ledDirty = 0;
+}
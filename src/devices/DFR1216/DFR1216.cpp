@@ -11,93 +11,496 @@
 #include "DFR1216/DFR1216.h"
 
 SemaphoreHandle_t DFR1216_I2C::__i2c_mutex = nullptr;
+sShadowState_t DFR1216::__shadows[SHADOW_BOARDS] = {};
+sBusStats_t DFR1216::__busStats = {};
+portMUX_TYPE DFR1216::__busStatsLock = portMUX_INITIALIZER_UNLOCKED;
 
-DFR1216::DFR1216(){}
+DFR1216::DFR1216(uint8_t addr)
+{
+  // Several services drive the same board through their own instance: they must
+  // see each other's writes, or the skip of unchanged values drops needed writes
+  // and verifyShadow() puts back what another instance changed. Instances are
+  // built during static initialisation, before any task runs.
+  __sh = nullptr;
+  for (uint8_t i = 0; i < SHADOW_BOARDS && !__sh; i++) {
+    if (__shadows[i].addr == addr) {
+      __sh = &__shadows[i];
+    }
+  }
+  for (uint8_t i = 0; i < SHADOW_BOARDS && !__sh; i++) {
+    if (__shadows[i].addr == 0) {
+      __sh = &__shadows[i];
+      __sh->addr = addr;
+    }
+  }
+}
 DFR1216::~DFR1216(){}
 
+// ---------------------------------------------------------------------------
+// Actuator register shadow
+// The period/duty block (0x00..0x23) is write-mostly: keep a copy of what was
+// sent so repeated commands cost no bus traffic, and so several channel updates
+// can be pushed as one auto-increment write.
+// ---------------------------------------------------------------------------
 
-void DFR1216::setMotorPeriod(ePeriod_t number ,uint16_t motorPeriod)
+// The shadow starts at register 0: a register is in it iff reg < SHADOW_REG_LEN
+static_assert(SHADOW_REG_BASE == 0, "shadow range checks assume it starts at register 0");
+
+void DFR1216::__lockShadow(void)
+{
+  if (__sh && __sh->mutex) xSemaphoreTakeRecursive(__sh->mutex, portMAX_DELAY);
+}
+
+void DFR1216::__unlockShadow(void)
+{
+  if (__sh && __sh->mutex) xSemaphoreGiveRecursive(__sh->mutex);
+}
+
+uint8_t DFR1216::__writeRetry(uint8_t reg, uint8_t *data, uint8_t len)
 {
-  uint8_t reg = 0;
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  if(number == eMotor1_2){
-    reg = I2C_MOTOR12_PERIOD_H;
-  }else if(number == eMotor3_4){
-    reg = I2C_MOTOR34_PERIOD_H;
-  }else if (number == eServo0_1){
-    reg = I2C_SERVO01_PERIOD_H;
-  }else if (number == eServo2_5){
-    reg = I2C_SERVO25_PERIOD_H;
-  }
-  _tempData[0] = (motorPeriod >> 8)& 0xFF;
-  _tempData[1] = (motorPeriod >> 0)& 0xFF;
   for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 2);
-    if(result == 0){
-      return;
+    if (i > 0) {
+      __noteRetry(reg);
+    }
+    if(writeReg(reg, data, len) == 0){
+      return 0;
     }else{
       DBG("i2c write error ");
     }
     delay(I2C_RETRY_DELAY_MS);
   }
-  return;
+  __noteFailure(reg);
+  return 0xff;
 }
 
-void DFR1216::setMotorDuty(eMotorNumber_t number, uint16_t duty)
+int16_t DFR1216::__readRetry(uint8_t reg, uint8_t *data, uint8_t len)
 {
-  uint8_t reg = 0;
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  reg = I2C_MOTOR1_Z_DUTY_H + number*2;
-  _tempData[0] = (duty >> 8)& 0xFF;
-  _tempData[1] = (duty >> 0)& 0xFF;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 2);
-    if(result == 0){
-      return;
+  for (uint8_t i = 0; i < RETRY_COUNT; i++) {
+    if (i > 0) {
+      __noteRetry(reg);
+    }
+    if (readReg(reg, data, len) == 0) {
+      return 0;
     }else{
-      DBG("i2c write error ");
+      DBG("i2c read error, please wait !");
     }
     delay(I2C_RETRY_DELAY_MS);
   }
-  return;
+  __noteFailure(reg);
+  return -1;
 }
 
+// ---------------------------------------------------------------------------
+// I2C bus statistics
+// Shared by every instance (they all sit on the same bus behind the same
+// mutex), so a marginal cable shows up as retries/NACKs and a fattening
+// duration histogram long before the robot visibly lags.
+// ---------------------------------------------------------------------------
 
-void DFR1216::setServo360(eServoNumber_t number, eServo360Direction_t direction, uint8_t speed)
+eRegClass_t DFR1216::regClass(uint8_t reg)
 {
-  uint8_t reg = 0;
-  uint16_t period = 0;
+  if (reg < I2C_IR_S_STATE) return eRegActuator;
+  if (reg < I2C_SR04_STATE) return eRegIR;
+  if (reg < I2C_IO_MODE_C0) return eRegSR04;
+  if (reg < I2C_ADC_C0_S) return eRegGPIO;
+  if (reg < I2C_DHT_C0_S) return eRegADC;
+  if (reg < I2C_18B20_C0_S) return eRegDHT;
+  if (reg < I2C_BATTERY) return eReg18B20;
+  if (reg == I2C_BATTERY) return eRegBattery;
+  if (reg < I2C_WS2812_STATE) return eRegIR;
+  if (reg < I2C_RESET_SENSOR) return eRegWS2812;
+  return eRegControl;
+}
+
+const char *DFR1216::regClassName(eRegClass_t regClass)
+{
+  static const char *const names[eRegClassCount] = {
+    "actuator", "ir", "sr04", "gpio", "adc", "dht", "ds18b20", "battery", "ws2812", "control"};
+  return regClass < eRegClassCount ? names[regClass] : "unknown";
+}
+
+void DFR1216::recordTransaction(uint8_t reg, bool read, uint8_t error, uint32_t busUs)
+{
+  uint8_t bucket = busUs < 2 ? 0 : 31 - __builtin_clz(busUs);
+  if (bucket >= BUS_HIST_BUCKETS) {
+    bucket = BUS_HIST_BUCKETS - 1;
+  }
+  sBusClassStats_t &cls = __busStats.classes[regClass(reg)];
+  portENTER_CRITICAL(&__busStatsLock);
+  if (read) {
+    cls.reads++;
+  } else {
+    cls.writes++;
+  }
+  if (error == 2 || error == 3) {
+    cls.nacks++;
+  } else if (error != 0) {
+    cls.errors++;
+  }
+  __busStats.durationHist[bucket]++;
+  __busStats.durationSumUs += busUs;
+  if (busUs > __busStats.durationMaxUs) {
+    __busStats.durationMaxUs = busUs;
+  }
+  __busStats.transactions++;
+  portEXIT_CRITICAL(&__busStatsLock);
+}
+
+void DFR1216::recordMutexWait(bool contended, uint32_t waitUs)
+{
+  portENTER_CRITICAL(&__busStatsLock);
+  __busStats.mutexAcquisitions++;
+  if (contended) {
+    __busStats.mutexContended++;
+    __busStats.mutexWaitSumUs += waitUs;
+    if (waitUs > __busStats.mutexWaitMaxUs) {
+      __busStats.mutexWaitMaxUs = waitUs;
+    }
+  }
+  portEXIT_CRITICAL(&__busStatsLock);
+}
+
+void DFR1216::__noteRetry(uint8_t reg)
+{
+  portENTER_CRITICAL(&__busStatsLock);
+  __busStats.classes[regClass(reg)].retries++;
+  portEXIT_CRITICAL(&__busStatsLock);
+}
+
+void DFR1216::__noteFailure(uint8_t reg)
+{
+  portENTER_CRITICAL(&__busStatsLock);
+  __busStats.classes[regClass(reg)].failures++;
+  portEXIT_CRITICAL(&__busStatsLock);
+}
+
+sBusStats_t DFR1216::getBusStats(void)
+{
+  portENTER_CRITICAL(&__busStatsLock);
+  sBusStats_t stats = __busStats;
+  portEXIT_CRITICAL(&__busStatsLock);
+  return stats;
+}
+
+void DFR1216::resetBusStats(void)
+{
+  portENTER_CRITICAL(&__busStatsLock);
+  memset(&__busStats, 0, sizeof(__busStats));
+  portEXIT_CRITICAL(&__busStatsLock);
+}
+
+void DFR1216::attachShadow(void)
+{
+  if (__sh && !__sh->mutex) {
+    __sh->mutex = xSemaphoreCreateRecursiveMutex();
+  }
+}
+
+void DFR1216::resetShadow(void)
+{
+  if (!__sh) {
+    return;
+  }
+  attachShadow();
+  __lockShadow();
+  memset(__sh->regs, 0, sizeof(__sh->regs));
+  __sh->valid = 0;
+  __sh->dirty = 0;
+  __sh->verifyCursor = 0;
+  __unlockShadow();
+}
+
+void DFR1216::rewriteShadow(void)
+{
+  if (!__sh) {
+    return;
+  }
+  __lockShadow();
+  __sh->dirty = __sh->valid;
+  __unlockShadow();
+}
+
+void DFR1216::beginUpdate(void)
+{
+  if (!__sh) {
+    return;
+  }
+  __lockShadow();
+  if (__sh->batchDepth == 0) {
+    __sh->batchEpoch = __sh->stopEpoch;
+  }
+  __sh->batchDepth++;
+}
+
+uint8_t DFR1216::endUpdate(void)
+{
+  if (!__sh) {
+    return 0;
+  }
   uint8_t result = 0;
+  if (__sh->batchDepth > 0) {
+    __sh->batchDepth--;
+  }
+  if (__sh->batchDepth == 0) {
+    // Values staged before an emergency write must not follow it to the bus
+    result = __flushSpans(__sh->batchEpoch);
+  }
+  __unlockShadow();
+  return result;
+}
+
+uint8_t DFR1216::writeWord(uint8_t reg, uint16_t value)
+{
+  uint8_t _tempData[2];
+  _tempData[0] = (value >> 8) & 0xFF;
+  _tempData[1] = (value >> 0) & 0xFF;
+  if (!__sh || (reg & 0x01) || reg >= SHADOW_REG_BASE + SHADOW_REG_LEN) {
+    return __writeRetry(reg, _tempData, 2);
+  }
+  uint8_t result = 0;
+  uint8_t offset = reg - SHADOW_REG_BASE;
+  uint32_t bit = 1UL << (offset / 2);
+  __lockShadow();
+  __sh->stats.writesRequested++;
+  if ((__sh->valid & bit) && __sh->regs[offset] == _tempData[0] && __sh->regs[offset + 1] == _tempData[1]) {
+    __sh->stats.writesSkipped++;
+  } else {
+    __sh->regs[offset] = _tempData[0];
+    __sh->regs[offset + 1] = _tempData[1];
+    __sh->valid |= bit;
+    __sh->dirty |= bit;
+    if (__sh->batchDepth == 0) {
+      result = flushShadow();
+    }
+  }
+  __unlockShadow();
+  return result;
+}
+
+uint8_t DFR1216::flushShadow(void)
+{
+  if (!__sh) {
+    return 0;
+  }
+  __lockShadow();
+  uint8_t result = __flushSpans(__sh->stopEpoch);
+  __unlockShadow();
+  return result;
+}
+
+uint8_t DFR1216::__flushSpans(uint32_t epoch)
+{
+  uint8_t result = 0;
+  uint8_t word = 0;
+  while (__sh->dirty && word < SHADOW_WORDS) {
+    // Checked before each span, under the shadow lock: emergencyWrite() does not
+    // take it, so a stop can land between two spans of the same flush
+    if (__sh->stopEpoch != epoch) {
+      __sh->stats.flushesOvertaken++;
+      return 0xff;
+    }
+    if (!(__sh->dirty & (1UL << word))) {
+      word++;
+      continue;
+    }
+    // Grow the span over dirty words, bridging short runs of clean words whose
+    // value is known (re-sending them is cheaper than a new transaction).
+    uint8_t first = word;
+    uint8_t last = word;
+    uint8_t dirtyWords = 1;
+    uint8_t next = word + 1;
+    while (next < SHADOW_WORDS) {
+      if (__sh->dirty & (1UL << next)) {
+        last = next;
+        dirtyWords++;
+        next++;
+        continue;
+      }
+      uint8_t gap = 0;
+      while (next + gap < SHADOW_WORDS && gap <= SHADOW_MERGE_GAP &&
+             !(__sh->dirty & (1UL << (next + gap))) && (__sh->valid & (1UL << (next + gap)))) {
+        gap++;
+      }
+      if (gap == 0 || gap > SHADOW_MERGE_GAP || next + gap >= SHADOW_WORDS ||
+          !(__sh->dirty & (1UL << (next + gap)))) {
+        break;
+      }
+      next += gap;
+    }
+    uint32_t spanMask = ((1UL << (last - first + 1)) - 1) << first;
+    if (__writeRetry(SHADOW_REG_BASE + first * 2, &__sh->regs[first * 2], (last - first + 1) * 2) == 0) {
+      __sh->dirty &= ~spanMask;
+      __sh->stats.spansFlushed++;
+      __sh->stats.writesMerged += dirtyWords - 1;
+    } else {
+      __sh->stats.flushErrors++;
+      result = 0xff;
+    }
+    word = last + 1;
+  }
+  return result;
+}
+
+uint8_t DFR1216::verifyShadow(uint8_t maxBytes)
+{
+  uint8_t repaired = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
+  if (!__sh) {
+    return 0;
+  }
+  if (maxBytes > SHADOW_REG_LEN) {
+    maxBytes = SHADOW_REG_LEN;
+  }
+  __lockShadow();
+  uint8_t done = 0;
+  while (done < maxBytes) {
+    uint8_t start = __sh->verifyCursor;
+    uint8_t len = SHADOW_VERIFY_CHUNK;
+    if (start + len > SHADOW_REG_LEN) {
+      len = SHADOW_REG_LEN - start;
+    }
+    uint32_t chunkMask = ((1UL << (len / 2)) - 1) << (start / 2);
+    uint32_t checkMask = chunkMask & __sh->valid & ~__sh->dirty;
+    if (checkMask) {
+      __sh->stats.verifyReads++;
+      if (readReg(SHADOW_REG_BASE + start, _tempData, len) == 0) {
+        for (uint8_t w = start / 2; w < (start + len) / 2; w++) {
+          if (!(checkMask & (1UL << w))) {
+            continue;
+          }
+          uint8_t o = w * 2 - start;
+          if (_tempData[o] != __sh->regs[w * 2] || _tempData[o + 1] != __sh->regs[w * 2 + 1]) {
+            DBG("shadow drift, repairing");
+            __sh->dirty |= 1UL << w;
+            repaired++;
+          }
+        }
+      } else {
+        __sh->stats.verifyErrors++;
+      }
+    }
+    done += len;
+    __sh->verifyCursor = (start + len >= SHADOW_REG_LEN) ? 0 : start + len;
+  }
+  if (repaired) {
+    __sh->stats.registersRepaired += repaired;
+    flushShadow();
+  }
+  __unlockShadow();
+  return repaired;
+}
+
+bool DFR1216::readShadow(uint8_t reg, uint16_t *value)
+{
+  if (!__sh || (reg & 0x01) || reg >= SHADOW_REG_BASE + SHADOW_REG_LEN || value == NULL) {
+    return false;
+  }
+  uint8_t offset = reg - SHADOW_REG_BASE;
+  bool known = false;
+  __lockShadow();
+  if (__sh->valid & (1UL << (offset / 2))) {
+    *value = ((uint16_t)__sh->regs[offset] << 8) | __sh->regs[offset + 1];
+    known = true;
+  }
+  __unlockShadow();
+  return known;
+}
+
+uint8_t DFR1216::emergencyWrite(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+  // Announced before the bus is taken: a flush that checks after this point
+  // leaves its pre-stop values staged instead of writing them over the stop
+  if (__sh) {
+    portENTER_CRITICAL(&__busStatsLock);
+    __sh->stopEpoch++;
+    portEXIT_CRITICAL(&__busStatsLock);
+  }
+  uint8_t result = writeReg(reg, const_cast<uint8_t *>(data), len);
+  if (result != 0) {
+    __noteRetry(reg);
+    result = writeReg(reg, const_cast<uint8_t *>(data), len);
+  }
+  if (result != 0) {
+    __noteFailure(reg);
+    return 0xff;
+  }
+  return 0;
+}
+
+sShadowStats_t DFR1216::getShadowStats(void)
+{
+  if (!__sh) {
+    sShadowStats_t none = {};
+    return none;
+  }
+  __lockShadow();
+  sShadowStats_t stats = __sh->stats;
+  __unlockShadow();
+  return stats;
+}
+
+
+void DFR1216::setMotorPeriod(ePeriod_t number ,uint16_t motorPeriod)
+{
+  uint8_t reg = 0;
+  if(number == eMotor1_2){
+    reg = I2C_MOTOR12_PERIOD_H;
+  }else if(number == eMotor3_4){
+    reg = I2C_MOTOR34_PERIOD_H;
+  }else if (number == eServo0_1){
+    reg = I2C_SERVO01_PERIOD_H;
+  }else if (number == eServo2_5){
+    reg = I2C_SERVO25_PERIOD_H;
+  }
+  writeWord(reg, motorPeriod);
+}
+
+void DFR1216::setMotorDuty(eMotorNumber_t number, uint16_t duty)
+{
+  writeWord(I2C_MOTOR1_Z_DUTY_H + number*2, duty);
+}
+
+
+uint16_t DFR1216::servo360Pulse(eServo360Direction_t direction, uint8_t speed)
+{
   if (speed > 100) {
     speed = 100;
   }
-  
   if (direction == eBackward) {
     // SERVO360_STOP_US ~ SERVO360_BACKWARD_MAX_US
-    period = SERVO360_STOP_US + (speed * (SERVO360_BACKWARD_MAX_US - SERVO360_STOP_US) / 100);
+    return SERVO360_STOP_US + (speed * (SERVO360_BACKWARD_MAX_US - SERVO360_STOP_US) / 100);
   } else if (direction == eForward) {
     // SERVO360_STOP_US ~ SERVO360_FORWARD_MIN_US
-    period = SERVO360_STOP_US - (speed * (SERVO360_STOP_US - SERVO360_FORWARD_MIN_US) / 100);
-  } else if (direction == eStop) {
-    period = SERVO360_STOP_US;
-  } else {
+    return SERVO360_STOP_US - (speed * (SERVO360_STOP_US - SERVO360_FORWARD_MIN_US) / 100);
+  }
+  return SERVO360_STOP_US;
+}
+
+uint16_t DFR1216::servoAnglePulse(uint16_t angle, uint16_t maxAngle)
+{
+  if (maxAngle == 270) {
+    if (angle > 270) angle = 270;
+    return SERVO270_MIN_US + ((uint32_t)angle * (SERVO270_MAX_US - SERVO270_MIN_US) / 270);
+  }
+  // Default to 180°
+  if (angle > 180) angle = 180;
+  return SERVO180_MIN_US + ((uint32_t)angle * (SERVO180_MAX_US - SERVO180_MIN_US) / 180);
+}
+
+void DFR1216::setServo360(eServoNumber_t number, eServo360Direction_t direction, uint8_t speed)
+{
+  if (direction != eForward && direction != eBackward && direction != eStop) {
     return;
   }
-  reg = number*2+I2C_SERVO0_DUTY_H;
-  _tempData[0] = (period >> 8)& 0xFF;
-  _tempData[1] = (period >> 0)& 0xFF;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 2);
-    if(result == 0){
-      return;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
+  writeWord(number*2 + I2C_SERVO0_DUTY_H, servo360Pulse(direction, speed));
+}
+
+uint8_t DFR1216::setServoPulse(eServoNumber_t number, uint16_t pulseUs)
+{
+  if (number > eServo5) {
+    return 0xff;
   }
+  return writeWord(number*2 + I2C_SERVO0_DUTY_H, pulseUs);
 }
 
 void DFR1216::setServoAngle(eServoNumber_t number, uint16_t angle)
@@ -107,67 +510,27 @@ void DFR1216::setServoAngle(eServoNumber_t number, uint16_t angle)
 
 void DFR1216::setServoAngle(eServoNumber_t number, uint16_t angle, uint16_t maxAngle)
 {
-  uint8_t reg = 0;
-  uint16_t period = 0;
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  
-  if (maxAngle == 270) {
-    if (angle > 270) angle = 270;
-    period = SERVO270_MIN_US + ((uint32_t)angle * (SERVO270_MAX_US - SERVO270_MIN_US) / 270);
-  } else {
-    // Default to 180°
-    if (angle > 180) angle = 180;
-    period = SERVO180_MIN_US + ((uint32_t)angle * (SERVO180_MAX_US - SERVO180_MIN_US) / 180);
-  }
-
-  reg = number*2 + I2C_SERVO0_DUTY_H;
-  _tempData[0] = (period >> 8)& 0xFF;
-  _tempData[1] = (period >> 0)& 0xFF;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 2);
-    if(result == 0){
-      return;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
-  return;
+  writeWord(number*2 + I2C_SERVO0_DUTY_H, servoAnglePulse(angle, maxAngle));
 }
 
 uint8_t DFR1216::getBattery(void)
 {
-  uint8_t result = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
-  for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(I2C_BATTERY, _tempData, 1);
-    if (result == 0) {
-      return _tempData[0];
-    }else{
-      DBG("i2c read error, please wait !");
-    }
-    delay(I2C_RETRY_DELAY_MS);
+  if (__readRetry(I2C_BATTERY, _tempData, 1) == 0) {
+    return _tempData[0];
   }
   return 0xFF;
 }
 
 uint32_t DFR1216::getIRData(void)
 {
-  uint8_t result = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
-  for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(I2C_IR_R_STATE, _tempData, 5);
-    if (result == 0) {
-      if(_tempData[0] == DATA_DISABLE){
-        return 0x00000000;
-      }else{
-        return ((uint32_t)_tempData[1] << 24) | ((uint32_t)_tempData[2] << 16) | ((uint32_t)_tempData[3] << 8) | _tempData[4];
-      }
+  if (__readRetry(I2C_IR_R_STATE, _tempData, 5) == 0) {
+    if(_tempData[0] == DATA_DISABLE){
+      return 0x00000000;
     }else{
-      DBG("i2c read error, please wait !");
+      return ((uint32_t)_tempData[1] << 24) | ((uint32_t)_tempData[2] << 16) | ((uint32_t)_tempData[3] << 8) | _tempData[4];
     }
-    delay(I2C_RETRY_DELAY_MS);
   }
   return 0xFFFFFFFF;
 }
@@ -181,17 +544,8 @@ uint8_t DFR1216::sendIR(uint32_t data)
   _tempData[2] = (data >> 16) & 0xFF;
   _tempData[3] = (data >> 8) & 0xFF;
   _tempData[4] = data & 0xFF;
-  
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(I2C_IR_S_STATE, _tempData, 5);
-    if(result == 0){
-      return 0;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
-  return 0xff;
+  result = __writeRetry(I2C_IR_S_STATE, _tempData, 5);
+  return result;
 }
 
 uint8_t DFR1216::setWS2812(uint32_t *data, uint8_t bright)
@@ -206,16 +560,8 @@ uint8_t DFR1216::setWS2812(uint32_t *data, uint8_t bright)
   _tempData[5] = (data[1] >> 16) & 0xFF;
   _tempData[6] = (data[1] >> 8)  & 0xFF;
   _tempData[7] = (data[1] >> 0)  & 0xFF;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(I2C_WS2812_STATE, _tempData, 8);
-    if(result == 0){
-      return 0;
-    }else{
-      DBG("i2c write error");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
-  return 0xff;
+  result = __writeRetry(I2C_WS2812_STATE, _tempData, 8);
+  return result;
 }
 
 
@@ -225,17 +571,11 @@ uint8_t DFR1216::setMode(eIONumber_t number, eIOType_t mode)
   uint8_t reg = I2C_IO_MODE_C0+number;
   uint8_t _tempData[TEMP_LEN] = {0};
   _tempData[0] = mode;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 1);
-    if(result == 0){
-      delay(10);
-      return 0;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
+  result = __writeRetry(reg, _tempData, 1);
+  if(result == 0){
+    delay(10);
   }
-  return 0xff;
+  return result;
 }
 
 uint8_t DFR1216::setGpioState(eIONumber_t number, eGpioState_t state)
@@ -244,17 +584,11 @@ uint8_t DFR1216::setGpioState(eIONumber_t number, eGpioState_t state)
   uint8_t _tempData[TEMP_LEN] = {0};
   uint8_t reg = I2C_W_C0+number;
   _tempData[0] = state;  
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 1);
-    if(result == 0){
-      delay(10);
-      return 0;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
+  result = __writeRetry(reg, _tempData, 1);
+  if(result == 0){
+    delay(10);
   }
-  return 0xff;
+  return result;
 }
 
 uint8_t DFR1216::getGpioState(eIONumber_t number)
@@ -262,181 +596,278 @@ uint8_t DFR1216::getGpioState(eIONumber_t number)
   uint8_t result = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
   uint8_t reg = I2C_R_C0+number;
-  for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(reg, _tempData, 1);
-    if (result == 0) {
-      return _tempData[0];
-    }else{
-      DBG("i2c read error, please wait !");
-    }
-    delay(I2C_RETRY_DELAY_MS);
+  result = __readRetry(reg, _tempData, 1);
+  if (result == 0) {
+    return _tempData[0];
   }
   return 0xFF;
 }
 
-uint16_t DFR1216::getADCValue(eIONumber_t number)
+// ---------------------------------------------------------------------------
+// Sensors
+// Each conversion is split into start (trigger write) and poll (one status+data
+// read that collects the value once the coprocessor reports it ready), so a
+// scheduler can overlap conversions with other bus traffic. The blocking
+// getters are kept for simple callers and are built on the same primitives.
+// ---------------------------------------------------------------------------
+
+eSensorPoll_t DFR1216::pollADC(eIONumber_t number, uint16_t *adcValue)
+{
+  uint8_t _tempData[3] = {0};
+  uint8_t reg = I2C_ADC_C0_S+number*3;
+  if (readReg(reg, _tempData, 3) != 0) {
+    return eSensorBusError;
+  }
+  if (_tempData[0] == MODE_ERROR) {
+    return eSensorModeError;
+  }
+  if (_tempData[0] != DATA_ENABLE) {
+    return eSensorPending;
+  }
+  uint16_t value = ((uint16_t)_tempData[1] << 8) | _tempData[2];
+  if (value > 3900) {
+    value = 4095;
+  } else if (value < 40) {
+    value = 0;
+  }
+  *adcValue = value;
+  return eSensorReady;
+}
+
+uint8_t DFR1216::readADCBlock(uint8_t mask, uint16_t *adcValues, uint8_t *readyMask, uint8_t *modeErrorMask)
 {
-  uint8_t result = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
+  uint8_t first = 0;
+  uint8_t last = 0;
+  *readyMask = 0;
+  if (modeErrorMask) {
+    *modeErrorMask = 0;
+  }
+  mask &= 0x3f;
+  if (mask == 0) {
+    return 0;
+  }
+  while (!(mask & (1 << first))) {
+    first++;
+  }
+  for (last = 5; !(mask & (1 << last)); last--) {
+  }
+  if (readReg(I2C_ADC_C0_S+first*3, _tempData, (last-first+1)*3) != 0) {
+    return 0xff;
+  }
+  for (uint8_t number = first; number <= last; number++) {
+    if (!(mask & (1 << number))) {
+      continue;
+    }
+    uint8_t *entry = &_tempData[(number-first)*3];
+    if (entry[0] == MODE_ERROR) {
+      if (modeErrorMask) {
+        *modeErrorMask |= 1 << number;
+      }
+      continue;
+    }
+    if (entry[0] != DATA_ENABLE) {
+      continue;
+    }
+    uint16_t value = ((uint16_t)entry[1] << 8) | entry[2];
+    if (value > 3900) {
+      value = 4095;
+    } else if (value < 40) {
+      value = 0;
+    }
+    adcValues[number] = value;
+    *readyMask |= 1 << number;
+  }
+  return 0;
+}
+
+uint8_t DFR1216::getGpioStates(uint8_t *levels)
+{
+  uint8_t _tempData[6] = {0};
+  if (readReg(I2C_R_C0, _tempData, 6) != 0) {
+    return 0xff;
+  }
+  *levels = 0;
+  for (uint8_t number = 0; number < 6; number++) {
+    if (_tempData[number] == eHIGH) {
+      *levels |= 1 << number;
+    }
+  }
+  return 0;
+}
+
+uint8_t DFR1216::startDHT(eIONumber_t number)
+{
+  uint8_t _tempData[1] = {DATA_ENABLE};
+  return __writeRetry(I2C_DHT_C0_S+number*5, _tempData, 1);
+}
+
+eSensorPoll_t DFR1216::pollDHT(eIONumber_t number, sDhtData_t *dhtData)
+{
+  uint8_t _tempData[5] = {0};
+  uint8_t reg = I2C_DHT_C0_S+number*5;
+  if (readReg(reg, _tempData, 5) != 0) {
+    return eSensorBusError;
+  }
+  if (_tempData[0] == MODE_ERROR) {
+    dhtData->state = MODE_ERROR;
+    return eSensorModeError;
+  }
+  if (_tempData[0] != DATA_ENABLE) {
+    return eSensorPending;
+  }
+  if (_tempData[1] & 0x80) {
+    dhtData->temperature = ((float)(_tempData[1] & 0x7F) + (float)_tempData[2] * 0.01)*-1.0;
+  } else {
+    dhtData->temperature = (float)_tempData[1] + (float)_tempData[2] * 0.01;
+  }
+  dhtData->humidity = (float)_tempData[3] + (float)_tempData[4] * 0.01;
+  dhtData->state = _tempData[0];
+  return eSensorReady;
+}
+
+uint8_t DFR1216::start18b20(eIONumber_t number)
+{
+  uint8_t _tempData[1] = {DATA_ENABLE};
+  return __writeRetry(I2C_18B20_C0_S+number*3, _tempData, 1);
+}
+
+eSensorPoll_t DFR1216::poll18b20(eIONumber_t number, float *temperature)
+{
+  uint8_t _tempData[3] = {0};
+  uint8_t reg = I2C_18B20_C0_S+number*3;
+  float sign = 1.0;
+  if (readReg(reg, _tempData, 3) != 0) {
+    return eSensorBusError;
+  }
+  if (_tempData[0] == MODE_ERROR) {
+    return eSensorModeError;
+  }
+  if (_tempData[0] != DATA_ENABLE) {
+    return eSensorPending;
+  }
+  if (_tempData[1] == 0xff && _tempData[2] == 0xff) {
+    return eSensorNoDevice;
+  }
+  if (_tempData[1] & 0x80) {
+    _tempData[1] &= 0x7f;
+    sign = -1.0;
+  }
+  *temperature = sign * (((uint16_t)_tempData[1]*256 + (uint16_t)_tempData[2]) / 16.0);
+  return eSensorReady;
+}
+
+uint8_t DFR1216::startSr04(void)
+{
+  uint8_t _tempData[1] = {SR04_COLLECT};
+  return __writeRetry(I2C_SR04_STATE, _tempData, 1);
+}
+
+eSensorPoll_t DFR1216::pollSr04(int16_t *distance)
+{
+  uint8_t _tempData[3] = {0};
+  if (readReg(I2C_SR04_STATE, _tempData, 3) != 0) {
+    return eSensorBusError;
+  }
+  if (_tempData[0] != SR04_COMPLETE) {
+    return eSensorPending;
+  }
+  *distance = (int16_t)(((uint16_t)_tempData[1])<<8 | _tempData[2]);
+  return eSensorReady;
+}
+
+uint16_t DFR1216::getADCValue(eIONumber_t number)
+{
   uint8_t reg = I2C_ADC_C0_S+number*3;
   uint16_t adcValue = 0;
   for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(reg, _tempData, 3);
-    if (result == 0) {
-      if(_tempData[0] == DATA_ENABLE){
-        adcValue =  ((uint16_t)_tempData[1] << 8) | _tempData[2];
-        if(adcValue > 3900){
-          adcValue = 4095;
-        }else if(adcValue < 40){
-          adcValue = 0;
-        }
-        return adcValue;
-      }else if(_tempData[0] == MODE_ERROR){
-        DBG("gpio mode error!")
-        return 0xffff;
-      }else{
-        DBG("data readly! please wait !");
-      }
-    }else{
-      DBG("i2c read error! please wait !");
+    if (i > 0) {
+      __noteRetry(reg);
     }
+    eSensorPoll_t state = pollADC(number, &adcValue);
+    if (state == eSensorReady) {
+      return adcValue;
+    } else if (state == eSensorModeError) {
+      DBG("gpio mode error!")
+      return 0xffff;
+    }
+    DBG("data readly! please wait !");
     delay(I2C_RETRY_DELAY_MS);
   }
+  __noteFailure(reg);
   return 0xFFFF;
 }
 
 sDhtData_t DFR1216::getDHTValue(eIONumber_t number)
 {
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  uint8_t reg = 0;
+  uint8_t reg = I2C_DHT_C0_S+number*5;
   sDhtData_t dhtData;
   dhtData.humidity = 0.0;
   dhtData.temperature = 0.0;
-  reg = I2C_DHT_C0_S+number*5;
+  dhtData.state = 0;
 
-  _tempData[0] = DATA_ENABLE;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 1);
-    if(result == 0){
-      break;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
+  startDHT(number);
   delay(30);
   for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(reg, _tempData, 5);
-    if (result == 0) {
-      if(_tempData[0] == DATA_ENABLE){
-        if (_tempData[1] & 0x80){
-          dhtData.temperature  = ((float)(_tempData[1] & 0x7F) + (float)_tempData[2] * 0.01)*-1.0;
-        }else{
-          dhtData.temperature = (float)_tempData[1] + (float)_tempData[2] * 0.01;
-        }
-        dhtData.humidity = (float)_tempData[3] + (float)_tempData[4] * 0.01;
-        dhtData.state = _tempData[0];
-        return dhtData;
-      }else if(_tempData[0] == MODE_ERROR){
-        dhtData.state = MODE_ERROR;
-        DBG("gpio mode error!")
-        return dhtData;
-      }else{
-      }
-    }else{
-      DBG("i2c read error! please wait !");
+    if (i > 0) {
+      __noteRetry(reg);
+    }
+    eSensorPoll_t state = pollDHT(number, &dhtData);
+    if (state == eSensorReady || state == eSensorModeError) {
+      return dhtData;
     }
+    DBG("data readly! please wait !");
     delay(30);
   }
+  __noteFailure(reg);
   return dhtData;
 }
 
 float DFR1216::get18b20Value(eIONumber_t number)
 {
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  uint8_t reg = 0;
+  uint8_t reg = I2C_18B20_C0_S+number*3;
   float temperature = 0.0;
-  reg = I2C_18B20_C0_S+number*3;
-  float sign = 1.0;
-  _tempData[0] = DATA_ENABLE;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    result = writeReg(reg, _tempData, 1);
-    if(result == 0){
-      break;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
+  start18b20(number);
   delay(50);
   for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(reg, _tempData, 3);
-    if (result == 0) {
-      if(_tempData[0] == DATA_ENABLE){
-        if(_tempData[1] == 0xff && _tempData[2] == 0xff){
-          return 0.0;
-        }
-        if(_tempData[1] & 0x80){
-          _tempData[1] &= 0x7f;
-          sign = -1.0;
-        }else{
-          sign = 1.0;
-        }
-        temperature = ((uint16_t)_tempData[1]*256 + (uint16_t)_tempData[2]) / 16.0;
-        temperature *= sign;
-        return temperature;
-      }else if(_tempData[0] == MODE_ERROR){
-        DBG("gpio mode error!")
-        return 0.0;
-      }else{
-      }
-    }else{
-      DBG("i2c read error! please wait !");
+    if (i > 0) {
+      __noteRetry(reg);
     }
+    eSensorPoll_t state = poll18b20(number, &temperature);
+    if (state == eSensorReady) {
+      return temperature;
+    } else if (state == eSensorModeError || state == eSensorNoDevice) {
+      DBG("gpio mode error!")
+      return 0.0;
+    }
+    DBG("data readly! please wait !");
     delay(30);
   }
+  __noteFailure(reg);
   return 0.0;
 }
 
 int16_t  DFR1216::getSr04Distance(void)
 {
-  uint8_t result = 0;
-  uint8_t _tempData[TEMP_LEN] = {0};
-  uint8_t reg = 0;
-  int16_t distance = 0.0;
-  reg = I2C_SR04_STATE;
-  _tempData[0] = SR04_COLLECT;
-  for(uint8_t i = 0; i < RETRY_COUNT; i++){
-    uint8_t result = writeReg(reg, _tempData, 1);
-    if(result == 0){
-      break;
-    }else{
-      DBG("i2c write error ");
-    }
-    delay(I2C_RETRY_DELAY_MS);
-  }
+  int16_t distance = 0;
+  startSr04();
   delay(30);
   for (uint8_t i = 0; i < RETRY_COUNT; i++) {
-    result = readReg(reg, _tempData, 3);
-    if (result == 0) {
-      if(_tempData[0] == SR04_COMPLETE){
-        distance = (int16_t)(((uint16_t)_tempData[1])<<8 | _tempData[2]);
-        return distance;
-      }else{
-        DBG("data readly! please wait !");
-      }
-    }else{
-      DBG("i2c read error! please wait !");
+    if (i > 0) {
+      __noteRetry(I2C_SR04_STATE);
     }
+    if (pollSr04(&distance) == eSensorReady) {
+      return distance;
+    }
+    DBG("data readly! please wait !");
     delay(30);
   }
+  __noteFailure(I2C_SR04_STATE);
   return -1;
 }
 
 
-DFR1216_I2C::DFR1216_I2C(TwoWire *pWire, uint8_t addr)
+DFR1216_I2C::DFR1216_I2C(TwoWire *pWire, uint8_t addr) : DFR1216(addr)
 {
   __pWire = pWire;
   this->__I2C_addr = addr;
@@ -448,6 +879,7 @@ bool DFR1216_I2C::begin()
   if (!__i2c_mutex) {
     __i2c_mutex = xSemaphoreCreateRecursiveMutex();
   }
+  attachShadow();
   bool result = false;
   uint8_t retry = 0;
   uint8_t _tempData[TEMP_LEN] = {0};
@@ -460,6 +892,9 @@ bool DFR1216_I2C::begin()
     result = false;
   }
   if(result){
+    // Reset with the shadow held, so no other instance on the board flushes in
+    // between; what they had set is written again once the board is back
+    beginUpdate();
     _tempData[0] = DATA_ENABLE;
     writeReg(I2C_RESET_SENSOR, _tempData, 1);
     delay(20);
@@ -476,13 +911,36 @@ bool DFR1216_I2C::begin()
       }
       delay(10);
     }
+    rewriteShadow();
+    endUpdate();
   }
   return result;
 }
 
+void DFR1216_I2C::__lockBus(void)
+{
+  if (!__i2c_mutex) {
+    return;
+  }
+  // Try first so the uncontended path costs no timing
+  if (xSemaphoreTakeRecursive(__i2c_mutex, 0) == pdTRUE) {
+    recordMutexWait(false, 0);
+    return;
+  }
+  const uint32_t start = micros();
+  xSemaphoreTakeRecursive(__i2c_mutex, portMAX_DELAY);
+  recordMutexWait(true, micros() - start);
+}
+
+void DFR1216_I2C::__unlockBus(void)
+{
+  if (__i2c_mutex) xSemaphoreGiveRecursive(__i2c_mutex);
+}
+
 uint8_t DFR1216_I2C::writeReg(uint8_t reg, uint8_t *data, uint8_t len)
 {
-  if (__i2c_mutex) xSemaphoreTakeRecursive(__i2c_mutex, portMAX_DELAY);
+  __lockBus();
+  const uint32_t start = micros();
   uint8_t result = 0;
   __pWire->beginTransmission(this->__I2C_addr);
   __pWire->write(reg);
@@ -490,25 +948,31 @@ uint8_t DFR1216_I2C::writeReg(uint8_t reg, uint8_t *data, uint8_t len)
     __pWire->write(data[i]);
   }
   result = __pWire->endTransmission();
-  if (__i2c_mutex) xSemaphoreGiveRecursive(__i2c_mutex);
+  recordTransaction(reg, false, result, micros() - start);
+  __unlockBus();
   return result;
 }
 
 int16_t DFR1216_I2C::readReg(uint8_t reg, uint8_t *data, uint8_t len)
 {
-  if (__i2c_mutex) xSemaphoreTakeRecursive(__i2c_mutex, portMAX_DELAY);
+  __lockBus();
+  const uint32_t start = micros();
   uint8_t result = 0;
   uint8_t i = 0;
-  result = writeReg(reg, NULL, 0);
+  __pWire->beginTransmission(this->__I2C_addr);
+  __pWire->write(reg);
+  result = __pWire->endTransmission();
   if(result!= 0){
-    if (__i2c_mutex) xSemaphoreGiveRecursive(__i2c_mutex);
+    recordTransaction(reg, true, result, micros() - start);
+    __unlockBus();
     return -1;
   }
   result = __pWire->requestFrom((uint8_t)this->__I2C_addr,(uint8_t)len);
-  while (__pWire->available()){
+  while (__pWire->available() && i < len){
     data[i++]=__pWire->read();
   }
-  if (__i2c_mutex) xSemaphoreGiveRecursive(__i2c_mutex);
+  recordTransaction(reg, true, i == len ? 0 : 0xff, micros() - start);
+  __unlockBus();
   if(i == len){
     return 0;
   }else{
@@ -0,0 +1,395 @@
+/**
+ * DFR1216SensorScheduler implementation
+ */
+#include "DFR1216/DFR1216Sensors.h"
+#include <string.h>
+
+static inline bool reached(uint32_t now_ms, uint32_t at_ms)
+{
+    return static_cast<int32_t>(now_ms - at_ms) >= 0;
+}
+
+uint32_t DFR1216SensorScheduler::conversionTime(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::DHT11:
+    case Kind::DHT22:
+    case Kind::SR04:
+        return 30;
+    case Kind::DS18B20:
+        return 50;
+    default:
+        return 0;
+    }
+}
+
+uint32_t DFR1216SensorScheduler::defaultPeriod(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::ADC:
+    case Kind::DIN:
+        return 50;
+    case Kind::DHT11:
+    case Kind::DHT22:
+        return 2000; // DHT sensors need >= 1 s between conversions
+    case Kind::DS18B20:
+        return 1000;
+    case Kind::SR04:
+        return 100;
+    default:
+        return 0;
+    }
+}
+
+static const char *const kind_names[] = {"none", "adc", "dht11", "dht22", "ds18b20", "sr04", "din"};
+
+const char *DFR1216SensorScheduler::kindName(Kind kind)
+{
+    const uint8_t index = static_cast<uint8_t>(kind);
+    return index < sizeof(kind_names) / sizeof(kind_names[0]) ? kind_names[index] : kind_names[0];
+}
+
+bool DFR1216SensorScheduler::kindFromName(const char *name, Kind &kind)
+{
+    if (!name)
+        return false;
+    for (uint8_t index = 0; index < sizeof(kind_names) / sizeof(kind_names[0]); ++index)
+    {
+        if (strcasecmp(name, kind_names[index]) == 0)
+        {
+            kind = static_cast<Kind>(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DFR1216SensorScheduler::configure(uint8_t port, Kind kind, uint32_t period_ms)
+{
+    if (port >= PORTS || kind > Kind::DIN)
+        return false;
+    if ((port == SR04_PORT) != (kind == Kind::SR04) && kind != Kind::NONE)
+        return false;
+    if (period_ms == 0)
+        period_ms = defaultPeriod(kind);
+    if (kind != Kind::NONE)
+    {
+        if (period_ms < MIN_PERIOD_MS)
+            period_ms = MIN_PERIOD_MS;
+        else if (period_ms > MAX_PERIOD_MS)
+            period_ms = MAX_PERIOD_MS;
+    }
+    requested_[port].store(static_cast<uint32_t>(kind) << 24 | period_ms, std::memory_order_relaxed);
+    reconfigure_.fetch_or(1UL << port, std::memory_order_release);
+    return true;
+}
+
+DFR1216SensorScheduler::Kind DFR1216SensorScheduler::kind(uint8_t port) const
+{
+    return port < PORTS ? static_cast<Kind>(requested_[port].load(std::memory_order_relaxed) >> 24) : Kind::NONE;
+}
+
+uint32_t DFR1216SensorScheduler::period(uint8_t port) const
+{
+    return port < PORTS ? requested_[port].load(std::memory_order_relaxed) & 0xFFFFFF : 0;
+}
+
+void DFR1216SensorScheduler::applyConfiguration(uint8_t port, uint32_t now_ms)
+{
+    const uint32_t request = requested_[port].load(std::memory_order_relaxed);
+    Port &state = ports_[port];
+    const Kind kind = static_cast<Kind>(request >> 24);
+    const bool kind_changed = kind != state.kind;
+    state.period_ms = request & 0xFFFFFF;
+    if (!kind_changed)
+        return;
+
+    state.kind = kind;
+    state.phase = Phase::IDLE;
+    state.due_ms = now_ms;
+    if (port < IO_PORTS)
+    {
+        eIOType_t mode = eReadGpio; // unassigned ports fall back to a harmless input
+        switch (kind)
+        {
+        case Kind::ADC:
+            mode = eADC;
+            break;
+        case Kind::DHT11:
+            mode = eDHT11;
+            break;
+        case Kind::DHT22:
+            mode = eDHT22;
+            break;
+        case Kind::DS18B20:
+            mode = eDS18B20;
+            break;
+        default:
+            break;
+        }
+        device_.setMode(static_cast<eIONumber_t>(port), mode);
+    }
+    readings_[port].write([kind](Reading &reading)
+                          {
+                              reading = Reading();
+                              reading.kind = kind; });
+}
+
+bool DFR1216SensorScheduler::start(uint8_t port)
+{
+    const eIONumber_t io = static_cast<eIONumber_t>(port);
+    switch (ports_[port].kind)
+    {
+    case Kind::DHT11:
+    case Kind::DHT22:
+        return device_.startDHT(io) == 0;
+    case Kind::DS18B20:
+        return device_.start18b20(io) == 0;
+    case Kind::SR04:
+        return device_.startSr04() == 0;
+    default:
+        return true;
+    }
+}
+
+eSensorPoll_t DFR1216SensorScheduler::poll(uint8_t port, Reading &reading)
+{
+    const eIONumber_t io = static_cast<eIONumber_t>(port);
+    eSensorPoll_t status = eSensorBusError;
+    switch (ports_[port].kind)
+    {
+    case Kind::DHT11:
+    case Kind::DHT22:
+    {
+        sDhtData_t data = {};
+        status = device_.pollDHT(io, &data);
+        reading.value = data.temperature;
+        reading.humidity = data.humidity;
+        break;
+    }
+    case Kind::DS18B20:
+    {
+        float temperature = 0;
+        status = device_.poll18b20(io, &temperature);
+        reading.value = temperature;
+        break;
+    }
+    case Kind::SR04:
+    {
+        int16_t distance = 0;
+        status = device_.pollSr04(&distance);
+        reading.value = distance;
+        break;
+    }
+    default:
+        break;
+    }
+    return status;
+}
+
+void DFR1216SensorScheduler::finish(uint8_t port, uint32_t now_ms, eSensorPoll_t status, const Reading *collected)
+{
+    Port &state = ports_[port];
+    const uint32_t conversion_ms = now_ms - state.started_ms;
+    readings_[port].write([&](Reading &reading)
+                          {
+                              reading.status = status;
+                              if (collected)
+                              {
+                                  reading.value = collected->value;
+                                  reading.humidity = collected->humidity;
+                                  reading.timestamp_ms = now_ms ? now_ms : 1;
+                                  reading.conversion_ms = conversion_ms;
+                                  reading.count++;
+                              }
+                              else
+                              {
+                                  reading.failures++;
+                              } });
+    // Keep the cadence anchored to the start time; skip ahead if we fell behind
+    state.phase = Phase::IDLE;
+    state.due_ms = state.started_ms + state.period_ms;
+    if (reached(now_ms, state.due_ms))
+        state.due_ms = now_ms + POLL_INTERVAL_MS;
+}
+
+void DFR1216SensorScheduler::scan(uint32_t now_ms)
+{
+    ScanFrame frame;
+    frame.timestamp_ms = now_ms;
+    uint8_t adc_wanted = 0;
+    uint8_t din_wanted = 0;
+    for (uint8_t port = 0; port < IO_PORTS; ++port)
+    {
+        if (ports_[port].kind == Kind::ADC)
+            adc_wanted |= 1 << port;
+        else if (ports_[port].kind == Kind::DIN)
+            din_wanted |= 1 << port;
+    }
+
+    uint8_t failed = 0; // ports whose block read failed
+    uint8_t mode_errors = 0;
+    const uint32_t start_us = micros();
+    if (adc_wanted)
+    {
+        frame.transactions++;
+        if (device_.readADCBlock(adc_wanted, frame.adc, &frame.adc_mask, &mode_errors) != 0)
+            failed |= adc_wanted;
+    }
+    if (din_wanted)
+    {
+        frame.transactions++;
+        if (device_.getGpioStates(&frame.din_levels) == 0)
+            frame.din_mask = din_wanted;
+        else
+            failed |= din_wanted;
+    }
+    frame.bus_us = micros() - start_us;
+
+    for (uint8_t port = 0; port < IO_PORTS; ++port)
+    {
+        const uint8_t bit = 1 << port;
+        if (!((adc_wanted | din_wanted) & bit))
+            continue;
+        const bool collected = (frame.adc_mask | frame.din_mask) & bit;
+        // An ADC value not ready yet is not a failure: the previous value stays current
+        if (!collected && !((mode_errors | failed) & bit))
+            continue;
+        readings_[port].write([&](Reading &reading)
+                              {
+                                  if (collected)
+                                  {
+                                      reading.status = eSensorReady;
+                                      reading.value = (frame.adc_mask & bit) ? frame.adc[port] : ((frame.din_levels & bit) ? 1 : 0);
+                                      reading.timestamp_ms = now_ms ? now_ms : 1;
+                                      reading.conversion_ms = 0;
+                                      reading.count++;
+                                  }
+                                  else
+                                  {
+                                      reading.status = (mode_errors & bit) ? eSensorModeError : eSensorBusError;
+                                      reading.failures++;
+                                  } });
+    }
+
+    const uint32_t sequence = scan_head_.load(std::memory_order_relaxed);
+    frame.sequence = sequence;
+    scan_ring_[sequence % SCAN_RING].write([&](ScanFrame &slot)
+                                           { slot = frame; });
+    scan_head_.store(sequence + 1, std::memory_order_release);
+    scan_stats_.write([&](ScanStats &stats)
+                      {
+                          stats.scans++;
+                          if (failed)
+                              stats.errors++;
+                          stats.bus_us_sum += frame.bus_us;
+                          if (frame.bus_us > stats.bus_us_max)
+                              stats.bus_us_max = frame.bus_us; });
+}
+
+uint16_t DFR1216SensorScheduler::readScans(uint32_t from_sequence, ScanFrame *out, uint16_t max_frames, uint32_t *lost) const
+{
+    const uint32_t head = scan_head_.load(std::memory_order_acquire);
+    const uint32_t oldest = head > SCAN_RING ? head - SCAN_RING : 0;
+    uint32_t skipped = 0;
+    if (from_sequence < oldest)
+    {
+        skipped = oldest - from_sequence;
+        from_sequence = oldest;
+    }
+    uint16_t copied = 0;
+    for (uint32_t sequence = from_sequence; sequence < head && copied < max_frames; ++sequence)
+    {
+        const ScanFrame frame = scan_ring_[sequence % SCAN_RING].read();
+        if (frame.sequence != sequence)
+        {
+            skipped++; // overwritten while we were copying
+            continue;
+        }
+        out[copied++] = frame;
+    }
+    if (lost)
+        *lost = skipped;
+    return copied;
+}
+
+uint32_t DFR1216SensorScheduler::step(uint32_t now_ms)
+{
+    uint32_t pending = reconfigure_.exchange(0, std::memory_order_acquire);
+    if (pending)
+    {
+        for (uint8_t port = 0; pending; ++port, pending >>= 1)
+        {
+            if (pending & 1)
+                applyConfiguration(port, now_ms);
+        }
+        uint32_t scan_period = 0;
+        for (uint8_t port = 0; port < IO_PORTS; ++port)
+        {
+            if (isScanned(ports_[port].kind) && (scan_period == 0 || ports_[port].period_ms < scan_period))
+                scan_period = ports_[port].period_ms;
+        }
+        if (scan_period && !scan_period_ms_)
+            scan_due_ms_ = now_ms;
+        scan_period_ms_ = scan_period;
+        scan_stats_.write([scan_period](ScanStats &stats)
+                          { stats.period_ms = scan_period; });
+    }
+
+    uint32_t wait_ms = IDLE_WAKE_MS;
+    if (scan_period_ms_)
+    {
+        if (reached(now_ms, scan_due_ms_))
+        {
+            scan(now_ms);
+            scan_due_ms_ += scan_period_ms_;
+            if (reached(now_ms, scan_due_ms_))
+                scan_due_ms_ = now_ms + scan_period_ms_;
+        }
+        wait_ms = scan_due_ms_ - now_ms;
+    }
+
+    for (uint8_t port = 0; port < PORTS; ++port)
+    {
+        Port &state = ports_[port];
+        if (state.kind == Kind::NONE || isScanned(state.kind))
+            continue;
+
+        if (state.phase == Phase::IDLE && reached(now_ms, state.due_ms))
+        {
+            state.started_ms = now_ms;
+            if (start(port))
+            {
+                state.phase = Phase::CONVERTING;
+                state.due_ms = now_ms + conversionTime(state.kind);
+                state.deadline_ms = state.due_ms + TIMEOUT_MS;
+            }
+            else
+            {
+                finish(port, now_ms, eSensorBusError, nullptr);
+            }
+        }
+
+        if (state.phase == Phase::CONVERTING && reached(now_ms, state.due_ms))
+        {
+            Reading collected;
+            const eSensorPoll_t status = poll(port, collected);
+            if (status == eSensorReady)
+                finish(port, now_ms, status, &collected);
+            else if (status != eSensorPending && status != eSensorBusError)
+                finish(port, now_ms, status, nullptr); // mode error / no device: retrying now won't help
+            else if (reached(now_ms, state.deadline_ms))
+                finish(port, now_ms, status, nullptr);
+            else
+                state.due_ms = now_ms + POLL_INTERVAL_MS;
+        }
+
+        const int32_t until = static_cast<int32_t>(state.due_ms - now_ms);
+        const uint32_t port_wait = until > 0 ? static_cast<uint32_t>(until) : 0;
+        if (port_wait < wait_ms)
+            wait_ms = port_wait;
+    }
+    return wait_ms;
+}
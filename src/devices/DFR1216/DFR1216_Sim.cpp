@@ -0,0 +1,387 @@
+/*!
+ * @file DFR1216_Sim.cpp
+ * @brief Virtual DFR1216 board (see DFR1216_Sim.h)
+ * @copyright MIT License
+ */
+#include "DFR1216/DFR1216_Sim.h"
+
+SemaphoreHandle_t DFR1216_Sim::__busMutex = nullptr;
+portMUX_TYPE DFR1216_Sim::__simLock = portMUX_INITIALIZER_UNLOCKED;
+sSimConfig_t DFR1216_Sim::__config = DFR1216_Sim::defaultConfig();
+uint8_t DFR1216_Sim::__regs[256] = {0};
+uint32_t DFR1216_Sim::__modeSince[6] = {0};
+uint32_t DFR1216_Sim::__dhtStart[6] = {0};
+uint32_t DFR1216_Sim::__ds18b20Start[6] = {0};
+uint32_t DFR1216_Sim::__sr04Start = 0;
+uint8_t DFR1216_Sim::__dhtActive = 0;
+uint8_t DFR1216_Sim::__ds18b20Active = 0;
+bool DFR1216_Sim::__sr04Active = false;
+uint16_t DFR1216_Sim::__analog[6] = {0};
+uint8_t DFR1216_Sim::__inputs = 0;
+int16_t DFR1216_Sim::__dhtHundredths[6][2] = {{0}};
+int16_t DFR1216_Sim::__ds18b20Sixteenths[6] = {0};
+uint8_t DFR1216_Sim::__ds18b20Present = 0x3f;
+int16_t DFR1216_Sim::__sr04Distance = 100;
+uint8_t DFR1216_Sim::__battery = 100;
+uint32_t DFR1216_Sim::__nackPending = 0;
+uint32_t DFR1216_Sim::__random = 1;
+sSimStats_t DFR1216_Sim::__stats = {};
+uint32_t DFR1216_Sim::__statsSince = 0;
+
+#define SIM_SR04_US_PER_UNIT 58 ///> Echo round trip per distance unit (cm)
+
+DFR1216_Sim::DFR1216_Sim(uint8_t addr) : DFR1216(addr)
+{
+  __I2C_addr = addr;
+}
+
+sSimConfig_t DFR1216_Sim::defaultConfig(void)
+{
+  sSimConfig_t config;
+  config.clockHz = 400000;
+  config.overheadUs = 0;
+  config.realtime = true;
+  config.adcConversionUs = 2000;
+  config.dhtConversionUs = 25000;
+  config.ds18b20ConversionUs = 40000;
+  config.sr04BaseUs = 2000;
+  config.nackRatePermille = 0;
+  config.seed = 1;
+  return config;
+}
+
+bool DFR1216_Sim::begin(void)
+{
+  attachShadow();
+  // Each service begins its own instance; the board they share powers up once,
+  // or a later begin() would wipe the registers and counters of the earlier ones
+  if (__busMutex) {
+    return true;
+  }
+  __busMutex = xSemaphoreCreateRecursiveMutex();
+  beginUpdate();
+  brownout();
+  rewriteShadow();
+  endUpdate();
+  resetSimStats();
+  return true;
+}
+
+void DFR1216_Sim::configure(const sSimConfig_t &config)
+{
+  portENTER_CRITICAL(&__simLock);
+  __config = config;
+  if (__config.clockHz == 0) {
+    __config.clockHz = 400000;
+  }
+  __random = config.seed ? config.seed : 1;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+sSimConfig_t DFR1216_Sim::getConfig(void)
+{
+  portENTER_CRITICAL(&__simLock);
+  sSimConfig_t config = __config;
+  portEXIT_CRITICAL(&__simLock);
+  return config;
+}
+
+void DFR1216_Sim::injectNacks(uint32_t count)
+{
+  portENTER_CRITICAL(&__simLock);
+  __nackPending = count;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::brownout(void)
+{
+  const uint32_t now = micros();
+  portENTER_CRITICAL(&__simLock);
+  __powerOnReset(now);
+  portEXIT_CRITICAL(&__simLock);
+}
+
+// Called with __simLock held
+void DFR1216_Sim::__powerOnReset(uint32_t now)
+{
+  memset(__regs, 0, sizeof(__regs));
+  for (uint8_t n = 0; n < 6; n++) {
+    __modeSince[n] = now;
+  }
+  __dhtActive = 0;
+  __ds18b20Active = 0;
+  __sr04Active = false;
+}
+
+void DFR1216_Sim::setAnalog(eIONumber_t number, uint16_t value)
+{
+  portENTER_CRITICAL(&__simLock);
+  __analog[number] = value > 4095 ? 4095 : value;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::setInput(eIONumber_t number, bool level)
+{
+  portENTER_CRITICAL(&__simLock);
+  if (level) {
+    __inputs |= 1 << number;
+  } else {
+    __inputs &= ~(1 << number);
+  }
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::setDht(eIONumber_t number, float temperature, float humidity)
+{
+  portENTER_CRITICAL(&__simLock);
+  __dhtHundredths[number][0] = (int16_t)(temperature * 100);
+  __dhtHundredths[number][1] = (int16_t)(humidity * 100);
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::set18b20(eIONumber_t number, float temperature, bool present)
+{
+  portENTER_CRITICAL(&__simLock);
+  __ds18b20Sixteenths[number] = (int16_t)(temperature * 16);
+  if (present) {
+    __ds18b20Present |= 1 << number;
+  } else {
+    __ds18b20Present &= ~(1 << number);
+  }
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::setSr04Distance(int16_t distance)
+{
+  portENTER_CRITICAL(&__simLock);
+  __sr04Distance = distance;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::setBattery(uint8_t level)
+{
+  portENTER_CRITICAL(&__simLock);
+  __battery = level;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+#define SIM_NACK_CLOCKS (2 + 9) ///> START, NACKed address byte, STOP
+
+static uint32_t clocksToUs(uint32_t clocks, const sSimConfig_t &config)
+{
+  return (uint32_t)(((uint64_t)clocks * 1000000 + config.clockHz - 1) / config.clockHz) + config.overheadUs;
+}
+
+// START + bytes at 9 clocks (8 data + ACK) + STOP; a read adds the pointer write
+uint32_t DFR1216_Sim::wireTimeUs(uint8_t len, bool read)
+{
+  const uint32_t clocks = read ? 4 + (3 + (uint32_t)len) * 9 : 2 + (2 + (uint32_t)len) * 9;
+  return clocksToUs(clocks, getConfig());
+}
+
+sSimStats_t DFR1216_Sim::getSimStats(void)
+{
+  const uint32_t now = micros();
+  portENTER_CRITICAL(&__simLock);
+  sSimStats_t stats = __stats;
+  stats.windowUs = now - __statsSince;
+  portEXIT_CRITICAL(&__simLock);
+  stats.utilisationPermille = stats.windowUs ? (uint16_t)(stats.busyUs * 1000 / stats.windowUs) : 0;
+  return stats;
+}
+
+void DFR1216_Sim::resetSimStats(void)
+{
+  const uint32_t now = micros();
+  portENTER_CRITICAL(&__simLock);
+  memset(&__stats, 0, sizeof(__stats));
+  __statsSince = now;
+  portEXIT_CRITICAL(&__simLock);
+}
+
+void DFR1216_Sim::__lockBus(void)
+{
+  if (!__busMutex) {
+    return;
+  }
+  if (xSemaphoreTakeRecursive(__busMutex, 0) == pdTRUE) {
+    recordMutexWait(false, 0);
+    return;
+  }
+  const uint32_t start = micros();
+  xSemaphoreTakeRecursive(__busMutex, portMAX_DELAY);
+  recordMutexWait(true, micros() - start);
+}
+
+void DFR1216_Sim::__unlockBus(void)
+{
+  if (__busMutex) xSemaphoreGiveRecursive(__busMutex);
+}
+
+// Called with __simLock held
+bool DFR1216_Sim::__nackNext(void)
+{
+  if (__nackPending) {
+    __nackPending--;
+    return true;
+  }
+  if (__config.nackRatePermille == 0) {
+    return false;
+  }
+  __random = __random * 1664525UL + 1013904223UL;
+  return ((__random >> 16) % 1000) < __config.nackRatePermille;
+}
+
+// Called with __simLock held: side effects of a write on the coprocessor
+void DFR1216_Sim::__applyWrite(uint8_t reg, const uint8_t *data, uint8_t len, uint32_t now)
+{
+  for (uint8_t i = 0; i < len; i++) {
+    const uint8_t r = reg + i;
+    __regs[r] = data[i];
+    if (r >= I2C_IO_MODE_C0 && r < I2C_IO_MODE_C0 + 6) {
+      __modeSince[r - I2C_IO_MODE_C0] = now;
+    } else if (r == I2C_SR04_STATE && data[i] == SR04_COLLECT) {
+      __sr04Start = now;
+      __sr04Active = true;
+    } else if (r >= I2C_DHT_C0_S && r < I2C_18B20_C0_S && (r - I2C_DHT_C0_S) % 5 == 0 && data[i] == DATA_ENABLE) {
+      const uint8_t n = (r - I2C_DHT_C0_S) / 5;
+      if (n < 6) {
+        __dhtStart[n] = now;
+        __dhtActive |= 1 << n;
+      }
+    } else if (r >= I2C_18B20_C0_S && r < I2C_BATTERY && (r - I2C_18B20_C0_S) % 3 == 0 && data[i] == DATA_ENABLE) {
+      const uint8_t n = (r - I2C_18B20_C0_S) / 3;
+      __ds18b20Start[n] = now;
+      __ds18b20Active |= 1 << n;
+    } else if (r == I2C_RESET_SENSOR && data[i] == DATA_ENABLE) {
+      __powerOnReset(now);
+      return;
+    }
+  }
+}
+
+// Called with __simLock held: bring the sensor registers up to date before a read
+void DFR1216_Sim::__refreshSensors(uint32_t now)
+{
+  for (uint8_t n = 0; n < 6; n++) {
+    const uint8_t mode = __regs[I2C_IO_MODE_C0 + n];
+
+    uint8_t *adc = &__regs[I2C_ADC_C0_S + n * 3];
+    if (mode != eADC) {
+      adc[0] = MODE_ERROR;
+    } else if (now - __modeSince[n] >= __config.adcConversionUs) {
+      adc[0] = DATA_ENABLE;
+      adc[1] = __analog[n] >> 8;
+      adc[2] = __analog[n] & 0xFF;
+    } else {
+      adc[0] = DATA_DISABLE;
+    }
+
+    if (mode == eReadGpio) {
+      __regs[I2C_R_C0 + n] = (__inputs & (1 << n)) ? eHIGH : eLOW;
+    }
+
+    uint8_t *dht = &__regs[I2C_DHT_C0_S + n * 5];
+    if (mode != eDHT11 && mode != eDHT22) {
+      dht[0] = MODE_ERROR;
+    } else if ((__dhtActive & (1 << n)) && now - __dhtStart[n] >= __config.dhtConversionUs) {
+      const int16_t t = __dhtHundredths[n][0];
+      const uint16_t magnitude = t < 0 ? -t : t;
+      dht[0] = DATA_ENABLE;
+      dht[1] = (uint8_t)((magnitude / 100) & 0x7F) | (t < 0 ? 0x80 : 0);
+      dht[2] = magnitude % 100;
+      dht[3] = __dhtHundredths[n][1] / 100;
+      dht[4] = __dhtHundredths[n][1] % 100;
+    } else {
+      dht[0] = DATA_DISABLE;
+    }
+
+    uint8_t *ds = &__regs[I2C_18B20_C0_S + n * 3];
+    if (mode != eDS18B20) {
+      ds[0] = MODE_ERROR;
+    } else if ((__ds18b20Active & (1 << n)) && now - __ds18b20Start[n] >= __config.ds18b20ConversionUs) {
+      const int16_t raw = __ds18b20Sixteenths[n];
+      const uint16_t magnitude = raw < 0 ? -raw : raw;
+      ds[0] = DATA_ENABLE;
+      if (__ds18b20Present & (1 << n)) {
+        ds[1] = (uint8_t)((magnitude >> 8) & 0x7F) | (raw < 0 ? 0x80 : 0);
+        ds[2] = magnitude & 0xFF;
+      } else {
+        ds[1] = 0xff;
+        ds[2] = 0xff;
+      }
+    } else {
+      ds[0] = DATA_DISABLE;
+    }
+  }
+
+  uint8_t *sr04 = &__regs[I2C_SR04_STATE];
+  const uint32_t echoUs = __sr04Distance > 0 ? (uint32_t)__sr04Distance * SIM_SR04_US_PER_UNIT : 0;
+  if (__sr04Active && now - __sr04Start >= __config.sr04BaseUs + echoUs) {
+    sr04[0] = SR04_COMPLETE;
+    sr04[1] = (uint16_t)__sr04Distance >> 8;
+    sr04[2] = (uint16_t)__sr04Distance & 0xFF;
+  }
+  __regs[I2C_BATTERY] = __battery;
+}
+
+// Occupy the bus for the modelled time and account the transaction (bus mutex held)
+void DFR1216_Sim::__holdBus(uint32_t busUs, uint32_t wireBytes, bool read, bool nacked)
+{
+  portENTER_CRITICAL(&__simLock);
+  const bool realtime = __config.realtime;
+  __stats.transactions++;
+  if (read) {
+    __stats.reads++;
+  } else {
+    __stats.writes++;
+  }
+  __stats.wireBytes += wireBytes;
+  __stats.busyUs += busUs;
+  if (nacked) {
+    __stats.nacksInjected++;
+  }
+  portEXIT_CRITICAL(&__simLock);
+  if (realtime) {
+    delayMicroseconds(busUs);
+  }
+}
+
+uint8_t DFR1216_Sim::writeReg(uint8_t reg, uint8_t *data, uint8_t len)
+{
+  __lockBus();
+  const uint32_t now = micros();
+  portENTER_CRITICAL(&__simLock);
+  const bool nacked = __nackNext();
+  if (!nacked) {
+    __applyWrite(reg, data, len, now);
+  }
+  portEXIT_CRITICAL(&__simLock);
+  // An address NACK ends the transaction after the first byte; nothing reaches the registers
+  const uint32_t busUs = nacked ? clocksToUs(SIM_NACK_CLOCKS, getConfig()) : wireTimeUs(len, false);
+  __holdBus(busUs, nacked ? 1 : 2 + len, false, nacked);
+  const uint8_t result = nacked ? 2 : 0;
+  recordTransaction(reg, false, result, busUs);
+  __unlockBus();
+  return result;
+}
+
+int16_t DFR1216_Sim::readReg(uint8_t reg, uint8_t *data, uint8_t len)
+{
+  __lockBus();
+  const uint32_t now = micros();
+  portENTER_CRITICAL(&__simLock);
+  const bool nacked = __nackNext();
+  if (!nacked) {
+    __refreshSensors(now);
+    for (uint8_t i = 0; i < len; i++) {
+      data[i] = __regs[(uint8_t)(reg + i)];
+    }
+  }
+  portEXIT_CRITICAL(&__simLock);
+  const uint32_t busUs = nacked ? clocksToUs(SIM_NACK_CLOCKS, getConfig()) : wireTimeUs(len, true);
+  __holdBus(busUs, nacked ? 1 : 3 + len, true, nacked);
+  recordTransaction(reg, true, nacked ? 2 : 0, busUs);
+  __unlockBus();
+  return nacked ? -1 : 0;
+}
@@ -61,7 +61,7 @@ namespace MainConsts
 namespace
 {
   constexpr uint16_t web_port = 80;
-  constexpr TickType_t udp_task_delay_ticks = pdMS_TO_TICKS(10);
+  constexpr TickType_t udp_task_delay_ticks = pdMS_TO_TICKS(1000);
   constexpr TickType_t display_task_delay_ticks = pdMS_TO_TICKS(500);
   constexpr TickType_t display_update_interval_ticks = pdMS_TO_TICKS(500);
   constexpr TickType_t web_server_task_delay_ticks = pdMS_TO_TICKS(10);
@@ -116,23 +116,16 @@ AmakerBotService amakerbot_service = AmakerBotService();
  */
 void xtask_UDP_SVR(void *pvParameters)
 {
-  // Counter for periodic WebSocket cleanup (every ~1 second)
-  uint8_t cleanup_counter = 0;
-  constexpr uint8_t cleanup_interval = 100; // 100 * 10ms = 1 second
-  
+  // The heartbeat watchdog runs on its own esp_timer (AmakerBotService): this task
+  // only does housekeeping, once per second
   for (;;)
   {
-    // Check for heartbeat timeout every tick (~10 ms)
-    amakerbot_service.checkHeartbeatTimeout();
-    
     // Periodically cleanup stale WebSocket clients to free TCP resources
     // This prevents resource exhaustion when browsers have multiple tabs open
-    if (++cleanup_counter >= cleanup_interval)
-    {
-      cleanup_counter = 0;
-      http_service.cleanupWebSockets();
-    }
-    
+    http_service.cleanupWebSockets();
+    // Have the commit task repair actuator registers reset by a brownout
+    servo_service.verifyActuatorRegisters();
+
     vTaskDelay(udp_task_delay_ticks);
   }
 }
@@ -340,7 +333,8 @@ void setup()
         &board_info,
         &music_service,
         &dfr1216_service,
-        &amakerbot_service
+        &amakerbot_service,
+        &webcam_service
     };
     for (IsServiceInterface *svc : udp_aware_services)
     {
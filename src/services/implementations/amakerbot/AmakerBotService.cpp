@@ -11,13 +11,32 @@
  *          - POST /api/amakerbot/v1/display/next            Cycle to next display mode (same as button A)
  *          - GET  /api/amakerbot/v1/name                    Get current bot name
  *          - POST /api/amakerbot/v1/name?name=<name>        Set bot name (max 32 chars)
+ *          - GET  /api/amakerbot/v1/heartbeat               Heartbeat watchdog state and expiry-to-stop latency
+ *          - GET  /api/amakerbot/v1/roles                   Granted peer roles, role defaults and denial counts
+ *          - GET  /api/amakerbot/v1/link                    Link statistics of the master session, derating config
+ *          - POST /api/amakerbot/v1/link?derate=<0|1>&...   Configure near-timeouts and speed derating (master only)
  *
  *          UDP protocol (service_id 0x4):
  *          - [0x41]<token>  Register UDP sender as master (if token valid);
  *          - [0x42]         Clear master (master IP only);
- *          - [0x43]         Heartbeat keep-alive — must arrive every ≤50 ms or all motors are stopped
+ *          - [0x43][seq:2B optional]  Heartbeat keep-alive — must arrive every ≤50 ms or all motors are stopped
+ *          - [0x44][id:4B][rtt_us:4B optional]  Ping (master only) — echoed as [0x44][id]
  *          - [0x45]         Get bot name — server replies with [0x45][name bytes];
  *          - [0x46]<name>   Set bot name (master only) — server replies with [0x46][status];
+ *          - [0x47][ip:4B][role][mask:32B optional]  Grant a role to a peer (master only) — [echo][status]
+ *          - [0x48]         Link statistics (master or granted peer) — [0x48][version][fields]
+ *
+ *          The heartbeat watchdog is a one-shot esp_timer re-armed by every accepted
+ *          heartbeat; when the deadline passes its callback wakes ServoService's stop
+ *          task (highest priority), so the stop lands within timer dispatch plus task
+ *          wake-up latency of the 50 ms, the esp_timer task never waits for the bus,
+ *          and nothing polls while no master is registered.
+ *
+ *          Link quality: heartbeats (optional 16-bit counter), pings (optional RTT
+ *          measured by the master) and timeouts feed a per-session LinkQuality:
+ *          inter-arrival histogram, jitter, loss, longest gap, near-timeouts, RTT
+ *          and a 0-1000 quality score. With derating enabled, the wheel speed is
+ *          scaled down through ServoService::setSpeedScale() while it is low.
  *
  *          On service init, a random 5-character alphanumeric token is generated
  *          and logged to app_info_logger so it appears in MODE_APP_LOG on the screen.
@@ -25,12 +44,14 @@
 
 #include "services/AmakerBotService.h"
 #include "services/ServoService.h"
+#include "services/SettingsService.h"
 #include "services/UDPService.h"
 #include "FlashStringHelper.h"
 #include "utb2026.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
+#include <esp_timer.h>
 #include <freertos/semphr.h>
 #include <random>
 
@@ -53,6 +74,8 @@ namespace AmakerBotConsts
     constexpr const char field_ip[] PROGMEM = "ip";
     constexpr const char field_token[] PROGMEM = "token";
     constexpr const char field_registered[] PROGMEM = "registered";
+    constexpr const char field_port[] PROGMEM = "port";
+    constexpr const char field_session[] PROGMEM = "session";
 
     // HTTP parameter names
     constexpr const char param_token[] PROGMEM = "token";
@@ -64,6 +87,7 @@ namespace AmakerBotConsts
 
     // Service-internal log messages (debug_logger)
     constexpr const char msg_mutex_failed[] PROGMEM = "AmakerBot: mutex creation failed";
+    constexpr const char msg_timer_failed[] PROGMEM = "AmakerBot: heartbeat timer creation failed";
 
     // HTTP response descriptions
     constexpr const char resp_registered[] PROGMEM = "Master registered successfully";
@@ -80,10 +104,15 @@ namespace AmakerBotConsts
     constexpr const char resp_unauthorized[] PROGMEM = "Not authorized: you are not the master";
 
     // Heartbeat watchdog
-    constexpr uint32_t heartbeat_timeout_ms = 50; ///< ms without heartbeat before all motors are stopped
+    constexpr uint32_t heartbeat_timeout_us = 50000; ///< us without heartbeat before all motors are stopped
+    constexpr const char heartbeat_timer_name[] = "abHeartbeat";
     constexpr const char msg_heartbeat_timeout[] PROGMEM = "[AMAKERBOT] Heartbeat timeout - stopping motors";
     constexpr const char msg_heartbeat_restored[] PROGMEM = "[AMAKERBOT] Heartbeat restored";
 
+    // Link quality
+    constexpr const char settings_key_link[] PROGMEM = "link";
+    constexpr uint8_t link_stats_version = 1; ///< Layout version of the 0x48 reply
+
     // UDP command prefixes
     constexpr uint8_t udp_service_id = 0x04;                                       ///< Unique ID for DFR1216 Service (high nibble of action byte)
     constexpr uint8_t udp_action_master_register = (udp_service_id << 4) | 0x01;   ///< 0x41 - followed by token string, registers sender IP as master if token valid; server responds with udp_action_master_register + 0x00 on success or + 0x01 on failure (invalid token) — e.g. [0x41][0x00] for success, [0x41][0x01] for invalid token
@@ -92,6 +121,24 @@ namespace AmakerBotConsts
     constexpr uint8_t udp_action_ping = (udp_service_id << 4) | 0x04;              ///< 0x44 - (no params), used to detect connection loss to master :  must send at least one heartbeat every ~30ms or all motors are stopped
     constexpr uint8_t udp_action_get_name = (udp_service_id << 4) | 0x05;          ///< 0x45 - (no params), server replies with [0x45][name bytes]
     constexpr uint8_t udp_action_set_name = (udp_service_id << 4) | 0x06;          ///< 0x46 - followed by name string (max 32 chars, master only); server replies with [0x46][status]
+    constexpr uint8_t udp_action_grant_role = (udp_service_id << 4) | 0x07;        ///< 0x47 - [ip:4B][role:1B][mask:32B optional] (master only); server replies with [echo][status]
+    constexpr uint8_t udp_action_link_stats = (udp_service_id << 4) | 0x08;        ///< 0x48 - (no params, master or granted peer); server replies with [0x48][version][fields]
+
+    // Default allowed actions of granted roles: ServoService (0x5x) and DFR1216Service (0x3x) action bytes
+    constexpr uint8_t acl_observer_actions[] = {
+        0x57, 0x58, 0x59, 0x5B, 0x5F, // servo status, all status, battery, motion status, obstacle
+        0x34, 0x35, 0x36, 0x37,       // LED status, bus stats, sensors, sensor scans
+        0x48,                         // link statistics
+        0x61, 0x63, 0x64,             // frame transport subscribe, unsubscribe, statistics
+    };
+    constexpr uint8_t acl_student_actions[] = {
+        0x57, 0x58, 0x59, 0x5B, 0x5F, // observer telemetry
+        0x34, 0x35, 0x36, 0x37,
+        0x48,
+        0x61, 0x63, 0x64,
+        0x53, 0x56, 0x5D,             // stop servos, stop motors, stop timeline
+        0x31, 0x32, 0x33,             // LED colour, LED off, all LEDs off
+    };
 
     // OpenAPI route metadata
     constexpr const char desc_register[] PROGMEM = "Register the calling client (identified by its IP address) as the master controller. Must provide the server-generated token shown in MODE_APP_LOG.";
@@ -127,6 +174,63 @@ namespace AmakerBotConsts
     constexpr const char resp_name_set[] PROGMEM = "Bot name updated";
     constexpr const char resp_missing_name[] PROGMEM = "Missing or empty name parameter";
     constexpr const char msg_name_changed[] PROGMEM = "[AMAKERBOT] Bot name set to: ";
+
+    // Peer roles route
+    constexpr const char path_roles[] PROGMEM = "roles";
+    constexpr const char desc_roles[] PROGMEM = "Peer roles granted by the master (UDP 0x47): per-peer allowed-action bitmap, role defaults and denial counts per role.";
+    constexpr const char resp_roles_ok[] PROGMEM = "Peer roles";
+    constexpr const char field_roles[] PROGMEM = "roles";
+    constexpr const char field_peers[] PROGMEM = "peers";
+    constexpr const char field_role[] PROGMEM = "role";
+    constexpr const char field_mask[] PROGMEM = "mask";
+    constexpr const char field_denials[] PROGMEM = "denials";
+    constexpr const char msg_role_granted[] PROGMEM = "[MASTER] role granted: ";
+
+    // Heartbeat watchdog route
+    constexpr const char path_heartbeat[] PROGMEM = "heartbeat";
+    constexpr const char desc_heartbeat[] PROGMEM = "Heartbeat watchdog state: timeout, counters and the deadline-to-stop latency distribution of heartbeat timeouts.";
+    constexpr const char resp_heartbeat_ok[] PROGMEM = "Heartbeat watchdog statistics";
+    constexpr const char field_timeout_us[] PROGMEM = "timeout_us";
+    constexpr const char field_armed[] PROGMEM = "armed";
+    constexpr const char field_timed_out[] PROGMEM = "timed_out";
+    constexpr const char field_heartbeats[] PROGMEM = "heartbeats";
+    constexpr const char field_expiries[] PROGMEM = "expiries";
+    constexpr const char field_stale_expiries[] PROGMEM = "stale_expiries";
+    constexpr const char field_restores[] PROGMEM = "restores";
+    constexpr const char field_failed_stops[] PROGMEM = "failed_stops";
+    constexpr const char field_timer_late_max_us[] PROGMEM = "timer_late_max_us";
+    constexpr const char field_stop_latency[] PROGMEM = "stop_latency";
+    constexpr const char field_min_us[] PROGMEM = "min_us";
+    constexpr const char field_max_us[] PROGMEM = "max_us";
+    constexpr const char field_avg_us[] PROGMEM = "avg_us";
+    constexpr const char field_last_us[] PROGMEM = "last_us";
+    constexpr const char field_hist_log2_us[] PROGMEM = "hist_log2_us";
+
+    // Link quality route
+    constexpr const char path_link[] PROGMEM = "link";
+    constexpr const char desc_link_get[] PROGMEM = "Link statistics of the current master session: heartbeat inter-arrival histogram, jitter, loss, longest gap, near-timeouts, ping RTT reported by the master, quality score and derating.";
+    constexpr const char desc_link_set[] PROGMEM = "Configure the near-timeout threshold and the automatic wheel speed derating on low link quality (master only). Omitted parameters keep their value.";
+    constexpr const char resp_link_ok[] PROGMEM = "Link statistics";
+    constexpr const char resp_link_set[] PROGMEM = "Link configuration updated";
+    constexpr const char param_derate[] PROGMEM = "derate";
+    constexpr const char param_near_timeout_pct[] PROGMEM = "near_timeout_pct";
+    constexpr const char param_derate_below[] PROGMEM = "derate_below";
+    constexpr const char param_min_scale[] PROGMEM = "min_scale";
+    constexpr const char field_config[] PROGMEM = "config";
+    constexpr const char field_quality[] PROGMEM = "quality";
+    constexpr const char field_speed_scale[] PROGMEM = "speed_scale";
+    constexpr const char field_lost[] PROGMEM = "lost";
+    constexpr const char field_loss_permille[] PROGMEM = "loss_permille";
+    constexpr const char field_duplicates[] PROGMEM = "duplicates";
+    constexpr const char field_reordered[] PROGMEM = "reordered";
+    constexpr const char field_near_timeouts[] PROGMEM = "near_timeouts";
+    constexpr const char field_timeouts[] PROGMEM = "timeouts";
+    constexpr const char field_gap[] PROGMEM = "gap";
+    constexpr const char field_jitter_us[] PROGMEM = "jitter_us";
+    constexpr const char field_hist_width_us[] PROGMEM = "hist_width_us";
+    constexpr const char field_hist[] PROGMEM = "hist";
+    constexpr const char field_rtt[] PROGMEM = "rtt";
+    constexpr const char field_reports[] PROGMEM = "reports";
 }
 
 // ---------------------------------------------------------------------------
@@ -153,43 +257,51 @@ std::string AmakerBotService::generateRandomToken()
 
 /**
  * @brief Register a client as master (thread-safe).
- * @details Cancels with a warning if ip is empty or ip is already the master.
+ * @details Cancels with a warning if ip is unset or ip is already the master.
  *          Rejects with an error if a different master is already registered.
+ *          The identity is published with a single compare-and-swap from "no master",
+ *          so two concurrent registrations cannot both win.
  *          Token validation is the caller's responsibility.
- * @param ip IP address of the new master
+ * @param ip   IP address of the new master
+ * @param port UDP source port of the registration, 0 for HTTP
  */
-bool AmakerBotService::registerMaster(const std::string &ip)
+bool AmakerBotService::registerMaster(const IPAddress &ip, uint16_t port)
 {
-    if (ip.empty() || ip == getMasterIP())
+    const uint32_t ipv4 = static_cast<uint32_t>(ip);
+    uint64_t current = master_identity_.load(std::memory_order_acquire);
+    if (ipv4 == 0 || (current != 0 && identityIPv4(current) == ipv4))
     {
         app_info_logger.warning(progmem_to_string(AmakerBotConsts::resp_ignore_registration));
         return false;
     }
 
-    if (!getMasterIP().empty())
+    // Session token: never 0, so a registered identity is never 0 either
+    uint16_t session = 0;
+    while (session == 0)
+        session = static_cast<uint16_t>(esp_random());
+    if (current != 0 ||
+        !master_identity_.compare_exchange_strong(current, packIdentity(ipv4, port, session),
+                                                  std::memory_order_acq_rel))
     {
         app_info_logger.error(progmem_to_string(AmakerBotConsts::resp_already_have_master));
         return false; // a different master is already registered
     }
 
-    if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(100)))
-    {
-        master_ip_ = ip;
-        xSemaphoreGive(master_mutex_);
-    }
-
-    // Reset heartbeat watchdog for the new master session
-    last_heartbeat_ms_ = 0;
-    heartbeat_active_ = false;
-    heartbeat_timed_out_ = false;
+    // Reset heartbeat watchdog, link statistics and peer grants for the new master session
+    resetHeartbeat();
+    resetLink();
+    portENTER_CRITICAL(&acl_lock_);
+    acl_.clear();
+    portEXIT_CRITICAL(&acl_lock_);
 
     // Log to app_info_logger — visible in MODE_APP_LOG on the screen
     app_info_logger.info(
-        progmem_to_string(AmakerBotConsts::msg_registered) + ip);
+        progmem_to_string(AmakerBotConsts::msg_registered) + ip.toString().c_str());
 
 #ifdef VERBOSE_DEBUG
     if (logger)
-        logger->debug(std::string("AmakerBot: master set ip=") + ip);
+        logger->debug(std::string("AmakerBot: master set ip=") + ip.toString().c_str() +
+                      " session=" + std::to_string(session));
 #endif
     return true;
 }
@@ -197,24 +309,24 @@ bool AmakerBotService::registerMaster(const std::string &ip)
 /**
  * @brief Clear master registration (thread-safe) and log to app_info_logger.
  */
-bool AmakerBotService::unregisterMaster(const std::string &ip)
+bool AmakerBotService::unregisterMaster(const IPAddress &ip)
 {
-    if (ip.empty() || ip != getMasterIP())
+    uint64_t current = master_identity_.load(std::memory_order_acquire);
+    if (current == 0 || identityIPv4(current) != static_cast<uint32_t>(ip) ||
+        !master_identity_.compare_exchange_strong(current, 0, std::memory_order_acq_rel))
     {
         app_info_logger.warning(progmem_to_string(AmakerBotConsts::resp_ignore_unregistration));
         return false;
     }
-    std::string prev_ip;
-    if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(100)))
-    {
-        prev_ip = master_ip_;
-        master_ip_ = "";
-        xSemaphoreGive(master_mutex_);
-    }
+    resetHeartbeat();
+    resetLink();
+    portENTER_CRITICAL(&acl_lock_);
+    acl_.clear();
+    portEXIT_CRITICAL(&acl_lock_);
 
 #ifdef VERBOSE_DEBUG
     if (logger)
-        logger->debug(std::string("AmakerBot: master cleared (was ") + prev_ip + ")");
+        logger->debug(std::string("AmakerBot: master cleared (was ") + ip.toString().c_str() + ")");
 #endif
 
     app_info_logger.info(progmem_to_string(AmakerBotConsts::msg_unregistered));
@@ -241,6 +353,31 @@ bool AmakerBotService::initializeService()
     // Set default bot name
     bot_name_ = progmem_to_string(AmakerBotConsts::default_bot_name);
 
+    // Default bitmaps of the grantable roles
+    ActionMask all_actions;
+    all_actions.setAll();
+    acl_.setRoleMask(PeerRole::MASTER, all_actions);
+    acl_.setRoleMask(PeerRole::OBSERVER, ActionMask::of(AmakerBotConsts::acl_observer_actions,
+                                                        sizeof(AmakerBotConsts::acl_observer_actions)));
+    acl_.setRoleMask(PeerRole::STUDENT, ActionMask::of(AmakerBotConsts::acl_student_actions,
+                                                       sizeof(AmakerBotConsts::acl_student_actions)));
+
+    // Heartbeat watchdog timer, armed by the first heartbeat of a master
+    heartbeat_ = HeartbeatWatchdog(AmakerBotConsts::heartbeat_timeout_us);
+    link_ = LinkQuality(AmakerBotConsts::heartbeat_timeout_us);
+    loadSettings();
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = &AmakerBotService::heartbeatTimerCallback;
+    timer_args.arg = this;
+    timer_args.name = AmakerBotConsts::heartbeat_timer_name;
+    if (esp_timer_create(&timer_args, &heartbeat_timer_) != ESP_OK)
+    {
+        heartbeat_timer_ = nullptr;
+        if (logger)
+            logger->error(progmem_to_string(AmakerBotConsts::msg_timer_failed));
+        return false;
+    }
+
     // Log the token to app_info_logger so it's visible in MODE_APP_LOG
     app_info_logger.info(
         progmem_to_string(AmakerBotConsts::msg_token_generated) + server_token_);
@@ -256,12 +393,18 @@ bool AmakerBotService::initializeService()
 
 bool AmakerBotService::stopService()
 {
+    if (heartbeat_timer_)
+    {
+        esp_timer_stop(heartbeat_timer_);
+        esp_timer_delete(heartbeat_timer_);
+        heartbeat_timer_ = nullptr;
+    }
     if (master_mutex_)
     {
         vSemaphoreDelete(master_mutex_);
         master_mutex_ = nullptr;
     }
-    master_ip_.clear();
+    master_identity_.store(0, std::memory_order_release);
     setServiceStatus(STOPPED);
     return true;
 }
@@ -282,24 +425,47 @@ std::string AmakerBotService::getServiceSubPath()
 
 bool AmakerBotService::isMaster(const std::string &ip) const
 {
-    if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(10)))
-    {
-        bool result = !master_ip_.empty() && master_ip_ == ip;
-        xSemaphoreGive(master_mutex_);
-        return result;
-    }
-    return false;
+    IPAddress address;
+    return address.fromString(ip.c_str()) && isMasterAddress(address);
+}
+
+bool AmakerBotService::isMasterAddress(const IPAddress &ip) const
+{
+    const uint64_t identity = master_identity_.load(std::memory_order_acquire);
+    return identity != 0 && identityIPv4(identity) == static_cast<uint32_t>(ip);
+}
+
+bool AmakerBotService::isActionAllowed(uint8_t action, const IPAddress &ip) const
+{
+    const bool master = isMasterAddress(ip);
+    if (master)
+        return true;
+    portENTER_CRITICAL(&acl_lock_);
+    const bool allowed = acl_.allowed(static_cast<uint32_t>(ip), false, action);
+    portEXIT_CRITICAL(&acl_lock_);
+    return allowed;
+}
+
+bool AmakerBotService::grantRole(const IPAddress &ip, PeerRole role, const ActionMask *mask)
+{
+    // The master always has every action: it cannot hold a role as well
+    if (isMasterAddress(ip))
+        return false;
+    portENTER_CRITICAL(&acl_lock_);
+    const bool ok = acl_.grant(static_cast<uint32_t>(ip), role, mask);
+    portEXIT_CRITICAL(&acl_lock_);
+    if (ok)
+        app_info_logger.info(progmem_to_string(AmakerBotConsts::msg_role_granted) +
+                             ip.toString().c_str() + " " + ActionAcl::roleName(role));
+    return ok;
 }
 
 std::string AmakerBotService::getMasterIP() const
 {
-    if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(10)))
-    {
-        std::string ip = master_ip_;
-        xSemaphoreGive(master_mutex_);
-        return ip;
-    }
-    return "";
+    const uint64_t identity = master_identity_.load(std::memory_order_acquire);
+    if (identity == 0)
+        return "";
+    return IPAddress(identityIPv4(identity)).toString().c_str();
 }
 
 std::string AmakerBotService::getServerToken() const
@@ -336,9 +502,10 @@ void AmakerBotService::setBotName(const std::string &name)
 
 bool AmakerBotService::setMasterIfTokenValid(const std::string &ip, const std::string &token)
 {
-    if (token != getServerToken())
-        return false; // Token mismatch
-    registerMaster(ip);
+    IPAddress address;
+    if (token != getServerToken() || !address.fromString(ip.c_str()))
+        return false; // Token mismatch or malformed address
+    registerMaster(address, 0);
     return true;
 }
 
@@ -385,19 +552,19 @@ bool AmakerBotService::messageHandler(const std::string &message,
             return true;
         }
 
-        bool ok = registerMaster(remoteIP.toString().c_str());
+        bool ok = registerMaster(remoteIP, remotePort);
         udp_reply(message, ok ? UDPResponseStatus::SUCCESS : UDPResponseStatus::IGNORED, remoteIP, remotePort);
         return true;
     }
 
     if (message[0] == AmakerBotConsts::udp_action_master_unregister)
     {
-        if (!isMaster(remoteIP.toString().c_str()))
+        if (!isMasterAddress(remoteIP))
         {
             udp_reply(message, UDPResponseStatus::DENIED, remoteIP, remotePort); // not the master
             return true;                                                         // not the master — let other handlers try
         }
-        bool ok = unregisterMaster(remoteIP.toString().c_str());
+        bool ok = unregisterMaster(remoteIP);
         udp_reply(message, ok ? UDPResponseStatus::SUCCESS : UDPResponseStatus::ERROR, remoteIP, remotePort);
         return true;
     }
@@ -405,22 +572,44 @@ bool AmakerBotService::messageHandler(const std::string &message,
     if (message[0] == AmakerBotConsts::udp_action_heartbeat)
     {
         // Only accept heartbeats from the registered master
-        if (!isMaster(remoteIP.toString().c_str()))
+        if (!isMasterAddress(remoteIP))
         {
             udp_reply(message, UDPResponseStatus::DENIED, remoteIP, remotePort); // not the master
             return true;                                                         // not the master — let other handlers try
         }
 
-        last_heartbeat_ms_ = millis();
-        heartbeat_active_ = true;
-        heartbeat_timed_out_ = false; // restore flag so timeout can fire again
+        // Move the deadline and re-arm the one-shot timer (stop + start: esp_timer_restart
+        // is not available on every IDF the Arduino core ships with)
+        const int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&heartbeat_lock_);
+        const bool restored = heartbeat_.feed(now_us);
+        portEXIT_CRITICAL(&heartbeat_lock_);
+        if (heartbeat_timer_)
+        {
+            esp_timer_stop(heartbeat_timer_);
+            esp_timer_start_once(heartbeat_timer_, heartbeat_.timeout());
+        }
+
+        // [0x43][seq:2B LE optional]: the counter lets the link statistics estimate loss
+        const uint8_t *d = reinterpret_cast<const uint8_t *>(message.data());
+        const bool has_seq = message.size() >= 3;
+        portENTER_CRITICAL(&link_lock_);
+        link_.onHeartbeat(now_us, has_seq, has_seq ? static_cast<uint16_t>(d[1] | (d[2] << 8)) : 0);
+        const uint16_t scale = link_.speedScale();
+        portEXIT_CRITICAL(&link_lock_);
+        servo_service.setSpeedScale(scale);
 
+        if (restored)
+        {
+            ui.set_info(ui.KEY_UDP_STATE, "up");
+            app_info_logger.info(progmem_to_string(AmakerBotConsts::msg_heartbeat_restored));
+        }
         return true;
     }
     if (message[0] == AmakerBotConsts::udp_action_ping)
     {
         // Only accept heartbeats from the registered master
-        if (!isMaster(remoteIP.toString().c_str()))
+        if (!isMasterAddress(remoteIP))
             return false; // not our message
 
         // Echo the ping payload back: [action:1B][id:4B]
@@ -428,6 +617,19 @@ bool AmakerBotService::messageHandler(const std::string &message,
         if (message.size() >= 5)
             udp_service.sendReply(message.substr(0, 5), remoteIP, remotePort);
 
+        // [0x44][id:4B][rtt_us:4B LE optional]: RTT of the previous ping, measured by the master
+        if (message.size() >= 9)
+        {
+            const uint8_t *d = reinterpret_cast<const uint8_t *>(message.data());
+            const uint32_t rtt_us = d[5] | (d[6] << 8) | (d[7] << 16) | (static_cast<uint32_t>(d[8]) << 24);
+            if (rtt_us)
+            {
+                portENTER_CRITICAL(&link_lock_);
+                link_.onPing(rtt_us);
+                portEXIT_CRITICAL(&link_lock_);
+            }
+        }
+
         return true;
     }
 
@@ -444,7 +646,7 @@ bool AmakerBotService::messageHandler(const std::string &message,
     if (message[0] == AmakerBotConsts::udp_action_set_name)
     {
         // Only the registered master may rename the bot
-        if (!isMaster(remoteIP.toString().c_str()))
+        if (!isMasterAddress(remoteIP))
         {
             udp_reply(message, UDPResponseStatus::DENIED, remoteIP, remotePort);
             return true;
@@ -460,6 +662,72 @@ bool AmakerBotService::messageHandler(const std::string &message,
         return true;
     }
 
+    if (message[0] == AmakerBotConsts::udp_action_grant_role)
+    {
+        // [0x47][ip:4B][role:1B][mask:32B optional] — only the registered master grants roles
+        if (!isMasterAddress(remoteIP))
+        {
+            udp_reply(message, UDPResponseStatus::DENIED, remoteIP, remotePort);
+            return true;
+        }
+        const uint8_t *d = reinterpret_cast<const uint8_t *>(message.data());
+        if ((message.size() != 6 && message.size() != 38) || d[5] >= ActionAcl::ROLE_COUNT)
+        {
+            udp_reply(message, UDPResponseStatus::ERROR, remoteIP, remotePort);
+            return true;
+        }
+        const IPAddress peer(d[1], d[2], d[3], d[4]);
+        ActionMask mask;
+        if (message.size() == 38)
+            mask = ActionMask::fromBytes(d + 6);
+        const bool ok = grantRole(peer, static_cast<PeerRole>(d[5]), message.size() == 38 ? &mask : nullptr);
+        udp_reply(message, ok ? UDPResponseStatus::SUCCESS : UDPResponseStatus::ERROR, remoteIP, remotePort);
+        return true;
+    }
+
+    if (message[0] == AmakerBotConsts::udp_action_link_stats)
+    {
+        // Master, or a peer whose granted bitmap holds 0x48 (observers and students by default)
+        if (!isActionAllowed(AmakerBotConsts::udp_action_link_stats, remoteIP))
+        {
+            udp_reply(message, UDPResponseStatus::DENIED, remoteIP, remotePort);
+            return true;
+        }
+        portENTER_CRITICAL(&link_lock_);
+        const LinkQuality::Stats stats = link_.stats();
+        const uint16_t scale = link_.speedScale();
+        portEXIT_CRITICAL(&link_lock_);
+
+        // [0x48][version][session:2][quality:2][speed_scale:2][15 x u32][hist: 16 x u32], little-endian
+        uint8_t reply[2 + 3 * 2 + 15 * 4 + LinkQuality::HIST_BUCKETS * 4];
+        size_t n = 0;
+        auto put16 = [&](uint16_t v)
+        {
+            reply[n++] = static_cast<uint8_t>(v);
+            reply[n++] = static_cast<uint8_t>(v >> 8);
+        };
+        auto put32 = [&](uint32_t v)
+        {
+            for (uint8_t shift = 0; shift < 32; shift += 8)
+                reply[n++] = static_cast<uint8_t>(v >> shift);
+        };
+        reply[n++] = AmakerBotConsts::udp_action_link_stats;
+        reply[n++] = AmakerBotConsts::link_stats_version;
+        put16(identitySession(getMasterIdentity()));
+        put16(stats.quality);
+        put16(scale);
+        const uint32_t fields[] = {stats.heartbeats, stats.lost, stats.duplicates, stats.reordered,
+                                   stats.gap_min_us, stats.gap_avg_us, stats.gap_max_us, stats.jitter_us,
+                                   stats.near_timeouts, stats.timeouts, stats.rtt_reports,
+                                   stats.rtt_min_us, stats.rtt_avg_us, stats.rtt_max_us, stats.rtt_last_us};
+        for (uint32_t field : fields)
+            put32(field);
+        for (uint8_t i = 0; i < LinkQuality::HIST_BUCKETS; ++i)
+            put32(stats.hist[i]);
+        udp_service.sendReply(std::string(reinterpret_cast<const char *>(reply), n), remoteIP, remotePort);
+        return true;
+    }
+
     return false; // not our message
 }
 
@@ -467,53 +735,140 @@ bool AmakerBotService::messageHandler(const std::string &message,
 // Heartbeat watchdog
 // ---------------------------------------------------------------------------
 
+void AmakerBotService::resetHeartbeat()
+{
+    if (heartbeat_timer_)
+        esp_timer_stop(heartbeat_timer_);
+    portENTER_CRITICAL(&heartbeat_lock_);
+    heartbeat_.reset();
+    portEXIT_CRITICAL(&heartbeat_lock_);
+}
+
 /**
  * @brief Stop all motors and servos when the master heartbeat times out.
- * @details Must be called periodically (e.g. every 10 ms from the UDP task).
- *          The emergency stop fires only on the transition into the timed-out
- *          state to avoid calling setAllMotorsSpeed(0) on every tick.
- *          The flag resets automatically when the next valid heartbeat arrives.
+ * @details Runs in the esp_timer task when the deadline set by the last heartbeat
+ *          passes. The emergency stop fires once per timeout, before any logging:
+ *          the callback only hands it to ServoService's stop task (prebuilt register
+ *          image, highest priority), which reports back through heartbeatStopDone().
+ *          Waiting for the bus here would stall every other esp_timer callback.
+ *          A callback overtaken by a heartbeat that re-armed the timer is dropped by
+ *          HeartbeatWatchdog::expire().
  */
-void AmakerBotService::checkHeartbeatTimeout()
+void AmakerBotService::heartbeatTimerCallback(void *arg)
 {
-    // Check master_ip_ under mutex (std::string is not safe to read across cores)
-    bool has_master = false;
-    if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(5)))
-    {
-        has_master = !master_ip_.empty();
-        xSemaphoreGive(master_mutex_);
-    }
+    AmakerBotService *self = static_cast<AmakerBotService *>(arg);
 
-    // Nothing to watch if no master is registered or no heartbeat has been sent yet
-    if (!has_master || !heartbeat_active_)
+    portENTER_CRITICAL(&self->heartbeat_lock_);
+    const bool stop = self->heartbeat_.expire(esp_timer_get_time());
+    portEXIT_CRITICAL(&self->heartbeat_lock_);
+    if (!stop)
         return;
 
-    // we're not at risk of millis() overflow during a game session as millis() rolls over every ~50 days :)
-    if ((millis() - last_heartbeat_ms_) > AmakerBotConsts::heartbeat_timeout_ms)
-    {
-        if (!heartbeat_timed_out_)
-        {
-            heartbeat_timed_out_ = true;
+    // Emergency stop — halt all DC motors and continuous servos (once), before any logging
+    servo_service.requestEmergencyStop(&AmakerBotService::heartbeatStopDone, self);
+    portENTER_CRITICAL(&self->link_lock_);
+    self->link_.onTimeout();
+    const uint16_t scale = self->link_.speedScale();
+    portEXIT_CRITICAL(&self->link_lock_);
+    servo_service.setSpeedScale(scale);
 
-            // Emergency stop — halt all DC motors and continuous servos (once)
-            servo_service.setAllMotorsSpeed(0);
-            servo_service.setAllServoSpeed(0);
-            ui.set_info(ui.KEY_UDP_STATE, "down");
-
-            app_info_logger.error(progmem_to_string(AmakerBotConsts::msg_heartbeat_timeout));
+    ui.set_info(ui.KEY_UDP_STATE, "down");
+    app_info_logger.error(progmem_to_string(AmakerBotConsts::msg_heartbeat_timeout));
 #ifdef VERBOSE_DEBUG
-            if (logger)
-                logger->error(progmem_to_string(AmakerBotConsts::msg_heartbeat_timeout));
+    if (self->logger)
+        self->logger->error(progmem_to_string(AmakerBotConsts::msg_heartbeat_timeout));
 #endif
-        }
+}
+
+/**
+ * @brief Completion of the heartbeat emergency stop, on ServoService's stop task.
+ */
+void AmakerBotService::heartbeatStopDone(void *arg, bool written)
+{
+    AmakerBotService *self = static_cast<AmakerBotService *>(arg);
+    const int64_t stopped_us = esp_timer_get_time();
+    portENTER_CRITICAL(&self->heartbeat_lock_);
+    // A failed write is not a stop: keep it out of the latency
+    if (written)
+        self->heartbeat_.recordStop(stopped_us);
+    else
+        self->heartbeat_.recordFailedStop();
+    portEXIT_CRITICAL(&self->heartbeat_lock_);
+}
+
+HeartbeatWatchdog::Stats AmakerBotService::getHeartbeatStats() const
+{
+    portENTER_CRITICAL(&heartbeat_lock_);
+    const HeartbeatWatchdog::Stats stats = heartbeat_.stats();
+    portEXIT_CRITICAL(&heartbeat_lock_);
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Link quality
+// ---------------------------------------------------------------------------
+
+void AmakerBotService::resetLink()
+{
+    portENTER_CRITICAL(&link_lock_);
+    link_.reset();
+    portEXIT_CRITICAL(&link_lock_);
+    servo_service.setSpeedScale(LinkQuality::FULL_SCALE);
+}
+
+LinkQuality::Stats AmakerBotService::getLinkStats() const
+{
+    portENTER_CRITICAL(&link_lock_);
+    const LinkQuality::Stats stats = link_.stats();
+    portEXIT_CRITICAL(&link_lock_);
+    return stats;
+}
+
+LinkConfig AmakerBotService::getLinkConfig() const
+{
+    portENTER_CRITICAL(&link_lock_);
+    const LinkConfig config = link_.config();
+    portEXIT_CRITICAL(&link_lock_);
+    return config;
+}
+
+bool AmakerBotService::setLinkConfig(const LinkConfig &config, std::string &error)
+{
+    if (!config.validate(error))
+        return false;
+    portENTER_CRITICAL(&link_lock_);
+    link_.configure(config);
+    const uint16_t scale = link_.speedScale();
+    portEXIT_CRITICAL(&link_lock_);
+    servo_service.setSpeedScale(scale);
+    return true;
+}
+
+bool AmakerBotService::saveSettings()
+{
+    if (!settings_service_)
+    {
+        if (logger)
+            logger->error(getServiceName() + ": Settings service not available");
+        return false;
     }
-    else if (heartbeat_timed_out_)
+    return settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(AmakerBotConsts::settings_key_link)), getLinkConfig().toString());
+}
+
+bool AmakerBotService::loadSettings()
+{
+    if (!settings_service_)
     {
-        // Heartbeat just came back — clear the timed-out flag
-        heartbeat_timed_out_ = false;
-        ui.set_info(ui.KEY_UDP_STATE, "up");
-        app_info_logger.info(progmem_to_string(AmakerBotConsts::msg_heartbeat_restored));
+        if (logger)
+            logger->error(getServiceName() + ": Settings service not available");
+        return false;
     }
+    const std::string link_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(AmakerBotConsts::settings_key_link)));
+    LinkConfig config;
+    std::string error;
+    if (config.fromString(link_settings.c_str()))
+        setLinkConfig(config, error);
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -596,7 +951,7 @@ bool AmakerBotService::registerRoutes()
                          return;
                      }
 
-                     registerMaster(ip);
+                     registerMaster(request->client()->remoteIP(), 0);
 
                      JsonDocument doc;
                      doc[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_ok);
@@ -611,8 +966,8 @@ bool AmakerBotService::registerRoutes()
     // ------------------------------------------------------------------
     std::vector<OpenAPIResponse> master_responses;
     OpenAPIResponse mst_ok(200, AmakerBotConsts::resp_master_info);
-    mst_ok.schema = R"({"type":"object","properties":{"registered":{"type":"boolean"},"ip":{"type":"string","description":"Master IP address, empty when no master is registered"}}})";
-    mst_ok.example = R"({"registered":true,"ip":"192.168.1.42"})";
+    mst_ok.schema = R"({"type":"object","properties":{"registered":{"type":"boolean"},"ip":{"type":"string","description":"Master IP address, empty when no master is registered"},"port":{"type":"integer","description":"UDP source port of a UDP registration, 0 for HTTP"},"session":{"type":"integer","description":"Session token drawn at registration, 0 when no master is registered"}}})";
+    mst_ok.example = R"({"registered":true,"ip":"192.168.1.42","port":51234,"session":40312})";
     master_responses.push_back(mst_ok);
     master_responses.push_back(createServiceNotStartedResponse());
 
@@ -628,18 +983,14 @@ bool AmakerBotService::registerRoutes()
                      if (!checkServiceStarted(request))
                          return;
 
-                     std::string ip;
-                     bool registered = false;
-                     if (master_mutex_ && xSemaphoreTake(master_mutex_, pdMS_TO_TICKS(50)))
-                     {
-                         ip = master_ip_;
-                         registered = !master_ip_.empty();
-                         xSemaphoreGive(master_mutex_);
-                     }
+                     const uint64_t identity = getMasterIdentity();
 
                      JsonDocument doc;
-                     doc[FPSTR(AmakerBotConsts::field_registered)] = registered;
-                     doc[FPSTR(AmakerBotConsts::field_ip)] = ip.c_str();
+                     doc[FPSTR(AmakerBotConsts::field_registered)] = identity != 0;
+                     doc[FPSTR(AmakerBotConsts::field_ip)] =
+                         identity ? IPAddress(identityIPv4(identity)).toString() : String();
+                     doc[FPSTR(AmakerBotConsts::field_port)] = identityPort(identity);
+                     doc[FPSTR(AmakerBotConsts::field_session)] = identitySession(identity);
                      String out;
                      serializeJson(doc, out);
                      request->send(200, FPSTR(RoutesConsts::mime_json), out);
@@ -694,10 +1045,8 @@ bool AmakerBotService::registerRoutes()
                      if (!checkServiceStarted(request))
                          return;
 
-                     std::string caller_ip = request->client()->remoteIP().toString().c_str();
-
                      // Accept: matching IP only
-                     if (!isMaster(caller_ip))
+                     if (!isMasterAddress(request->client()->remoteIP()))
                      {
                          JsonDocument err;
                          err[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_err);
@@ -708,7 +1057,7 @@ bool AmakerBotService::registerRoutes()
                          return;
                      }
 
-                     unregisterMaster(request->client()->remoteIP().toString().c_str());
+                     unregisterMaster(request->client()->remoteIP());
 
                      JsonDocument doc;
                      doc[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_ok);
@@ -967,6 +1316,283 @@ bool AmakerBotService::registerRoutes()
                      request->send(200, FPSTR(RoutesConsts::mime_json), out);
                  });
 
+    // ------------------------------------------------------------------
+    // GET /api/amakerbot/v1/roles
+    // ------------------------------------------------------------------
+    std::string path_roles = getPath(progmem_to_string(AmakerBotConsts::path_roles).c_str());
+
+    std::vector<OpenAPIResponse> roles_responses;
+    OpenAPIResponse roles_ok(200, AmakerBotConsts::resp_roles_ok);
+    roles_ok.schema = R"({"type":"object","properties":{"roles":{"type":"array","items":{"type":"object","properties":{"role":{"type":"string","enum":["guest","observer","student","master"]},"mask":{"type":"string","description":"Default allowed-action bitmap, 64 hex digits: bit n of byte n/8 is action byte 8*(n/8)+n%8"},"denials":{"type":"integer"}}}},"peers":{"type":"array","items":{"type":"object","properties":{"ip":{"type":"string"},"role":{"type":"string"},"mask":{"type":"string"},"denials":{"type":"integer"}}}}}})";
+    roles_ok.example = R"({"roles":[{"role":"guest","mask":"0000000000000000000000000000000000000000000000000000000000000000","denials":3},{"role":"observer","mask":"000000000000f0000001808b0000000000000000000000000000000000000000","denials":1}],"peers":[{"ip":"192.168.1.50","role":"observer","mask":"000000000000f0000001808b0000000000000000000000000000000000000000","denials":1}]})";
+    roles_responses.push_back(roles_ok);
+    roles_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(path_roles.c_str(), RoutesConsts::method_get,
+                     AmakerBotConsts::desc_roles,
+                     AmakerBotConsts::tag_service, false,
+                     {}, roles_responses));
+
+    webserver.on(path_roles.c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 {
+                     if (!checkServiceStarted(request))
+                         return;
+
+                     ActionAcl::Peer peers[ActionAcl::MAX_PEERS];
+                     ActionMask masks[ActionAcl::ROLE_COUNT];
+                     uint32_t denials[ActionAcl::ROLE_COUNT];
+                     portENTER_CRITICAL(&acl_lock_);
+                     const uint8_t count = acl_.peers(peers, ActionAcl::MAX_PEERS);
+                     for (uint8_t r = 0; r < ActionAcl::ROLE_COUNT; ++r)
+                     {
+                         masks[r] = acl_.roleMask(static_cast<PeerRole>(r));
+                         denials[r] = acl_.denials(static_cast<PeerRole>(r));
+                     }
+                     portEXIT_CRITICAL(&acl_lock_);
+
+                     char hex[65];
+                     JsonDocument doc;
+                     JsonArray roles = doc[FPSTR(AmakerBotConsts::field_roles)].to<JsonArray>();
+                     for (uint8_t r = 0; r < ActionAcl::ROLE_COUNT; ++r)
+                     {
+                         JsonObject role = roles.add<JsonObject>();
+                         role[FPSTR(AmakerBotConsts::field_role)] = ActionAcl::roleName(static_cast<PeerRole>(r));
+                         masks[r].toHex(hex);
+                         role[FPSTR(AmakerBotConsts::field_mask)] = hex;
+                         role[FPSTR(AmakerBotConsts::field_denials)] = denials[r];
+                     }
+                     JsonArray list = doc[FPSTR(AmakerBotConsts::field_peers)].to<JsonArray>();
+                     for (uint8_t i = 0; i < count; ++i)
+                     {
+                         JsonObject peer = list.add<JsonObject>();
+                         peer[FPSTR(AmakerBotConsts::field_ip)] = IPAddress(peers[i].ipv4).toString();
+                         peer[FPSTR(AmakerBotConsts::field_role)] = ActionAcl::roleName(peers[i].role);
+                         peers[i].mask.toHex(hex);
+                         peer[FPSTR(AmakerBotConsts::field_mask)] = hex;
+                         peer[FPSTR(AmakerBotConsts::field_denials)] = peers[i].denied;
+                     }
+                     String out;
+                     serializeJson(doc, out);
+                     request->send(200, FPSTR(RoutesConsts::mime_json), out);
+                 });
+
+    // ------------------------------------------------------------------
+    // GET /api/amakerbot/v1/heartbeat
+    // ------------------------------------------------------------------
+    std::string path_heartbeat = getPath(progmem_to_string(AmakerBotConsts::path_heartbeat).c_str());
+
+    std::vector<OpenAPIResponse> heartbeat_responses;
+    OpenAPIResponse hb_ok(200, AmakerBotConsts::resp_heartbeat_ok);
+    hb_ok.schema = R"({"type":"object","properties":{"timeout_us":{"type":"integer"},"armed":{"type":"boolean"},"timed_out":{"type":"boolean"},"heartbeats":{"type":"integer"},"expiries":{"type":"integer","description":"Timeouts that stopped the motors"},"stale_expiries":{"type":"integer","description":"Timer callbacks overtaken by a heartbeat"},"restores":{"type":"integer"},"failed_stops":{"type":"integer","description":"Stops whose write did not reach the bus, left out of stop_latency"},"timer_late_max_us":{"type":"integer","description":"Worst deadline to timer callback delay"},"stop_latency":{"type":"object","description":"Deadline to emergency stop completed","properties":{"min_us":{"type":"integer"},"max_us":{"type":"integer"},"avg_us":{"type":"integer"},"last_us":{"type":"integer"},"hist_log2_us":{"type":"array","items":{"type":"integer"},"description":"Bucket n counts latencies in [2^n, 2^(n+1)) us"}}}}})";
+    hb_ok.example = R"({"timeout_us":50000,"armed":true,"timed_out":false,"heartbeats":1520,"expiries":2,"stale_expiries":0,"restores":2,"failed_stops":0,"timer_late_max_us":41,"stop_latency":{"min_us":388,"max_us":455,"avg_us":421,"last_us":455,"hist_log2_us":[0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0]}})";
+    heartbeat_responses.push_back(hb_ok);
+    heartbeat_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(path_heartbeat.c_str(), RoutesConsts::method_get,
+                     AmakerBotConsts::desc_heartbeat,
+                     AmakerBotConsts::tag_service, false,
+                     {}, heartbeat_responses));
+
+    webserver.on(path_heartbeat.c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 {
+                     if (!checkServiceStarted(request))
+                         return;
+
+                     portENTER_CRITICAL(&heartbeat_lock_);
+                     const HeartbeatWatchdog::Stats stats = heartbeat_.stats();
+                     const bool armed = heartbeat_.armed();
+                     const bool timed_out = heartbeat_.timedOut();
+                     portEXIT_CRITICAL(&heartbeat_lock_);
+
+                     JsonDocument doc;
+                     doc[FPSTR(AmakerBotConsts::field_timeout_us)] = heartbeat_.timeout();
+                     doc[FPSTR(AmakerBotConsts::field_armed)] = armed;
+                     doc[FPSTR(AmakerBotConsts::field_timed_out)] = timed_out;
+                     doc[FPSTR(AmakerBotConsts::field_heartbeats)] = stats.heartbeats;
+                     doc[FPSTR(AmakerBotConsts::field_expiries)] = stats.expiries;
+                     doc[FPSTR(AmakerBotConsts::field_stale_expiries)] = stats.stale_expiries;
+                     doc[FPSTR(AmakerBotConsts::field_restores)] = stats.restores;
+                     doc[FPSTR(AmakerBotConsts::field_failed_stops)] = stats.failed_stops;
+                     doc[FPSTR(AmakerBotConsts::field_timer_late_max_us)] = stats.timer_late_max_us;
+                     JsonObject latency = doc[FPSTR(AmakerBotConsts::field_stop_latency)].to<JsonObject>();
+                     latency[FPSTR(AmakerBotConsts::field_min_us)] = stats.latency_min_us;
+                     latency[FPSTR(AmakerBotConsts::field_max_us)] = stats.latency_max_us;
+                     latency[FPSTR(AmakerBotConsts::field_avg_us)] = stats.latency_avg_us;
+                     latency[FPSTR(AmakerBotConsts::field_last_us)] = stats.latency_last_us;
+                     JsonArray hist = latency[FPSTR(AmakerBotConsts::field_hist_log2_us)].to<JsonArray>();
+                     for (uint8_t i = 0; i < HeartbeatWatchdog::Stats::HIST_BUCKETS; ++i)
+                         hist.add(stats.hist[i]);
+                     String out;
+                     serializeJson(doc, out);
+                     request->send(200, FPSTR(RoutesConsts::mime_json), out);
+                 });
+
+    // ------------------------------------------------------------------
+    // GET /api/amakerbot/v1/link
+    // ------------------------------------------------------------------
+    std::string path_link = getPath(progmem_to_string(AmakerBotConsts::path_link).c_str());
+
+    std::vector<OpenAPIResponse> link_responses;
+    OpenAPIResponse link_ok(200, AmakerBotConsts::resp_link_ok);
+    link_ok.schema = R"({"type":"object","properties":{"session":{"type":"integer","description":"Master session token, 0 if no master"},"quality":{"type":"integer","description":"0-1000, EWMA of the heartbeat timeliness; lost heartbeats and timeouts count as 0"},"speed_scale":{"type":"integer","description":"Wheel speed scale applied by the derating, in 1/1000"},"heartbeats":{"type":"integer"},"lost":{"type":"integer","description":"Estimated from the heartbeat counter"},"loss_permille":{"type":"integer"},"duplicates":{"type":"integer"},"reordered":{"type":"integer"},"near_timeouts":{"type":"integer"},"timeouts":{"type":"integer"},"gap":{"type":"object","description":"Heartbeat inter-arrival time","properties":{"min_us":{"type":"integer"},"avg_us":{"type":"integer"},"max_us":{"type":"integer"},"jitter_us":{"type":"integer"},"hist_width_us":{"type":"integer"},"hist":{"type":"array","items":{"type":"integer"},"description":"Bucket n counts gaps in [n, n+1) * hist_width_us, the last bucket is open-ended"}}},"rtt":{"type":"object","description":"Ping round trip time reported by the master","properties":{"reports":{"type":"integer"},"min_us":{"type":"integer"},"avg_us":{"type":"integer"},"max_us":{"type":"integer"},"last_us":{"type":"integer"}}},"config":{"type":"object","properties":{"derate":{"type":"boolean"},"near_timeout_pct":{"type":"integer"},"derate_below":{"type":"integer"},"min_scale":{"type":"integer"}}}}})";
+    link_ok.example = R"({"session":40213,"quality":962,"speed_scale":1000,"heartbeats":3012,"lost":9,"loss_permille":2,"duplicates":0,"reordered":1,"near_timeouts":4,"timeouts":0,"gap":{"min_us":8120,"avg_us":20004,"max_us":43870,"jitter_us":1210,"hist_width_us":5000,"hist":[0,12,25,2911,41,11,5,3,2,1,0,0,0,0,0,0]},"rtt":{"reports":150,"min_us":2900,"avg_us":6400,"max_us":38100,"last_us":5200},"config":{"derate":true,"near_timeout_pct":80,"derate_below":700,"min_scale":300}})";
+    link_responses.push_back(link_ok);
+    link_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(path_link.c_str(), RoutesConsts::method_get,
+                     AmakerBotConsts::desc_link_get,
+                     AmakerBotConsts::tag_service, false,
+                     {}, link_responses));
+
+    webserver.on(path_link.c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 {
+                     if (!checkServiceStarted(request))
+                         return;
+
+                     portENTER_CRITICAL(&link_lock_);
+                     const LinkQuality::Stats stats = link_.stats();
+                     const LinkConfig config = link_.config();
+                     const uint16_t scale = link_.speedScale();
+                     portEXIT_CRITICAL(&link_lock_);
+
+                     JsonDocument doc;
+                     doc[FPSTR(AmakerBotConsts::field_session)] = identitySession(getMasterIdentity());
+                     doc[FPSTR(AmakerBotConsts::field_quality)] = stats.quality;
+                     doc[FPSTR(AmakerBotConsts::field_speed_scale)] = scale;
+                     doc[FPSTR(AmakerBotConsts::field_heartbeats)] = stats.heartbeats;
+                     doc[FPSTR(AmakerBotConsts::field_lost)] = stats.lost;
+                     doc[FPSTR(AmakerBotConsts::field_loss_permille)] = stats.lossPermille();
+                     doc[FPSTR(AmakerBotConsts::field_duplicates)] = stats.duplicates;
+                     doc[FPSTR(AmakerBotConsts::field_reordered)] = stats.reordered;
+                     doc[FPSTR(AmakerBotConsts::field_near_timeouts)] = stats.near_timeouts;
+                     doc[FPSTR(AmakerBotConsts::field_timeouts)] = stats.timeouts;
+                     JsonObject gap = doc[FPSTR(AmakerBotConsts::field_gap)].to<JsonObject>();
+                     gap[FPSTR(AmakerBotConsts::field_min_us)] = stats.gap_min_us;
+                     gap[FPSTR(AmakerBotConsts::field_avg_us)] = stats.gap_avg_us;
+                     gap[FPSTR(AmakerBotConsts::field_max_us)] = stats.gap_max_us;
+                     gap[FPSTR(AmakerBotConsts::field_jitter_us)] = stats.jitter_us;
+                     gap[FPSTR(AmakerBotConsts::field_hist_width_us)] = LinkQuality::HIST_WIDTH_US;
+                     JsonArray hist = gap[FPSTR(AmakerBotConsts::field_hist)].to<JsonArray>();
+                     for (uint8_t i = 0; i < LinkQuality::HIST_BUCKETS; ++i)
+                         hist.add(stats.hist[i]);
+                     JsonObject rtt = doc[FPSTR(AmakerBotConsts::field_rtt)].to<JsonObject>();
+                     rtt[FPSTR(AmakerBotConsts::field_reports)] = stats.rtt_reports;
+                     rtt[FPSTR(AmakerBotConsts::field_min_us)] = stats.rtt_min_us;
+                     rtt[FPSTR(AmakerBotConsts::field_avg_us)] = stats.rtt_avg_us;
+                     rtt[FPSTR(AmakerBotConsts::field_max_us)] = stats.rtt_max_us;
+                     rtt[FPSTR(AmakerBotConsts::field_last_us)] = stats.rtt_last_us;
+                     JsonObject cfg = doc[FPSTR(AmakerBotConsts::field_config)].to<JsonObject>();
+                     cfg[FPSTR(AmakerBotConsts::param_derate)] = config.derate;
+                     cfg[FPSTR(AmakerBotConsts::param_near_timeout_pct)] = config.near_timeout_pct;
+                     cfg[FPSTR(AmakerBotConsts::param_derate_below)] = config.derate_below;
+                     cfg[FPSTR(AmakerBotConsts::param_min_scale)] = config.min_scale;
+                     String out;
+                     serializeJson(doc, out);
+                     request->send(200, FPSTR(RoutesConsts::mime_json), out);
+                 });
+
+    // ------------------------------------------------------------------
+    // POST /api/amakerbot/v1/link?derate=<0|1>&near_timeout_pct=&derate_below=&min_scale=
+    // ------------------------------------------------------------------
+    std::vector<OpenAPIParameter> link_params;
+    link_params.push_back(OpenAPIParameter(AmakerBotConsts::param_derate, RoutesConsts::type_integer, RoutesConsts::in_query,
+                                           "1 = scale the wheel speed down on low link quality, 0 = never", false));
+    link_params.push_back(OpenAPIParameter(AmakerBotConsts::param_near_timeout_pct, RoutesConsts::type_integer, RoutesConsts::in_query,
+                                           "Heartbeat gap, in % of the watchdog timeout, counted as a near-timeout (10-99)", false));
+    link_params.push_back(OpenAPIParameter(AmakerBotConsts::param_derate_below, RoutesConsts::type_integer, RoutesConsts::in_query,
+                                           "Quality (1-1000) under which the speed is scaled down", false));
+    link_params.push_back(OpenAPIParameter(AmakerBotConsts::param_min_scale, RoutesConsts::type_integer, RoutesConsts::in_query,
+                                           "Speed scale (0-1000) at quality 0; full scale at derate_below", false));
+
+    std::vector<OpenAPIResponse> link_set_responses;
+    OpenAPIResponse link_set_ok(200, AmakerBotConsts::resp_link_set);
+    link_set_ok.schema = R"({"type":"object","properties":{"result":{"type":"string"},"config":{"type":"object"}}})";
+    link_set_ok.example = R"({"result":"ok","config":{"derate":true,"near_timeout_pct":80,"derate_below":700,"min_scale":300}})";
+    link_set_responses.push_back(link_set_ok);
+    link_set_responses.push_back(OpenAPIResponse(400, RoutesConsts::msg_invalid_values));
+    link_set_responses.push_back(OpenAPIResponse(403, AmakerBotConsts::resp_unauthorized));
+    link_set_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(path_link.c_str(), RoutesConsts::method_post,
+                     AmakerBotConsts::desc_link_set,
+                     AmakerBotConsts::tag_service, false,
+                     link_params, link_set_responses));
+
+    webserver.on(path_link.c_str(), HTTP_POST,
+                 [this](AsyncWebServerRequest *request)
+                 {
+                     if (!checkServiceStarted(request))
+                         return;
+
+                     if (!isMasterAddress(request->client()->remoteIP()))
+                     {
+                         JsonDocument err;
+                         err[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_err);
+                         err[FPSTR(RoutesConsts::message)] = FPSTR(AmakerBotConsts::resp_unauthorized);
+                         String out;
+                         serializeJson(err, out);
+                         request->send(403, FPSTR(RoutesConsts::mime_json), out);
+                         return;
+                     }
+
+                     // Omitted parameters keep their value; out of range numbers fail validate()
+                     LinkConfig config = getLinkConfig();
+                     auto param = [request](const char *name, long fallback) -> long
+                     {
+                         const AsyncWebParameter *p = nullptr;
+                         if (request->hasParam(FPSTR(name), true))
+                             p = request->getParam(FPSTR(name), true);
+                         else if (request->hasParam(FPSTR(name)))
+                             p = request->getParam(FPSTR(name));
+                         return p ? p->value().toInt() : fallback;
+                     };
+                     const long derate = param(AmakerBotConsts::param_derate, config.derate ? 1 : 0);
+                     const long pct = param(AmakerBotConsts::param_near_timeout_pct, config.near_timeout_pct);
+                     const long below = param(AmakerBotConsts::param_derate_below, config.derate_below);
+                     const long scale = param(AmakerBotConsts::param_min_scale, config.min_scale);
+                     std::string error;
+                     bool ok = pct >= 0 && pct <= 255 && below >= 0 && below <= 65535 && scale >= 0 && scale <= 65535;
+                     if (ok)
+                     {
+                         config.derate = derate != 0;
+                         config.near_timeout_pct = static_cast<uint8_t>(pct);
+                         config.derate_below = static_cast<uint16_t>(below);
+                         config.min_scale = static_cast<uint16_t>(scale);
+                         ok = setLinkConfig(config, error);
+                     }
+                     if (!ok)
+                     {
+                         JsonDocument err;
+                         err[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_err);
+                         if (error.empty())
+                             err[FPSTR(RoutesConsts::message)] = FPSTR(RoutesConsts::msg_invalid_values);
+                         else
+                             err[FPSTR(RoutesConsts::message)] = error.c_str();
+                         String out;
+                         serializeJson(err, out);
+                         request->send(400, FPSTR(RoutesConsts::mime_json), out);
+                         return;
+                     }
+
+                     JsonDocument doc;
+                     doc[FPSTR(RoutesConsts::result)] = FPSTR(RoutesConsts::result_ok);
+                     JsonObject cfg = doc[FPSTR(AmakerBotConsts::field_config)].to<JsonObject>();
+                     cfg[FPSTR(AmakerBotConsts::param_derate)] = config.derate;
+                     cfg[FPSTR(AmakerBotConsts::param_near_timeout_pct)] = config.near_timeout_pct;
+                     cfg[FPSTR(AmakerBotConsts::param_derate_below)] = config.derate_below;
+                     cfg[FPSTR(AmakerBotConsts::param_min_scale)] = config.min_scale;
+                     String out;
+                     serializeJson(doc, out);
+                     request->send(200, FPSTR(RoutesConsts::mime_json), out);
+                 });
+
     registerServiceStatusRoute(this);
     registerSettingsRoutes(this);
     return true;
@@ -6,6 +6,12 @@
  *          - POST /api/dfr1216/setServoAngle - Set the angle of a servo motor on the expansion board
  *          - POST /api/dfr1216/setMotorSpeed - Set the speed and direction of a DC motor
  *          - GET /api/dfr1216/getStatus - Get initialization status and operational state of the board
+ *          - GET /api/dfr1216/getBusStats - I2C bus counters per register class, duration histogram, mutex wait
+ *            (plus the simulated bus utilisation in DFR1216_SIMULATED builds)
+ *          - POST /api/dfr1216/resetBusStats - Zero the I2C bus statistics
+ *          - GET /api/dfr1216/getSensors - Latest sampled value of every configured sensor port
+ *          - POST /api/dfr1216/configureSensor - Assign a sensor type and period to a port
+ *          - GET /api/dfr1216/getSensorScans - Batched ADC/digital-input scans from the ring buffer
  *
  */
 
@@ -15,7 +21,9 @@
 #include <ESPAsyncWebServer.h>
 #include <pgmspace.h>
 #include <ArduinoJson.h>
+#include <memory>
 #include "IsOpenAPIInterface.h"
+#include "services/SettingsService.h"
 #include "services/UDPService.h"
 #include "services/AmakerBotService.h"
 
@@ -27,9 +35,24 @@ namespace DFR1216Consts
 {
     // Route paths and actions
     constexpr const char action_get_status[] PROGMEM = "getStatus";
+    constexpr const char action_get_bus_stats[] PROGMEM = "getBusStats";
+    constexpr const char action_reset_bus_stats[] PROGMEM = "resetBusStats";
+    constexpr const char action_get_sensors[] PROGMEM = "getSensors";
+    constexpr const char action_configure_sensor[] PROGMEM = "configureSensor";
+    constexpr const char action_get_sensor_scans[] PROGMEM = "getSensorScans";
     constexpr const char action_set_motor_speed[] PROGMEM = "setMotorSpeed";
     constexpr const char action_set_servo_angle[] PROGMEM = "setServoAngle";
     constexpr const char desc_angle_degrees[] PROGMEM = "Angle in degrees (0-180)";
+    constexpr const char desc_get_bus_stats[] PROGMEM = "Get I2C bus statistics of the DFR1216: per register class writes/reads/retries/NACKs/errors/failures, transaction duration histogram (bucket n = [2^n, 2^(n+1)) us) and bus mutex wait";
+    constexpr const char desc_reset_bus_stats[] PROGMEM = "Zero the DFR1216 I2C bus statistics";
+    constexpr const char desc_get_sensors[] PROGMEM = "Latest value of every configured sensor port, sampled in the background (value: ADC raw 0-4095, temperature in C, or SR04 distance), with the millis() timestamp and age of the reading";
+    constexpr const char desc_configure_sensor[] PROGMEM = "Assign a sensor type and sampling period to a port. Ports 0-5 (C0-C5) take adc, din (digital input), dht11, dht22 or ds18b20; port 6 is the SR04 connector and takes sr04. Type none stops sampling";
+    constexpr const char desc_get_sensor_scans[] PROGMEM = "ADC and digital-input ports are scanned together (one burst read per register block) at the shortest period configured among them; every scan is kept in a 64-entry ring. Returns the scans from sequence 'since' on, plus the sequence to ask for next and how many requested scans were already overwritten";
+    constexpr const char desc_scan_since[] PROGMEM = "First scan sequence wanted (default: oldest kept)";
+    constexpr const char desc_scan_max[] PROGMEM = "Maximum scans returned (1-64, default 64)";
+    constexpr const char desc_sensor_port[] PROGMEM = "Port: 0-5 for C0-C5, 6 for the SR04 connector";
+    constexpr const char desc_sensor_type[] PROGMEM = "Sensor type: none, adc, din, dht11, dht22, ds18b20, sr04";
+    constexpr const char desc_sensor_period[] PROGMEM = "Sampling period in ms (20-60000, omitted or 0 = default for the type)";
     constexpr const char desc_get_status[] PROGMEM = "Get initialization status and operational state of the DFR1216 expansion board";
     constexpr const char desc_motor_control[] PROGMEM = "Set the speed and direction of a DC motor on the DFR1216 expansion board";
     constexpr const char desc_motor_number[] PROGMEM = "Motor number (1-4)";
@@ -39,10 +62,18 @@ namespace DFR1216Consts
     constexpr const char desc_servo_params[] PROGMEM = "Servo control parameters";
     constexpr const char desc_speed_percent[] PROGMEM = "Speed percentage (-100 to +100)";
     constexpr const char json_angle[] PROGMEM = "angle";
+    constexpr const char json_avg_us[] PROGMEM = "avg_us";
+    constexpr const char json_classes[] PROGMEM = "classes";
+    constexpr const char json_duration[] PROGMEM = "duration";
+    constexpr const char json_histogram[] PROGMEM = "histogram";
+    constexpr const char json_max_us[] PROGMEM = "max_us";
+    constexpr const char json_mutex[] PROGMEM = "mutex";
+    constexpr const char json_transactions[] PROGMEM = "transactions";
     constexpr const char json_channel[] PROGMEM = "channel";
     constexpr const char json_error[] PROGMEM = "{\"error\":\"";
     constexpr const char json_motor[] PROGMEM = "motor";
     constexpr const char json_speed[] PROGMEM = "speed";
+    constexpr const char msg_invalid_sensor[] PROGMEM = "Invalid port/type: ports 0-5 take none|adc|din|dht11|dht22|ds18b20, port 6 takes none|sr04";
     constexpr const char msg_angle_out_of_range[] PROGMEM = "Angle out of range (0-180)";
     constexpr const char msg_missing_motor_params[] PROGMEM = "Missing required parameters: motor and speed";
     constexpr const char msg_missing_servo_params[] PROGMEM = "Missing required parameters: channel and angle";
@@ -52,14 +83,22 @@ namespace DFR1216Consts
     constexpr const char param_angle[] PROGMEM = "angle";
     constexpr const char param_channel[] PROGMEM = "channel";
     constexpr const char param_motor[] PROGMEM = "motor";
+    constexpr const char param_max[] PROGMEM = "max";
+    constexpr const char param_period_ms[] PROGMEM = "period_ms";
+    constexpr const char param_port[] PROGMEM = "port";
+    constexpr const char param_since[] PROGMEM = "since";
+    constexpr const char param_type[] PROGMEM = "type";
     constexpr const char param_speed[] PROGMEM = "speed";
     constexpr const char path_dfr1216[] PROGMEM = "dfr1216/";
     constexpr const char tag_dfr1216[] PROGMEM = "DFR1216";
+    constexpr const char settings_key_sensors[] PROGMEM = "sensors";
 
     // Response descriptions
     constexpr const char resp_servo_angle_set[] PROGMEM = "Servo angle set successfully";
     constexpr const char resp_motor_speed_set[] PROGMEM = "Motor speed set successfully";
     constexpr const char resp_status_retrieved[] PROGMEM = "Status retrieved successfully";
+    constexpr const char resp_bus_stats_reset[] PROGMEM = "Bus statistics reset";
+    constexpr const char resp_sensor_configured[] PROGMEM = "Sensor port configured";
 
     // JSON Schema definitions
     constexpr const char schema_channel_angle[] PROGMEM = "{\"type\":\"object\",\"required\":[\"channel\",\"angle\"],\"properties\":{\"channel\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":5},\"angle\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":180}}}";
@@ -77,6 +116,12 @@ namespace DFR1216Consts
     constexpr const char resp_motor_speed_example[] PROGMEM = "{\"result\":\"ok\",\"motor\":1,\"speed\":75}";
     constexpr const char resp_status_schema[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"message\":{\"type\":\"string\"},\"status\":{\"type\":\"string\"}}}";
     constexpr const char resp_status_example[] PROGMEM = "{\"message\":\"DFR1216Service\",\"status\":\"started\"}";
+    constexpr const char schema_bus_stats[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"transactions\":{\"type\":\"integer\"},\"duration\":{\"type\":\"object\",\"properties\":{\"avg_us\":{\"type\":\"integer\"},\"max_us\":{\"type\":\"integer\"},\"histogram\":{\"type\":\"array\",\"items\":{\"type\":\"integer\"},\"minItems\":16,\"maxItems\":16}}},\"mutex\":{\"type\":\"object\",\"properties\":{\"acquisitions\":{\"type\":\"integer\"},\"contended\":{\"type\":\"integer\"},\"avg_us\":{\"type\":\"integer\"},\"max_us\":{\"type\":\"integer\"}}},\"classes\":{\"type\":\"object\",\"additionalProperties\":{\"type\":\"object\",\"properties\":{\"writes\":{\"type\":\"integer\"},\"reads\":{\"type\":\"integer\"},\"retries\":{\"type\":\"integer\"},\"nacks\":{\"type\":\"integer\"},\"errors\":{\"type\":\"integer\"},\"failures\":{\"type\":\"integer\"}}}},\"simulator\":{\"type\":\"object\",\"description\":\"Only in DFR1216_SIMULATED builds\",\"properties\":{\"clock_hz\":{\"type\":\"integer\"},\"transactions\":{\"type\":\"integer\"},\"wire_bytes\":{\"type\":\"integer\"},\"nacks_injected\":{\"type\":\"integer\"},\"busy_us\":{\"type\":\"integer\"},\"window_us\":{\"type\":\"integer\"},\"utilisation_permille\":{\"type\":\"integer\"}}}}}";
+    constexpr const char ex_bus_stats[] PROGMEM = "{\"transactions\":48210,\"duration\":{\"avg_us\":212,\"max_us\":15420,\"histogram\":[0,0,0,0,0,0,1210,38004,8770,190,30,4,2,0,0,0]},\"mutex\":{\"acquisitions\":48210,\"contended\":1320,\"avg_us\":390,\"max_us\":15600},\"classes\":{\"actuator\":{\"writes\":41000,\"reads\":3600,\"retries\":2,\"nacks\":2,\"errors\":0,\"failures\":0},\"sr04\":{\"writes\":1200,\"reads\":1350,\"retries\":150,\"nacks\":0,\"errors\":0,\"failures\":0}}}";
+    constexpr const char schema_sensors[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"now_ms\":{\"type\":\"integer\"},\"sensors\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"properties\":{\"port\":{\"type\":\"integer\"},\"type\":{\"type\":\"string\"},\"period_ms\":{\"type\":\"integer\"},\"status\":{\"type\":\"string\",\"enum\":[\"pending\",\"ready\",\"mode_error\",\"no_device\",\"bus_error\"]},\"value\":{\"type\":\"number\"},\"humidity\":{\"type\":\"number\"},\"timestamp_ms\":{\"type\":\"integer\"},\"age_ms\":{\"type\":\"integer\"},\"conversion_ms\":{\"type\":\"integer\"},\"count\":{\"type\":\"integer\"},\"failures\":{\"type\":\"integer\"}}}},\"scan\":{\"type\":\"object\",\"properties\":{\"period_ms\":{\"type\":\"integer\"},\"scans\":{\"type\":\"integer\"},\"errors\":{\"type\":\"integer\"},\"next\":{\"type\":\"integer\"},\"bus_avg_us\":{\"type\":\"integer\"},\"bus_max_us\":{\"type\":\"integer\"}}}}}";
+    constexpr const char ex_sensors[] PROGMEM = "{\"now_ms\":81230,\"sensors\":[{\"port\":0,\"type\":\"adc\",\"period_ms\":50,\"status\":\"ready\",\"value\":2048,\"timestamp_ms\":81220,\"age_ms\":10,\"conversion_ms\":0,\"count\":1620,\"failures\":0},{\"port\":6,\"type\":\"sr04\",\"period_ms\":100,\"status\":\"ready\",\"value\":42,\"timestamp_ms\":81190,\"age_ms\":40,\"conversion_ms\":30,\"count\":810,\"failures\":3}],\"scan\":{\"period_ms\":50,\"scans\":1620,\"errors\":0,\"next\":1620,\"bus_avg_us\":610,\"bus_max_us\":2150}}";
+    constexpr const char schema_sensor_scans[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"next\":{\"type\":\"integer\"},\"lost\":{\"type\":\"integer\"},\"scans\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"properties\":{\"seq\":{\"type\":\"integer\"},\"t\":{\"type\":\"integer\"},\"adc\":{\"type\":\"array\",\"items\":{\"type\":[\"integer\",\"null\"]},\"minItems\":6,\"maxItems\":6},\"din\":{\"type\":\"array\",\"items\":{\"type\":[\"integer\",\"null\"]},\"minItems\":6,\"maxItems\":6},\"bus_us\":{\"type\":\"integer\"}}}}}}";
+    constexpr const char ex_sensor_scans[] PROGMEM = "{\"next\":1622,\"lost\":0,\"scans\":[{\"seq\":1620,\"t\":81200,\"adc\":[2048,1023,null,null,null,null],\"din\":[null,null,null,null,1,0],\"bus_us\":590},{\"seq\":1621,\"t\":81250,\"adc\":[2050,1019,null,null,null,null],\"din\":[null,null,null,null,1,0],\"bus_us\":602}]}";
 
     // UDP binary protocol constants
     constexpr uint8_t udp_service_id = 0x03;  ///< Unique ID for DFR1216 Service (high nibble of action byte)
@@ -84,10 +129,91 @@ namespace DFR1216Consts
     constexpr uint8_t udp_action_turn_off_led = (udp_service_id << 4) | 0x02;  ///< [led:1B]
     constexpr uint8_t udp_action_turn_off_all_leds = (udp_service_id << 4) | 0x03;  ///< (no params)
     constexpr uint8_t udp_action_get_led_status = (udp_service_id << 4) | 0x04;  ///< (no params) → [action][ok][JSON]
-    constexpr uint8_t udp_action_max = (udp_service_id << 4) | 0x04;  ///< highest valid action code
+    constexpr uint8_t udp_action_get_bus_stats = (udp_service_id << 4) | 0x05;  ///< [flags:1B optional] → [action][ok][binary stats]
+    constexpr uint8_t udp_action_get_sensors = (udp_service_id << 4) | 0x06;  ///< (no params) → [action][ok][binary readings]
+    constexpr uint8_t udp_action_get_sensor_scans = (udp_service_id << 4) | 0x07;  ///< [since:u32 optional] → [action][ok][binary scans]
+    constexpr uint8_t udp_action_max = (udp_service_id << 4) | 0x07;  ///< highest valid action code
+    constexpr uint8_t udp_bus_stats_version = 1;     ///< Layout version of the GET_BUS_STATS payload
+    constexpr uint8_t udp_bus_stats_flag_reset = 0x01; ///< Zero the statistics after the snapshot
+    constexpr uint8_t udp_sensors_version = 1;       ///< Layout version of the GET_SENSORS payload
+    constexpr uint8_t udp_scans_version = 1;         ///< Layout version of the GET_SENSOR_SCANS payload
+    constexpr uint8_t udp_scans_max = 24;            ///< Scans per reply (24 × 23 B keeps the datagram under 600 B)
 }
 
 
+/**
+ * @brief JSON view of the I2C bus statistics (classes without traffic are omitted).
+ */
+static void busStatsToJson(const sBusStats_t &stats, JsonDocument &doc)
+{
+    doc[FPSTR(DFR1216Consts::json_transactions)] = stats.transactions;
+    JsonObject duration = doc[FPSTR(DFR1216Consts::json_duration)].to<JsonObject>();
+    duration[FPSTR(DFR1216Consts::json_avg_us)] = stats.transactions ? static_cast<uint32_t>(stats.durationSumUs / stats.transactions) : 0;
+    duration[FPSTR(DFR1216Consts::json_max_us)] = stats.durationMaxUs;
+    JsonArray histogram = duration[FPSTR(DFR1216Consts::json_histogram)].to<JsonArray>();
+    for (uint8_t bucket = 0; bucket < BUS_HIST_BUCKETS; ++bucket)
+        histogram.add(stats.durationHist[bucket]);
+
+    JsonObject mutex = doc[FPSTR(DFR1216Consts::json_mutex)].to<JsonObject>();
+    mutex["acquisitions"] = stats.mutexAcquisitions;
+    mutex["contended"] = stats.mutexContended;
+    mutex[FPSTR(DFR1216Consts::json_avg_us)] = stats.mutexContended ? static_cast<uint32_t>(stats.mutexWaitSumUs / stats.mutexContended) : 0;
+    mutex[FPSTR(DFR1216Consts::json_max_us)] = stats.mutexWaitMaxUs;
+
+    JsonObject classes = doc[FPSTR(DFR1216Consts::json_classes)].to<JsonObject>();
+    for (uint8_t c = 0; c < eRegClassCount; ++c)
+    {
+        const sBusClassStats_t &cls = stats.classes[c];
+        if (!cls.writes && !cls.reads && !cls.failures)
+            continue;
+        JsonObject entry = classes[DFR1216::regClassName(static_cast<eRegClass_t>(c))].to<JsonObject>();
+        entry["writes"] = cls.writes;
+        entry["reads"] = cls.reads;
+        entry["retries"] = cls.retries;
+        entry["nacks"] = cls.nacks;
+        entry["errors"] = cls.errors;
+        entry["failures"] = cls.failures;
+    }
+}
+
+static inline void appendU32(std::string &out, uint32_t value)
+{
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+    out += static_cast<char>((value >> 16) & 0xFF);
+    out += static_cast<char>((value >> 24) & 0xFF);
+}
+
+static const char *sensorStatusName(uint8_t status)
+{
+    switch (status)
+    {
+    case eSensorReady:
+        return "ready";
+    case eSensorModeError:
+        return "mode_error";
+    case eSensorNoDevice:
+        return "no_device";
+    case eSensorBusError:
+        return "bus_error";
+    default:
+        return "pending";
+    }
+}
+
+void DFR1216Service::sensor_task_fn(void *param)
+{
+    DFR1216Service *self = static_cast<DFR1216Service *>(param);
+    for (;;)
+    {
+        uint32_t wait_ms = DFR1216SensorScheduler::IDLE_WAKE_MS;
+        if (self->isServiceStarted())
+            wait_ms = self->sensors.step(millis());
+        // configureSensor() notifies, so a new port does not wait out the idle period
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms ? wait_ms : 1));
+    }
+}
+
 bool DFR1216Service::initializeService()
 {
     if (!controller.begin())
@@ -111,6 +237,12 @@ bool DFR1216Service::startService()
     }
 
     setServiceStatus(STARTED);
+    if (!sensor_task_)
+    {
+        // Low priority: conversions are slow and readers only see the published values
+        xTaskCreatePinnedToCore(sensor_task_fn, "DFRSensors", 3072, this, 2, &sensor_task_, 1);
+    }
+    loadSettings();
 
     logger->info(getServiceName() + " " + getStatusString());
     return true;
@@ -123,6 +255,15 @@ bool DFR1216Service::stopService()
     return true;
 }
 
+bool DFR1216Service::configureSensor(uint8_t port, DFR1216SensorScheduler::Kind kind, uint32_t period_ms)
+{
+    if (!sensors.configure(port, kind, period_ms))
+        return false;
+    if (sensor_task_)
+        xTaskNotifyGive(sensor_task_);
+    return true;
+}
+
 bool DFR1216Service::setServoAngle(uint8_t channel, uint16_t angle)
 {
     if (!isServiceStarted())
@@ -284,6 +425,109 @@ bool DFR1216Service::registerRoutes()
                  [this](AsyncWebServerRequest *request)
                  { this->handle_get_status(request); });
 
+    // I2C bus statistics routes
+    std::vector<OpenAPIResponse> bus_stats_responses;
+    OpenAPIResponse bus_stats_ok(200, FPSTR(DFR1216Consts::resp_status_retrieved));
+    bus_stats_ok.schema = DFR1216Consts::schema_bus_stats;
+    bus_stats_ok.example = DFR1216Consts::ex_bus_stats;
+    bus_stats_responses.push_back(bus_stats_ok);
+    bus_stats_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(getPath(DFR1216Consts::action_get_bus_stats).c_str(),
+                     RoutesConsts::method_get,
+                     progmem_to_string(DFR1216Consts::desc_get_bus_stats).c_str(),
+                     FPSTR(DFR1216Consts::tag_dfr1216), false, {}, bus_stats_responses));
+
+    webserver.on(getPath(DFR1216Consts::action_get_bus_stats).c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 { this->handle_get_bus_stats(request); });
+
+    std::vector<OpenAPIResponse> bus_reset_responses;
+    bus_reset_responses.push_back(OpenAPIResponse(200, FPSTR(DFR1216Consts::resp_bus_stats_reset)));
+    bus_reset_responses.push_back(createServiceNotStartedResponse());
+    bus_reset_responses.push_back(createForbiddenResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(getPath(DFR1216Consts::action_reset_bus_stats).c_str(),
+                     RoutesConsts::method_post,
+                     progmem_to_string(DFR1216Consts::desc_reset_bus_stats).c_str(),
+                     FPSTR(DFR1216Consts::tag_dfr1216), false, {}, bus_reset_responses));
+
+    webserver.on(getPath(DFR1216Consts::action_reset_bus_stats).c_str(), HTTP_POST,
+                 [this](AsyncWebServerRequest *request)
+                 { this->handle_reset_bus_stats(request); });
+
+    // Sensor sampling routes
+    std::vector<OpenAPIResponse> sensors_responses;
+    OpenAPIResponse sensors_ok(200, FPSTR(DFR1216Consts::resp_status_retrieved));
+    sensors_ok.schema = DFR1216Consts::schema_sensors;
+    sensors_ok.example = DFR1216Consts::ex_sensors;
+    sensors_responses.push_back(sensors_ok);
+    sensors_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(getPath(DFR1216Consts::action_get_sensors).c_str(),
+                     RoutesConsts::method_get,
+                     progmem_to_string(DFR1216Consts::desc_get_sensors).c_str(),
+                     FPSTR(DFR1216Consts::tag_dfr1216), false, {}, sensors_responses));
+
+    webserver.on(getPath(DFR1216Consts::action_get_sensors).c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 { this->handle_get_sensors(request); });
+
+    std::vector<OpenAPIParameter> sensor_params;
+    sensor_params.push_back(OpenAPIParameter(
+        DFR1216Consts::param_port, RoutesConsts::type_integer, RoutesConsts::in_query,
+        FPSTR(DFR1216Consts::desc_sensor_port), true));
+    sensor_params.push_back(OpenAPIParameter(
+        DFR1216Consts::param_type, RoutesConsts::type_string, RoutesConsts::in_query,
+        FPSTR(DFR1216Consts::desc_sensor_type), true));
+    sensor_params.push_back(OpenAPIParameter(
+        DFR1216Consts::param_period_ms, RoutesConsts::type_integer, RoutesConsts::in_query,
+        FPSTR(DFR1216Consts::desc_sensor_period), false));
+
+    std::vector<OpenAPIResponse> sensor_config_responses;
+    sensor_config_responses.push_back(OpenAPIResponse(200, FPSTR(DFR1216Consts::resp_sensor_configured)));
+    sensor_config_responses.push_back(createMissingParamsResponse());
+    sensor_config_responses.push_back(createServiceNotStartedResponse());
+    sensor_config_responses.push_back(createForbiddenResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(getPath(DFR1216Consts::action_configure_sensor).c_str(),
+                     RoutesConsts::method_post,
+                     progmem_to_string(DFR1216Consts::desc_configure_sensor).c_str(),
+                     FPSTR(DFR1216Consts::tag_dfr1216), false, sensor_params, sensor_config_responses));
+
+    webserver.on(getPath(DFR1216Consts::action_configure_sensor).c_str(), HTTP_POST,
+                 [this](AsyncWebServerRequest *request)
+                 { this->handle_configure_sensor(request); });
+
+    std::vector<OpenAPIParameter> scan_params;
+    scan_params.push_back(OpenAPIParameter(
+        DFR1216Consts::param_since, RoutesConsts::type_integer, RoutesConsts::in_query,
+        FPSTR(DFR1216Consts::desc_scan_since), false));
+    scan_params.push_back(OpenAPIParameter(
+        DFR1216Consts::param_max, RoutesConsts::type_integer, RoutesConsts::in_query,
+        FPSTR(DFR1216Consts::desc_scan_max), false));
+
+    std::vector<OpenAPIResponse> scan_responses;
+    OpenAPIResponse scan_ok(200, FPSTR(DFR1216Consts::resp_status_retrieved));
+    scan_ok.schema = DFR1216Consts::schema_sensor_scans;
+    scan_ok.example = DFR1216Consts::ex_sensor_scans;
+    scan_responses.push_back(scan_ok);
+    scan_responses.push_back(createServiceNotStartedResponse());
+
+    registerOpenAPIRoute(
+        OpenAPIRoute(getPath(DFR1216Consts::action_get_sensor_scans).c_str(),
+                     RoutesConsts::method_get,
+                     progmem_to_string(DFR1216Consts::desc_get_sensor_scans).c_str(),
+                     FPSTR(DFR1216Consts::tag_dfr1216), false, scan_params, scan_responses));
+
+    webserver.on(getPath(DFR1216Consts::action_get_sensor_scans).c_str(), HTTP_GET,
+                 [this](AsyncWebServerRequest *request)
+                 { this->handle_get_sensor_scans(request); });
+
     // LED control routes
     std::vector<OpenAPIParameter> led_color_params;
     led_color_params.push_back(OpenAPIParameter("led", RoutesConsts::type_integer, RoutesConsts::in_query, "LED index (0-2)", true));
@@ -445,6 +689,148 @@ void DFR1216Service::handle_get_status(AsyncWebServerRequest *request)
     request->send(200, RoutesConsts::mime_json, response.c_str());
 }
 
+void DFR1216Service::handle_get_bus_stats(AsyncWebServerRequest *request)
+{
+    if (!checkServiceStarted(request))
+        return;
+    JsonDocument doc;
+    busStatsToJson(DFR1216::getBusStats(), doc);
+#ifdef DFR1216_SIMULATED
+    // Virtual board: modelled wire time and bus utilisation since the last reset
+    const sSimStats_t sim = DFR1216_Sim::getSimStats();
+    JsonObject simulator = doc["simulator"].to<JsonObject>();
+    simulator["clock_hz"] = DFR1216_Sim::getConfig().clockHz;
+    simulator["transactions"] = sim.transactions;
+    simulator["wire_bytes"] = sim.wireBytes;
+    simulator["nacks_injected"] = sim.nacksInjected;
+    simulator["busy_us"] = sim.busyUs;
+    simulator["window_us"] = sim.windowUs;
+    simulator["utilisation_permille"] = sim.utilisationPermille;
+#endif
+    String response;
+    serializeJson(doc, response);
+    request->send(200, RoutesConsts::mime_json, response.c_str());
+}
+
+void DFR1216Service::handle_reset_bus_stats(AsyncWebServerRequest *request)
+{
+    if (!checkServiceStarted(request) || !checkIsRequestFromMaster(request, &amakerbot_service))
+        return;
+    DFR1216::resetBusStats();
+#ifdef DFR1216_SIMULATED
+    DFR1216_Sim::resetSimStats();
+#endif
+    ResponseHelper::sendSuccess(request);
+}
+
+void DFR1216Service::handle_get_sensors(AsyncWebServerRequest *request)
+{
+    if (!checkServiceStarted(request))
+        return;
+    const uint32_t now = millis();
+    JsonDocument doc;
+    doc["now_ms"] = now;
+    JsonArray list = doc["sensors"].to<JsonArray>();
+    for (uint8_t port = 0; port < DFR1216SensorScheduler::PORTS; ++port)
+    {
+        const DFR1216SensorScheduler::Reading reading = sensors.read(port);
+        if (reading.kind == DFR1216SensorScheduler::Kind::NONE)
+            continue;
+        JsonObject entry = list.add<JsonObject>();
+        entry[FPSTR(DFR1216Consts::param_port)] = port;
+        entry[FPSTR(DFR1216Consts::param_type)] = DFR1216SensorScheduler::kindName(reading.kind);
+        entry[FPSTR(DFR1216Consts::param_period_ms)] = sensors.period(port);
+        entry["status"] = sensorStatusName(reading.status);
+        if (reading.timestamp_ms)
+        {
+            entry["value"] = reading.value;
+            if (reading.kind == DFR1216SensorScheduler::Kind::DHT11 || reading.kind == DFR1216SensorScheduler::Kind::DHT22)
+                entry["humidity"] = reading.humidity;
+            entry["timestamp_ms"] = reading.timestamp_ms;
+            entry["age_ms"] = now - reading.timestamp_ms;
+            entry["conversion_ms"] = reading.conversion_ms;
+        }
+        entry["count"] = reading.count;
+        entry["failures"] = reading.failures;
+    }
+    const DFR1216SensorScheduler::ScanStats scan = sensors.scanStats();
+    JsonObject scan_json = doc["scan"].to<JsonObject>();
+    scan_json[FPSTR(DFR1216Consts::param_period_ms)] = scan.period_ms;
+    scan_json["scans"] = scan.scans;
+    scan_json["errors"] = scan.errors;
+    scan_json["next"] = sensors.nextScanSequence();
+    scan_json["bus_avg_us"] = scan.scans ? static_cast<uint32_t>(scan.bus_us_sum / scan.scans) : 0;
+    scan_json["bus_max_us"] = scan.bus_us_max;
+    String response;
+    serializeJson(doc, response);
+    request->send(200, RoutesConsts::mime_json, response.c_str());
+}
+
+void DFR1216Service::handle_get_sensor_scans(AsyncWebServerRequest *request)
+{
+    if (!checkServiceStarted(request))
+        return;
+    const long since = request->hasArg(FPSTR(DFR1216Consts::param_since)) ? request->arg(FPSTR(DFR1216Consts::param_since)).toInt() : 0;
+    long max_frames = request->hasArg(FPSTR(DFR1216Consts::param_max)) ? request->arg(FPSTR(DFR1216Consts::param_max)).toInt() : DFR1216SensorScheduler::SCAN_RING;
+    if (max_frames < 1 || max_frames > DFR1216SensorScheduler::SCAN_RING)
+        max_frames = DFR1216SensorScheduler::SCAN_RING;
+
+    std::unique_ptr<DFR1216SensorScheduler::ScanFrame[]> frames(new DFR1216SensorScheduler::ScanFrame[max_frames]);
+    uint32_t lost = 0;
+    const uint16_t count = sensors.readScans(since > 0 ? static_cast<uint32_t>(since) : 0, frames.get(), static_cast<uint16_t>(max_frames), &lost);
+
+    JsonDocument doc;
+    doc["next"] = count ? frames[count - 1].sequence + 1 : sensors.nextScanSequence();
+    doc["lost"] = lost;
+    JsonArray list = doc["scans"].to<JsonArray>();
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        const DFR1216SensorScheduler::ScanFrame &frame = frames[i];
+        JsonObject entry = list.add<JsonObject>();
+        entry["seq"] = frame.sequence;
+        entry["t"] = frame.timestamp_ms;
+        JsonArray adc = entry["adc"].to<JsonArray>();
+        JsonArray din = entry["din"].to<JsonArray>();
+        for (uint8_t port = 0; port < DFR1216SensorScheduler::IO_PORTS; ++port)
+        {
+            if (frame.adc_mask & (1 << port))
+                adc.add(frame.adc[port]);
+            else
+                adc.add(nullptr);
+            if (frame.din_mask & (1 << port))
+                din.add((frame.din_levels >> port) & 1);
+            else
+                din.add(nullptr);
+        }
+        entry["bus_us"] = frame.bus_us;
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(200, RoutesConsts::mime_json, response.c_str());
+}
+
+void DFR1216Service::handle_configure_sensor(AsyncWebServerRequest *request)
+{
+    if (!checkServiceStarted(request) || !checkIsRequestFromMaster(request, &amakerbot_service))
+        return;
+    if (!request->hasArg(FPSTR(DFR1216Consts::param_port)) || !request->hasArg(FPSTR(DFR1216Consts::param_type)))
+    {
+        ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, FPSTR(RoutesConsts::resp_missing_params));
+        return;
+    }
+    const long port = request->arg(FPSTR(DFR1216Consts::param_port)).toInt();
+    const long period = request->hasArg(FPSTR(DFR1216Consts::param_period_ms)) ? request->arg(FPSTR(DFR1216Consts::param_period_ms)).toInt() : 0;
+    DFR1216SensorScheduler::Kind kind;
+    if (port < 0 || port >= DFR1216SensorScheduler::PORTS || period < 0 ||
+        !DFR1216SensorScheduler::kindFromName(request->arg(FPSTR(DFR1216Consts::param_type)).c_str(), kind) ||
+        !configureSensor(static_cast<uint8_t>(port), kind, static_cast<uint32_t>(period)))
+    {
+        ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, FPSTR(DFR1216Consts::msg_invalid_sensor));
+        return;
+    }
+    ResponseHelper::sendSuccess(request);
+}
+
 bool DFR1216Service::setLEDColor(uint8_t led_index, uint8_t red, uint8_t green, uint8_t blue, uint8_t brightness)
 {
     if (!isServiceStarted())
@@ -725,6 +1111,107 @@ bool DFR1216Service::messageHandler(const std::string &message,
         return true;
     }
 
+    // 0x35 GET_BUS_STATS [flags:1B optional, bit0 = reset after read] → [action][ok][binary stats]
+    //   [version:1B][classes:1B] then per class 6×u32 (writes,reads,retries,nacks,errors,failures)
+    //   [buckets:1B] then buckets×u32, then u32 transactions, duration avg/max us,
+    //   mutex acquisitions, contended, wait avg/max us. All integers little-endian.
+    case DFR1216Consts::udp_action_get_bus_stats:
+    {
+        const bool reset = len >= 2 && (d[1] & DFR1216Consts::udp_bus_stats_flag_reset);
+        const sBusStats_t stats = DFR1216::getBusStats();
+        if (reset)
+            DFR1216::resetBusStats();
+
+        udp_build_response(action, UDPProto::udp_resp_ok, nullptr, resp);
+        resp += static_cast<char>(DFR1216Consts::udp_bus_stats_version);
+        resp += static_cast<char>(eRegClassCount);
+        for (uint8_t c = 0; c < eRegClassCount; ++c)
+        {
+            const sBusClassStats_t &cls = stats.classes[c];
+            appendU32(resp, cls.writes);
+            appendU32(resp, cls.reads);
+            appendU32(resp, cls.retries);
+            appendU32(resp, cls.nacks);
+            appendU32(resp, cls.errors);
+            appendU32(resp, cls.failures);
+        }
+        resp += static_cast<char>(BUS_HIST_BUCKETS);
+        for (uint8_t bucket = 0; bucket < BUS_HIST_BUCKETS; ++bucket)
+            appendU32(resp, stats.durationHist[bucket]);
+        appendU32(resp, stats.transactions);
+        appendU32(resp, stats.transactions ? static_cast<uint32_t>(stats.durationSumUs / stats.transactions) : 0);
+        appendU32(resp, stats.durationMaxUs);
+        appendU32(resp, stats.mutexAcquisitions);
+        appendU32(resp, stats.mutexContended);
+        appendU32(resp, stats.mutexContended ? static_cast<uint32_t>(stats.mutexWaitSumUs / stats.mutexContended) : 0);
+        appendU32(resp, stats.mutexWaitMaxUs);
+        break;
+    }
+
+    // 0x36 GET_SENSORS (no params) → [action][ok][version:1B][count:1B] then per configured port
+    //   [port:1B][type:1B][status:1B][value×100:i32][humidity×100:i32][age_ms:u32][count:u32][failures:u32]
+    //   age_ms = 0xFFFFFFFF until the first reading. All integers little-endian.
+    case DFR1216Consts::udp_action_get_sensors:
+    {
+        const uint32_t now = millis();
+        udp_build_response(action, UDPProto::udp_resp_ok, nullptr, resp);
+        resp += static_cast<char>(DFR1216Consts::udp_sensors_version);
+        const size_t count_at = resp.size();
+        resp += static_cast<char>(0);
+        uint8_t count = 0;
+        for (uint8_t port = 0; port < DFR1216SensorScheduler::PORTS; ++port)
+        {
+            const DFR1216SensorScheduler::Reading reading = sensors.read(port);
+            if (reading.kind == DFR1216SensorScheduler::Kind::NONE)
+                continue;
+            resp += static_cast<char>(port);
+            resp += static_cast<char>(reading.kind);
+            resp += static_cast<char>(reading.status);
+            appendU32(resp, static_cast<uint32_t>(static_cast<int32_t>(lroundf(reading.value * 100.0f))));
+            appendU32(resp, static_cast<uint32_t>(static_cast<int32_t>(lroundf(reading.humidity * 100.0f))));
+            appendU32(resp, reading.timestamp_ms ? now - reading.timestamp_ms : 0xFFFFFFFFUL);
+            appendU32(resp, reading.count);
+            appendU32(resp, reading.failures);
+            count++;
+        }
+        resp[count_at] = static_cast<char>(count);
+        break;
+    }
+
+    // 0x37 GET_SENSOR_SCANS [since:u32 optional] → [action][ok][version:1B][count:1B][next:u32][lost:u32]
+    //   then per scan [seq:u32][t_ms:u32][adc_mask:1B][din_mask:1B][din_levels:1B][adc:6×u16]
+    //   Up to udp_scans_max scans per reply; ask again from `next`. All integers little-endian.
+    case DFR1216Consts::udp_action_get_sensor_scans:
+    {
+        uint32_t since = 0;
+        if (len >= 5)
+            since = d[1] | (d[2] << 8) | (d[3] << 16) | (static_cast<uint32_t>(d[4]) << 24);
+        DFR1216SensorScheduler::ScanFrame frames[DFR1216Consts::udp_scans_max];
+        uint32_t lost = 0;
+        const uint16_t count = sensors.readScans(since, frames, DFR1216Consts::udp_scans_max, &lost);
+
+        udp_build_response(action, UDPProto::udp_resp_ok, nullptr, resp);
+        resp += static_cast<char>(DFR1216Consts::udp_scans_version);
+        resp += static_cast<char>(count);
+        appendU32(resp, count ? frames[count - 1].sequence + 1 : sensors.nextScanSequence());
+        appendU32(resp, lost);
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            const DFR1216SensorScheduler::ScanFrame &frame = frames[i];
+            appendU32(resp, frame.sequence);
+            appendU32(resp, frame.timestamp_ms);
+            resp += static_cast<char>(frame.adc_mask);
+            resp += static_cast<char>(frame.din_mask);
+            resp += static_cast<char>(frame.din_levels);
+            for (uint8_t port = 0; port < DFR1216SensorScheduler::IO_PORTS; ++port)
+            {
+                resp += static_cast<char>(frame.adc[port] & 0xFF);
+                resp += static_cast<char>(frame.adc[port] >> 8);
+            }
+        }
+        break;
+    }
+
     default:
     {
         udp_build_response(action, UDPProto::udp_resp_unknown_cmd, nullptr, resp);
@@ -738,12 +1225,45 @@ bool DFR1216Service::messageHandler(const std::string &message,
 
 bool DFR1216Service::saveSettings()
 {
-    // To be implemented if needed
-    return true;
+    if (!settings_service_)
+    {
+        if (logger)
+            logger->error(getServiceName() + ": Settings service not available");
+        return false;
+    }
+    // Sensor ports: "type:period_ms" per port, comma separated
+    std::string ports;
+    for (uint8_t port = 0; port < DFR1216SensorScheduler::PORTS; ++port)
+    {
+        if (port)
+            ports += ',';
+        ports += DFR1216SensorScheduler::kindName(sensors.kind(port));
+        ports += ':' + std::to_string(sensors.period(port));
+    }
+    return settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(DFR1216Consts::settings_key_sensors)), ports);
 }
 
 bool DFR1216Service::loadSettings()
 {
-    // To be implemented if needed
+    if (!settings_service_)
+    {
+        if (logger)
+            logger->error(getServiceName() + ": Settings service not available");
+        return false;
+    }
+    const std::string ports = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(DFR1216Consts::settings_key_sensors)));
+    const char *cursor = ports.c_str();
+    for (uint8_t port = 0; port < DFR1216SensorScheduler::PORTS && *cursor; ++port)
+    {
+        char name[12] = {};
+        unsigned period = 0;
+        DFR1216SensorScheduler::Kind kind;
+        if (sscanf(cursor, "%11[^:,]:%u", name, &period) == 2 && DFR1216SensorScheduler::kindFromName(name, kind))
+            configureSensor(port, kind, period);
+        const char *next = strchr(cursor, ',');
+        if (!next)
+            break;
+        cursor = next + 1;
+    }
     return true;
 }
@@ -5,18 +5,37 @@
  *          - GET /api/webcam/snapshot - Capture and return a JPEG snapshot from the camera
  *          - GET /api/webcam/stream - Stream MJPEG video using multipart/x-mixed-replace
  *          - GET /api/webcam/status - Get camera initialization status and current settings
+ *          - GET /api/webcam/encoder - Shared JPEG encoder statistics (encoded vs delivered frames)
+ *          - GET/PUT /api/webcam/rate - Stream rate controller state and bounds
  *
+ *          The camera task's frames go through a single-slot mailbox that only keeps
+ *          the latest one (FrameMailbox); nothing waits in a queue for a consumer.
+ *          A single encoder task converts each camera frame to JPEG once, while at least
+ *          one consumer is subscribed, and publishes it through a JpegFanout; every stream
+ *          client and snapshot sends the latest published frame at its own pace. A
+ *          StreamRateController lowers the JPEG quality, skips camera frames and, if
+ *          allowed, steps the frame size down while stream clients fall behind.
+ *
+ *          UDP actions (service id 0x6, also over the WebSocket bridge): a peer
+ *          subscribes (0x61) and is then pushed every new frame as FrameTransport
+ *          fragments (0x62) until its lease ends or it unsubscribes (0x63); 0x64
+ *          returns its counters. Fragments are never retransmitted.
  */
 
 #include "services/WebcamService.h"
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include <memory>
+#include <new>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include <driver/i2s.h>
 #include <unihiker_k10.h>
 #include "IsOpenAPIInterface.h"
 #include "FlashStringHelper.h"
 #include "services/AmakerBotService.h"
+#include "services/UDPService.h"
+#include "services/HTTPService.h"
 #include <img_converters.h>
 #include <Preferences.h>
 #define LOG_LOCAL_LEVEL ESP_LOG_DEBUG
@@ -26,6 +45,9 @@
 extern AsyncWebServer webserver;
 extern UNIHIKER_K10 unihiker;
 extern AmakerBotService amakerbot_service;
+extern UDPService udp_service;
+extern class HTTPService http_service;
+extern uint32_t ws_client_id_context;
 QueueHandle_t xQueueCamera; // Camera frame queue from unihiker_k10
 
 // WebcamService constants namespace
@@ -41,7 +63,6 @@ namespace WebcamConsts
     constexpr const char msg_not_initialized[] PROGMEM = "Camera not initialized.";
     constexpr const char msg_capture_error[] PROGMEM = "Failed to capture image.";
     constexpr const char msg_camera_capture_failed[] PROGMEM = "Camera capture failed";
-    constexpr const char msg_streaming_active[] PROGMEM = "Snapshot unavailable during active streaming. Stop stream first.";
     constexpr const char service_name[] PROGMEM = "Webcam Service";
     constexpr const char service_path[] PROGMEM = "webcam/v1";
     constexpr const char field_initialized[] PROGMEM = "initialized";
@@ -79,6 +100,129 @@ namespace WebcamConsts
     constexpr const char pref_saturation[] PROGMEM = "saturation";
     constexpr uint16_t stream_delay_ms = 33; // ~30fps target frame rate
 
+    // ─── Shared JPEG encoder ─────────────────────────────────────────
+    constexpr size_t encoder_task_stack = 6144;        ///< Also re-registers the camera for the rate controller
+    constexpr uint8_t encoder_task_priority = 4;
+    constexpr uint8_t encoder_task_core = 1;
+    constexpr uint16_t encoder_idle_ms = 500;          ///< Re-check period with no subscriber
+    constexpr uint16_t camera_lock_ms = 1000;          ///< Framesize change waiting for the encoder
+    constexpr uint16_t snapshot_wait_ms = 500;         ///< Snapshot waiting for a fresh frame
+    constexpr uint16_t snapshot_poll_ms = 10;
+    constexpr size_t mailbox_task_stack = 2048;
+    constexpr uint8_t mailbox_task_priority = 5;       ///< Above the encoder: the queue never fills
+    constexpr uint8_t mailbox_task_core = 1;
+    constexpr uint8_t reinit_flush_frames = 3;         ///< Frames discarded after a framesize change
+    constexpr uint16_t reinit_flush_ms = 100;
+    constexpr const char msg_mailbox_task_fail[] PROGMEM = "Failed to create camera mailbox task";
+    // PSRAM buffers the encoder writes into: ~15-40 KB per HVGA frame at quality 80,
+    // 4 + 4 leave one buffer per stream client of a handful plus the latest frame
+    constexpr JpegPoolClass jpeg_pool_classes[] = {{24 * 1024, 4}, {48 * 1024, 4}, {96 * 1024, 2}};
+    constexpr const char msg_pool_fail[] PROGMEM = "JPEG buffer pool unavailable (no PSRAM?), encoding to heap";
+    constexpr const char action_encoder[] PROGMEM = "encoder";
+    constexpr const char desc_encoder[] PROGMEM = "Shared JPEG encoder statistics: camera frames encoded (once, whatever the number of clients) versus frames delivered to stream clients and snapshots, frames skipped by slow clients, frames superseded before anyone sent them, camera frames dropped before encoding and the age of the camera frames taken, encode time, size of the latest frame, bytes copied and heap operations per delivered frame, PSRAM buffer pool usage, frame transport peers and heap fragmentation.";
+    constexpr const char resp_encoder_ok[] PROGMEM = "Encoder statistics";
+    constexpr const char msg_encoder_task_fail[] PROGMEM = "Failed to create JPEG encoder task";
+    constexpr const char field_subscribers[] PROGMEM = "subscribers";
+    constexpr const char field_encoded[] PROGMEM = "encoded";
+    constexpr const char field_delivered[] PROGMEM = "delivered";
+    constexpr const char field_skipped[] PROGMEM = "skipped";
+    constexpr const char field_superseded[] PROGMEM = "superseded";
+    constexpr const char field_camera_dropped[] PROGMEM = "camera_dropped";
+    constexpr const char field_live_frames[] PROGMEM = "live_frames";
+    constexpr const char field_last_size[] PROGMEM = "last_size";
+    constexpr const char field_encode_us[] PROGMEM = "encode_us";
+    constexpr const char field_min[] PROGMEM = "min";
+    constexpr const char field_avg[] PROGMEM = "avg";
+    constexpr const char field_max[] PROGMEM = "max";
+    constexpr const char field_last[] PROGMEM = "last";
+    constexpr const char field_copied_kib[] PROGMEM = "copied_kib";
+    constexpr const char field_copied_per_frame[] PROGMEM = "copied_per_frame";
+    constexpr const char field_heap_ops[] PROGMEM = "heap_ops";
+    constexpr const char field_heap_ops_per_frame[] PROGMEM = "heap_ops_per_frame";
+    constexpr const char field_pool[] PROGMEM = "pool";
+    constexpr const char field_bytes[] PROGMEM = "bytes";
+    constexpr const char field_slots[] PROGMEM = "slots";
+    constexpr const char field_in_use[] PROGMEM = "in_use";
+    constexpr const char field_high_water[] PROGMEM = "high_water";
+    constexpr const char field_takes[] PROGMEM = "takes";
+    constexpr const char field_exhausted[] PROGMEM = "exhausted";
+    constexpr const char field_overflows[] PROGMEM = "overflows";
+    constexpr const char field_fallbacks[] PROGMEM = "fallbacks";
+    constexpr const char field_classes[] PROGMEM = "classes";
+    constexpr const char field_size[] PROGMEM = "size";
+    constexpr const char field_count[] PROGMEM = "count";
+    constexpr const char field_heap[] PROGMEM = "heap";
+    constexpr const char field_internal[] PROGMEM = "internal";
+    constexpr const char field_psram[] PROGMEM = "psram";
+    constexpr const char field_free[] PROGMEM = "free";
+    constexpr const char field_largest[] PROGMEM = "largest";
+    constexpr const char field_min_free[] PROGMEM = "min_free";
+    constexpr const char field_frag_pct[] PROGMEM = "frag_pct";
+    constexpr const char field_camera[] PROGMEM = "camera";
+    constexpr const char field_generation[] PROGMEM = "generation";
+    constexpr const char field_taken[] PROGMEM = "taken";
+    constexpr const char field_dropped[] PROGMEM = "dropped";
+    constexpr const char field_full[] PROGMEM = "full";
+    constexpr const char field_age_us[] PROGMEM = "age_us";
+
+    // ─── Stream rate controller ──────────────────────────────────────
+    constexpr const char action_rate[] PROGMEM = "rate";
+    constexpr const char pref_rate[] PROGMEM = "rate";
+    constexpr const char desc_rate[] PROGMEM = "Stream rate controller: bounds and control-loop state. Every 500 ms the worst capture-to-sent latency of the stream clients is compared with target_ms; above it the JPEG quality goes down, then camera frames are skipped, then (max_downsize > 0) the frame size steps down; well below it for 2 s the last step is undone.";
+    constexpr const char desc_rate_settings[] PROGMEM = "Update the stream rate controller bounds (saved). Only provided fields are updated; the state is clamped into the new bounds.";
+    constexpr const char resp_rate_ok[] PROGMEM = "Rate controller bounds and state";
+    constexpr const char resp_rate_updated[] PROGMEM = "Rate controller bounds updated";
+    constexpr const char msg_rate_updated[] PROGMEM = "Rate controller updated: ";
+    constexpr const char msg_rate_framesize[] PROGMEM = "Rate controller frame size step: ";
+    constexpr const char field_config[] PROGMEM = "config";
+    constexpr const char field_state[] PROGMEM = "state";
+    constexpr const char field_enabled[] PROGMEM = "enabled";
+    constexpr const char field_target_ms[] PROGMEM = "target_ms";
+    constexpr const char field_quality_min[] PROGMEM = "quality_min";
+    constexpr const char field_quality_max[] PROGMEM = "quality_max";
+    constexpr const char field_max_skip[] PROGMEM = "max_skip";
+    constexpr const char field_max_downsize[] PROGMEM = "max_downsize";
+    constexpr const char field_skip[] PROGMEM = "skip";
+    constexpr const char field_downsize[] PROGMEM = "downsize";
+    constexpr const char field_base_framesize[] PROGMEM = "base_framesize";
+    constexpr const char field_stream_clients[] PROGMEM = "stream_clients";
+    constexpr const char field_latency_avg_ms[] PROGMEM = "latency_avg_ms";
+    constexpr const char field_latency_max_ms[] PROGMEM = "latency_max_ms";
+    constexpr const char field_encode_avg_us[] PROGMEM = "encode_avg_us";
+    constexpr const char field_last_action[] PROGMEM = "last_action";
+    constexpr const char field_periods[] PROGMEM = "periods";
+    constexpr const char field_decreases[] PROGMEM = "decreases";
+    constexpr const char field_increases[] PROGMEM = "increases";
+    constexpr const char field_rate_skipped[] PROGMEM = "rate_skipped";
+
+    // ─── Frame transport (fragments to UDP / WebSocket peers) ────────
+    constexpr uint8_t udp_service_id = 0x06;  ///< Unique ID for Webcam Service (high nibble of action byte)
+    constexpr uint8_t udp_action_frame_subscribe = (udp_service_id << 4) | 0x01;    ///< [max_fps:1B optional] → [action][ok][payload_max:u16][lease_ms:u16]
+    constexpr uint8_t udp_action_frame_fragment = (udp_service_id << 4) | 0x02;     ///< Pushed to peers, FrameTransport fragment
+    constexpr uint8_t udp_action_frame_unsubscribe = (udp_service_id << 4) | 0x03;  ///< (no params)
+    constexpr uint8_t udp_action_frame_stats = (udp_service_id << 4) | 0x04;        ///< (no params) → [action][ok][binary counters]
+    constexpr uint8_t udp_action_min = (udp_service_id << 4) | 0x01;  ///< lowest valid action code
+    constexpr uint8_t udp_action_max = (udp_service_id << 4) | 0x04;  ///< highest valid action code
+    constexpr uint8_t udp_frame_stats_version = 1;
+    constexpr uint8_t transport_max_fps = 30;
+    constexpr size_t transport_task_stack = 4096;
+    constexpr uint8_t transport_task_priority = 3;     ///< Below the encoder
+    constexpr uint8_t transport_task_core = 1;
+    constexpr uint16_t transport_idle_ms = 500;        ///< Lease check period with no peer
+    constexpr uint8_t transport_yield_fragments = 8;   ///< Fragments sent between two yields to the network stack
+    constexpr const char msg_transport_task_fail[] PROGMEM = "Failed to create frame transport task";
+    constexpr const char field_transport[] PROGMEM = "transport";
+    constexpr const char field_peers[] PROGMEM = "peers";
+    constexpr const char field_address[] PROGMEM = "address";
+    constexpr const char field_port[] PROGMEM = "port";
+    constexpr const char field_ws_client[] PROGMEM = "ws_client";
+    constexpr const char field_max_fps[] PROGMEM = "max_fps";
+    constexpr const char field_lease_ms[] PROGMEM = "lease_ms";
+    constexpr const char field_frames_sent[] PROGMEM = "frames_sent";
+    constexpr const char field_frames_aborted[] PROGMEM = "frames_aborted";
+    constexpr const char field_frames_skipped[] PROGMEM = "frames_skipped";
+    constexpr const char field_fragments_sent[] PROGMEM = "fragments_sent";
+
     // Framesize name mappings
     constexpr const char fs_96x96[] PROGMEM = "96X96";
     constexpr const char fs_qqvga[] PROGMEM = "QQVGA";
@@ -152,10 +296,19 @@ namespace WebcamConsts
     constexpr uint8_t wav_header_size = 44;
 }
 
+/**
+ * @brief JPEG pool allocator: PSRAM, keeps frame buffers out of internal RAM
+ */
+static void *psramAlloc(size_t size)
+{
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
 /**
  * @brief Initialize the camera service using register_camera()
- * @details Creates the camera queue and registers camera with hardware
- *          without UI display components
+ * @details Creates the camera queue and the task moving its frames into the
+ *          latest-frame mailbox, and registers camera with hardware without UI
+ *          display components
  */
 bool WebcamService::initializeService()
 {
@@ -181,6 +334,26 @@ bool WebcamService::initializeService()
         }
     }
 
+    if (!camera_mutex_)
+        camera_mutex_ = xSemaphoreCreateMutex();
+    if (!frame_posted_)
+        frame_posted_ = xSemaphoreCreateBinary();
+
+    // Empties the camera queue into the latest-frame mailbox from the first frame on
+    if (!mailbox_task_ &&
+        xTaskCreatePinnedToCore(mailboxTaskStatic, "cam_mbox",
+                                WebcamConsts::mailbox_task_stack,
+                                this,
+                                WebcamConsts::mailbox_task_priority,
+                                &mailbox_task_,
+                                WebcamConsts::mailbox_task_core) != pdPASS)
+    {
+        mailbox_task_ = nullptr;
+        logger->error(progmem_to_string(WebcamConsts::msg_mailbox_task_fail));
+        setServiceStatus(INITIALIZED_FAILED);
+        return false;
+    }
+
     // Load framesize from preferences if saved, otherwise use default
     Preferences prefs;
     if (prefs.begin(progmem_to_string(WebcamConsts::pref_namespace).c_str(), true))
@@ -200,15 +373,16 @@ bool WebcamService::initializeService()
     {
         current_framesize_ = WebcamConsts::frame_size;
     }
+    base_framesize_ = current_framesize_;
 
     // Register camera using low-level API (no screen display)
     // Use RGB565 format - more universally supported than JPEG
-    // The frame will be converted to JPEG in handleSnapshot()
+    // Frames are converted to JPEG by the shared encoder task
     register_camera(PIXFORMAT_RGB565, current_framesize_, WebcamConsts::camera_queue_length, xQueueCamera);
 
     // Suppress noisy "failed to get the frame" warnings from camera HAL.
-    // These occur whenever the internal capture task cannot enqueue a frame
-    // (queue full) which is normal when no client is consuming frames.
+    // These occur whenever the internal capture task cannot get a free frame
+    // buffer, which is normal while a consumer holds one and the mailbox another.
     esp_log_level_set("cam_hal", ESP_LOG_ERROR);
 
     // Verify camera sensor is accessible
@@ -244,7 +418,42 @@ bool WebcamService::startService()
         // Load saved settings if available
         loadSettings();
 
-        // Start camera capture task
+        // Frame buffers, allocated once (the encoder is not running yet the first time)
+        if (!jpeg_pool_.ready() &&
+            !jpeg_pool_.begin(WebcamConsts::jpeg_pool_classes,
+                              sizeof(WebcamConsts::jpeg_pool_classes) / sizeof(WebcamConsts::jpeg_pool_classes[0]),
+                              psramAlloc, heap_caps_free))
+        {
+            logger->warning(progmem_to_string(WebcamConsts::msg_pool_fail));
+        }
+
+        // Start the shared JPEG encoder (idle until a consumer subscribes)
+        if (!encoder_task_ &&
+            xTaskCreatePinnedToCore(encoderTaskStatic, "jpeg_enc",
+                                    WebcamConsts::encoder_task_stack,
+                                    this,
+                                    WebcamConsts::encoder_task_priority,
+                                    &encoder_task_,
+                                    WebcamConsts::encoder_task_core) != pdPASS)
+        {
+            encoder_task_ = nullptr;
+            logger->error(progmem_to_string(WebcamConsts::msg_encoder_task_fail));
+            setServiceStatus(START_FAILED);
+            return false;
+        }
+
+        // Frame transport (idle until a peer subscribes); streaming over HTTP works without it
+        if (!transport_task_ &&
+            xTaskCreatePinnedToCore(transportTaskStatic, "frame_tx",
+                                    WebcamConsts::transport_task_stack,
+                                    this,
+                                    WebcamConsts::transport_task_priority,
+                                    &transport_task_,
+                                    WebcamConsts::transport_task_core) != pdPASS)
+        {
+            transport_task_ = nullptr;
+            logger->error(progmem_to_string(WebcamConsts::msg_transport_task_fail));
+        }
 
 #ifdef VERBOSE_DEBUG
         logger->debug(getServiceName() + " " + getStatusString());
@@ -313,16 +522,16 @@ bool WebcamService::reinitializeWithFramesize(framesize_t framesize)
     logger->info("Stopping camera service...");
     bool was_initialized = initialized_;
 
-    // Flush and clear queue
-    camera_fb_t *stale_fb = nullptr;
-    while (xQueueReceive(xQueueCamera, &stale_fb, 0) == pdTRUE)
+    // Keep the encoder away from the camera while it is re-registered
+    if (camera_mutex_ && xSemaphoreTake(camera_mutex_, pdMS_TO_TICKS(WebcamConsts::camera_lock_ms)) != pdTRUE)
     {
-        if (stale_fb)
-        {
-            esp_camera_fb_return(stale_fb);
-        }
+        logger->error("Camera busy, framesize not changed");
+        return false;
     }
 
+    // Give the latest frame back before its buffer goes away
+    clearCameraMailbox();
+
     // Step 2: Deinitialize camera hardware
     logger->info("Deinitializing camera hardware...");
     esp_err_t err = esp_camera_deinit();
@@ -331,6 +540,8 @@ bool WebcamService::reinitializeWithFramesize(framesize_t framesize)
         logger->error("Failed to deinitialize camera: " + std::to_string(err));
         initialized_ = false;
         setServiceStatus(INITIALIZED_FAILED);
+        if (camera_mutex_)
+            xSemaphoreGive(camera_mutex_);
         return false;
     }
 
@@ -352,6 +563,8 @@ bool WebcamService::reinitializeWithFramesize(framesize_t framesize)
         logger->error("Failed to get camera sensor after reinitialization");
         initialized_ = false;
         setServiceStatus(INITIALIZED_FAILED);
+        if (camera_mutex_)
+            xSemaphoreGive(camera_mutex_);
         return false;
     }
 
@@ -366,25 +579,33 @@ bool WebcamService::reinitializeWithFramesize(framesize_t framesize)
     // Wait for camera to stabilize
     delay(200);
 
-    // Flush initial frames
-    int flushed = 0;
-    while (flushed < 3 && xQueueReceive(xQueueCamera, &stale_fb, pdMS_TO_TICKS(100)) == pdTRUE)
+    // Discard the first frames of the new size (sensor still adjusting)
+    uint32_t generation = 0;
+    for (uint8_t flushed = 0; flushed < WebcamConsts::reinit_flush_frames; ++flushed)
     {
-        if (stale_fb)
-        {
-            esp_camera_fb_return(stale_fb);
-            flushed++;
-        }
+        camera_fb_t *stale_fb = takeCameraFrame(generation, WebcamConsts::reinit_flush_ms);
+        if (!stale_fb)
+            break;
+        esp_camera_fb_return(stale_fb);
     }
 
+    // The latest frame has the old size: consumers wait for the first new one
+    portENTER_CRITICAL(&jpeg_lock_);
+    JpegFrame *stale = jpeg_fanout_.clear();
+    portEXIT_CRITICAL(&jpeg_lock_);
+    freeFrame(stale);
+
+    if (camera_mutex_)
+        xSemaphoreGive(camera_mutex_);
+
     logger->info("Camera reinitialized successfully with framesize " + std::to_string(framesize));
     return true;
 }
 
 /**
- * @brief Capture a snapshot from the camera queue
- * @details Retrieves the latest frame from xQueuWebcam queue populated by
- *          the camera task started via setBgCamerImage(true)
+ * @brief Capture a snapshot from the camera mailbox
+ * @details Takes the latest camera frame if one is waiting, otherwise waits for
+ *          the next one. The caller gives it back with esp_camera_fb_return().
  * @return Camera frame buffer pointer, or nullptr if unavailable
  */
 camera_fb_t *WebcamService::captureSnapshot()
@@ -395,60 +616,576 @@ camera_fb_t *WebcamService::captureSnapshot()
         return nullptr;
     }
 
-    // Check if queue exists
-    if (!xQueueCamera)
+    // One camera frame consumer at a time (the encoder takes frames too)
+    if (xSemaphoreTake(camera_mutex_, pdMS_TO_TICKS(WebcamConsts::camera_rate_ms)) != pdTRUE)
     {
-        logger->error("Camera queue not initialized");
         return nullptr;
     }
+    camera_fb_t *fb = takeCameraFrame(snapshot_generation_, WebcamConsts::camera_rate_ms);
+    xSemaphoreGive(camera_mutex_);
+
+    if (!fb)
+    {
+#ifdef VERBOSE_DEBUG
+        logger->debug("No frame available in mailbox after " + std::to_string(WebcamConsts::camera_rate_ms) + "ms timeout");
+#endif
+        return nullptr;
+    }
+
+    return fb;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Latest camera frame mailbox
+// ═══════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Static FreeRTOS task entry point
+ */
+void WebcamService::mailboxTaskStatic(void *param)
+{
+    static_cast<WebcamService *>(param)->mailboxLoop();
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Move each frame of the camera queue into the mailbox
+ * @details The camera task (unihiker_k10) only knows a FIFO queue: this task
+ *          receives every frame as soon as it is queued and posts it, the frame
+ *          it replaces goes straight back to the camera driver. Frames therefore
+ *          never wait in the queue, whether or not anybody consumes them.
+ */
+void WebcamService::mailboxLoop()
+{
+    for (;;)
+    {
+        camera_fb_t *fb = nullptr;
+        if (xQueueReceive(xQueueCamera, &fb, portMAX_DELAY) != pdTRUE || !fb)
+            continue;
+
+        const int64_t capture_us = static_cast<int64_t>(fb->timestamp.tv_sec) * 1000000LL + fb->timestamp.tv_usec;
+        portENTER_CRITICAL(&mailbox_lock_);
+        camera_fb_t *previous = static_cast<camera_fb_t *>(camera_mailbox_.post(fb, capture_us));
+        portEXIT_CRITICAL(&mailbox_lock_);
+        if (previous)
+            esp_camera_fb_return(previous);
+        xSemaphoreGive(frame_posted_);
+    }
+}
+
+camera_fb_t *WebcamService::takeCameraFrame(uint32_t &generation, uint32_t wait_ms)
+{
+    const int64_t deadline_us = esp_timer_get_time() + static_cast<int64_t>(wait_ms) * 1000;
+    for (;;)
+    {
+        const int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&mailbox_lock_);
+        void *frame = camera_mailbox_.take(generation, now_us);
+        portEXIT_CRITICAL(&mailbox_lock_);
+        if (frame)
+            return static_cast<camera_fb_t *>(frame);
+
+        // A give left over from a frame already taken only costs one more pass
+        const int64_t left_us = deadline_us - now_us;
+        if (left_us <= 0 ||
+            xSemaphoreTake(frame_posted_, pdMS_TO_TICKS(left_us / 1000) + 1) != pdTRUE)
+            return nullptr;
+    }
+}
+
+void WebcamService::clearCameraMailbox()
+{
+    portENTER_CRITICAL(&mailbox_lock_);
+    camera_fb_t *previous = static_cast<camera_fb_t *>(camera_mailbox_.clear());
+    portEXIT_CRITICAL(&mailbox_lock_);
+    if (previous)
+        esp_camera_fb_return(previous);
+}
 
-    // Flush old frames and get the most recent one
-    // This ensures we always get the latest captured image, not a stale frame
-    camera_fb_t *fb = nullptr;
-    camera_fb_t *latest_fb = nullptr;
+// ═══════════════════════════════════════════════════════════════════════════
+// Shared JPEG encoder
+// ═══════════════════════════════════════════════════════════════════════════
 
-    // Keep reading frames until queue is empty, keeping only the last one
-    while (xQueueReceive(xQueueCamera, &fb, 0) == pdTRUE)
+/**
+ * @brief Static FreeRTOS task entry point
+ */
+void WebcamService::encoderTaskStatic(void *param)
+{
+    static_cast<WebcamService *>(param)->encoderLoop();
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Encode each camera frame once and publish it to every consumer
+ * @details Runs only while a consumer is subscribed; otherwise the mailbox
+ *          keeps replacing (and releasing) the camera frames. It always takes
+ *          the latest frame: those posted while it was encoding are dropped.
+ *          While stream clients are connected the rate controller sets the JPEG
+ *          quality, which camera frames are skipped and the frame size.
+ */
+void WebcamService::encoderLoop()
+{
+    uint32_t generation = 0; // Last camera frame taken
+    for (;;)
     {
-        // Return previous frame if we had one
-        if (latest_fb != nullptr)
+        portENTER_CRITICAL(&jpeg_lock_);
+        const uint8_t subscribers = jpeg_fanout_.subscribers();
+        const bool streaming = stream_clients_ != 0;
+        if (streaming)
+            rate_.update(esp_timer_get_time());
+        const uint8_t quality = rate_.quality();
+        const uint8_t downsize = rate_.downsize();
+        portEXIT_CRITICAL(&jpeg_lock_);
+
+        if (initialized_ && service_status_ == STARTED)
+            applyRateFramesize(downsize);
+
+        if (!subscribers || !initialized_ || service_status_ != STARTED)
         {
-            esp_camera_fb_return(latest_fb);
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WebcamConsts::encoder_idle_ms));
+            continue;
         }
-        latest_fb = fb;
+
+        if (xSemaphoreTake(camera_mutex_, pdMS_TO_TICKS(WebcamConsts::camera_rate_ms)) != pdTRUE)
+            continue;
+
+        // The mailbox only holds the latest frame: nothing to drain
+        camera_fb_t *fb = takeCameraFrame(generation, WebcamConsts::camera_rate_ms * 2);
+        if (!fb)
+        {
+            xSemaphoreGive(camera_mutex_);
+            continue;
+        }
+
+        portENTER_CRITICAL(&jpeg_lock_);
+        const bool encode = !streaming || rate_.shouldEncode();
+        portEXIT_CRITICAL(&jpeg_lock_);
+
+        JpegFrame *frame = encode ? encodeFrame(fb, quality) : nullptr;
+        esp_camera_fb_return(fb);
+        xSemaphoreGive(camera_mutex_);
+
+        JpegFrame *stale = nullptr;
+        portENTER_CRITICAL(&jpeg_lock_);
+        if (frame)
+        {
+            if (streaming)
+                rate_.onEncoded(frame->encode_us);
+            stale = jpeg_fanout_.publish(frame);
+        }
+        portEXIT_CRITICAL(&jpeg_lock_);
+        freeFrame(stale);
+        if (frame && transport_task_)
+            xTaskNotifyGive(transport_task_);
     }
+}
+
+/**
+ * @brief Static FreeRTOS task entry point
+ */
+void WebcamService::transportTaskStatic(void *param)
+{
+    static_cast<WebcamService *>(param)->transportLoop();
+    vTaskDelete(nullptr);
+}
 
-    // If we got at least one frame, return it
-    if (latest_fb != nullptr)
+/**
+ * @brief Push each new frame to the subscribed peers
+ * @details Subscribes to the shared encoder while at least one peer holds a lease,
+ *          and is woken by the encoder on every published frame. A frame that is
+ *          superseded while it is being sent is finished; the next one sent is the
+ *          latest published, the frames in between are skipped for every peer.
+ */
+void WebcamService::transportLoop()
+{
+    bool subscribed = false;
+    uint32_t last_seq = 0;      // Last frame taken
+    uint32_t delivered_seq = 0; // Last frame some peer got whole
+    uint16_t frame_id = 0;
+    FrameTransport::Target targets[FrameTransport::MAX_PEERS];
+
+    for (;;)
     {
-        return latest_fb;
+        portENTER_CRITICAL(&jpeg_lock_);
+        const uint8_t peers = transport_.expire(esp_timer_get_time());
+        portEXIT_CRITICAL(&jpeg_lock_);
+
+        if (peers && !subscribed)
+        {
+            subscribeFrames();
+            subscribed = true;
+        }
+        else if (!peers && subscribed)
+        {
+            unsubscribeFrames();
+            subscribed = false;
+            last_seq = 0;
+            delivered_seq = 0;
+        }
+
+        JpegFrame *frame = subscribed ? acquireFrame(last_seq) : nullptr;
+        if (!frame)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(subscribed ? WebcamConsts::camera_rate_ms * 2
+                                                               : WebcamConsts::transport_idle_ms));
+            continue;
+        }
+
+        portENTER_CRITICAL(&jpeg_lock_);
+        const uint8_t count = transport_.due(esp_timer_get_time(), targets);
+        portEXIT_CRITICAL(&jpeg_lock_);
+
+        // The transport is one consumer of the encoder (the frame is copied once into
+        // the fragments); the per-peer counts are in transport_. No rate feedback.
+        // A frame is never sent twice, even if no peer got all of it
+        if (count && sendFrameFragments(frame, ++frame_id, targets, count))
+        {
+            frameDelivered(delivered_seq, frame->seq, frame->len);
+            delivered_seq = frame->seq;
+        }
+        last_seq = frame->seq;
+        releaseFrame(frame);
     }
+}
 
-    // No frames available, wait for a new one
-    BaseType_t result = xQueueReceive(xQueueCamera, &latest_fb, WebcamConsts::camera_rate_ms / portTICK_PERIOD_MS);
-    if (result != pdTRUE)
+/**
+ * @brief Send one frame to its peers, fragment by fragment
+ * @details Each fragment is built once, then sent to every peer still receiving the
+ *          frame. A failed send (WebSocket queue full, no lwIP buffer) ends the frame
+ *          for that peer: the peer drops it, nothing is retransmitted, and the next
+ *          frame starts clean.
+ */
+uint8_t WebcamService::sendFrameFragments(const JpegFrame *frame, uint16_t frame_id,
+                                          const FrameTransport::Target *targets, uint8_t count)
+{
+    static uint8_t datagram[FrameTransport::MAX_DATAGRAM]; // Transport task only
+    const uint16_t fragments = FrameTransport::fragmentCount(frame->len);
+    uint16_t sent[FrameTransport::MAX_PEERS] = {};
+    bool failed[FrameTransport::MAX_PEERS] = {};
+    uint8_t receiving = count;
+
+    for (uint16_t index = 0; index < fragments && receiving; ++index)
     {
-#ifdef VERBOSE_DEBUG
-        logger->debug("No frame available in queue after " + std::to_string(WebcamConsts::camera_rate_ms) + "ms timeout");
-#endif
+        const size_t len = FrameTransport::buildFragment(WebcamConsts::udp_action_frame_fragment, frame_id,
+                                                         static_cast<uint64_t>(frame->capture_us),
+                                                         frame->data, frame->len, index, datagram);
+        for (uint8_t t = 0; t < count; ++t)
+        {
+            if (failed[t])
+                continue;
+            const bool ok = targets[t].ws_client
+                                ? http_service.sendWebSocketMessage(targets[t].ws_client, datagram, len)
+                                : udp_service.sendTo(datagram, len, IPAddress(targets[t].ipv4), targets[t].port);
+            if (ok)
+            {
+                sent[t]++;
+            }
+            else
+            {
+                failed[t] = true;
+                receiving--;
+            }
+        }
+        // Let the network stack drain its buffers before the next burst
+        if ((index + 1) % WebcamConsts::transport_yield_fragments == 0)
+            vTaskDelay(1);
+    }
+
+    portENTER_CRITICAL(&jpeg_lock_);
+    for (uint8_t t = 0; t < count; ++t)
+        transport_.sent(targets[t], !failed[t], sent[t]);
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return receiving;
+}
+
+/**
+ * @brief Follow the rate controller's frame size steps below the configured size
+ * @details Re-registering the camera takes about a second and drops the latest
+ *          frame; the controller only steps after several overloaded periods.
+ */
+void WebcamService::applyRateFramesize(uint8_t downsize)
+{
+    const framesize_t target = static_cast<int>(base_framesize_) > downsize
+                                   ? static_cast<framesize_t>(base_framesize_ - downsize)
+                                   : static_cast<framesize_t>(0);
+    if (target == current_framesize_)
+        return;
+    logger->info(progmem_to_string(WebcamConsts::msg_rate_framesize) + std::to_string(downsize) +
+                 " (framesize " + std::to_string(target) + ")");
+    reinitializeWithFramesize(target);
+}
+
+/**
+ * @brief jpg_out_cb writing the encoder output into a pool buffer
+ */
+struct PoolWriter
+{
+    JpegFrame *frame;
+    bool overflow;
+};
+
+static size_t poolWrite(void *arg, size_t index, const void *data, size_t len)
+{
+    PoolWriter *writer = static_cast<PoolWriter *>(arg);
+    if (index + len > writer->frame->capacity)
+    {
+        writer->overflow = true;
+        return 0; // aborts the encoding
+    }
+    memcpy(writer->frame->data + index, data, len);
+    writer->frame->len = index + len;
+    return len;
+}
+
+bool WebcamService::encodeInto(camera_fb_t *fb, uint8_t quality, JpegFrame *frame, bool &overflow)
+{
+    frame->len = 0;
+    overflow = false;
+
+    // Check actual JPEG magic bytes (0xFF 0xD8) - don't trust fb->format field
+    if (fb->len >= 2 && fb->buf[0] == 0xFF && fb->buf[1] == 0xD8)
+    {
+        if (fb->len > frame->capacity)
+        {
+            overflow = true;
+            return false;
+        }
+        memcpy(frame->data, fb->buf, fb->len);
+        frame->len = fb->len;
+        frame->copied = fb->len;
+        return true;
+    }
+
+    PoolWriter writer = {frame, false};
+    const bool ok = frame2jpg_cb(fb, quality, poolWrite, &writer);
+    overflow = writer.overflow;
+    return ok && !overflow && frame->len > 0;
+}
+
+JpegFrame *WebcamService::encodeToHeap(camera_fb_t *fb, uint8_t quality)
+{
+    JpegFrame *frame = new (std::nothrow) JpegFrame();
+    frame_heap_ops_.fetch_add(1, std::memory_order_relaxed);
+    if (!frame)
         return nullptr;
+
+    if (fb->len >= 2 && fb->buf[0] == 0xFF && fb->buf[1] == 0xD8)
+    {
+        frame->data = (uint8_t *)malloc(fb->len);
+        if (frame->data)
+        {
+            memcpy(frame->data, fb->buf, fb->len);
+            frame->len = fb->len;
+            frame->copied = fb->len;
+        }
+    }
+    else if (!frame2jpg(fb, quality, &frame->data, &frame->len))
+    {
+        frame->len = 0;
     }
+    if (frame->data)
+        frame_heap_ops_.fetch_add(1, std::memory_order_relaxed); // output buffer (frame2jpg mallocs it)
 
-    if (!latest_fb)
+    if (!frame->data || frame->len == 0)
     {
-#ifdef VERBOSE_DEBUG
-        logger->debug(progmem_to_string(WebcamConsts::msg_camera_capture_failed));
-#endif
+        freeFrame(frame);
+        return nullptr;
+    }
+    return frame;
+}
+
+JpegFrame *WebcamService::encodeFrame(camera_fb_t *fb, uint8_t quality)
+{
+    if (!fb->buf || fb->len == 0)
+        return nullptr;
+
+    const int64_t start_us = esp_timer_get_time();
+    JpegFrame *frame = nullptr;
+
+    if (jpeg_pool_.ready())
+    {
+        // Aim a quarter above the last JPEG: the scene rarely changes faster
+        portENTER_CRITICAL(&jpeg_lock_);
+        frame = jpeg_pool_.take(expected_jpeg_ + expected_jpeg_ / 4);
+        portEXIT_CRITICAL(&jpeg_lock_);
+        if (!frame)
+            return nullptr; // every buffer still held by a consumer: skip this camera frame
+
+        bool overflow = false;
+        if (!encodeInto(fb, quality, frame, overflow))
+        {
+            // Did not fit: once more in the largest free buffer, else on the heap
+            const uint32_t tried = frame->capacity;
+            portENTER_CRITICAL(&jpeg_lock_);
+            if (overflow)
+                jpeg_pool_.overflowed();
+            jpeg_pool_.give(frame);
+            frame = overflow ? jpeg_pool_.take(jpeg_pool_.largest()) : nullptr;
+            portEXIT_CRITICAL(&jpeg_lock_);
+
+            if (overflow)
+                expected_jpeg_ = tried + 1;
+            if (frame && (frame->capacity <= tried || !encodeInto(fb, quality, frame, overflow)))
+            {
+                portENTER_CRITICAL(&jpeg_lock_);
+                if (overflow)
+                    jpeg_pool_.overflowed();
+                jpeg_pool_.give(frame);
+                portEXIT_CRITICAL(&jpeg_lock_);
+                frame = nullptr;
+            }
+            if (!frame && overflow)
+            {
+                portENTER_CRITICAL(&jpeg_lock_);
+                jpeg_pool_.fellBack();
+                portEXIT_CRITICAL(&jpeg_lock_);
+                frame = encodeToHeap(fb, quality);
+            }
+        }
+    }
+    else
+    {
+        frame = encodeToHeap(fb, quality);
+    }
+
+    if (!frame)
         return nullptr;
+    expected_jpeg_ = frame->len;
+
+    frame->encode_us = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    frame->capture_us = static_cast<int64_t>(fb->timestamp.tv_sec) * 1000000LL + fb->timestamp.tv_usec;
+
+    // Multipart part header, shared by every stream client of this frame
+    constexpr size_t start_len = sizeof(WebcamConsts::boundary_start) - 1;
+    constexpr size_t end_len = sizeof(WebcamConsts::boundary_end) - 1;
+    static_assert(start_len + 10 + end_len <= sizeof(JpegFrame::part_header), "part header too long");
+    char digits[11];
+    const size_t digits_len = snprintf(digits, sizeof(digits), "%u", (unsigned)frame->len);
+    memcpy(frame->part_header, WebcamConsts::boundary_start, start_len);
+    memcpy(frame->part_header + start_len, digits, digits_len);
+    memcpy(frame->part_header + start_len + digits_len, WebcamConsts::boundary_end, end_len);
+    frame->part_header_len = static_cast<uint8_t>(start_len + digits_len + end_len);
+    return frame;
+}
+
+void WebcamService::freeFrame(JpegFrame *frame)
+{
+    if (!frame)
+        return;
+    if (jpeg_pool_.owns(frame))
+    {
+        portENTER_CRITICAL(&jpeg_lock_);
+        jpeg_pool_.give(frame);
+        portEXIT_CRITICAL(&jpeg_lock_);
+        return;
+    }
+    if (frame->data)
+    {
+        free(frame->data);
+        frame_heap_ops_.fetch_add(1, std::memory_order_relaxed);
     }
+    delete frame;
+    frame_heap_ops_.fetch_add(1, std::memory_order_relaxed);
+}
 
-    return latest_fb;
+void WebcamService::subscribeFrames(bool stream)
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    jpeg_fanout_.subscribe();
+    if (stream)
+        stream_clients_++;
+    portEXIT_CRITICAL(&jpeg_lock_);
+    if (encoder_task_)
+        xTaskNotifyGive(encoder_task_);
+}
+
+void WebcamService::unsubscribeFrames(bool stream)
+{
+    JpegFrame *stale = nullptr;
+    portENTER_CRITICAL(&jpeg_lock_);
+    jpeg_fanout_.unsubscribe();
+    // The next stream starts at the best settings (the encoder restores the frame size)
+    if (stream && stream_clients_ && !--stream_clients_)
+        rate_.reset();
+    // Nobody left: do not keep an old frame for the next consumer
+    if (!jpeg_fanout_.subscribers())
+        stale = jpeg_fanout_.clear();
+    portEXIT_CRITICAL(&jpeg_lock_);
+    freeFrame(stale);
+}
+
+JpegFrame *WebcamService::acquireFrame(uint32_t after_seq)
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    JpegFrame *frame = jpeg_fanout_.acquire(after_seq);
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return frame;
+}
+
+void WebcamService::releaseFrame(JpegFrame *frame)
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    JpegFrame *stale = jpeg_fanout_.release(frame);
+    portEXIT_CRITICAL(&jpeg_lock_);
+    freeFrame(stale);
+}
+
+void WebcamService::frameDelivered(uint32_t previous_seq, uint32_t seq, size_t copied, int64_t capture_us)
+{
+    const int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&jpeg_lock_);
+    jpeg_fanout_.delivered(previous_seq, seq, copied);
+    if (capture_us > 0 && now_us > capture_us)
+        rate_.onDelivered(static_cast<uint32_t>(now_us - capture_us));
+    portEXIT_CRITICAL(&jpeg_lock_);
+}
+
+JpegFanout::Stats WebcamService::getEncoderStats()
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    const JpegFanout::Stats stats = jpeg_fanout_.stats();
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return stats;
+}
+
+JpegBufferPool::Stats WebcamService::getPoolStats()
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    const JpegBufferPool::Stats stats = jpeg_pool_.stats();
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return stats;
+}
+
+StreamRateController WebcamService::getRateController()
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    const StreamRateController rate = rate_;
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return rate;
+}
+
+FrameTransport WebcamService::getFrameTransport()
+{
+    portENTER_CRITICAL(&jpeg_lock_);
+    const FrameTransport transport = transport_;
+    portEXIT_CRITICAL(&jpeg_lock_);
+    return transport;
+}
+
+FrameMailbox::Stats WebcamService::getCameraMailboxStats()
+{
+    portENTER_CRITICAL(&mailbox_lock_);
+    const FrameMailbox::Stats stats = camera_mailbox_.stats();
+    portEXIT_CRITICAL(&mailbox_lock_);
+    return stats;
 }
 
 /**
  * @brief Handle MJPEG streaming request
- * @details Continuously captures frames and sends them as multipart/x-mixed-replace stream
- *          Each frame is sent with proper MIME boundaries for MJPEG protocol.
+ * @details Sends the frames published by the shared encoder as a multipart/x-mixed-replace
+ *          stream. The client holds a reference to the frame it is sending and, once it is
+ *          fully sent, takes the latest published frame: a slow client skips frames instead
+ *          of delaying the others, and no client encodes anything itself.
  *          Uses AsyncWebServer's chunked response with RESPONSE_TRY_AGAIN to stream
  *          JPEG frames that are larger than the TCP send buffer (~2.8 KB) by splitting
  *          each frame (boundary header + JPEG data) across multiple callback invocations.
@@ -465,35 +1202,32 @@ void WebcamService::handleStream(AsyncWebServerRequest *request)
         return;
     }
 
-    // Mark streaming as active to prevent snapshot conflicts
-    streaming_active_ = true;
-
     /**
      * @brief Persistent state for streaming across multiple chunked callback invocations
      * @details Each JPEG frame (typically 10-50 KB) is much larger than the TCP
      *          send buffer (~2.8 KB). This struct tracks our position within the
      *          current frame so we can send it in pieces across multiple callbacks.
-     *          Freed automatically via shared_ptr when the response is destroyed.
+     *          Destroyed via shared_ptr with the response: drops the frame reference
+     *          and the subscription.
      */
     struct StreamState
     {
-        uint8_t *jpg_buf = nullptr; ///< Current JPEG frame data (malloc'd)
-        size_t jpg_len = 0;         ///< Total JPEG data length
-        size_t offset = 0;          ///< Bytes already sent from (header + jpeg)
-        char header[80] = {};       ///< MJPEG part boundary header for current frame
-        size_t header_len = 0;      ///< Length of header string
+        WebcamService *owner = nullptr;
+        JpegFrame *frame = nullptr; ///< Frame being sent (one reference held)
+        uint32_t last_seq = 0;      ///< Sequence of the last frame sent, 0 for none
+        size_t offset = 0;          ///< Bytes already sent from (part header + jpeg)
 
         ~StreamState()
         {
-            if (jpg_buf)
-            {
-                free(jpg_buf);
-                jpg_buf = nullptr;
-            }
+            if (frame)
+                owner->releaseFrame(frame);
+            owner->unsubscribeFrames(true);
         }
     };
 
     auto state = std::make_shared<StreamState>();
+    state->owner = this;
+    subscribeFrames(true);
 
     // Create async chunked response for MJPEG streaming
     AsyncWebServerResponse *response = request->beginChunkedResponse(
@@ -503,127 +1237,58 @@ void WebcamService::handleStream(AsyncWebServerRequest *request)
             // Stop streaming if service is stopped
             if (!initialized_ || service_status_ == STOPPED)
             {
-                streaming_active_ = false;
                 return 0; // End stream
             }
 
-            // --- Acquire a new frame if we don't have one in progress ---
-            if (!state->jpg_buf)
+            // --- Take the latest frame if we don't have one in progress ---
+            if (!state->frame)
             {
                 // IMPORTANT: This lambda runs on the async network task (lwIP).
-                // Never block here - drain queue with zero timeout only.
-                camera_fb_t *fb = nullptr;
-                camera_fb_t *latest_fb = nullptr;
-
-                // Drain stale frames, keep only the latest (all non-blocking)
-                while (xQueueReceive(xQueueCamera, &fb, 0) == pdTRUE)
-                {
-                    if (latest_fb)
-                    {
-                        esp_camera_fb_return(latest_fb);
-                    }
-                    latest_fb = fb;
-                }
-
-                // No frame ready yet - tell AsyncWebServer to call us again
-                if (!latest_fb || !latest_fb->buf || latest_fb->len == 0)
+                // Never block here - no newer frame yet means try again later.
+                state->frame = acquireFrame(state->last_seq);
+                if (!state->frame)
                 {
-                    if (latest_fb)
-                    {
-                        esp_camera_fb_return(latest_fb);
-                    }
                     return RESPONSE_TRY_AGAIN;
                 }
-
-                // Convert to JPEG if needed, always copying data out so we
-                // can return the camera frame buffer immediately.
-                bool is_valid_jpeg = (latest_fb->len >= 2 &&
-                                      latest_fb->buf[0] == 0xFF &&
-                                      latest_fb->buf[1] == 0xD8);
-
-                if (is_valid_jpeg)
-                {
-                    // Already JPEG - copy data so we can return the fb
-                    state->jpg_len = latest_fb->len;
-                    state->jpg_buf = (uint8_t *)malloc(state->jpg_len);
-                    if (!state->jpg_buf)
-                    {
-                        esp_camera_fb_return(latest_fb);
-                        return RESPONSE_TRY_AGAIN;
-                    }
-                    memcpy(state->jpg_buf, latest_fb->buf, state->jpg_len);
-                }
-                else
-                {
-                    // Convert RGB565 to JPEG (frame2jpg allocates via malloc)
-                    bool conversion_ok = frame2jpg(latest_fb, 80,
-                                                   &state->jpg_buf, &state->jpg_len);
-                    if (!conversion_ok || !state->jpg_buf || state->jpg_len == 0)
-                    {
-                        esp_camera_fb_return(latest_fb);
-                        if (state->jpg_buf)
-                        {
-                            free(state->jpg_buf);
-                            state->jpg_buf = nullptr;
-                        }
-                        return RESPONSE_TRY_AGAIN;
-                    }
-                }
-
-                // Return camera frame buffer as soon as possible
-                esp_camera_fb_return(latest_fb);
-
-                // Build the MJPEG part boundary header for this frame
-                state->header_len = snprintf(state->header, sizeof(state->header),
-                                             "\r\n--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
-                                             (unsigned)state->jpg_len);
                 state->offset = 0;
             }
 
-            // --- Stream current frame in chunks that fit within maxLen ---
-            size_t total_frame_size = state->header_len + state->jpg_len;
-            size_t remaining = total_frame_size - state->offset;
-            size_t to_write = (remaining < maxLen) ? remaining : maxLen;
+            // --- Serve the next slice straight out of the shared frame ---
+            // Part header (preformatted by the encoder) then JPEG data: one copy,
+            // into the server's send buffer, and no allocation per frame.
+            const JpegFrame *frame = state->frame;
+            const size_t header_len = frame->part_header_len;
+            const size_t total_frame_size = header_len + frame->len;
             size_t written = 0;
-            size_t pos = state->offset;
 
-            // Copy from header and/or JPEG data into the output buffer
-            while (written < to_write)
+            if (state->offset < header_len)
             {
-                if (pos < state->header_len)
-                {
-                    // Still within the boundary header
-                    size_t hdr_remaining = state->header_len - pos;
-                    size_t chunk = ((to_write - written) < hdr_remaining)
-                                       ? (to_write - written)
-                                       : hdr_remaining;
-                    memcpy(buffer + written, state->header + pos, chunk);
-                    written += chunk;
-                    pos += chunk;
-                }
-                else
-                {
-                    // Sending JPEG payload
-                    size_t jpg_offset = pos - state->header_len;
-                    size_t jpg_remaining = state->jpg_len - jpg_offset;
-                    size_t chunk = ((to_write - written) < jpg_remaining)
-                                       ? (to_write - written)
-                                       : jpg_remaining;
-                    memcpy(buffer + written, state->jpg_buf + jpg_offset, chunk);
-                    written += chunk;
-                    pos += chunk;
-                }
+                size_t chunk = header_len - state->offset;
+                if (chunk > maxLen)
+                    chunk = maxLen;
+                memcpy(buffer, frame->part_header + state->offset, chunk);
+                written = chunk;
+            }
+            if (written < maxLen && state->offset + written >= header_len)
+            {
+                const size_t jpg_offset = state->offset + written - header_len;
+                size_t chunk = frame->len - jpg_offset;
+                if (chunk > maxLen - written)
+                    chunk = maxLen - written;
+                memcpy(buffer + written, frame->data + jpg_offset, chunk);
+                written += chunk;
             }
 
             state->offset += written;
 
-            // If entire frame has been sent, free JPEG buffer and prepare for next frame
+            // If entire frame has been sent, release it and prepare for next frame
             if (state->offset >= total_frame_size)
             {
-                free(state->jpg_buf);
-                state->jpg_buf = nullptr;
-                state->jpg_len = 0;
-                state->header_len = 0;
+                // Capture to last byte handed to the network: grows with this client's backlog
+                frameDelivered(state->last_seq, frame->seq, total_frame_size, frame->capture_us);
+                state->last_seq = frame->seq;
+                releaseFrame(state->frame);
+                state->frame = nullptr;
                 state->offset = 0;
             }
 
@@ -636,12 +1301,9 @@ void WebcamService::handleStream(AsyncWebServerRequest *request)
     response->addHeader("Expires", "0");
     response->addHeader(progmem_to_string(RoutesConsts::header_access_control).c_str(), "*");
 
-    // Set callback to clear streaming flag when connection closes
     response->setCode(200);
     request->onDisconnect([this]()
-                          {
-        streaming_active_ = false;
-        logger->info("Client disconnected from stream"); });
+                          { logger->info("Client disconnected from stream"); });
 
     request->send(response);
     logger->info("MJPEG stream started");
@@ -1011,76 +1673,297 @@ void WebcamService::handleSnapshot(AsyncWebServerRequest *request)
         return;
     }
 
-    // Reject snapshot if streaming is active
-    if (streaming_active_)
+    // Snapshot of a frame encoded after the request, from the shared encoder.
+    // With a stream running the encoder is already busy and the wait is about
+    // one frame; otherwise the subscription wakes it up.
+    subscribeFrames();
+    portENTER_CRITICAL(&jpeg_lock_);
+    const uint32_t seen_seq = jpeg_fanout_.latestSeq();
+    portEXIT_CRITICAL(&jpeg_lock_);
+
+    JpegFrame *frame = nullptr;
+    for (uint16_t waited_ms = 0; waited_ms < WebcamConsts::snapshot_wait_ms; waited_ms += WebcamConsts::snapshot_poll_ms)
     {
-        request->send(409, RoutesConsts::mime_plain_text, progmem_to_string(WebcamConsts::msg_streaming_active).c_str());
-        return;
+        frame = acquireFrame(seen_seq);
+        if (frame)
+            break;
+        vTaskDelay(pdMS_TO_TICKS(WebcamConsts::snapshot_poll_ms));
     }
+    unsubscribeFrames();
 
-    camera_fb_t *fb = captureSnapshot();
-    if (!fb)
+    if (!frame)
     {
         request->send(503, RoutesConsts::mime_plain_text, progmem_to_string(WebcamConsts::msg_capture_error).c_str());
         return;
     }
 
-    // Validate frame buffer content
-    if (!fb->buf || fb->len == 0)
+    // The response reads the frame while it is sent: hold the reference until it is destroyed
+    struct SnapshotRef
     {
-        logger->error("Frame buffer is empty or invalid");
-        esp_camera_fb_return(fb);
-        request->send(503, RoutesConsts::mime_plain_text, "Frame buffer is empty");
-        return;
+        WebcamService *owner;
+        JpegFrame *frame;
+        ~SnapshotRef() { owner->releaseFrame(frame); }
+    };
+    auto ref = std::make_shared<SnapshotRef>(SnapshotRef{this, frame});
+
+    AsyncWebServerResponse *response = request->beginResponse(
+        RoutesConsts::mime_image_jpeg, frame->len,
+        [this, ref](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        {
+            const JpegFrame *f = ref->frame;
+            if (index >= f->len)
+                return 0;
+            size_t chunk = f->len - index;
+            if (chunk > maxLen)
+                chunk = maxLen;
+            memcpy(buffer, f->data + index, chunk);
+            if (index + chunk == f->len)
+                frameDelivered(0, f->seq, f->len);
+            return chunk;
+        });
+    response->addHeader(progmem_to_string(RoutesConsts::header_content_disposition).c_str(), progmem_to_string(WebcamConsts::inline_filename).c_str());
+    response->addHeader(progmem_to_string(RoutesConsts::header_access_control).c_str(), "*");
+    request->send(response);
+}
+
+void WebcamService::handleEncoderStats(AsyncWebServerRequest *request)
+{
+    const JpegFanout::Stats stats = getEncoderStats();
+
+    JsonDocument doc;
+    doc[FPSTR(WebcamConsts::field_subscribers)] = stats.subscribers;
+    doc[FPSTR(WebcamConsts::field_encoded)] = stats.encoded;
+    doc[FPSTR(WebcamConsts::field_delivered)] = stats.delivered;
+    doc[FPSTR(WebcamConsts::field_skipped)] = stats.skipped;
+    doc[FPSTR(WebcamConsts::field_superseded)] = stats.superseded;
+    const FrameMailbox::Stats mailbox = getCameraMailboxStats();
+    doc[FPSTR(WebcamConsts::field_camera_dropped)] = mailbox.dropped;
+    doc[FPSTR(WebcamConsts::field_live_frames)] = stats.live;
+    doc[FPSTR(WebcamConsts::field_last_size)] = stats.last_size;
+    JsonObject encode = doc[FPSTR(WebcamConsts::field_encode_us)].to<JsonObject>();
+    encode[FPSTR(WebcamConsts::field_min)] = stats.encode_us_min;
+    encode[FPSTR(WebcamConsts::field_avg)] = stats.encode_us_avg;
+    encode[FPSTR(WebcamConsts::field_max)] = stats.encode_us_max;
+    encode[FPSTR(WebcamConsts::field_last)] = stats.encode_us_last;
+
+    // Latest camera frame mailbox: frames replaced before anyone took them, and
+    // how old a camera frame is when the encoder (or a snapshot) takes it
+    JsonObject camera = doc[FPSTR(WebcamConsts::field_camera)].to<JsonObject>();
+    camera[FPSTR(WebcamConsts::field_generation)] = mailbox.generation;
+    camera[FPSTR(WebcamConsts::field_taken)] = mailbox.taken;
+    camera[FPSTR(WebcamConsts::field_dropped)] = mailbox.dropped;
+    camera[FPSTR(WebcamConsts::field_full)] = mailbox.full;
+    JsonObject age = camera[FPSTR(WebcamConsts::field_age_us)].to<JsonObject>();
+    age[FPSTR(WebcamConsts::field_min)] = mailbox.age_us_min;
+    age[FPSTR(WebcamConsts::field_avg)] = mailbox.age_us_avg;
+    age[FPSTR(WebcamConsts::field_max)] = mailbox.age_us_max;
+    age[FPSTR(WebcamConsts::field_last)] = mailbox.age_us_last;
+
+    // Copy and heap cost per delivered frame (encoder and consumers together)
+    const uint32_t heap_ops = getFrameHeapOps();
+    doc[FPSTR(WebcamConsts::field_copied_kib)] = static_cast<uint32_t>(stats.copied_bytes >> 10);
+    doc[FPSTR(WebcamConsts::field_copied_per_frame)] = stats.delivered ? static_cast<uint32_t>(stats.copied_bytes / stats.delivered) : 0;
+    doc[FPSTR(WebcamConsts::field_heap_ops)] = heap_ops;
+    doc[FPSTR(WebcamConsts::field_heap_ops_per_frame)] = stats.delivered ? static_cast<float>(heap_ops) / stats.delivered : 0.0f;
+
+    const JpegBufferPool::Stats pool_stats = getPoolStats();
+    JsonObject pool = doc[FPSTR(WebcamConsts::field_pool)].to<JsonObject>();
+    pool[FPSTR(WebcamConsts::field_ready)] = pool_stats.slots != 0;
+    pool[FPSTR(WebcamConsts::field_bytes)] = pool_stats.bytes;
+    pool[FPSTR(WebcamConsts::field_slots)] = pool_stats.slots;
+    pool[FPSTR(WebcamConsts::field_in_use)] = pool_stats.in_use;
+    pool[FPSTR(WebcamConsts::field_high_water)] = pool_stats.high_water;
+    pool[FPSTR(WebcamConsts::field_takes)] = pool_stats.takes;
+    pool[FPSTR(WebcamConsts::field_exhausted)] = pool_stats.exhausted;
+    pool[FPSTR(WebcamConsts::field_overflows)] = pool_stats.overflows;
+    pool[FPSTR(WebcamConsts::field_fallbacks)] = pool_stats.fallbacks;
+    JsonArray classes = pool[FPSTR(WebcamConsts::field_classes)].to<JsonArray>();
+    for (uint8_t c = 0; c < pool_stats.classes; ++c)
+    {
+        JsonObject cls = classes.add<JsonObject>();
+        cls[FPSTR(WebcamConsts::field_size)] = pool_stats.cls[c].size;
+        cls[FPSTR(WebcamConsts::field_count)] = pool_stats.cls[c].count;
+        cls[FPSTR(WebcamConsts::field_in_use)] = pool_stats.cls[c].in_use;
+        cls[FPSTR(WebcamConsts::field_high_water)] = pool_stats.cls[c].high_water;
+        cls[FPSTR(WebcamConsts::field_takes)] = pool_stats.cls[c].takes;
+        cls[FPSTR(WebcamConsts::field_exhausted)] = pool_stats.cls[c].exhausted;
+    }
+
+    // Frame transport peers (UDP / WebSocket fragments)
+    const FrameTransport transport = getFrameTransport();
+    const int64_t now_us = esp_timer_get_time();
+    JsonArray peers = doc[FPSTR(WebcamConsts::field_transport)][FPSTR(WebcamConsts::field_peers)].to<JsonArray>();
+    for (uint8_t slot = 0; slot < FrameTransport::MAX_PEERS; ++slot)
+    {
+        const FramePeer &p = transport.peer(slot);
+        if (!p.ipv4)
+            continue;
+        JsonObject peer = peers.add<JsonObject>();
+        peer[FPSTR(WebcamConsts::field_address)] = IPAddress(p.ipv4).toString();
+        peer[FPSTR(WebcamConsts::field_port)] = p.port;
+        peer[FPSTR(WebcamConsts::field_ws_client)] = p.ws_client;
+        peer[FPSTR(WebcamConsts::field_max_fps)] = p.min_interval_us ? 1000000u / p.min_interval_us : 0;
+        peer[FPSTR(WebcamConsts::field_lease_ms)] = p.expires_us > now_us ? static_cast<uint32_t>((p.expires_us - now_us) / 1000) : 0;
+        peer[FPSTR(WebcamConsts::field_frames_sent)] = p.frames_sent;
+        peer[FPSTR(WebcamConsts::field_frames_aborted)] = p.frames_aborted;
+        peer[FPSTR(WebcamConsts::field_frames_skipped)] = p.frames_skipped;
+        peer[FPSTR(WebcamConsts::field_fragments_sent)] = p.fragments_sent;
     }
 
-    uint8_t *jpg_buf = nullptr;
-    size_t jpg_len = 0;
-    bool needs_free = false;
+    // Fragmentation: share of the free heap not in the largest free block
+    JsonObject heap = doc[FPSTR(WebcamConsts::field_heap)].to<JsonObject>();
+    const uint32_t caps[] = {MALLOC_CAP_INTERNAL, MALLOC_CAP_SPIRAM};
+    const char *names[] = {WebcamConsts::field_internal, WebcamConsts::field_psram};
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        const size_t free_bytes = heap_caps_get_free_size(caps[i]);
+        const size_t largest = heap_caps_get_largest_free_block(caps[i]);
+        JsonObject region = heap[FPSTR(names[i])].to<JsonObject>();
+        region[FPSTR(WebcamConsts::field_free)] = static_cast<uint32_t>(free_bytes);
+        region[FPSTR(WebcamConsts::field_largest)] = static_cast<uint32_t>(largest);
+        region[FPSTR(WebcamConsts::field_min_free)] = static_cast<uint32_t>(heap_caps_get_minimum_free_size(caps[i]));
+        region[FPSTR(WebcamConsts::field_frag_pct)] = free_bytes ? static_cast<uint8_t>(100 - (largest * 100) / free_bytes) : 0;
+    }
 
-    // Check actual JPEG magic bytes (0xFF 0xD8) - don't trust fb->format field
-    bool is_valid_jpeg = (fb->len >= 2 && fb->buf[0] == 0xFF && fb->buf[1] == 0xD8);
+    String response;
+    serializeJson(doc, response);
+    request->send(200, RoutesConsts::mime_json, response);
+}
+
+void WebcamService::handleRate(AsyncWebServerRequest *request)
+{
+    const StreamRateController rate = getRateController();
+    portENTER_CRITICAL(&jpeg_lock_);
+    const uint8_t stream_clients = stream_clients_;
+    portEXIT_CRITICAL(&jpeg_lock_);
+    const StreamRateConfig &config = rate.config();
+    const StreamRateController::State &state = rate.state();
 
-    if (is_valid_jpeg)
+    JsonDocument doc;
+    JsonObject bounds = doc[FPSTR(WebcamConsts::field_config)].to<JsonObject>();
+    bounds[FPSTR(WebcamConsts::field_enabled)] = config.enabled;
+    bounds[FPSTR(WebcamConsts::field_target_ms)] = config.target_ms;
+    bounds[FPSTR(WebcamConsts::field_quality_min)] = config.quality_min;
+    bounds[FPSTR(WebcamConsts::field_quality_max)] = config.quality_max;
+    bounds[FPSTR(WebcamConsts::field_max_skip)] = config.max_skip;
+    bounds[FPSTR(WebcamConsts::field_max_downsize)] = config.max_downsize;
+
+    JsonObject loop = doc[FPSTR(WebcamConsts::field_state)].to<JsonObject>();
+    loop[FPSTR(WebcamConsts::field_stream_clients)] = stream_clients;
+    loop[FPSTR(WebcamConsts::field_quality)] = state.quality;
+    loop[FPSTR(WebcamConsts::field_skip)] = state.skip;
+    loop[FPSTR(WebcamConsts::field_downsize)] = state.downsize;
+    loop[FPSTR(WebcamConsts::field_framesize)] = static_cast<int>(current_framesize_);
+    loop[FPSTR(WebcamConsts::field_base_framesize)] = static_cast<int>(base_framesize_);
+    loop[FPSTR(WebcamConsts::field_latency_avg_ms)] = state.latency_avg_ms;
+    loop[FPSTR(WebcamConsts::field_latency_max_ms)] = state.latency_max_ms;
+    loop[FPSTR(WebcamConsts::field_encode_avg_us)] = state.encode_avg_us;
+    loop[FPSTR(WebcamConsts::field_encoded)] = state.encoded;
+    loop[FPSTR(WebcamConsts::field_delivered)] = state.delivered;
+    loop[FPSTR(WebcamConsts::field_last_action)] = StreamRateController::actionName(state.last_action);
+    loop[FPSTR(WebcamConsts::field_periods)] = state.periods;
+    loop[FPSTR(WebcamConsts::field_decreases)] = state.decreases;
+    loop[FPSTR(WebcamConsts::field_increases)] = state.increases;
+    loop[FPSTR(WebcamConsts::field_rate_skipped)] = state.rate_skipped;
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, RoutesConsts::mime_json, response);
+}
+
+/**
+ * @brief Handle stream rate controller bounds update
+ * @details Accepts JSON body with optional fields: enabled, target_ms, quality_min,
+ *          quality_max, max_skip, max_downsize. The bounds are checked together,
+ *          applied at once and saved.
+ */
+void WebcamService::handleRateSettings(AsyncWebServerRequest *request)
+{
+    if (!request->hasParam("plain", true))
     {
-        // Data is already valid JPEG
-        jpg_buf = fb->buf;
-        jpg_len = fb->len;
-        logger->info("Frame is valid JPEG, size: " + std::to_string(jpg_len) + " bytes");
+        request->send(400, RoutesConsts::mime_json,
+                      getResultJsonString(RoutesConsts::result_err,
+                                          progmem_to_string(RoutesConsts::msg_invalid_json))
+                          .c_str());
+        return;
     }
-    else
+
+    JsonDocument doc;
+    const AsyncWebParameter *p = request->getParam("plain", true);
+    if (deserializeJson(doc, p->value()) || !doc.is<JsonObject>())
     {
-        // Data is not JPEG - need to convert regardless of what fb->format says
-        logger->info("Frame is not JPEG (format=" + std::to_string(fb->format) +
-                     ", first bytes: " + std::to_string(fb->buf[0]) + " " +
-                     std::to_string(fb->buf[1]) + "), converting...");
+        request->send(400, RoutesConsts::mime_json,
+                      getResultJsonString(RoutesConsts::result_err,
+                                          progmem_to_string(WebcamConsts::resp_invalid_json))
+                          .c_str());
+        return;
+    }
 
-        bool conversion_ok = frame2jpg(fb, 80, &jpg_buf, &jpg_len);
-        if (!conversion_ok || !jpg_buf || jpg_len == 0)
+    StreamRateConfig config = getRateController().config();
+    bool updated = false;
+    if (doc[FPSTR(WebcamConsts::field_enabled)].is<bool>())
+    {
+        config.enabled = doc[FPSTR(WebcamConsts::field_enabled)];
+        updated = true;
+    }
+    // Numeric bounds, in StreamRateConfig order; target_ms is 16-bit, the others 8-bit
+    const char *fields[] = {WebcamConsts::field_target_ms, WebcamConsts::field_quality_min,
+                            WebcamConsts::field_quality_max, WebcamConsts::field_max_skip,
+                            WebcamConsts::field_max_downsize};
+    int values[] = {config.target_ms, config.quality_min, config.quality_max, config.max_skip, config.max_downsize};
+    for (uint8_t i = 0; i < 5; ++i)
+    {
+        JsonVariant v = doc[FPSTR(fields[i])];
+        if (v.isNull())
+            continue;
+        if (!v.is<int>() || v.as<int>() < 0 || v.as<int>() > (i == 0 ? 0xFFFF : 0xFF))
         {
-            logger->error("Failed to convert frame to JPEG");
-            esp_camera_fb_return(fb);
-            if (jpg_buf)
-                free(jpg_buf);
-            request->send(503, RoutesConsts::mime_plain_text, "JPEG conversion failed");
+            request->send(422, RoutesConsts::mime_json,
+                          getResultJsonString(RoutesConsts::result_err,
+                                              (progmem_to_string(fields[i]) + " out of range").c_str())
+                              .c_str());
             return;
         }
-        needs_free = true;
-        logger->info("Converted to JPEG, size: " + std::to_string(jpg_len) + " bytes");
+        values[i] = v.as<int>();
+        updated = true;
+    }
+    if (!updated)
+    {
+        request->send(400, RoutesConsts::mime_json,
+                      getResultJsonString(RoutesConsts::result_err,
+                                          progmem_to_string(WebcamConsts::err_no_valid_settings).c_str())
+                          .c_str());
+        return;
+    }
+    config.target_ms = static_cast<uint16_t>(values[0]);
+    config.quality_min = static_cast<uint8_t>(values[1]);
+    config.quality_max = static_cast<uint8_t>(values[2]);
+    config.max_skip = static_cast<uint8_t>(values[3]);
+    config.max_downsize = static_cast<uint8_t>(values[4]);
+
+    std::string error;
+    if (!config.validate(error))
+    {
+        request->send(422, RoutesConsts::mime_json,
+                      getResultJsonString(RoutesConsts::result_err, error.c_str()).c_str());
+        return;
     }
 
-    // Send JPEG image using AsyncWebServer
-    AsyncWebServerResponse *response = request->beginResponse(200, RoutesConsts::mime_image_jpeg, jpg_buf, jpg_len);
-    response->addHeader(progmem_to_string(RoutesConsts::header_content_disposition).c_str(), progmem_to_string(WebcamConsts::inline_filename).c_str());
-    response->addHeader(progmem_to_string(RoutesConsts::header_access_control).c_str(), "*");
-    request->send(response);
+    portENTER_CRITICAL(&jpeg_lock_);
+    rate_.configure(config);
+    portEXIT_CRITICAL(&jpeg_lock_);
 
-    // Clean up
-    if (needs_free && jpg_buf)
+    Preferences prefs;
+    if (prefs.begin(progmem_to_string(WebcamConsts::pref_namespace).c_str(), false))
     {
-        free(jpg_buf);
+        prefs.putString(progmem_to_string(WebcamConsts::pref_rate).c_str(), config.toString().c_str());
+        prefs.end();
     }
-    esp_camera_fb_return(fb);
+
+    const std::string msg = progmem_to_string(WebcamConsts::msg_rate_updated) + config.toString();
+    logger->info(msg);
+    request->send(200, RoutesConsts::mime_json,
+                  getResultJsonString(RoutesConsts::result_ok, msg.c_str()).c_str());
 }
 
 void WebcamService::handleStatus(AsyncWebServerRequest *request)
@@ -1511,6 +2394,65 @@ bool WebcamService::registerRoutes()
             if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
         handleStream(request); });
 
+    // Encoder endpoint - shared JPEG encoder statistics
+    path = getPath(WebcamConsts::action_encoder);
+#ifdef VERBOSE_DEBUG
+    logger->debug("+" + path);
+#endif
+    std::vector<OpenAPIResponse> encoderResponses;
+    OpenAPIResponse encoderOk(200, WebcamConsts::resp_encoder_ok);
+    encoderOk.schema = R"({"type":"object","properties":{"subscribers":{"type":"integer","description":"Stream clients and snapshots waiting for frames"},"encoded":{"type":"integer","description":"Frames encoded, once for all consumers"},"delivered":{"type":"integer","description":"Frames fully sent, one count per consumer"},"skipped":{"type":"integer","description":"Frames a slow client never sent because a newer one was ready"},"superseded":{"type":"integer","description":"Frames replaced before any consumer took them"},"camera_dropped":{"type":"integer","description":"Camera frames replaced in the latest-frame mailbox before anyone took them, also while nobody consumes"},"camera":{"type":"object","description":"Latest camera frame mailbox: generation (frames posted), taken, dropped, full (a frame is waiting), age_us of the frames taken, capture to take: min, avg, max, last"},"live_frames":{"type":"integer","description":"Encoded frames still referenced"},"last_size":{"type":"integer","description":"Bytes of the latest JPEG"},"encode_us":{"type":"object","properties":{"min":{"type":"integer"},"avg":{"type":"integer"},"max":{"type":"integer"},"last":{"type":"integer"}}},"copied_kib":{"type":"integer","description":"KiB copied by the encoder and the consumers"},"copied_per_frame":{"type":"integer","description":"Bytes copied per delivered frame"},"heap_ops":{"type":"integer","description":"Heap allocations and frees made for encoded frames"},"heap_ops_per_frame":{"type":"number","description":"Heap operations per delivered frame"},"pool":{"type":"object","description":"PSRAM JPEG buffer pool: bytes, slots, in_use, high_water, takes, exhausted (frames skipped, every buffer held), overflows, fallbacks (encoded to the heap), classes[]"},"transport":{"type":"object","properties":{"peers":{"type":"array","description":"Frame transport peers (UDP actions 0x61-0x64): address, port, ws_client (WebSocket bridge, 0 for UDP), max_fps, lease_ms left, frames_sent, frames_aborted (a fragment could not be sent, the peer drops the frame), frames_skipped (frame rate cap), fragments_sent","items":{"type":"object"}}}},"heap":{"type":"object","description":"internal / psram: free, largest, min_free, frag_pct"}}})";
+    encoderOk.example = R"({"subscribers":2,"encoded":1200,"delivered":2310,"skipped":85,"superseded":3,"camera_dropped":40,"camera":{"generation":1262,"taken":1240,"dropped":40,"full":false,"age_us":{"min":1210,"avg":18430,"max":61200,"last":9870}},"live_frames":2,"last_size":14872,"encode_us":{"min":31250,"avg":38410,"max":61020,"last":37990},"copied_kib":33612,"copied_per_frame":14899,"heap_ops":0,"heap_ops_per_frame":0,"pool":{"ready":true,"bytes":491520,"slots":10,"in_use":3,"high_water":5,"takes":1203,"exhausted":0,"overflows":2,"fallbacks":0,"classes":[{"size":24576,"count":4,"in_use":3,"high_water":4,"takes":1180,"exhausted":1}]},"transport":{"peers":[{"address":"192.168.1.20","port":52000,"ws_client":0,"max_fps":15,"lease_ms":3810,"frames_sent":1540,"frames_aborted":12,"frames_skipped":1490,"fragments_sent":17210}]},"heap":{"internal":{"free":148212,"largest":110592,"min_free":131004,"frag_pct":25},"psram":{"free":7612316,"largest":7536640,"min_free":7590012,"frag_pct":0}}})";
+    encoderResponses.push_back(encoderOk);
+    encoderResponses.push_back(createServiceNotStartedResponse());
+    encoderResponses.push_back(createForbiddenResponse());
+    registerOpenAPIRoute(OpenAPIRoute(path.c_str(), RoutesConsts::method_get,
+                                      WebcamConsts::desc_encoder,
+                                      WebcamConsts::tag, false, {}, encoderResponses));
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+        handleEncoderStats(request); });
+
+    // Rate endpoint - stream rate controller state (GET) and bounds (PUT)
+    path = getPath(WebcamConsts::action_rate);
+#ifdef VERBOSE_DEBUG
+    logger->debug("+" + path);
+#endif
+    std::vector<OpenAPIResponse> rateResponses;
+    OpenAPIResponse rateOk(200, WebcamConsts::resp_rate_ok);
+    rateOk.schema = R"({"type":"object","properties":{"config":{"type":"object","properties":{"enabled":{"type":"boolean"},"target_ms":{"type":"integer","description":"Capture-to-sent latency target"},"quality_min":{"type":"integer"},"quality_max":{"type":"integer","description":"JPEG quality bounds, 1-100, higher is better"},"max_skip":{"type":"integer","description":"Camera frames skipped at most between two encoded ones"},"max_downsize":{"type":"integer","description":"Frame size steps below the configured one, 0: never resize"}}},"state":{"type":"object","properties":{"stream_clients":{"type":"integer"},"quality":{"type":"integer"},"skip":{"type":"integer"},"downsize":{"type":"integer"},"framesize":{"type":"integer"},"base_framesize":{"type":"integer"},"latency_avg_ms":{"type":"integer","description":"Last period"},"latency_max_ms":{"type":"integer","description":"Last period, worst client"},"encode_avg_us":{"type":"integer"},"encoded":{"type":"integer"},"delivered":{"type":"integer"},"last_action":{"type":"string","enum":["hold","quality_down","skip_up","size_down","size_up","skip_down","quality_up"]},"periods":{"type":"integer"},"decreases":{"type":"integer"},"increases":{"type":"integer"},"rate_skipped":{"type":"integer","description":"Camera frames not encoded because of the frame skip"}}}}})";
+    rateOk.example = R"({"config":{"enabled":true,"target_ms":300,"quality_min":30,"quality_max":80,"max_skip":3,"max_downsize":1},"state":{"stream_clients":2,"quality":55,"skip":0,"downsize":0,"framesize":7,"base_framesize":7,"latency_avg_ms":184,"latency_max_ms":262,"encode_avg_us":36120,"encoded":9,"delivered":17,"last_action":"hold","periods":412,"decreases":6,"increases":1,"rate_skipped":0}})";
+    rateResponses.push_back(rateOk);
+    rateResponses.push_back(createServiceNotStartedResponse());
+    rateResponses.push_back(createForbiddenResponse());
+    registerOpenAPIRoute(OpenAPIRoute(path.c_str(), RoutesConsts::method_get,
+                                      WebcamConsts::desc_rate,
+                                      WebcamConsts::tag, false, {}, rateResponses));
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+        handleRate(request); });
+
+    std::vector<OpenAPIResponse> rateSettingsResponses;
+    rateSettingsResponses.push_back(OpenAPIResponse(200, WebcamConsts::resp_rate_updated));
+    rateSettingsResponses.push_back(OpenAPIResponse(400, WebcamConsts::resp_invalid_json));
+    rateSettingsResponses.push_back(OpenAPIResponse(422, RoutesConsts::resp_missing_params));
+    rateSettingsResponses.push_back(createServiceNotStartedResponse());
+    rateSettingsResponses.push_back(createForbiddenResponse());
+    OpenAPIRoute rateSettingsRoute(path.c_str(), RoutesConsts::method_put,
+                                   WebcamConsts::desc_rate_settings,
+                                   WebcamConsts::tag, false, {}, rateSettingsResponses);
+    rateSettingsRoute.requestBody = OpenAPIRequestBody(
+        WebcamConsts::desc_rate_settings,
+        R"({"type":"object","properties":{"enabled":{"type":"boolean"},"target_ms":{"type":"integer","minimum":50,"maximum":10000},"quality_min":{"type":"integer","minimum":1,"maximum":100},"quality_max":{"type":"integer","minimum":1,"maximum":100},"max_skip":{"type":"integer","minimum":0,"maximum":10},"max_downsize":{"type":"integer","minimum":0,"maximum":4}},"additionalProperties":false})",
+        true);
+    registerOpenAPIRoute(rateSettingsRoute);
+    webserver.on(path.c_str(), HTTP_PUT, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+        handleRateSettings(request); });
+
     // Audio stream endpoint - streams WAV from on-board microphone
     path = getPath(WebcamConsts::action_audio);
 #ifdef VERBOSE_DEBUG
@@ -1585,6 +2527,133 @@ std::string WebcamService::getServiceSubPath()
 {
     return std::string(WebcamConsts::service_path);
 }
+// UDP helper functions to build binary responses
+static inline void udp_build_response(uint8_t action, uint8_t resp, const char *payload, std::string &out)
+{
+    out.clear();
+    out += static_cast<char>(action);
+    out += static_cast<char>(resp);
+    if (payload && *payload) out.append(payload);
+}
+
+static inline void appendU16(std::string &out, uint16_t value)
+{
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+}
+
+static inline void appendU32(std::string &out, uint32_t value)
+{
+    appendU16(out, static_cast<uint16_t>(value & 0xFFFF));
+    appendU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+bool WebcamService::messageHandler(const std::string &message,
+                                   const IPAddress &remoteIP,
+                                   uint16_t remotePort)
+{
+    const size_t len = message.size();
+    if (len < 1) return false;
+
+    const uint8_t *d      = reinterpret_cast<const uint8_t *>(message.data());
+    const uint8_t  action = d[0];
+
+    if (action < WebcamConsts::udp_action_min || action > WebcamConsts::udp_action_max) return false;
+
+    static std::string resp;
+    resp.clear();
+
+    if (!IsServiceInterface::isServiceStarted())
+    {
+        udp_build_response(action, UDPProto::udp_resp_not_started, nullptr, resp);
+        udp_service.sendReply(resp, remoteIP, remotePort);
+        return true;
+    }
+
+    if (!checkUDPIsMaster(action, remoteIP, &amakerbot_service, resp))
+    {
+        udp_service.sendReply(resp, remoteIP, remotePort);
+        return true;
+    }
+
+    // Over the WebSocket bridge the peer is the client, the address is a marker
+    const uint32_t ws_client = remoteIP == IPAddress(127, 0, 0, 2) ? ws_client_id_context : 0;
+    const uint32_t ipv4 = static_cast<uint32_t>(remoteIP);
+
+    switch (action)
+    {
+    // 0x61 FRAME_SUBSCRIBE [max_fps:1B optional, 0: every frame] → [action][ok][payload_max:u16][lease_ms:u16]
+    //   Renews the lease when already subscribed; send it again before lease_ms elapses.
+    case WebcamConsts::udp_action_frame_subscribe:
+    {
+        const uint8_t max_fps = len >= 2 ? d[1] : 0;
+        if (max_fps > WebcamConsts::transport_max_fps)
+        {
+            udp_build_response(action, UDPProto::udp_resp_invalid_values, nullptr, resp);
+            break;
+        }
+        portENTER_CRITICAL(&jpeg_lock_);
+        const bool ok = transport_.subscribe(ipv4, remotePort, ws_client, max_fps, esp_timer_get_time());
+        portEXIT_CRITICAL(&jpeg_lock_);
+        if (!ok)
+        {
+            // Every peer slot is taken
+            udp_build_response(action, UDPProto::udp_resp_operation_failed, nullptr, resp);
+            break;
+        }
+        if (transport_task_)
+            xTaskNotifyGive(transport_task_);
+        udp_build_response(action, UDPProto::udp_resp_ok, nullptr, resp);
+        appendU16(resp, static_cast<uint16_t>(FrameTransport::MAX_PAYLOAD));
+        appendU16(resp, static_cast<uint16_t>(FrameTransport::LEASE_US / 1000));
+        break;
+    }
+
+    // 0x63 FRAME_UNSUBSCRIBE (no params); invalid_values if not subscribed
+    case WebcamConsts::udp_action_frame_unsubscribe:
+    {
+        portENTER_CRITICAL(&jpeg_lock_);
+        const bool ok = transport_.unsubscribe(ipv4, remotePort, ws_client);
+        portEXIT_CRITICAL(&jpeg_lock_);
+        udp_build_response(action, ok ? UDPProto::udp_resp_ok : UDPProto::udp_resp_invalid_values, nullptr, resp);
+        break;
+    }
+
+    // 0x64 FRAME_STATS (no params) → [action][ok][version:1B][peers:1B][subscribed:1B]
+    //   [frames_sent:u32][frames_aborted:u32][fragments_sent:u32][frames_skipped:u32]
+    //   Counters of the caller's subscription, 0 when not subscribed. Little-endian.
+    case WebcamConsts::udp_action_frame_stats:
+    {
+        FramePeer peer;
+        portENTER_CRITICAL(&jpeg_lock_);
+        const uint8_t peers = transport_.peers();
+        const FramePeer *found = transport_.find(ipv4, remotePort, ws_client);
+        if (found)
+            peer = *found;
+        portEXIT_CRITICAL(&jpeg_lock_);
+        udp_build_response(action, UDPProto::udp_resp_ok, nullptr, resp);
+        resp += static_cast<char>(WebcamConsts::udp_frame_stats_version);
+        resp += static_cast<char>(peers);
+        resp += static_cast<char>(found ? 1 : 0);
+        appendU32(resp, peer.frames_sent);
+        appendU32(resp, peer.frames_aborted);
+        appendU32(resp, peer.fragments_sent);
+        appendU32(resp, peer.frames_skipped);
+        break;
+    }
+
+    // 0x62 is pushed by the device only
+    default:
+    {
+        udp_build_response(action, UDPProto::udp_resp_unknown_cmd, nullptr, resp);
+        break;
+    }
+    }
+
+    udp_service.sendReply(resp, remoteIP, remotePort);
+    return true;
+}
+
 bool WebcamService::saveSettings()
 {
     logger->info("Saving " + getServiceName() + " settings...");
@@ -1610,10 +2679,12 @@ bool WebcamService::saveSettings()
     }
 
     prefs.putInt(progmem_to_string(WebcamConsts::pref_quality).c_str(), s->status.quality);
-    prefs.putInt(progmem_to_string(WebcamConsts::pref_framesize).c_str(), s->status.framesize);
+    // The configured size, not one the rate controller stepped down to
+    prefs.putInt(progmem_to_string(WebcamConsts::pref_framesize).c_str(), base_framesize_);
     prefs.putInt(progmem_to_string(WebcamConsts::pref_brightness).c_str(), s->status.brightness);
     prefs.putInt(progmem_to_string(WebcamConsts::pref_contrast).c_str(), s->status.contrast);
     prefs.putInt(progmem_to_string(WebcamConsts::pref_saturation).c_str(), s->status.saturation);
+    prefs.putString(progmem_to_string(WebcamConsts::pref_rate).c_str(), getRateController().config().toString().c_str());
 
     prefs.end();
     logger->info("Settings saved successfully");
@@ -1676,6 +2747,19 @@ bool WebcamService::loadSettings()
         logger->debug("Loaded saturation: " + std::to_string(saturation));
     }
 
+    if (prefs.isKey(progmem_to_string(WebcamConsts::pref_rate).c_str()))
+    {
+        StreamRateConfig config;
+        const String text = prefs.getString(progmem_to_string(WebcamConsts::pref_rate).c_str(), "");
+        if (config.fromString(text.c_str()))
+        {
+            portENTER_CRITICAL(&jpeg_lock_);
+            rate_.configure(config);
+            portEXIT_CRITICAL(&jpeg_lock_);
+            logger->debug("Loaded rate controller: " + config.toString());
+        }
+    }
+
     prefs.end();
     logger->info("Settings loaded successfully");
     return true;
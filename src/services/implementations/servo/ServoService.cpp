@@ -17,6 +17,37 @@
  *          - POST /api/servos/v1/stopAllMotors - Stop all DC motors
  *          - POST /api/servos/v1/setAllMotorsSpeed - Set same speed on all DC motors
  *          - GET /api/servos/v1/getBattery - Get K10 board battery level (0-100%)
+ *          - GET /api/servos/v1/getDriverStats - Actuator driver write counters (DFR1216 shadow or DFR0548 bursts)
+ *          - GET /api/servos/v1/getCommitStats - Actuator commit task counters and command-to-wire latency
+ *          - POST /api/servos/v1/setMotionProfile - Set per-channel velocity/acceleration/jerk limits
+ *          - GET /api/servos/v1/getMotionStatus - Per-channel profiled position, target and velocity
+ *          - POST /api/servos/v1/setCalibration - Per-channel endpoints, trim, deadband and speed curve
+ *          - GET /api/servos/v1/getCalibration - Effective calibration of every channel
+ *          - POST /api/servos/v1/calibrationJog - Calibration routine: output a raw pulse width
+ *          - POST /api/servos/v1/calibrationCapture - Calibration routine: store the jog pulse as min/max/center/deadband
+ *          - POST /api/servos/v1/uploadTimeline - Validate and store a keyframe timeline in LittleFS
+ *          - POST /api/servos/v1/playTimeline - Play a stored timeline by ID (once or looped)
+ *          - POST /api/servos/v1/stopTimeline - Stop the running timeline
+ *          - POST /api/servos/v1/deleteTimeline - Remove a stored timeline
+ *          - GET /api/servos/v1/getTimelineStatus - Playback state and stored timeline IDs
+ *          - POST /api/servos/v1/setTwist - Drive the wheel motors from a linear/angular twist
+ *          - POST /api/servos/v1/setDriveConfig - Twist wheel mapping, inversion, deadband and acceleration limit
+ *          - GET /api/servos/v1/getDriveStatus - Twist drive configuration, wheel commands and duties
+ *          - POST /api/servos/v1/setObstacleReflex - Range-based forward cap of the wheel motors
+ *          - GET /api/servos/v1/getObstacleReflex - Obstacle reflex configuration, range, cap and trips
+ *
+ *          Setters never touch the I2C bus: they publish into a lock-free desired-state
+ *          table that a dedicated task commits at COMMIT_PERIOD_MS (latest value wins).
+ *          Angular channels with a motion profile move to each new target along a
+ *          trapezoidal or S-curve trajectory stepped by the same task, which also
+ *          evaluates the differential-drive kinematics of setTwist() and the obstacle
+ *          reflex, which caps the forward duty of the wheel motors from the range
+ *          sampled by DFR1216Service without waiting for the master.
+ *          Keyframe timelines are played locally by a single periodic esp_timer.
+ *          Pulse widths come from per-channel tables compiled from each channel's
+ *          calibration when the servo is attached or recalibrated.
+ *          The board is a compile-time policy (ActuatorBackend.h): DFR1216 by default,
+ *          PCA9685-based DFR0548 with -DSERVO_DRIVER_DFR0548.
  *
  */
 
@@ -25,21 +56,45 @@
 #include <ESPAsyncWebServer.h>
 #include <pgmspace.h>
 #include <ArduinoJson.h>
-#include <freertos/timers.h>
-#include "DFR1216/DFR1216.h"
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <LittleFS.h>
+#include <atomic>
+#include "ActuatorBackend.h"
+#include "MotionProfile.h"
+#include "KeyframeTimeline.h"
+#include "TimingWheel.h"
+#include "ServoCalibration.h"
+#include "DifferentialDrive.h"
+#include "ObstacleReflex.h"
+#include "SeqLock.h"
 #include "services/SettingsService.h"
 #include "services/UDPService.h"
 #include "services/AmakerBotService.h"
+#include "services/HTTPService.h"
+#include "services/DFR1216Service.h"
 
 constexpr uint8_t MAX_SERVO_CHANNELS = 8;
 constexpr uint8_t MAX_MOTOR_CHANNELS = 4;
 constexpr uint16_t MOTOR_PWM_PERIOD = 1000; ///< PWM period (µs) for DC motors — 1 kHz
-
-DFR1216_I2C servoController = DFR1216_I2C();
+constexpr uint32_t COMMIT_PERIOD_MS = 5;    ///< Actuator commit period — 200 Hz control rate
+constexpr uint32_t MOTION_MAX_STEP_US = 20000; ///< Clamp of one profile step after a late wake-up
+
+// Board driver selected at build time (non-virtual calls in the commit path)
+#ifdef SERVO_DRIVER_DFR0548
+using ActuatorBackend = DFR0548Backend;
+#else
+using ActuatorBackend = DFR1216Backend;
+#endif
+ActuatorBackend servoController;
 
 extern SettingsService settings_service;
 extern UDPService udp_service;
 extern AmakerBotService amakerbot_service;
+extern ServoService servo_service; // defined in main.cpp
+extern HTTPService http_service;
+extern DFR1216Service dfr1216_service;
+extern uint32_t ws_client_id_context; // WebSocket client behind the message being handled (HTTPService.cpp)
 
 // No module-level UDP buffers needed — binary protocol uses raw message bytes directly.
 
@@ -71,6 +126,7 @@ namespace ServoConsts
     constexpr const char servos[] PROGMEM = "servos";
     constexpr const char msg_no_saved_settings[] PROGMEM = "No saved servo settings found.";
     constexpr const char msg_loaded_settings[] PROGMEM = "Loaded servo settings successfully.";
+    constexpr const char msg_calibration_reset[] PROGMEM = "Stored calibration rejected, defaults used on channel ";
     constexpr const char str_service_name[] PROGMEM = "Servo Service";
     constexpr const char path_service[] PROGMEM = "servos/v1";
     constexpr const char str_plain[] PROGMEM = "plain";
@@ -171,8 +227,14 @@ namespace ServoConsts
     constexpr uint8_t udp_action_get_servo_status = (udp_service_id << 4) | 0x07; ///< [mask]  → [action][ok][JSON]
     constexpr uint8_t udp_action_get_all_status = (udp_service_id << 4) | 0x08;   ///<          → [action][ok][JSON]
     constexpr uint8_t udp_action_get_battery = (udp_service_id << 4) | 0x09;      ///<          → [action][ok][batt_byte]
+    constexpr uint8_t udp_action_set_motion_profile = (udp_service_id << 4) | 0x0A; ///< [mask][vmax:u16_LE][amax:u16_LE][jerk:u16_LE]  deg/s, deg/s², deg/s³
+    constexpr uint8_t udp_action_motion_status = (udp_service_id << 4) | 0x0B;      ///<          → [action][ok][moving_mask]  (event adds [reached_mask])
+    constexpr uint8_t udp_action_timeline_play = (udp_service_id << 4) | 0x0C;      ///< [id][loop:1B optional]  loop: 0 once, 1 loop, absent = timeline flag
+    constexpr uint8_t udp_action_timeline_stop = (udp_service_id << 4) | 0x0D;      ///< (no params)
+    constexpr uint8_t udp_action_set_twist = (udp_service_id << 4) | 0x0E;          ///< [linear:int16_LE][angular:int16_LE][duration_ms:u16_LE optional]  1/1000 of full speed
+    constexpr uint8_t udp_action_obstacle = (udp_service_id << 4) | 0x0F;           ///<          → [action][ok][state][range:int16_LE][cap:u16_LE]  (also sent as event)
     constexpr uint8_t udp_action_min = (udp_service_id << 4) | 0x01;              ///< lowest valid action code
-    constexpr uint8_t udp_action_max = (udp_service_id << 4) | 0x09;              ///< highest valid action code
+    constexpr uint8_t udp_action_max = (udp_service_id << 4) | 0x0F;              ///< highest valid action code
 
     // Motor control
     constexpr const char action_set_motor_speed[] PROGMEM = "setMotorSpeed";
@@ -183,46 +245,945 @@ namespace ServoConsts
     constexpr const char desc_set_motor_speed[] PROGMEM = "Set DC motor speed (motor 1-4, speed -100 to +100)";
     constexpr const char desc_stop_all_motors[] PROGMEM = "Stop all DC motors";
     constexpr const char desc_set_all_motors_speed[] PROGMEM = "Set the same speed on all DC motors (-100 to +100)";
-    constexpr const char req_motor_speed[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"motor\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":4},\"speed\":{\"type\":\"integer\",\"minimum\":-100,\"maximum\":100}},\"required\":[\"motor\",\"speed\"]}";
-    constexpr const char ex_motor_speed[] PROGMEM = "{\"motor\":1,\"speed\":75}";
+    constexpr const char req_motor_speed[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"motor\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":4},\"speed\":{\"type\":\"integer\",\"minimum\":-100,\"maximum\":100},\"duration_ms\":{\"type\":\"integer\",\"minimum\":1,\"description\":\"Auto-stop delay in ms (optional)\"}},\"required\":[\"motor\",\"speed\"]}";
+    constexpr const char ex_motor_speed[] PROGMEM = "{\"motor\":1,\"speed\":75,\"duration_ms\":500}";
     constexpr const char req_all_motors_speed[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"speed\":{\"type\":\"integer\",\"minimum\":-100,\"maximum\":100}},\"required\":[\"speed\"]}";
     constexpr const char ex_all_motors_speed[] PROGMEM = "{\"speed\":50}";
 
+    // Twist drive (differential kinematics)
+    constexpr const char action_set_twist[] PROGMEM = "setTwist";
+    constexpr const char action_set_drive_config[] PROGMEM = "setDriveConfig";
+    constexpr const char action_get_drive_status[] PROGMEM = "getDriveStatus";
+    constexpr const char desc_set_twist[] PROGMEM = "Drive the wheel motors from a twist: linear and angular (counter-clockwise) in 1/1000 of full speed. Mixing, ramping, deadband compensation and wheel mapping run on the device; both motors change in one bus burst";
+    constexpr const char desc_set_drive_config[] PROGMEM = "Set the twist wheel mapping (motors 1-4), inversion, motor deadband (1/1000 duty) and acceleration limit (1/1000 per s, 0 = none); omitted fields keep their value. An engaged twist is released and its motors stopped";
+    constexpr const char desc_get_drive_status[] PROGMEM = "Get the twist drive configuration, last twist, wheel commands and motor duties (1/1000)";
+    constexpr const char json_linear[] PROGMEM = "linear";
+    constexpr const char json_angular[] PROGMEM = "angular";
+    constexpr const char json_left_motor[] PROGMEM = "left_motor";
+    constexpr const char json_right_motor[] PROGMEM = "right_motor";
+    constexpr const char json_invert_left[] PROGMEM = "invert_left";
+    constexpr const char json_invert_right[] PROGMEM = "invert_right";
+    constexpr const char json_deadband[] PROGMEM = "deadband";
+    constexpr const char json_accel_limit[] PROGMEM = "accel_limit";
+    constexpr const char json_config[] PROGMEM = "config";
+    constexpr const char json_engaged[] PROGMEM = "engaged";
+    constexpr const char json_left[] PROGMEM = "left";
+    constexpr const char json_right[] PROGMEM = "right";
+    constexpr const char json_target_left[] PROGMEM = "target_left";
+    constexpr const char json_target_right[] PROGMEM = "target_right";
+    constexpr const char json_left_duty[] PROGMEM = "left_duty";
+    constexpr const char json_right_duty[] PROGMEM = "right_duty";
+    constexpr const char json_twists[] PROGMEM = "twists";
+    constexpr const char json_engagements[] PROGMEM = "engagements";
+    constexpr const char json_releases[] PROGMEM = "releases";
+    constexpr const char err_twist_range[] PROGMEM = "Twist out of range (-1000 to 1000)";
+    constexpr const char settings_key_drive[] PROGMEM = "drive";
+    constexpr const char req_twist[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"linear\":{\"type\":\"integer\",\"minimum\":-1000,\"maximum\":1000,\"description\":\"Forward, 1/1000 of full speed\"},\"angular\":{\"type\":\"integer\",\"minimum\":-1000,\"maximum\":1000,\"description\":\"Counter-clockwise turn, 1/1000 of full wheel speed\"},\"duration_ms\":{\"type\":\"integer\",\"minimum\":1,\"description\":\"Ramp back to a stop after this delay (optional)\"}},\"required\":[\"linear\",\"angular\"]}";
+    constexpr const char ex_twist[] PROGMEM = "{\"linear\":600,\"angular\":-250,\"duration_ms\":300}";
+    constexpr const char req_drive_config[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"left_motor\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":4},\"right_motor\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":4},\"invert_left\":{\"type\":\"boolean\"},\"invert_right\":{\"type\":\"boolean\"},\"deadband\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":500,\"description\":\"Duty (1/1000) below which the motors do not turn\"},\"accel_limit\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":65535,\"description\":\"Wheel command change per second (1/1000 per s, 0 = none)\"}}}";
+    constexpr const char ex_drive_config[] PROGMEM = "{\"left_motor\":1,\"right_motor\":2,\"invert_right\":true,\"deadband\":150,\"accel_limit\":2500}";
+    constexpr const char schema_drive_status[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"config\":{\"type\":\"object\",\"properties\":{\"left_motor\":{\"type\":\"integer\"},\"right_motor\":{\"type\":\"integer\"},\"invert_left\":{\"type\":\"boolean\"},\"invert_right\":{\"type\":\"boolean\"},\"deadband\":{\"type\":\"integer\"},\"accel_limit\":{\"type\":\"integer\"}}},\"engaged\":{\"type\":\"boolean\"},\"linear\":{\"type\":\"integer\"},\"angular\":{\"type\":\"integer\"},\"left\":{\"type\":\"integer\"},\"right\":{\"type\":\"integer\"},\"target_left\":{\"type\":\"integer\"},\"target_right\":{\"type\":\"integer\"},\"left_duty\":{\"type\":\"integer\"},\"right_duty\":{\"type\":\"integer\"},\"twists\":{\"type\":\"integer\"},\"engagements\":{\"type\":\"integer\"},\"releases\":{\"type\":\"integer\"}}}";
+    constexpr const char ex_drive_status[] PROGMEM = "{\"config\":{\"left_motor\":1,\"right_motor\":2,\"invert_left\":false,\"invert_right\":true,\"deadband\":150,\"accel_limit\":2500},\"engaged\":true,\"linear\":600,\"angular\":-250,\"left\":700,\"right\":280,\"target_left\":850,\"target_right\":350,\"left_duty\":745,\"right_duty\":-388,\"twists\":5200,\"engagements\":3,\"releases\":2}";
+
+    // Obstacle reflex
+    constexpr const char action_set_obstacle_reflex[] PROGMEM = "setObstacleReflex";
+    constexpr const char action_get_obstacle_reflex[] PROGMEM = "getObstacleReflex";
+    constexpr const char desc_set_obstacle_reflex[] PROGMEM = "Configure the obstacle reflex: the commit task caps the forward duty of the wheel motors from the range of an SR04 (port 6) or analog IR sensor (ports 0-5) sampled by DFR1216Service. Forward motion stops at stop_distance and is limited within speed_margin cm beyond it; omitted fields keep their value";
+    constexpr const char desc_get_obstacle_reflex[] PROGMEM = "Get the obstacle reflex configuration, state (clear, limiting, blocked, no_sensor), range (cm), forward cap and trip counters";
+    constexpr const char json_enabled[] PROGMEM = "enabled";
+    constexpr const char json_port[] PROGMEM = "port";
+    constexpr const char json_stop_distance[] PROGMEM = "stop_distance";
+    constexpr const char json_speed_margin[] PROGMEM = "speed_margin";
+    constexpr const char json_hysteresis[] PROGMEM = "hysteresis";
+    constexpr const char json_max_age_ms[] PROGMEM = "max_age_ms";
+    constexpr const char json_ir_scale[] PROGMEM = "ir_scale";
+    constexpr const char json_state[] PROGMEM = "state";
+    constexpr const char json_range[] PROGMEM = "range";
+    constexpr const char json_cap[] PROGMEM = "cap";
+    constexpr const char json_request[] PROGMEM = "request";
+    constexpr const char json_reading_age_ms[] PROGMEM = "reading_age_ms";
+    constexpr const char json_trips[] PROGMEM = "trips";
+    constexpr const char json_blocks[] PROGMEM = "blocks";
+    constexpr const char json_sensor_losses[] PROGMEM = "sensor_losses";
+    constexpr const char json_events[] PROGMEM = "events";
+    constexpr const char json_last_trip_ms[] PROGMEM = "last_trip_ms";
+    constexpr const char json_trip_age_max_ms[] PROGMEM = "trip_age_max_ms";
+    constexpr const char settings_key_reflex[] PROGMEM = "obstacle_reflex";
+    constexpr const char req_obstacle_reflex[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"enabled\":{\"type\":\"boolean\"},\"port\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":6,\"description\":\"6 = SR04 connector, 0-5 = analog IR sensor on C0-C5\"},\"stop_distance\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":400,\"description\":\"cm: no forward motion at or below\"},\"speed_margin\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":400,\"description\":\"cm of extra clearance needed at full forward duty\"},\"hysteresis\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":100,\"description\":\"cm the range must clear by before the cap is lifted\"},\"max_age_ms\":{\"type\":\"integer\",\"minimum\":20,\"maximum\":65535,\"description\":\"Older readings block forward motion\"},\"ir_scale\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":65535,\"description\":\"Analog IR: range (cm) = ir_scale / ADC counts\"}}}";
+    constexpr const char ex_obstacle_reflex[] PROGMEM = "{\"enabled\":true,\"port\":6,\"stop_distance\":15,\"speed_margin\":40}";
+    constexpr const char schema_obstacle_reflex[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"config\":{\"type\":\"object\",\"properties\":{\"enabled\":{\"type\":\"boolean\"},\"port\":{\"type\":\"integer\"},\"stop_distance\":{\"type\":\"integer\"},\"speed_margin\":{\"type\":\"integer\"},\"hysteresis\":{\"type\":\"integer\"},\"max_age_ms\":{\"type\":\"integer\"},\"ir_scale\":{\"type\":\"integer\"}}},\"state\":{\"type\":\"string\",\"enum\":[\"clear\",\"limiting\",\"blocked\",\"no_sensor\"]},\"range\":{\"type\":\"integer\"},\"cap\":{\"type\":\"integer\"},\"request\":{\"type\":\"integer\"},\"reading_age_ms\":{\"type\":\"integer\"},\"trips\":{\"type\":\"integer\"},\"blocks\":{\"type\":\"integer\"},\"sensor_losses\":{\"type\":\"integer\"},\"events\":{\"type\":\"integer\"},\"last_trip_ms\":{\"type\":\"integer\"},\"trip_age_max_ms\":{\"type\":\"integer\"}}}";
+    constexpr const char ex_obstacle_reflex_status[] PROGMEM = "{\"config\":{\"enabled\":true,\"port\":6,\"stop_distance\":15,\"speed_margin\":40,\"hysteresis\":5,\"max_age_ms\":250,\"ir_scale\":30000},\"state\":\"limiting\",\"range\":32,\"cap\":300,\"request\":600,\"reading_age_ms\":38,\"trips\":14,\"blocks\":3,\"sensor_losses\":0,\"events\":31,\"last_trip_ms\":81230,\"trip_age_max_ms\":104}";
+
     // Battery route
     constexpr const char action_get_battery[] PROGMEM = "getBattery";
     constexpr const char desc_get_battery[] PROGMEM = "Get K10 board battery level (0-100%)";
     constexpr const char json_battery[] PROGMEM = "battery";
     constexpr const char schema_battery[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"battery\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":100}}}";
     constexpr const char ex_battery[] PROGMEM = "{\"battery\":85}";
+
+    // Register shadow cache statistics route
+    constexpr const char action_get_driver_stats[] PROGMEM = "getDriverStats";
+    constexpr const char desc_get_driver_stats[] PROGMEM = "Get actuator driver write counters (skipped, merged and repaired writes; DFR0548: merged = outputs bridged in a burst)";
+    constexpr const char json_driver[] PROGMEM = "driver";
+    constexpr const char json_writes_requested[] PROGMEM = "writes_requested";
+    constexpr const char json_writes_skipped[] PROGMEM = "writes_skipped";
+    constexpr const char json_writes_merged[] PROGMEM = "writes_merged";
+    constexpr const char json_spans_flushed[] PROGMEM = "spans_flushed";
+    constexpr const char json_flush_errors[] PROGMEM = "flush_errors";
+    constexpr const char json_verify_reads[] PROGMEM = "verify_reads";
+    constexpr const char json_verify_errors[] PROGMEM = "verify_errors";
+    constexpr const char json_registers_repaired[] PROGMEM = "registers_repaired";
+    constexpr const char json_flushes_overtaken[] PROGMEM = "flushes_overtaken";
+    constexpr const char schema_driver_stats[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"driver\":{\"type\":\"string\",\"enum\":[\"DFR1216\",\"DFR0548\"]},\"writes_requested\":{\"type\":\"integer\"},\"writes_skipped\":{\"type\":\"integer\"},\"writes_merged\":{\"type\":\"integer\"},\"spans_flushed\":{\"type\":\"integer\"},\"flush_errors\":{\"type\":\"integer\"},\"verify_reads\":{\"type\":\"integer\"},\"verify_errors\":{\"type\":\"integer\"},\"registers_repaired\":{\"type\":\"integer\"},\"flushes_overtaken\":{\"type\":\"integer\"}}}";
+    constexpr const char action_get_commit_stats[] PROGMEM = "getCommitStats";
+    constexpr const char desc_get_commit_stats[] PROGMEM = "Get actuator commit task counters, command-to-wire latency (µs), auto-stop wheel counters and emergency-stop trigger-to-bus latency (µs)";
+    constexpr const char json_commands[] PROGMEM = "commands";
+    constexpr const char json_coalesced[] PROGMEM = "coalesced";
+    constexpr const char json_commits[] PROGMEM = "commits";
+    constexpr const char json_slots_committed[] PROGMEM = "slots_committed";
+    constexpr const char json_commit_errors[] PROGMEM = "commit_errors";
+    constexpr const char json_latency_min_us[] PROGMEM = "latency_min_us";
+    constexpr const char json_latency_max_us[] PROGMEM = "latency_max_us";
+    constexpr const char json_latency_avg_us[] PROGMEM = "latency_avg_us";
+    constexpr const char json_latency_last_us[] PROGMEM = "latency_last_us";
+    constexpr const char json_commit_period_ms[] PROGMEM = "commit_period_ms";
+    constexpr const char json_auto_stop[] PROGMEM = "auto_stop";
+    constexpr const char json_arms[] PROGMEM = "arms";
+    constexpr const char json_rearms[] PROGMEM = "rearms";
+    constexpr const char json_cancels[] PROGMEM = "cancels";
+    constexpr const char json_expired[] PROGMEM = "expired";
+    constexpr const char json_pending[] PROGMEM = "pending";
+    constexpr const char json_arm_cycles_avg[] PROGMEM = "arm_cycles_avg";
+    constexpr const char json_arm_cycles_max[] PROGMEM = "arm_cycles_max";
+    constexpr const char json_tick_ms[] PROGMEM = "tick_ms";
+    constexpr const char json_emergency_stop[] PROGMEM = "emergency_stop";
+    constexpr const char json_triggers[] PROGMEM = "triggers";
+    constexpr const char json_failures[] PROGMEM = "failures";
+    constexpr const char json_transactions[] PROGMEM = "transactions";
+    constexpr const char json_bytes[] PROGMEM = "bytes";
+    constexpr const char json_wire_us[] PROGMEM = "wire_us";
+    constexpr const char json_hist_log2_us[] PROGMEM = "hist_log2_us";
+    constexpr const char schema_commit_stats[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"commands\":{\"type\":\"integer\"},\"coalesced\":{\"type\":\"integer\"},\"commits\":{\"type\":\"integer\"},\"slots_committed\":{\"type\":\"integer\"},\"commit_errors\":{\"type\":\"integer\"},\"latency_min_us\":{\"type\":\"integer\"},\"latency_max_us\":{\"type\":\"integer\"},\"latency_avg_us\":{\"type\":\"integer\"},\"latency_last_us\":{\"type\":\"integer\"},\"commit_period_ms\":{\"type\":\"integer\"},\"auto_stop\":{\"type\":\"object\",\"properties\":{\"arms\":{\"type\":\"integer\"},\"rearms\":{\"type\":\"integer\"},\"cancels\":{\"type\":\"integer\"},\"expired\":{\"type\":\"integer\"},\"pending\":{\"type\":\"integer\"},\"arm_cycles_avg\":{\"type\":\"integer\"},\"arm_cycles_max\":{\"type\":\"integer\"},\"tick_ms\":{\"type\":\"integer\"}}},\"emergency_stop\":{\"type\":\"object\",\"properties\":{\"triggers\":{\"type\":\"integer\"},\"failures\":{\"type\":\"integer\"},\"transactions\":{\"type\":\"integer\"},\"bytes\":{\"type\":\"integer\"},\"wire_us\":{\"type\":\"integer\"},\"latency_min_us\":{\"type\":\"integer\"},\"latency_max_us\":{\"type\":\"integer\"},\"latency_avg_us\":{\"type\":\"integer\"},\"latency_last_us\":{\"type\":\"integer\"},\"hist_log2_us\":{\"type\":\"array\",\"items\":{\"type\":\"integer\"}}}}}}";
+    constexpr const char ex_commit_stats[] PROGMEM = "{\"commands\":9000,\"coalesced\":6100,\"commits\":2400,\"slots_committed\":2900,\"commit_errors\":0,\"latency_min_us\":120,\"latency_max_us\":5400,\"latency_avg_us\":2700,\"latency_last_us\":2650,\"commit_period_ms\":5,\"auto_stop\":{\"arms\":48000,\"rearms\":47990,\"cancels\":6,\"expired\":4,\"pending\":2,\"arm_cycles_avg\":310,\"arm_cycles_max\":1900,\"tick_ms\":10},\"emergency_stop\":{\"triggers\":3,\"failures\":0,\"transactions\":2,\"bytes\":20,\"wire_us\":550,\"latency_min_us\":610,\"latency_max_us\":1480,\"latency_avg_us\":900,\"latency_last_us\":640,\"hist_log2_us\":[0,0,0,0,0,0,0,0,0,2,1,0,0,0,0,0]}}";
+    // Motion profiles
+    constexpr const char action_set_motion_profile[] PROGMEM = "setMotionProfile";
+    constexpr const char action_get_motion_status[] PROGMEM = "getMotionStatus";
+    constexpr const char desc_set_motion_profile[] PROGMEM = "Set the motion profile of an angular servo channel: later angle commands move along a trapezoidal (max_jerk=0) or S-curve trajectory. max_velocity=0 disables the profile.";
+    constexpr const char desc_get_motion_status[] PROGMEM = "Get profiled position, target and velocity of every servo channel";
+    constexpr const char json_max_velocity[] PROGMEM = "max_velocity";
+    constexpr const char json_max_acceleration[] PROGMEM = "max_acceleration";
+    constexpr const char json_max_jerk[] PROGMEM = "max_jerk";
+    constexpr const char json_position[] PROGMEM = "position";
+    constexpr const char json_target[] PROGMEM = "target";
+    constexpr const char json_velocity[] PROGMEM = "velocity";
+    constexpr const char json_moving[] PROGMEM = "moving";
+    constexpr const char json_moves_completed[] PROGMEM = "moves_completed";
+    constexpr const char settings_key_motion[] PROGMEM = "motion_profiles";
+    constexpr const char req_motion_profile[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":7},\"max_velocity\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":65535,\"description\":\"deg/s (0 disables the profile)\"},\"max_acceleration\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":65535,\"description\":\"deg/s²\"},\"max_jerk\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":65535,\"description\":\"deg/s³ (0 = trapezoidal, optional)\"}},\"required\":[\"channel\",\"max_velocity\",\"max_acceleration\"]}";
+    constexpr const char ex_motion_profile[] PROGMEM = "{\"channel\":0,\"max_velocity\":120,\"max_acceleration\":400,\"max_jerk\":2000}";
+    constexpr const char schema_motion_status[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"moves_completed\":{\"type\":\"integer\"},\"servos\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\"},\"position\":{\"type\":\"number\"},\"target\":{\"type\":\"number\"},\"velocity\":{\"type\":\"number\"},\"moving\":{\"type\":\"boolean\"},\"max_velocity\":{\"type\":\"integer\"},\"max_acceleration\":{\"type\":\"integer\"},\"max_jerk\":{\"type\":\"integer\"}}}}}}";
+    constexpr const char ex_motion_status[] PROGMEM = "{\"moves_completed\":12,\"servos\":[{\"channel\":0,\"position\":31.25,\"target\":45,\"velocity\":98.5,\"moving\":true,\"max_velocity\":120,\"max_acceleration\":400,\"max_jerk\":2000}]}";
+    // Per-channel calibration
+    constexpr const char action_set_calibration[] PROGMEM = "setCalibration";
+    constexpr const char action_get_calibration[] PROGMEM = "getCalibration";
+    constexpr const char action_calibration_jog[] PROGMEM = "calibrationJog";
+    constexpr const char action_calibration_capture[] PROGMEM = "calibrationCapture";
+    constexpr const char desc_set_calibration[] PROGMEM = "Set the calibration of a servo channel (endpoints, trim, deadband, speed curve); omitted fields keep their value, 0 restores the default";
+    constexpr const char desc_get_calibration[] PROGMEM = "Get the effective calibration of every servo channel";
+    constexpr const char desc_calibration_jog[] PROGMEM = "Calibration routine: output a raw pulse width on a channel, bypassing its calibration";
+    constexpr const char desc_calibration_capture[] PROGMEM = "Calibration routine: store the last jog pulse as the channel min, max, center or deadband edge";
+    constexpr const char json_min_us[] PROGMEM = "min_us";
+    constexpr const char json_max_us[] PROGMEM = "max_us";
+    constexpr const char json_trim_us[] PROGMEM = "trim_us";
+    constexpr const char json_deadband_us[] PROGMEM = "deadband_us";
+    constexpr const char json_expo[] PROGMEM = "expo";
+    constexpr const char json_centre_us[] PROGMEM = "centre_us";
+    constexpr const char json_pulse_us[] PROGMEM = "pulse_us";
+    constexpr const char json_point[] PROGMEM = "point";
+    constexpr const char point_min[] PROGMEM = "min";
+    constexpr const char point_max[] PROGMEM = "max";
+    constexpr const char point_center[] PROGMEM = "center";
+    constexpr const char point_deadband[] PROGMEM = "deadband";
+    constexpr const char err_no_jog[] PROGMEM = "No jog pulse on this channel: call calibrationJog first";
+    constexpr const char err_unknown_point[] PROGMEM = "point must be min, max, center or deadband";
+    constexpr const char err_pulse_range[] PROGMEM = "pulse_us must be 400-3500";
+    constexpr const char err_calibration_format[] PROGMEM = "malformed, expected min:max:trim:deadband:expo";
+    constexpr const char settings_key_calibration[] PROGMEM = "calibration";
+    constexpr const char req_calibration[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":7},\"min_us\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":3500,\"description\":\"Angular: pulse at -travel/2; continuous: full speed forward (0 = default)\"},\"max_us\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":3500,\"description\":\"Angular: pulse at +travel/2; continuous: full speed backward (0 = default)\"},\"trim_us\":{\"type\":\"integer\",\"minimum\":-300,\"maximum\":300},\"deadband_us\":{\"type\":\"integer\",\"minimum\":0},\"expo\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":100,\"description\":\"Speed curve, 0 linear to 100 cubic\"}},\"required\":[\"channel\"]}";
+    constexpr const char ex_calibration[] PROGMEM = "{\"channel\":2,\"trim_us\":-20,\"deadband_us\":60,\"expo\":40}";
+    constexpr const char schema_calibration[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"servos\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\"},\"min_us\":{\"type\":\"integer\"},\"max_us\":{\"type\":\"integer\"},\"trim_us\":{\"type\":\"integer\"},\"deadband_us\":{\"type\":\"integer\"},\"expo\":{\"type\":\"integer\"},\"centre_us\":{\"type\":\"integer\"},\"pulse_us\":{\"type\":\"integer\"}}}}}}";
+    constexpr const char ex_calibration_all[] PROGMEM = "{\"servos\":[{\"channel\":2,\"min_us\":520,\"max_us\":2480,\"trim_us\":-20,\"deadband_us\":60,\"expo\":40,\"centre_us\":1480,\"pulse_us\":0}]}";
+    constexpr const char req_calibration_jog[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":7},\"pulse_us\":{\"type\":\"integer\",\"minimum\":400,\"maximum\":3500}},\"required\":[\"channel\",\"pulse_us\"]}";
+    constexpr const char ex_calibration_jog[] PROGMEM = "{\"channel\":2,\"pulse_us\":1540}";
+    constexpr const char req_calibration_capture[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"channel\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":7},\"point\":{\"type\":\"string\",\"enum\":[\"min\",\"max\",\"center\",\"deadband\"]}},\"required\":[\"channel\",\"point\"]}";
+    constexpr const char ex_calibration_capture[] PROGMEM = "{\"channel\":2,\"point\":\"deadband\"}";
+    // Keyframe timelines
+    constexpr const char action_upload_timeline[] PROGMEM = "uploadTimeline";
+    constexpr const char action_play_timeline[] PROGMEM = "playTimeline";
+    constexpr const char action_stop_timeline[] PROGMEM = "stopTimeline";
+    constexpr const char action_delete_timeline[] PROGMEM = "deleteTimeline";
+    constexpr const char action_get_timeline_status[] PROGMEM = "getTimelineStatus";
+    constexpr const char desc_upload_timeline[] PROGMEM = "Validate a keyframe timeline (servo and motor tracks, linear or cubic interpolation) and store it in LittleFS under its id";
+    constexpr const char desc_play_timeline[] PROGMEM = "Play a stored timeline by id; optional loop overrides the timeline's own loop flag";
+    constexpr const char desc_stop_timeline[] PROGMEM = "Stop the running timeline (angular servos hold, motors and continuous servos stop)";
+    constexpr const char desc_delete_timeline[] PROGMEM = "Delete a stored timeline";
+    constexpr const char desc_get_timeline_status[] PROGMEM = "Get timeline playback state and the ids of stored timelines";
+    constexpr const char json_id[] PROGMEM = "id";
+    constexpr const char json_loop[] PROGMEM = "loop";
+    constexpr const char json_playing[] PROGMEM = "playing";
+    constexpr const char json_position_ms[] PROGMEM = "position_ms";
+    constexpr const char json_duration_ms[] PROGMEM = "duration_ms";
+    constexpr const char json_loops_completed[] PROGMEM = "loops_completed";
+    constexpr const char json_ticks[] PROGMEM = "ticks";
+    constexpr const char json_skipped_ticks[] PROGMEM = "skipped_ticks";
+    constexpr const char json_stored[] PROGMEM = "stored";
+    constexpr const char req_timeline[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"id\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":255},\"interpolation\":{\"type\":\"string\",\"enum\":[\"linear\",\"cubic\"]},\"loop\":{\"type\":\"boolean\"},\"tracks\":{\"type\":\"array\",\"maxItems\":12,\"items\":{\"type\":\"object\",\"properties\":{\"servo\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":7},\"motor\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":4},\"keys\":{\"type\":\"array\",\"items\":{\"type\":\"array\",\"items\":{\"type\":\"number\"},\"minItems\":2,\"maxItems\":2}}},\"required\":[\"keys\"]}}},\"required\":[\"id\",\"tracks\"]}";
+    constexpr const char ex_timeline[] PROGMEM = "{\"id\":1,\"interpolation\":\"cubic\",\"loop\":true,\"tracks\":[{\"servo\":0,\"keys\":[[0,0],[400,30],[800,0]]},{\"motor\":1,\"keys\":[[0,0],[800,60]]}]}";
+    constexpr const char req_timeline_play[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"id\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":255},\"loop\":{\"type\":\"boolean\"}},\"required\":[\"id\"]}";
+    constexpr const char ex_timeline_play[] PROGMEM = "{\"id\":1,\"loop\":false}";
+    constexpr const char req_timeline_id[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"id\":{\"type\":\"integer\",\"minimum\":0,\"maximum\":255}},\"required\":[\"id\"]}";
+    constexpr const char ex_timeline_id[] PROGMEM = "{\"id\":1}";
+    constexpr const char schema_timeline_status[] PROGMEM = "{\"type\":\"object\",\"properties\":{\"playing\":{\"type\":\"boolean\"},\"id\":{\"type\":\"integer\"},\"loop\":{\"type\":\"boolean\"},\"position_ms\":{\"type\":\"integer\"},\"duration_ms\":{\"type\":\"integer\"},\"loops_completed\":{\"type\":\"integer\"},\"ticks\":{\"type\":\"integer\"},\"skipped_ticks\":{\"type\":\"integer\"},\"stored\":{\"type\":\"array\",\"items\":{\"type\":\"integer\"}}}}";
+    constexpr const char ex_timeline_status[] PROGMEM = "{\"playing\":true,\"id\":1,\"loop\":true,\"position_ms\":420,\"duration_ms\":800,\"loops_completed\":3,\"ticks\":700,\"skipped_ticks\":0,\"stored\":[1,2]}";
+    constexpr const char ex_driver_stats[] PROGMEM = "{\"driver\":\"DFR1216\",\"writes_requested\":5120,\"writes_skipped\":4870,\"writes_merged\":180,\"spans_flushed\":70,\"flush_errors\":0,\"verify_reads\":360,\"verify_errors\":0,\"registers_repaired\":4,\"flushes_overtaken\":1}";
 }
 
-std::array<ServoConnection, MAX_SERVO_CHANNELS> attached_servos = {NOT_CONNECTED, NOT_CONNECTED, NOT_CONNECTED, NOT_CONNECTED,
-                                                                   NOT_CONNECTED, NOT_CONNECTED, NOT_CONNECTED, NOT_CONNECTED};
+// ─── Commanded actuator state ─────────────────────────────────────────────────
+// Servo types, last speeds/angles and motor speeds are written from the HTTP, UDP,
+// WebSocket, timer and heartbeat contexts. They live in one packed block behind a
+// sequence lock: writers publish complete updates inside a critical section and
+// readers (status replies, display) copy a consistent snapshot without locking.
+using ActuatorState = ServoService::ActuatorState;
+static_assert(ActuatorState::SERVOS == MAX_SERVO_CHANNELS && ActuatorState::MOTORS == MAX_MOTOR_CHANNELS,
+              "ActuatorState sizes must match the channel counts");
+static SeqLock<ActuatorState> actuator_state;
+static portMUX_TYPE actuator_state_lock = portMUX_INITIALIZER_UNLOCKED;
 
-// Track current servo speeds to avoid redundant updates (initialized to invalid value)
-std::array<int8_t, MAX_SERVO_CHANNELS> servo_speeds = {-128, -128, -128, -128, -128, -128, -128, -128};
+/**
+ * @brief Publish one change of the actuator state (all fields touched by @p update at once).
+ */
+template <typename Fn>
+static void publishActuatorState(Fn &&update)
+{
+    portENTER_CRITICAL(&actuator_state_lock);
+    actuator_state.write(update);
+    portEXIT_CRITICAL(&actuator_state_lock);
+}
 
-// Track current servo angles for angular servos (initialized to -1 = never set)
-std::array<int16_t, MAX_SERVO_CHANNELS> servo_angles = {-1, -1, -1, -1, -1, -1, -1, -1};
+static inline ActuatorState actuatorSnapshot()
+{
+    return actuator_state.read();
+}
 
-// Track current motor speeds to avoid redundant updates (initialized to invalid value)
-std::array<int8_t, MAX_MOTOR_CHANNELS> motor_speeds = {-128, -128, -128, -128};
+static inline ServoConnection attachedConnection(uint8_t channel)
+{
+    return actuatorSnapshot().connection(channel);
+}
+
+static void trackServoSpeed(uint8_t channel, int8_t speed)
+{
+    publishActuatorState([&](ActuatorState &state)
+                         { state.servo_speeds[channel] = speed; });
+}
+
+static void trackServoAngle(uint8_t channel, int16_t angle)
+{
+    publishActuatorState([&](ActuatorState &state)
+                         { state.servo_angles[channel] = angle; });
+}
+
+static void trackMotorSpeed(uint8_t index, int8_t speed)
+{
+    publishActuatorState([&](ActuatorState &state)
+                         { state.motor_speeds[index] = speed; });
+}
+
+// ─── Desired actuator state (latest-wins) ─────────────────────────────────────
+// Setters only publish the pulse/duty they want; the commit task pushes pending
+// slots to the driver once per control period, so bus load stays bounded no
+// matter how fast HTTP/UDP/WebSocket commands arrive. A slot rewritten before
+// it was committed is simply overwritten (coalesced).
+//   slot 0-7  : servo channel pulse width (µs)
+//   slot 8-15 : motor half-bridge duty (eMotor1_A..eMotor4_B)
+constexpr uint8_t DESIRED_MOTOR_BASE = MAX_SERVO_CHANNELS;
+constexpr uint8_t DESIRED_SLOTS = MAX_SERVO_CHANNELS + MAX_MOTOR_CHANNELS * 2;
+static std::array<std::atomic<uint16_t>, DESIRED_SLOTS> desired_values;
+static std::array<std::atomic<uint32_t>, DESIRED_SLOTS> desired_stamp_us; ///< micros() of the first uncommitted command
+static std::atomic<uint32_t> desired_pending{0};                           ///< bit N set: slot N awaits commit
+static std::atomic<uint32_t> commands_staged{0};
+static std::atomic<uint32_t> commands_coalesced{0};
+static ServoService::CommitStats commit_stats = {}; ///< Written by the commit task only
+static TaskHandle_t actuator_commit_task = nullptr;
+static std::atomic<bool> actuator_commit_exit{false}; ///< Set by stopService(): leave the loop
+static SemaphoreHandle_t actuator_commit_done = nullptr; ///< Given by the commit task as it exits
+static std::atomic<bool> actuator_verify_requested{false}; ///< Set by verifyActuatorRegisters(), run by the commit task
+static std::atomic<uint8_t> actuator_verify_repaired{0};    ///< Registers rewritten by the last check
+
+/**
+ * @brief Publish a desired value for one slot (lock-free, callable from any task).
+ */
+static void stageDesired(uint8_t slot, uint16_t value)
+{
+    const uint32_t bit = 1UL << slot;
+    desired_values[slot].store(value, std::memory_order_relaxed);
+    if (desired_pending.load(std::memory_order_relaxed) & bit)
+        commands_coalesced.fetch_add(1, std::memory_order_relaxed);
+    else
+        desired_stamp_us[slot].store(micros(), std::memory_order_relaxed);
+    desired_pending.fetch_or(bit, std::memory_order_release);
+    commands_staged.fetch_add(1, std::memory_order_relaxed);
+}
+
+static inline void stageServoPulse(uint8_t channel, uint16_t pulse_us)
+{
+    stageDesired(channel, pulse_us);
+}
+
+// ─── Twist drive (differential kinematics) ────────────────────────────────────
+// setTwist() publishes a (linear, angular) target; the commit task mixes it into
+// wheel commands, ramps them and stages both wheel motors right before the
+// commit, so the two wheels always change in the same bus burst. Any direct
+// command on a mapped motor (setMotorSpeed, UDP, timeline, auto-stop, stop
+// routes) releases the twist. The engaged flag and the twist's own staging share
+// twist_lock, so a direct stop can never be overwritten by a late twist step.
+// Lock order: actuator_state_lock, then twist_lock.
+static portMUX_TYPE twist_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool twist_engaged = false;        ///< Guarded by twist_lock
+static uint8_t twist_motor_mask = 0x03;   ///< Guarded by twist_lock: bit N = motor index N is a wheel
+static uint32_t twist_engagements = 0;    ///< Guarded by twist_lock
+static uint32_t twist_releases = 0;       ///< Guarded by twist_lock
+static SeqLock<DriveConfig> drive_config; ///< Written under twist_lock
+static std::atomic<uint32_t> twist_target{0}; ///< linear << 16 | (uint16_t)angular
+static std::atomic<uint32_t> twist_count{0};
+static std::atomic<bool> twist_retarget{false};
+static std::atomic<bool> twist_takeover{false}; ///< Engaged since the last step: ramp from the motors' state
+static std::atomic<bool> drive_reconfigure{true};
+static DifferentialDrive twist_drive;                  ///< Owned by the commit task
+static bool twist_reflex_restage = false;              ///< Owned by the commit task: the reflex cap or speed scale changed
+static SeqLock<ServoService::DriveStatus> drive_status; ///< Written by the commit task only
+
+// ─── Obstacle reflex ──────────────────────────────────────────────────────────
+// The commit task turns the latest range into a forward duty cap once per control
+// period (stepObstacleReflex). Every duty staged on a wheel motor of the drive
+// configuration, twist or direct, goes through stageMotorDuty(), which applies
+// the cap; when the cap changes the task re-stages the wheels itself, so a new
+// cap reaches the bus in the same commit, without a round trip to the master.
+static SeqLock<ReflexConfig> reflex_config;
+static std::atomic<bool> reflex_reconfigure{true};
+static std::atomic<int32_t> reflex_cap{ObstacleReflex::FULL_SCALE}; ///< Forward duty cap (1/1000)
+static ObstacleReflex obstacle_reflex;                   ///< Owned by the commit task
+static SeqLock<ServoService::ReflexStatus> reflex_status; ///< Written by the commit task only
+
+// ─── Link derating ────────────────────────────────────────────────────────────
+// AmakerBotService scales the wheel duty down while the master link degrades
+// (setSpeedScale). The scale is applied by stageMotorDuty() before the reflex cap,
+// in both directions; the commit task re-stages the wheels when it changes.
+static std::atomic<int32_t> speed_scale{1000}; ///< Wheel duty scale (1/1000)
+static std::atomic<bool> speed_rescale{false};
+
+static inline uint32_t packTwist(int16_t linear, int16_t angular)
+{
+    return (static_cast<uint32_t>(static_cast<uint16_t>(linear)) << 16) | static_cast<uint16_t>(angular);
+}
+
+static int32_t motor_requests[MAX_MOTOR_CHANNELS] = {}; ///< Guarded by twist_lock: last duty staged, before the reflex cap
+
+static void stageHalfBridges(uint8_t index, int32_t duty)
+{
+    const uint16_t magnitude = static_cast<uint16_t>((std::abs(duty) * 65535) / 1000);
+    const uint8_t slot_a = DESIRED_MOTOR_BASE + index * 2;
+    stageDesired(slot_a, duty > 0 ? magnitude : 0);
+    stageDesired(slot_a + 1, duty < 0 ? magnitude : 0);
+}
+
+/**
+ * @brief Publish both half-bridge duties of a motor.
+ * @details Called with twist_lock held. The duty of a wheel motor is scaled by the
+ *          link derating. While the obstacle reflex caps forward motion, both wheels
+ *          are then re-staged from their requests, scaled by the same factor so the
+ *          faster forward wheel meets the cap: the pair keeps its curvature, as in
+ *          the mixer's saturation. A pair with no forward wheel is never capped.
+ * @param index Motor index (0-3)
+ * @param duty  Signed duty in 1/1000 (-1000 to +1000, negative is reverse)
+ */
+static void stageMotorDuty(uint8_t index, int32_t duty)
+{
+    const bool wheel = twist_motor_mask & (1u << index);
+    const int32_t scale = speed_scale.load(std::memory_order_relaxed);
+    if (wheel && scale < 1000)
+        duty = duty * scale / 1000;
+    motor_requests[index] = duty;
+    if (!wheel)
+    {
+        stageHalfBridges(index, duty);
+        return;
+    }
+    const int32_t cap = reflex_cap.load(std::memory_order_relaxed);
+    if (cap >= ObstacleReflex::FULL_SCALE)
+    {
+        stageHalfBridges(index, duty);
+        return;
+    }
+    // drive_config is written under twist_lock: this read never retries
+    const DriveConfig config = drive_config.read();
+    const int32_t left = motor_requests[config.left_motor];
+    const int32_t right = motor_requests[config.right_motor];
+    const int32_t left_forward = config.invert_left ? -left : left;
+    const int32_t right_forward = config.invert_right ? -right : right;
+    const int32_t peak = left_forward > right_forward ? left_forward : right_forward;
+    if (peak > cap)
+    {
+        stageHalfBridges(config.left_motor, left * cap / peak);
+        stageHalfBridges(config.right_motor, right * cap / peak);
+    }
+    else
+    {
+        stageHalfBridges(config.left_motor, left);
+        stageHalfBridges(config.right_motor, right);
+    }
+}
+
+/**
+ * @brief Publish both half-bridge duties of a motor for a signed speed.
+ * @details A direct command on a wheel motor takes it back from the twist drive.
+ * @param index Motor index (0-3)
+ * @param speed Speed percentage (-100 to +100)
+ */
+static void stageMotorSpeed(uint8_t index, int8_t speed)
+{
+    portENTER_CRITICAL(&twist_lock);
+    if (twist_engaged && (twist_motor_mask & (1u << index)))
+    {
+        twist_engaged = false;
+        twist_releases++;
+    }
+    stageMotorDuty(index, static_cast<int32_t>(speed) * 10);
+    portEXIT_CRITICAL(&twist_lock);
+}
+
+// ─── Motion profiles (angular servos) ─────────────────────────────────────────
+// Limits and targets are published by setters through atomics; the profile
+// objects themselves belong to the commit task, which steps them once per
+// control period and stages the resulting pulse. Angles are centre-zero and
+// kept in 1/1000 degree.
+struct MotionLimits
+{
+    std::atomic<uint16_t> max_velocity{0};     ///< degree/s (0 = no profile, jump to target)
+    std::atomic<uint16_t> max_acceleration{0}; ///< degree/s²
+    std::atomic<uint16_t> max_jerk{0};         ///< degree/s³ (0 = trapezoidal)
+};
+static std::array<MotionLimits, MAX_SERVO_CHANNELS> motion_limits;
+static std::array<std::atomic<int32_t>, MAX_SERVO_CHANNELS> motion_targets;   ///< Latest commanded angle
+static std::array<std::atomic<int32_t>, MAX_SERVO_CHANNELS> motion_positions; ///< Published by the commit task
+static std::array<std::atomic<int32_t>, MAX_SERVO_CHANNELS> motion_velocities;
+static std::atomic<uint8_t> motion_retarget{0};     ///< bit N: channel N has a new target
+static std::atomic<uint8_t> motion_resync{0};       ///< bit N: channel N was moved elsewhere, target is its position
+static std::atomic<uint8_t> motion_moving_mask{0};  ///< bit N: channel N is following a profile
+static std::atomic<uint32_t> motion_moves_completed{0};
+static MotionProfile servo_profiles[MAX_SERVO_CHANNELS]; ///< Owned by the commit task
+
+// Receiver of unsolicited events (target reached, obstacle reflex): last UDP/WebSocket
+// peer that started a profiled move or drove the motors
+static std::atomic<uint32_t> motion_event_ip{0};
+static std::atomic<uint16_t> motion_event_port{0};
+static std::atomic<uint32_t> motion_event_ws_client{0};
+
+static inline bool motionProfileEnabled(uint8_t channel)
+{
+    return motion_limits[channel].max_velocity.load(std::memory_order_relaxed) > 0 &&
+           motion_limits[channel].max_acceleration.load(std::memory_order_relaxed) > 0;
+}
+
+// ─── Per-channel calibration ──────────────────────────────────────────────────
+// Each channel keeps its own calibration (SettingsService key "calibration") and a
+// pulse table compiled from it when the servo is attached or recalibrated, so
+// angle and speed commands cost one table read. The commit task and the timer
+// callbacks read the tables while HTTP/UDP handlers recalibrate: a table is
+// compiled aside and swapped in under pulse_table_lock, which readers take for
+// the read. Leaf lock: nothing else is taken while it is held.
+static std::array<ServoCalibration, MAX_SERVO_CHANNELS> servo_calibrations; ///< Written under pulse_table_lock
+static ServoPulseTable servo_pulse_tables[MAX_SERVO_CHANNELS];             ///< Guarded by pulse_table_lock
+static portMUX_TYPE pulse_table_lock = portMUX_INITIALIZER_UNLOCKED;
+static std::array<uint16_t, MAX_SERVO_CHANNELS> calibration_jog_us = {}; ///< Last raw pulse of the calibration routine (0 = none)
+
+static ServoPulseTable::Model pulseModel(ServoConnection connection)
+{
+    switch (connection)
+    {
+    case ROTATIONAL:
+        return ServoPulseTable::Model::CONTINUOUS;
+    case ANGULAR_180:
+        return ServoPulseTable::Model::ANGULAR_180;
+    case ANGULAR_270:
+        return ServoPulseTable::Model::ANGULAR_270;
+    default:
+        return ServoPulseTable::Model::NONE;
+    }
+}
+
+/**
+ * @brief Pulse width for a centre-zero angle given in 1/1000 degree.
+ * @details Read from the channel table; fractions of a degree are interpolated
+ *          so profiled moves do not advance in 1° stairs.
+ */
+static inline uint16_t anglePulseMilliDegrees(uint8_t channel, int32_t angle_mdeg)
+{
+    portENTER_CRITICAL(&pulse_table_lock);
+    const uint16_t pulse_us = servo_pulse_tables[channel].anglePulse(angle_mdeg);
+    portEXIT_CRITICAL(&pulse_table_lock);
+    return pulse_us;
+}
+
+/**
+ * @brief Pulse width for a continuous servo speed (-100..100).
+ */
+static inline uint16_t speedPulse(uint8_t channel, int8_t speed)
+{
+    portENTER_CRITICAL(&pulse_table_lock);
+    const uint16_t pulse_us = servo_pulse_tables[channel].speedPulse(speed);
+    portEXIT_CRITICAL(&pulse_table_lock);
+    return pulse_us;
+}
+
+/**
+ * @brief Compile a channel's table from a calibration and swap both in.
+ * @details The evaluation runs outside the lock; only the copy is inside.
+ */
+static void installCalibration(uint8_t channel, ServoPulseTable::Model model, const ServoCalibration &calibration)
+{
+    ServoPulseTable compiled;
+    compiled.compile(model, calibration);
+    portENTER_CRITICAL(&pulse_table_lock);
+    servo_calibrations[channel] = calibration;
+    servo_pulse_tables[channel] = compiled;
+    portEXIT_CRITICAL(&pulse_table_lock);
+}
+
+static ServoCalibration storedCalibration(uint8_t channel)
+{
+    portENTER_CRITICAL(&pulse_table_lock);
+    const ServoCalibration calibration = servo_calibrations[channel];
+    portEXIT_CRITICAL(&pulse_table_lock);
+    return calibration;
+}
+
+/**
+ * @brief Command an already validated centre-zero angle on an angular channel.
+ * @details Without a motion profile the pulse is staged immediately; otherwise the
+ *          commit task plans the move from the current profiled position.
+ */
+static void stageServoAngle(uint8_t channel, int16_t angle)
+{
+    const int32_t target_mdeg = static_cast<int32_t>(angle) * 1000;
+    if (!motionProfileEnabled(channel))
+        stageServoPulse(channel, anglePulseMilliDegrees(channel, target_mdeg));
+    motion_targets[channel].store(target_mdeg, std::memory_order_relaxed);
+    motion_retarget.fetch_or(static_cast<uint8_t>(1u << channel), std::memory_order_release);
+}
+
+/**
+ * @brief Remember which peer should receive target-reached and obstacle events.
+ */
+static void setMotionEventReceiver(const IPAddress &remoteIP, uint16_t remotePort)
+{
+    motion_event_ip.store(static_cast<uint32_t>(remoteIP), std::memory_order_relaxed);
+    motion_event_port.store(remotePort, std::memory_order_relaxed);
+    motion_event_ws_client.store(ws_client_id_context, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Tell the motion profile of a channel where another source left it.
+ */
+static void resyncMotionProfile(uint8_t channel, int32_t position_mdeg)
+{
+    motion_targets[channel].store(position_mdeg, std::memory_order_relaxed);
+    motion_resync.fetch_or(static_cast<uint8_t>(1u << channel), std::memory_order_release);
+}
+
+// ─── Keyframe timeline player ─────────────────────────────────────────────────
+// One periodic esp_timer samples every track of the active timeline and stages
+// the values like any other setter. The timeline object is shared with the
+// HTTP/UDP tasks through timeline_mutex; the timer never blocks on it and
+// counts a skipped tick instead.
+constexpr const char TIMELINE_DIR[] = "/timelines";
+static KeyframeTimeline active_timeline;   ///< Guarded by timeline_mutex
+static bool active_timeline_valid = false; ///< false once the stored copy has been replaced
+static SemaphoreHandle_t timeline_mutex = nullptr;
+static esp_timer_handle_t timeline_timer = nullptr;
+static int64_t timeline_start_us = 0;
+static bool timeline_loop = false;
+static std::atomic<bool> timeline_playing{false};
+static std::atomic<uint32_t> timeline_position_ms{0};
+static std::atomic<uint32_t> timeline_loops_completed{0};
+static std::atomic<uint32_t> timeline_ticks{0};
+static std::atomic<uint32_t> timeline_skipped_ticks{0};
+
+static std::string timelinePath(uint8_t id)
+{
+    return std::string(TIMELINE_DIR) + "/" + std::to_string(id) + ".json";
+}
+
+/**
+ * @brief Stage the value of every track at @p time_ms.
+ */
+static void applyTimelineFrame(uint32_t time_ms)
+{
+    struct TrackValue
+    {
+        KeyframeTimeline::Target target;
+        uint8_t channel;
+        ServoConnection connection;
+        int32_t value; ///< Speed (%) or angle (degrees), as tracked
+    };
+    TrackValue values[KeyframeTimeline::MAX_TRACKS];
+    uint8_t count = 0;
+    const ActuatorState state = actuatorSnapshot();
+    for (const KeyframeTimeline::Track &track : active_timeline.tracks())
+    {
+        if (count >= KeyframeTimeline::MAX_TRACKS)
+            break;
+        const int32_t value = active_timeline.sample(track, time_ms);
+        const uint8_t ch = track.channel;
+        int32_t speed = value / 1000;
+        speed = speed > 100 ? 100 : (speed < -100 ? -100 : speed);
+        const ServoConnection connection = state.connection(ch);
+        if (track.target == KeyframeTimeline::Target::MOTOR)
+        {
+            stageMotorSpeed(ch, static_cast<int8_t>(speed));
+            values[count++] = {track.target, ch, connection, speed};
+        }
+        else if (connection == ANGULAR_180 || connection == ANGULAR_270)
+        {
+            stageServoPulse(ch, anglePulseMilliDegrees(ch, value));
+            values[count++] = {track.target, ch, connection, value / 1000};
+        }
+        else if (connection == ROTATIONAL)
+        {
+            stageServoPulse(ch, speedPulse(ch, static_cast<int8_t>(speed)));
+            values[count++] = {track.target, ch, connection, speed};
+        }
+    }
+    // One publication per frame, touching only the channels the tracks drive:
+    // the other fields may have changed since the snapshot
+    publishActuatorState([&](ActuatorState &current)
+                         {
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            const TrackValue &track = values[i];
+            if (track.target == KeyframeTimeline::Target::MOTOR)
+                current.motor_speeds[track.channel] = static_cast<int8_t>(track.value);
+            else if (track.connection == ROTATIONAL)
+                current.servo_speeds[track.channel] = static_cast<int8_t>(track.value);
+            else
+                current.servo_angles[track.channel] = static_cast<int16_t>(track.value);
+        } });
+}
+
+/**
+ * @brief Hand the angular channels of the active timeline back to their motion
+ *        profiles at the given time, so a later profiled move starts from there.
+ */
+static void resyncTimelineProfiles(uint32_t time_ms)
+{
+    for (const KeyframeTimeline::Track &track : active_timeline.tracks())
+        if (track.target == KeyframeTimeline::Target::SERVO)
+            resyncMotionProfile(track.channel, active_timeline.sample(track, time_ms));
+}
+
+/**
+ * @brief esp_timer callback: one playback tick.
+ */
+static void timeline_tick_cb(void *arg)
+{
+    if (xSemaphoreTake(timeline_mutex, 0) != pdTRUE)
+    {
+        timeline_skipped_ticks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (timeline_playing.load(std::memory_order_relaxed) && !active_timeline.empty())
+    {
+        const uint32_t duration_ms = active_timeline.durationMs();
+        uint32_t elapsed_ms = static_cast<uint32_t>((esp_timer_get_time() - timeline_start_us) / 1000);
+        bool finished = false;
+        if (elapsed_ms >= duration_ms)
+        {
+            if (timeline_loop && duration_ms > 0)
+            {
+                // Keep the phase: restart from where the previous lap overran
+                const uint32_t laps = elapsed_ms / duration_ms;
+                timeline_start_us += static_cast<int64_t>(laps) * duration_ms * 1000;
+                elapsed_ms -= laps * duration_ms;
+                timeline_loops_completed.fetch_add(laps, std::memory_order_relaxed);
+            }
+            else
+            {
+                elapsed_ms = duration_ms;
+                finished = true;
+            }
+        }
+        applyTimelineFrame(elapsed_ms);
+        timeline_position_ms.store(elapsed_ms, std::memory_order_relaxed);
+        timeline_ticks.fetch_add(1, std::memory_order_relaxed);
+        if (finished)
+        {
+            timeline_playing.store(false, std::memory_order_relaxed);
+            esp_timer_stop(timeline_timer);
+            resyncTimelineProfiles(elapsed_ms);
+        }
+    }
+    xSemaphoreGive(timeline_mutex);
+}
+
+/**
+ * @brief Read and compile a stored timeline.
+ */
+static bool loadTimelineFile(uint8_t id, KeyframeTimeline &timeline, std::string &error)
+{
+    File file = LittleFS.open(timelinePath(id).c_str(), FILE_READ);
+    if (!file)
+    {
+        error = "timeline not found";
+        return false;
+    }
+    JsonDocument doc;
+    const DeserializationError json_error = deserializeJson(doc, file);
+    file.close();
+    if (json_error)
+    {
+        error = std::string("stored timeline unreadable: ") + json_error.c_str();
+        return false;
+    }
+    return timeline.parse(doc.as<JsonVariantConst>(), error);
+}
+
+/**
+ * @brief Actuator commit task: steps the motion profiles, the obstacle reflex and the twist
+ *        drive, then commits the desired-state diff every control period, or immediately
+ *        when notified (stop commands). Exits between two periods when stopService() asks,
+ *        never while it holds the shadow or bus mutex of the driver.
+ */
+static void actuator_commit_task_fn(void *pvParameters)
+{
+    uint32_t last_step_us = micros();
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(COMMIT_PERIOD_MS));
+        if (actuator_commit_exit.load(std::memory_order_acquire))
+            break;
+        const uint32_t now_us = micros();
+        const uint32_t dt_us = now_us - last_step_us;
+        last_step_us = now_us;
+        servo_service.stepMotionProfiles(dt_us < MOTION_MAX_STEP_US ? dt_us : MOTION_MAX_STEP_US);
+        servo_service.stepObstacleReflex(millis());
+        servo_service.stepSpeedScale();
+        servo_service.stepTwist(dt_us < MOTION_MAX_STEP_US ? dt_us : MOTION_MAX_STEP_US);
+        servo_service.commitPending();
+        servo_service.verifyRequestedRegisters();
+    }
+    xSemaphoreGive(actuator_commit_done);
+    vTaskDelete(nullptr);
+}
+
+// ─── Auto-stop deadlines (duration_ms) ────────────────────────────────────────
+// Every servo-channel and motor auto-stop lives in one hashed timing wheel that a
+// single periodic esp_timer advances, so re-arming on each packet is O(1) under a
+// spinlock instead of a command through the FreeRTOS timer service queue.
+//   timer 0-7  : continuous rotation servo channel
+//   timer 8-11 : motor 1-4
+//   timer 12   : twist drive (ramps back to a stop)
+constexpr uint32_t STOP_WHEEL_TICK_MS = 10;
+constexpr uint8_t STOP_TIMER_MOTOR_BASE = MAX_SERVO_CHANNELS;
+constexpr uint8_t STOP_TIMER_TWIST = STOP_TIMER_MOTOR_BASE + MAX_MOTOR_CHANNELS;
+static TimingWheel stop_wheel;                       ///< Guarded by stop_wheel_lock
+static portMUX_TYPE stop_wheel_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t stop_wheel_timer = nullptr;
+static ServoService::AutoStopStats auto_stop_stats = {}; ///< Guarded by stop_wheel_lock
+static uint64_t auto_stop_arm_cycles_sum = 0;
+
+static inline uint32_t stopWheelTick()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / (STOP_WHEEL_TICK_MS * 1000));
+}
+
+/**
+ * @brief Arm, re-arm or cancel one auto-stop deadline and account its cost.
+ * @param timer_id    Wheel timer (see table above)
+ * @param duration_ms Delay in ms; 0 cancels
+ */
+static void scheduleAutoStop(uint8_t timer_id, uint32_t duration_ms)
+{
+    const uint32_t start = ESP.getCycleCount();
+    portENTER_CRITICAL(&stop_wheel_lock);
+    if (duration_ms == 0)
+    {
+        if (stop_wheel.cancel(timer_id))
+            auto_stop_stats.cancels++;
+        portEXIT_CRITICAL(&stop_wheel_lock);
+        return;
+    }
+    // Round up so the stop never comes early
+    const bool rearm = stop_wheel.arm(timer_id, stopWheelTick(), (duration_ms + STOP_WHEEL_TICK_MS - 1) / STOP_WHEEL_TICK_MS);
+    const uint32_t cycles = ESP.getCycleCount() - start;
+    auto_stop_stats.arms++;
+    if (rearm)
+        auto_stop_stats.rearms++;
+    auto_stop_arm_cycles_sum += cycles;
+    if (cycles > auto_stop_stats.arm_cycles_max)
+        auto_stop_stats.arm_cycles_max = cycles;
+    portEXIT_CRITICAL(&stop_wheel_lock);
+}
+
+/**
+ * @brief esp_timer callback: expire due deadlines and stage the stops.
+ * @note  Runs in the esp_timer task. Stops are staged under the wheel lock so a
+ *        deadline re-armed concurrently is either moved before the sweep or
+ *        applied after it.
+ */
+static void stop_wheel_tick_cb(void *arg)
+{
+    const uint32_t now_tick = stopWheelTick();
+    portENTER_CRITICAL(&stop_wheel_lock);
+    const uint32_t expired = stop_wheel.advance(now_tick);
+    if (expired)
+    {
+        publishActuatorState([&](ActuatorState &state)
+                             {
+            for (uint8_t id = 0; id <= STOP_TIMER_TWIST; ++id)
+            {
+                if (!(expired & (1UL << id)))
+                    continue;
+                auto_stop_stats.expired++;
+                if (id < STOP_TIMER_MOTOR_BASE)
+                {
+                    if (state.connection(id) != ServoConnection::ROTATIONAL)
+                        continue;
+                    stageServoPulse(id, speedPulse(id, 0));
+                    state.servo_speeds[id] = 0;
+                }
+                else if (id == STOP_TIMER_TWIST)
+                {
+                    // Zero twist: the commit task ramps the wheels down at the acceleration limit
+                    twist_target.store(0, std::memory_order_relaxed);
+                    twist_retarget.store(true, std::memory_order_release);
+                }
+                else
+                {
+                    stageMotorSpeed(id - STOP_TIMER_MOTOR_BASE, 0);
+                    state.motor_speeds[id - STOP_TIMER_MOTOR_BASE] = 0;
+                }
+            } });
+    }
+    portEXIT_CRITICAL(&stop_wheel_lock);
+    if (expired)
+        servo_service.requestCommit();
+}
 
-// Per-channel one-shot FreeRTOS timers for the optional auto-stop (duration_ms) feature
-static TimerHandle_t channel_stop_timers[MAX_SERVO_CHANNELS] = {};
-extern ServoService servo_service; // defined in main.cpp
+
+// ─── Emergency stop ───────────────────────────────────────────────────────────
+// The stop image (ActuatorBackend::buildStopImage) is recompiled whenever a servo
+// type or calibration changes, so a stop costs one copy and the bus writes. The
+// same stops are staged afterwards; estop_epoch tells a commit batch collected
+// meanwhile to re-read its slots, so it cannot put back a pre-stop value. The
+// driver drops a batch that the image overtook on the bus.
+// Stops run on their own task at the highest priority: requesters (timer
+// callbacks) only notify it and never wait for the bus themselves.
+static SeqLock<ActuatorStopImage> stop_image; ///< Written under stop_image_lock
+static portMUX_TYPE stop_image_lock = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> estop_epoch{0}; ///< Bumped once the stops of an emergency stop are staged
+static std::atomic<uint32_t> estop_writes{0}; ///< Bumped before the stop image goes to the bus
+static ServoService::EmergencyStopStats estop_stats = {}; ///< Guarded by estop_stats_lock
+static uint64_t estop_latency_sum_us = 0;
+static portMUX_TYPE estop_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t actuator_stop_task = nullptr;
+static std::atomic<bool> actuator_stop_exit{false}; ///< Set by stopService(): leave the loop
+static SemaphoreHandle_t actuator_stop_done = nullptr; ///< Given by the stop task as it exits
+static bool estop_requested = false;                  ///< Guarded by estop_request_lock
+static uint32_t estop_request_us = 0;
+static ServoService::EmergencyStopDone estop_done_fn = nullptr;
+static void *estop_done_arg = nullptr;
+static portMUX_TYPE estop_request_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Emergency stop task: runs the requested stop, then its completion callback.
+ */
+static void actuator_stop_task_fn(void *pvParameters)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (actuator_stop_exit.load(std::memory_order_acquire))
+            break;
+        portENTER_CRITICAL(&estop_request_lock);
+        const bool requested = estop_requested;
+        const uint32_t requested_us = estop_request_us;
+        const ServoService::EmergencyStopDone done = estop_done_fn;
+        void *const arg = estop_done_arg;
+        estop_requested = false;
+        estop_done_fn = nullptr;
+        estop_done_arg = nullptr;
+        portEXIT_CRITICAL(&estop_request_lock);
+        if (!requested)
+            continue;
+        const bool written = servo_service.emergencyStop(requested_us);
+        if (done)
+            done(arg, written);
+    }
+    xSemaphoreGive(actuator_stop_done);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Bus time of an image at 400 kHz: START, address, register, data (9 clocks per byte), STOP.
+ */
+static uint32_t stopImageWireUs(const ActuatorStopImage &image)
+{
+    uint32_t clocks = 0;
+    for (uint8_t i = 0; i < image.count; i++)
+        clocks += 2 + (2 + image.blocks[i].len) * 9;
+    return (clocks * 5 + 1) / 2; // 2.5 µs per clock
+}
 
 /**
- * @brief FreeRTOS timer callback: stop the servo channel encoded in the timer ID.
- * @note  Called from the FreeRTOS timer service task. The one-shot timer is already
- *        dormant when the callback runs, so calling xTimerStop inside is safe.
+ * @brief Recompile the stop image from the attached types and the pulse tables.
+ * @details Built under the lock so two concurrent rebuilds cannot publish an older state last.
  */
-static void servo_stop_timer_cb(TimerHandle_t xTimer)
+static void rebuildStopImage()
+{
+    portENTER_CRITICAL(&stop_image_lock);
+    const ActuatorState state = actuatorSnapshot();
+    uint16_t stop_pulse_us[MAX_SERVO_CHANNELS] = {};
+    uint8_t servo_mask = 0;
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+    {
+        if (state.connection(ch) != ServoConnection::ROTATIONAL)
+            continue;
+        servo_mask |= static_cast<uint8_t>(1u << ch);
+        stop_pulse_us[ch] = speedPulse(ch, 0);
+    }
+    stop_image.write([&](ActuatorStopImage &image)
+                     { ActuatorBackend::buildStopImage(servo_mask, stop_pulse_us, image); });
+    portEXIT_CRITICAL(&stop_image_lock);
+}
+
+static void recordEmergencyStop(uint32_t latency_us, bool written)
 {
-    const uint8_t ch = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(pvTimerGetTimerID(xTimer)));
-    servo_service.setServoSpeed(ch, 0); // duration_ms=0 → no recursive scheduling
+    const uint8_t bucket = latency_us ? static_cast<uint8_t>(31 - __builtin_clz(latency_us)) : 0;
+    portENTER_CRITICAL(&estop_stats_lock);
+    if (estop_stats.triggers == 0 || latency_us < estop_stats.latency_min_us)
+        estop_stats.latency_min_us = latency_us;
+    if (latency_us > estop_stats.latency_max_us)
+        estop_stats.latency_max_us = latency_us;
+    estop_stats.latency_last_us = latency_us;
+    estop_latency_sum_us += latency_us;
+    estop_stats.triggers++;
+    estop_stats.latency_avg_us = static_cast<uint32_t>(estop_latency_sum_us / estop_stats.triggers);
+    estop_stats.hist[bucket < ServoService::EmergencyStopStats::HIST_BUCKETS ? bucket : ServoService::EmergencyStopStats::HIST_BUCKETS - 1]++;
+    if (!written)
+        estop_stats.failures++;
+    portEXIT_CRITICAL(&estop_stats_lock);
 }
 
+
 bool ServoService::initializeService()
 {
     logger->info(progmem_to_string(ServoConsts::msg_initializing));
@@ -237,17 +1198,6 @@ bool ServoService::initializeService()
         setServiceStatus(INITIALIZED_FAILED);
     }
 
-    // Create per-channel one-shot timers for the optional timed-stop feature
-    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
-    {
-        channel_stop_timers[ch] = xTimerCreate(
-            "svStop",
-            pdMS_TO_TICKS(1000),  // initial period is irrelevant; reset before each start
-            pdFALSE,              // one-shot (no auto-reload)
-            reinterpret_cast<void *>(static_cast<uintptr_t>(ch)),
-            servo_stop_timer_cb);
-    }
-
     // Return true to allow other services to continue even if servo fails
     return true;
 }
@@ -268,8 +1218,43 @@ bool ServoService::startService()
         logger->error(getServiceName() + progmem_to_string(ServoConsts::msg_start_failed));
         return false;
     }
-    servoController.setMotorPeriod(eMotor1_2, MOTOR_PWM_PERIOD);
-    servoController.setMotorPeriod(eMotor3_4, MOTOR_PWM_PERIOD);
+    servoController.configure(MOTOR_PWM_PERIOD);
+    if (!actuator_commit_done)
+        actuator_commit_done = xSemaphoreCreateBinary();
+    if (!actuator_commit_task)
+    {
+        // Dedicated task so HTTP/UDP callers never wait on the I2C bus
+        actuator_commit_exit.store(false, std::memory_order_relaxed);
+        xTaskCreatePinnedToCore(actuator_commit_task_fn, "ActCommit", 4096, nullptr, 6, &actuator_commit_task, 1);
+    }
+    if (!actuator_stop_done)
+        actuator_stop_done = xSemaphoreCreateBinary();
+    if (!actuator_stop_task)
+    {
+        // Highest priority: the next owner of the bus, ahead of the commit task
+        actuator_stop_exit.store(false, std::memory_order_relaxed);
+        xTaskCreatePinnedToCore(actuator_stop_task_fn, "ActStop", 3072, nullptr, configMAX_PRIORITIES - 1, &actuator_stop_task, 1);
+    }
+    if (!timeline_mutex)
+        timeline_mutex = xSemaphoreCreateMutex();
+    if (!timeline_timer)
+    {
+        esp_timer_create_args_t timer_args = {};
+        timer_args.callback = timeline_tick_cb;
+        timer_args.name = "svTimeline";
+        esp_timer_create(&timer_args, &timeline_timer);
+    }
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+        installCalibration(ch, pulseModel(attachedConnection(ch)), storedCalibration(ch));
+    rebuildStopImage();
+    if (!stop_wheel_timer)
+    {
+        esp_timer_create_args_t timer_args = {};
+        timer_args.callback = stop_wheel_tick_cb;
+        timer_args.name = "svStopWheel";
+        if (esp_timer_create(&timer_args, &stop_wheel_timer) == ESP_OK)
+            esp_timer_start_periodic(stop_wheel_timer, STOP_WHEEL_TICK_MS * 1000);
+    }
     setServiceStatus(STARTED);
     return true;
 }
@@ -286,7 +1271,12 @@ bool ServoService::attachServo(uint8_t channel, ServoConnection connection)
         {
             throw std::out_of_range(progmem_to_string(ServoConsts::err_channel_range));
         }
-        attached_servos[channel] = connection;
+        // Table first, so a concurrent reader never pairs the new type with an old table
+        installCalibration(channel, pulseModel(connection), storedCalibration(channel));
+        publishActuatorState([&](ActuatorState &state)
+                             { state.attached[channel] = static_cast<uint8_t>(connection); });
+        rebuildStopImage();
+        calibration_jog_us[channel] = 0;
 
         return true;
     }
@@ -312,26 +1302,25 @@ bool ServoService::setServoAngle(uint8_t channel, int16_t angle)
         {
             throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_channel_range)));
         }
-        if (attached_servos[channel] == ServoConnection::ANGULAR_180)
+        const ServoConnection connection = attachedConnection(channel);
+        if (connection == ServoConnection::ANGULAR_180)
         {
             if (angle < -90 || angle > 90)
             {
                 throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_angle_range_180)));
             }
-            uint16_t absolute_angle = static_cast<uint16_t>(angle + 90);
-            servoController.setServoAngle(eServoNumber_t(channel), absolute_angle, 180);
-            servo_angles[channel] = angle;
+            stageServoAngle(channel, angle);
+            trackServoAngle(channel, angle);
             return true;
         }
-        else if (attached_servos[channel] == ServoConnection::ANGULAR_270)
+        else if (connection == ServoConnection::ANGULAR_270)
         {
             if (angle < -135 || angle > 135)
             {
                 throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_angle_range_270)));
             }
-            uint16_t absolute_angle = static_cast<uint16_t>(angle + 135);
-            servoController.setServoAngle(eServoNumber_t(channel), absolute_angle, 270);
-            servo_angles[channel] = angle;
+            stageServoAngle(channel, angle);
+            trackServoAngle(channel, angle);
             return true;
         }
         else
@@ -363,7 +1352,7 @@ bool ServoService::setServoSpeed(uint8_t channel, int8_t speed, uint32_t duratio
         {
             throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_channel_range)));
         }
-        if (attached_servos[channel] != ServoConnection::ROTATIONAL)
+        if (attachedConnection(channel) != ServoConnection::ROTATIONAL)
         {
             throw std::runtime_error(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_servo_not_continuous)));
         }
@@ -371,12 +1360,8 @@ bool ServoService::setServoSpeed(uint8_t channel, int8_t speed, uint32_t duratio
         {
             throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_speed_range)));
         }
-        servoController.setServo360(eServoNumber_t(channel),
-                                    speed > 0 ? eServo360Direction_t::eForward
-                                              : (speed < 0 ? eServo360Direction_t::eBackward
-                                                           : eServo360Direction_t::eStop),
-                                    static_cast<uint8_t>(std::abs(speed)));
-        servo_speeds[channel] = speed; // Track speed for UI display
+        stageServoPulse(channel, speedPulse(channel, speed));
+        trackServoSpeed(channel, speed); // Track speed for UI display
         // Schedule an auto-stop if requested; cancel any pending stop when speed == 0
         scheduleChannelStop(channel, (speed != 0) ? duration_ms : 0);
         return true;
@@ -395,16 +1380,19 @@ bool ServoService::setAllServoSpeed(int8_t speed, uint32_t duration_ms)
 #endif
 
     bool allSuccess = true;
+    const ActuatorState state = actuatorSnapshot();
     for (uint8_t channel = 0; channel < MAX_SERVO_CHANNELS; channel++)
     {
 #ifdef SERVO_VERBOSE_DEBUG
-        logger->debug("  channel " + std::to_string(channel) + ": " + std::string(attached_servos[channel] == ServoConnection::ROTATIONAL ? "ROTATIONAL" : "NOT ROTATIONAL"));
+        logger->debug("  channel " + std::to_string(channel) + ": " + std::string(state.connection(channel) == ServoConnection::ROTATIONAL ? "ROTATIONAL" : "NOT ROTATIONAL"));
 #endif
-        if (attached_servos[channel] == ServoConnection::ROTATIONAL)
+        if (state.connection(channel) == ServoConnection::ROTATIONAL)
         {
             allSuccess = allSuccess && this->setServoSpeed(channel, speed, duration_ms);
         }
     }
+    if (speed == 0)
+        requestCommit(); // stops do not wait for the next control period
     return allSuccess;
 }
 
@@ -414,9 +1402,10 @@ bool ServoService::setAllServoAngle(int16_t angle)
     logger->debug("setAllServoAngle " + std::to_string(angle));
 #endif
     bool allSuccess = true;
+    const ActuatorState state = actuatorSnapshot();
     for (uint8_t channel = 0; channel < MAX_SERVO_CHANNELS; channel++)
     {
-        if (attached_servos[channel] == ServoConnection::ANGULAR_180 || attached_servos[channel] == ServoConnection::ANGULAR_270)
+        if (state.connection(channel) == ServoConnection::ANGULAR_180 || state.connection(channel) == ServoConnection::ANGULAR_270)
         {
             allSuccess = allSuccess && this->setServoAngle(channel, angle);
         }
@@ -449,56 +1438,166 @@ bool ServoService::setServosSpeedMultiple(const std::vector<ServoSpeedOp> &ops)
 }
 
 /**
- * @brief Start or cancel the per-channel auto-stop FreeRTOS timer.
+ * @brief Start, restart or cancel the auto-stop deadline of a servo channel.
  * @param channel     Servo channel (0-7).
  * @param duration_ms Auto-stop delay in ms; 0 cancels any pending stop.
- * @note  xTimerChangePeriod both changes the period AND starts the timer if it is dormant.
- *        Calling it with an already-running timer resets the countdown to the new period.
+ * @note  Re-arming an already-pending deadline simply moves it (O(1)).
  */
 void ServoService::scheduleChannelStop(uint8_t channel, uint32_t duration_ms)
 {
-    if (channel >= MAX_SERVO_CHANNELS || !channel_stop_timers[channel])
+    if (channel >= MAX_SERVO_CHANNELS)
         return;
-    if (duration_ms > 0)
-        xTimerChangePeriod(channel_stop_timers[channel], pdMS_TO_TICKS(duration_ms), 0);
-    else
-        xTimerStop(channel_stop_timers[channel], 0);
+    scheduleAutoStop(channel, duration_ms);
 }
 
 /**
- * @brief Set angle for multiple servos at once
- * @param ops Vector of ServoAngleOp operations
- * @return true if all operations successful, false otherwise
+ * @brief Start, restart or cancel the auto-stop deadline of a DC motor.
+ * @param index       Motor index (0-3).
+ * @param duration_ms Auto-stop delay in ms; 0 cancels any pending stop.
  */
-bool ServoService::setServosAngleMultiple(const std::vector<ServoAngleOp> &ops)
+void ServoService::scheduleMotorStop(uint8_t index, uint32_t duration_ms)
 {
-#ifdef SERVO_VERBOSE_DEBUG
-    logger->debug("setServosAngleMultiple " + std::to_string(ops.size()) + " ops");
-#endif
-    if (!isServiceStarted() || ops.empty())
-        return false;
-    bool all_success = true;
-    for (const auto &op : ops)
-    {
-#ifdef SERVO_VERBOSE_DEBUG
-        logger->debug("  op: channel=" + std::to_string(op.channel) + ", angle=" + std::to_string(op.angle));
-#endif
-        if (!setServoAngle(op.channel, op.angle))
-            all_success = false;
-    }
-    return all_success;
+    if (index >= MAX_MOTOR_CHANNELS)
+        return;
+    scheduleAutoStop(STOP_TIMER_MOTOR_BASE + index, duration_ms);
 }
 
 /**
- * @brief Set DC motor speed via DFR1216 expansion board
- * @param motor Motor number (1-4)
- * @param speed Speed percentage (-100 to +100, negative is reverse)
- * @return true if successful, false otherwise
+ * @brief Replace the calibration of a channel and recompile its pulse table.
+ * @details The channel output is refreshed with the new table (last angle or speed).
  */
-bool ServoService::setMotorSpeed(uint8_t motor, int8_t speed)
+bool ServoService::setServoCalibration(uint8_t channel, const ServoCalibration &calibration, std::string &error)
 {
-    if (!isServiceStarted())
-        return false;
+    if (channel >= MAX_SERVO_CHANNELS)
+    {
+        error = progmem_to_string(ServoConsts::err_channel_range);
+        return false;
+    }
+    const ActuatorState state = actuatorSnapshot();
+    const ServoConnection connection = state.connection(channel);
+    if (!ServoPulseTable::validate(pulseModel(connection), calibration, error))
+        return false;
+
+    installCalibration(channel, pulseModel(connection), calibration);
+    rebuildStopImage();
+    if (connection == ROTATIONAL && state.servo_speeds[channel] != -128)
+        stageServoPulse(channel, speedPulse(channel, state.servo_speeds[channel]));
+    else if ((connection == ANGULAR_180 || connection == ANGULAR_270) && state.servo_angles[channel] != -1)
+        stageServoPulse(channel, anglePulseMilliDegrees(channel, motion_positions[channel].load(std::memory_order_relaxed)));
+    calibration_jog_us[channel] = 0;
+    requestCommit();
+    return true;
+}
+
+ServoCalibration ServoService::getServoCalibration(uint8_t channel) const
+{
+    if (channel >= MAX_SERVO_CHANNELS)
+        return {};
+    return ServoPulseTable::effective(pulseModel(attachedConnection(channel)), storedCalibration(channel));
+}
+
+/**
+ * @brief Calibration routine: output a raw pulse, bypassing the channel table.
+ * @details The next angle or speed command on the channel replaces it.
+ */
+bool ServoService::calibrationJog(uint8_t channel, uint16_t pulse_us)
+{
+    if (channel >= MAX_SERVO_CHANNELS || pulse_us < ServoPulseTable::PULSE_MIN_US || pulse_us > ServoPulseTable::PULSE_MAX_US)
+        return false;
+    calibration_jog_us[channel] = pulse_us;
+    stageServoPulse(channel, pulse_us);
+    requestCommit();
+    return true;
+}
+
+/**
+ * @brief Calibration routine: store the last jog pulse as one calibration point.
+ * @param point "min" / "max" (endpoints or full speeds), "center" (trim) or
+ *              "deadband" (edge of the no-motion band, continuous servos)
+ */
+bool ServoService::captureCalibrationPoint(uint8_t channel, const std::string &point, std::string &error)
+{
+    if (channel >= MAX_SERVO_CHANNELS)
+    {
+        error = progmem_to_string(ServoConsts::err_channel_range);
+        return false;
+    }
+    const int32_t jog = calibration_jog_us[channel];
+    if (jog == 0)
+    {
+        error = progmem_to_string(ServoConsts::err_no_jog);
+        return false;
+    }
+    const ServoPulseTable::Model model = pulseModel(attachedConnection(channel));
+    ServoCalibration calibration = storedCalibration(channel);
+    const ServoCalibration current = ServoPulseTable::effective(model, calibration);
+    const int32_t nominal_centre = model == ServoPulseTable::Model::CONTINUOUS ? SERVO360_STOP_US
+                                                                               : (current.min_us + current.max_us) / 2;
+    if (point == ServoConsts::point_min)
+        calibration.min_us = static_cast<uint16_t>(jog);
+    else if (point == ServoConsts::point_max)
+        calibration.max_us = static_cast<uint16_t>(jog);
+    else if (point == ServoConsts::point_center)
+        calibration.trim_us = static_cast<int16_t>(jog - nominal_centre);
+    else if (point == ServoConsts::point_deadband)
+        calibration.deadband_us = static_cast<uint16_t>(std::abs(jog - (nominal_centre + current.trim_us)));
+    else
+    {
+        error = progmem_to_string(ServoConsts::err_unknown_point);
+        return false;
+    }
+    if (!ServoPulseTable::validate(model, calibration, error))
+        return false;
+    installCalibration(channel, model, calibration);
+    // A new centre or deadband moves the stop pulse of a continuous servo
+    rebuildStopImage();
+    return true;
+}
+
+ServoService::AutoStopStats ServoService::getAutoStopStats() const
+{
+    portENTER_CRITICAL(&stop_wheel_lock);
+    AutoStopStats stats = auto_stop_stats;
+    stats.pending = stop_wheel.armedCount();
+    stats.arm_cycles_avg = stats.arms ? static_cast<uint32_t>(auto_stop_arm_cycles_sum / stats.arms) : 0;
+    portEXIT_CRITICAL(&stop_wheel_lock);
+    return stats;
+}
+
+/**
+ * @brief Set angle for multiple servos at once
+ * @param ops Vector of ServoAngleOp operations
+ * @return true if all operations successful, false otherwise
+ */
+bool ServoService::setServosAngleMultiple(const std::vector<ServoAngleOp> &ops)
+{
+#ifdef SERVO_VERBOSE_DEBUG
+    logger->debug("setServosAngleMultiple " + std::to_string(ops.size()) + " ops");
+#endif
+    if (!isServiceStarted() || ops.empty())
+        return false;
+    bool all_success = true;
+    for (const auto &op : ops)
+    {
+#ifdef SERVO_VERBOSE_DEBUG
+        logger->debug("  op: channel=" + std::to_string(op.channel) + ", angle=" + std::to_string(op.angle));
+#endif
+        if (!setServoAngle(op.channel, op.angle))
+            all_success = false;
+    }
+    return all_success;
+}
+
+/**
+ * @brief Set DC motor speed via the expansion board
+ * @param motor Motor number (1-4)
+ * @param speed Speed percentage (-100 to +100, negative is reverse)
+ * @return true if successful, false otherwise
+ */
+bool ServoService::setMotorSpeed(uint8_t motor, int8_t speed, uint32_t duration_ms)
+{
+    if (!isServiceStarted())
+        return false;
 #ifdef SERVO_VERBOSE_DEBUG
     logger->debug("setMotorSpeed #" + std::to_string(motor) + ": " + std::to_string(speed));
 #endif
@@ -509,26 +1608,10 @@ bool ServoService::setMotorSpeed(uint8_t motor, int8_t speed)
         if (speed < -100 || speed > 100)
             throw std::out_of_range(reinterpret_cast<const char *>(FPSTR(ServoConsts::err_speed_range)));
 
-        eMotorNumber_t motor_a = static_cast<eMotorNumber_t>((motor - 1) * 2);
-        eMotorNumber_t motor_b = static_cast<eMotorNumber_t>((motor - 1) * 2 + 1);
-        uint16_t duty = static_cast<uint16_t>((std::abs(speed) * 65535) / 100);
-
-        if (speed > 0)
-        {
-            servoController.setMotorDuty(motor_a, duty);
-            servoController.setMotorDuty(motor_b, 0);
-        }
-        else if (speed < 0)
-        {
-            servoController.setMotorDuty(motor_a, 0);
-            servoController.setMotorDuty(motor_b, duty);
-        }
-        else
-        {
-            servoController.setMotorDuty(motor_a, 0);
-            servoController.setMotorDuty(motor_b, 0);
-        }
-        motor_speeds[motor - 1] = speed; // Track speed for UI display
+        stageMotorSpeed(motor - 1, speed);
+        trackMotorSpeed(motor - 1, speed); // Track speed for UI display
+        // Schedule an auto-stop if requested; cancel any pending stop otherwise
+        scheduleMotorStop(motor - 1, (speed != 0) ? duration_ms : 0);
         return true;
     }
     catch (const std::exception &e)
@@ -547,7 +1630,362 @@ int8_t ServoService::getMotorSpeed(uint8_t motor) const
 {
     if (motor < 1 || motor > MAX_MOTOR_CHANNELS)
         return -128;
-    return motor_speeds[motor - 1];
+    return actuatorSnapshot().motor_speeds[motor - 1];
+}
+
+/**
+ * @brief Drive the wheel motors from a twist (see DifferentialDrive.h).
+ * @details Only the target is published here; the commit task mixes, ramps and
+ *          stages both wheels right before its next commit.
+ */
+bool ServoService::setTwist(int16_t linear, int16_t angular, uint32_t duration_ms)
+{
+    if (!isServiceStarted())
+        return false;
+#ifdef SERVO_VERBOSE_DEBUG
+    logger->debug("setTwist " + std::to_string(linear) + " " + std::to_string(angular));
+#endif
+    if (linear < -DifferentialDrive::FULL_SCALE || linear > DifferentialDrive::FULL_SCALE ||
+        angular < -DifferentialDrive::FULL_SCALE || angular > DifferentialDrive::FULL_SCALE)
+    {
+        logger->error(progmem_to_string(ServoConsts::err_twist_range));
+        return false;
+    }
+
+    portENTER_CRITICAL(&twist_lock);
+    const uint8_t wheels = twist_motor_mask;
+    portEXIT_CRITICAL(&twist_lock);
+    // A pending per-motor auto-stop would release the twist when it expires
+    for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
+        if (wheels & (1u << m))
+            scheduleMotorStop(m, 0);
+
+    twist_target.store(packTwist(linear, angular), std::memory_order_relaxed);
+    twist_retarget.store(true, std::memory_order_release);
+    twist_count.fetch_add(1, std::memory_order_relaxed);
+    portENTER_CRITICAL(&twist_lock);
+    if (!twist_engaged)
+    {
+        twist_engaged = true;
+        twist_engagements++;
+        twist_takeover.store(true, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&twist_lock);
+
+    const bool stop = linear == 0 && angular == 0;
+    scheduleAutoStop(STOP_TIMER_TWIST, stop ? 0 : duration_ms);
+    if (stop)
+        requestCommit();
+    return true;
+}
+
+bool ServoService::setDriveConfig(const DriveConfig &config, std::string &error)
+{
+    if (!config.validate(error))
+        return false;
+
+    portENTER_CRITICAL(&twist_lock);
+    const bool was_engaged = twist_engaged;
+    const uint8_t previous_wheels = twist_motor_mask;
+    if (was_engaged)
+    {
+        twist_engaged = false;
+        twist_releases++;
+    }
+    twist_motor_mask = static_cast<uint8_t>((1u << config.left_motor) | (1u << config.right_motor));
+    drive_config.write([&](DriveConfig &current)
+                       { current = config; });
+    portEXIT_CRITICAL(&twist_lock);
+    drive_reconfigure.store(true, std::memory_order_release);
+
+    if (was_engaged)
+    {
+        // The previous wheels would otherwise keep their last twist duty
+        scheduleAutoStop(STOP_TIMER_TWIST, 0);
+        publishActuatorState([&](ActuatorState &state)
+                             {
+            for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
+            {
+                if (!(previous_wheels & (1u << m)))
+                    continue;
+                stageMotorSpeed(m, 0);
+                state.motor_speeds[m] = 0;
+            } });
+        requestCommit();
+    }
+    return true;
+}
+
+DriveConfig ServoService::getDriveConfig() const
+{
+    return drive_config.read();
+}
+
+ServoService::DriveStatus ServoService::getDriveStatus() const
+{
+    DriveStatus status = drive_status.read();
+    const uint32_t packed = twist_target.load(std::memory_order_relaxed);
+    status.linear = static_cast<int16_t>(packed >> 16);
+    status.angular = static_cast<int16_t>(packed & 0xFFFF);
+    status.twists = twist_count.load(std::memory_order_relaxed);
+    portENTER_CRITICAL(&twist_lock);
+    status.engaged = twist_engaged;
+    status.engagements = twist_engagements;
+    status.releases = twist_releases;
+    portEXIT_CRITICAL(&twist_lock);
+    return status;
+}
+
+/**
+ * @brief Wheel command that a motor's current speed corresponds to.
+ * @param speed Tracked motor speed (-100..100, -128 = never commanded)
+ */
+static int32_t wheelFromMotorSpeed(int8_t speed, bool invert, uint16_t deadband)
+{
+    if (speed == -128)
+        return 0;
+    const int32_t duty = static_cast<int32_t>(speed) * 10;
+    return DifferentialDrive::uncompensate(invert ? -duty : duty, deadband);
+}
+
+/**
+ * @brief Advance the twist ramp by one control period and stage both wheels.
+ * @details Runs on the commit task, right before commitPending(), so the two wheel
+ *          motors are always carried by the same burst. Nothing is staged while the
+ *          wheels hold still or after a direct motor command released the twist.
+ * @param dt_us Time elapsed since the previous step (µs)
+ */
+void ServoService::stepTwist(uint32_t dt_us)
+{
+    if (drive_reconfigure.exchange(false, std::memory_order_acquire))
+        twist_drive.configure(drive_config.read());
+    const DriveConfig &config = twist_drive.config();
+
+    const bool takeover = twist_takeover.exchange(false, std::memory_order_acquire);
+    if (takeover)
+    {
+        // Ramp from what the wheels are doing now, not from rest
+        const ActuatorState state = actuatorSnapshot();
+        twist_drive.reset(wheelFromMotorSpeed(state.motor_speeds[config.left_motor], config.invert_left, config.deadband),
+                          wheelFromMotorSpeed(state.motor_speeds[config.right_motor], config.invert_right, config.deadband));
+    }
+    if (twist_retarget.exchange(false, std::memory_order_acquire) || takeover)
+    {
+        const uint32_t packed = twist_target.load(std::memory_order_relaxed);
+        twist_drive.setTarget(static_cast<int16_t>(packed >> 16), static_cast<int16_t>(packed & 0xFFFF));
+    }
+    bool changed = twist_drive.step(dt_us);
+    const int32_t cap = reflex_cap.load(std::memory_order_relaxed);
+    if (cap < ObstacleReflex::FULL_SCALE)
+        // Hold the ramp at the cap so it resumes from there once the path clears
+        changed |= twist_drive.limitForward(DifferentialDrive::uncompensate(cap, config.deadband));
+    const bool restage = twist_reflex_restage;
+    twist_reflex_restage = false;
+    if (!changed && !takeover && !restage)
+        return;
+
+    const int32_t left_duty = twist_drive.leftDuty();
+    const int32_t right_duty = twist_drive.rightDuty();
+    publishActuatorState([&](ActuatorState &state)
+                         {
+        portENTER_CRITICAL(&twist_lock);
+        if (twist_engaged)
+        {
+            stageMotorDuty(config.left_motor, left_duty);
+            stageMotorDuty(config.right_motor, right_duty);
+            state.motor_speeds[config.left_motor] = static_cast<int8_t>(left_duty / 10);
+            state.motor_speeds[config.right_motor] = static_cast<int8_t>(right_duty / 10);
+        }
+        portEXIT_CRITICAL(&twist_lock); });
+    drive_status.write([&](DriveStatus &status)
+                       {
+        status.left = static_cast<int16_t>(twist_drive.left());
+        status.right = static_cast<int16_t>(twist_drive.right());
+        status.target_left = static_cast<int16_t>(twist_drive.targetLeft());
+        status.target_right = static_cast<int16_t>(twist_drive.targetRight());
+        status.left_duty = static_cast<int16_t>(left_duty);
+        status.right_duty = static_cast<int16_t>(right_duty); });
+}
+
+bool ServoService::setObstacleReflex(const ReflexConfig &config, std::string &error)
+{
+    if (!config.validate(error))
+        return false;
+    reflex_config.write([&](ReflexConfig &current)
+                        { current = config; });
+    reflex_reconfigure.store(true, std::memory_order_release);
+    return true;
+}
+
+ReflexConfig ServoService::getObstacleReflex() const
+{
+    return reflex_config.read();
+}
+
+ServoService::ReflexStatus ServoService::getObstacleReflexStatus() const
+{
+    return reflex_status.read();
+}
+
+/**
+ * @brief Latest range of the reflex sensor port.
+ * @param age_ms Receives the age of the reading
+ * @return cm, ObstacleReflex::NO_RANGE if the port is not sampled as expected or
+ *         the reading is older than max_age_ms
+ */
+static int32_t reflexRange(const ReflexConfig &config, uint32_t now_ms, uint32_t &age_ms)
+{
+    const DFR1216SensorScheduler::Reading reading = dfr1216_service.getSensorReading(config.port);
+    const bool sr04 = config.port == DFR1216SensorScheduler::SR04_PORT;
+    const DFR1216SensorScheduler::Kind expected = sr04 ? DFR1216SensorScheduler::Kind::SR04 : DFR1216SensorScheduler::Kind::ADC;
+    age_ms = reading.timestamp_ms ? now_ms - reading.timestamp_ms : 0;
+    if (reading.kind != expected || reading.timestamp_ms == 0 || age_ms > config.max_age_ms)
+        return ObstacleReflex::NO_RANGE;
+    if (!sr04)
+        return ObstacleReflex::irRange(static_cast<uint16_t>(reading.value), config.ir_scale);
+    // No echo reads as 0: nothing within range
+    return reading.value > 0 ? static_cast<int32_t>(reading.value) : ObstacleReflex::OUT_OF_RANGE;
+}
+
+/**
+ * @brief Re-stage direct wheel commands from their tracked speed (new cap or scale).
+ * @details Does nothing once the twist drive has taken the wheels.
+ */
+static void restageDirectWheels(const DriveConfig &drive, const ActuatorState &state)
+{
+    portENTER_CRITICAL(&twist_lock);
+    if (!twist_engaged)
+    {
+        if (state.motor_speeds[drive.left_motor] != -128)
+            stageMotorDuty(drive.left_motor, static_cast<int32_t>(state.motor_speeds[drive.left_motor]) * 10);
+        if (state.motor_speeds[drive.right_motor] != -128)
+            stageMotorDuty(drive.right_motor, static_cast<int32_t>(state.motor_speeds[drive.right_motor]) * 10);
+    }
+    portEXIT_CRITICAL(&twist_lock);
+}
+
+/**
+ * @brief Evaluate the obstacle reflex for this control period.
+ * @details The forward request is what the wheels are asked for before the cap:
+ *          the twist targets (deadband-compensated) while the twist is engaged,
+ *          the tracked motor speeds otherwise. When the cap changes, direct wheel
+ *          commands are re-staged here and an engaged twist in stepTwist(), both
+ *          before this period's commit.
+ */
+void ServoService::stepObstacleReflex(uint32_t now_ms)
+{
+    if (reflex_reconfigure.exchange(false, std::memory_order_acquire))
+        obstacle_reflex.configure(reflex_config.read());
+    const ReflexConfig &config = obstacle_reflex.config();
+    if (!config.enabled && obstacle_reflex.state() == ObstacleReflex::State::CLEAR &&
+        reflex_cap.load(std::memory_order_relaxed) == ObstacleReflex::FULL_SCALE)
+        return;
+
+    uint32_t age_ms = 0;
+    const int32_t range = config.enabled ? reflexRange(config, now_ms, age_ms) : ObstacleReflex::NO_RANGE;
+
+    const DriveConfig drive = twist_drive.config();
+    const ActuatorState state = actuatorSnapshot();
+    portENTER_CRITICAL(&twist_lock);
+    const bool engaged = twist_engaged;
+    portEXIT_CRITICAL(&twist_lock);
+    int32_t request = 0;
+    if (engaged)
+    {
+        const int32_t target = twist_drive.targetLeft() > twist_drive.targetRight() ? twist_drive.targetLeft() : twist_drive.targetRight();
+        request = DifferentialDrive::compensate(target, drive.deadband);
+    }
+    else
+    {
+        const uint8_t wheels[] = {drive.left_motor, drive.right_motor};
+        const bool inverted[] = {drive.invert_left, drive.invert_right};
+        for (uint8_t w = 0; w < 2; ++w)
+        {
+            const int8_t speed = state.motor_speeds[wheels[w]];
+            if (speed == -128)
+                continue;
+            const int32_t duty = static_cast<int32_t>(speed) * 10;
+            const int32_t forward = inverted[w] ? -duty : duty;
+            if (forward > request)
+                request = forward;
+        }
+    }
+
+    const ObstacleReflex::State previous = obstacle_reflex.state();
+    const bool changed = obstacle_reflex.update(range, request);
+    const int32_t cap = obstacle_reflex.cap();
+    if (cap != reflex_cap.load(std::memory_order_relaxed))
+    {
+        reflex_cap.store(cap, std::memory_order_relaxed);
+        if (engaged)
+        {
+            twist_reflex_restage = true;
+        }
+        else
+        {
+            // Direct commands keep their tracked speed; stageMotorDuty() scales the pair to the cap
+            restageDirectWheels(drive, state);
+        }
+    }
+
+    const ObstacleReflex::State current = obstacle_reflex.state();
+    ReflexStatus published;
+    reflex_status.write([&](ReflexStatus &status)
+                        {
+        status.state = current;
+        status.range = static_cast<int16_t>(range > 0x7FFF ? 0x7FFF : range);
+        status.cap = static_cast<int16_t>(cap);
+        status.request = static_cast<int16_t>(request);
+        status.reading_age_ms = age_ms;
+        if (changed)
+        {
+            const bool intervening = current == ObstacleReflex::State::LIMITING || current == ObstacleReflex::State::BLOCKED;
+            if (intervening && previous == ObstacleReflex::State::CLEAR)
+            {
+                status.trips++;
+                status.last_trip_ms = now_ms ? now_ms : 1;
+                if (age_ms > status.trip_age_max_ms)
+                    status.trip_age_max_ms = age_ms;
+            }
+            if (current == ObstacleReflex::State::BLOCKED)
+                status.blocks++;
+            if (current == ObstacleReflex::State::NO_SENSOR)
+                status.sensor_losses++;
+            status.events++;
+        }
+        published = status; });
+    if (changed)
+        notifyObstacle(published);
+}
+
+void ServoService::setSpeedScale(uint16_t permille)
+{
+    const int32_t scale = permille < 1000 ? permille : 1000;
+    if (speed_scale.exchange(scale, std::memory_order_relaxed) != scale)
+        speed_rescale.store(true, std::memory_order_release);
+}
+
+uint16_t ServoService::getSpeedScale() const
+{
+    return static_cast<uint16_t>(speed_scale.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Re-stage the wheels after a speed scale change.
+ * @details Direct wheel commands are re-staged here, an engaged twist in stepTwist(),
+ *          both before this period's commit (same path as a new reflex cap).
+ */
+void ServoService::stepSpeedScale()
+{
+    if (!speed_rescale.exchange(false, std::memory_order_acquire))
+        return;
+    portENTER_CRITICAL(&twist_lock);
+    const bool engaged = twist_engaged;
+    portEXIT_CRITICAL(&twist_lock);
+    if (engaged)
+        twist_reflex_restage = true;
+    else
+        restageDirectWheels(twist_drive.config(), actuatorSnapshot());
 }
 
 /**
@@ -559,7 +1997,7 @@ ServoConnection ServoService::getServoConnection(uint8_t channel) const
 {
     if (channel >= MAX_SERVO_CHANNELS)
         return NOT_CONNECTED;
-    return attached_servos[channel];
+    return attachedConnection(channel);
 }
 
 /**
@@ -571,7 +2009,7 @@ int8_t ServoService::getServoSpeed(uint8_t channel) const
 {
     if (channel >= MAX_SERVO_CHANNELS)
         return -128;
-    return servo_speeds[channel];
+    return actuatorSnapshot().servo_speeds[channel];
 }
 
 /**
@@ -583,72 +2021,524 @@ int16_t ServoService::getServoAngle(uint8_t channel) const
 {
     if (channel >= MAX_SERVO_CHANNELS)
         return -1;
-    return servo_angles[channel];
+    return actuatorSnapshot().servo_angles[channel];
 }
 
-bool ServoService::stopService()
+ServoService::ActuatorState ServoService::getActuatorState() const
 {
-    // Stop and delete per-channel auto-stop timers
-    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
-    {
-        if (channel_stop_timers[ch])
-        {
-            xTimerStop(channel_stop_timers[ch], 0);
-            xTimerDelete(channel_stop_timers[ch], 0);
-            channel_stop_timers[ch] = nullptr;
-        }
-    }
-    setServiceStatus(STOPPED);
-    return false;
+    return actuatorSnapshot();
 }
 
 /**
- * @brief Set the same speed on all DC motors.
- * @param speed Speed value (-100 to +100)
- * @return true if all motors were set successfully
+ * @brief Ask for the actuator registers to be re-read and any drift rewritten.
+ * @details Meant to be called periodically (about once per second): a brownout
+ *          resets the coprocessor to zero duty while the shadow still holds the
+ *          commanded values. The check runs on the commit task, which owns the
+ *          driver batch.
+ * @return Number of registers repaired by the previous check
  */
-bool ServoService::setAllMotorsSpeed(int8_t speed)
+uint8_t ServoService::verifyActuatorRegisters()
 {
     if (!isServiceStarted())
-        return false;
+        return 0;
+    actuator_verify_requested.store(true, std::memory_order_release);
+    return actuator_verify_repaired.load(std::memory_order_relaxed);
+}
 
-#ifdef SERVO_VERBOSE_DEBUG
-    logger->debug("setAllMotorsSpeed " + std::to_string(speed));
-#endif
-    if (speed < -100 || speed > 100)
-    {
-        logger->error(progmem_to_string(ServoConsts::err_speed_range));
-        return false;
-    }
-    bool ok = true;
-    for (uint8_t m = 1; m <= MAX_MOTOR_CHANNELS; m++)
-        ok = ok && setMotorSpeed(m, speed);
-    return ok;
+void ServoService::verifyRequestedRegisters()
+{
+    if (!actuator_verify_requested.exchange(false, std::memory_order_acquire))
+        return;
+    const uint8_t repaired = servoController.verify();
+    actuator_verify_repaired.store(repaired, std::memory_order_relaxed);
+    if (repaired)
+        logger->warning(std::string(ActuatorBackend::NAME) + " register drift repaired: " + std::to_string(repaired));
 }
-std::string ServoService::getAllAttachedServos()
+
+/**
+ * @brief Commit the pending desired-state slots as one driver batch.
+ * @details The pending mask is swapped out atomically, so a setter racing with the
+ *          commit simply re-arms its slot for the next period. On I2C failure the
+ *          slots are re-armed; the driver shadow keeps them dirty until they land.
+ */
+void ServoService::commitPending()
 {
-    if (!isServiceStarted())
+    const uint32_t writes = estop_writes.load(std::memory_order_acquire);
+    uint32_t epoch = estop_epoch.load(std::memory_order_acquire);
+    uint32_t pending = desired_pending.exchange(0, std::memory_order_acquire);
+    if (!pending)
+        return;
+
+    servoController.beginUpdate();
+    for (;;)
     {
-        return {};
+        for (uint8_t slot = 0; slot < DESIRED_SLOTS; ++slot)
+        {
+            if (!(pending & (1UL << slot)))
+                continue;
+            const uint16_t value = desired_values[slot].load(std::memory_order_relaxed);
+            if (slot < DESIRED_MOTOR_BASE)
+                servoController.setServoPulse(slot, value);
+            else
+                servoController.setMotorDuty(slot - DESIRED_MOTOR_BASE, value);
+        }
+        // An emergency stop staged its stops while this batch was collected: take them in
+        const uint32_t now_epoch = estop_epoch.load(std::memory_order_acquire);
+        if (now_epoch == epoch)
+            break;
+        epoch = now_epoch;
+        pending |= desired_pending.exchange(0, std::memory_order_acquire);
     }
-    JsonDocument doc;
-    JsonArray servosArray = doc[FPSTR(ServoConsts::json_attached_servos)].to<JsonArray>();
+    const uint8_t result = servoController.endUpdate();
+    const uint32_t now_us = micros();
 
-    for (uint8_t channel = 0; channel < MAX_SERVO_CHANNELS; channel++)
+    if (result != 0)
     {
-        const char *status = attached_servos.at(channel) == NOT_CONNECTED ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_not_connected))
-                             : attached_servos.at(channel) == ROTATIONAL  ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_rotational))
-                             : attached_servos.at(channel) == ANGULAR_180 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_180))
-                             : attached_servos.at(channel) == ANGULAR_270 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_270))
-                                                                          : reinterpret_cast<const char *>(FPSTR(ServoConsts::status_unknown));
-        JsonObject servoObj = servosArray.add<JsonObject>();
-        servoObj[ServoConsts::servo_channel] = channel;
-        servoObj[ServoConsts::connection] = status;
+        // Overtaken by an emergency stop is not a bus error: its staged stops follow
+        if (estop_writes.load(std::memory_order_acquire) == writes)
+            commit_stats.commit_errors++;
+        desired_pending.fetch_or(pending, std::memory_order_relaxed);
+        return;
     }
 
-    String output;
-    serializeJson(doc, output);
-    return std::string(output.c_str());
+    static uint64_t latency_sum_us = 0;
+    static uint32_t latency_samples = 0;
+    for (uint8_t slot = 0; slot < DESIRED_SLOTS; ++slot)
+    {
+        if (!(pending & (1UL << slot)))
+            continue;
+        const uint32_t latency = now_us - desired_stamp_us[slot].load(std::memory_order_relaxed);
+        if (latency_samples == 0 || latency < commit_stats.latency_min_us)
+            commit_stats.latency_min_us = latency;
+        if (latency > commit_stats.latency_max_us)
+            commit_stats.latency_max_us = latency;
+        commit_stats.latency_last_us = latency;
+        latency_sum_us += latency;
+        latency_samples++;
+        commit_stats.slots_committed++;
+    }
+    commit_stats.latency_avg_us = static_cast<uint32_t>(latency_sum_us / latency_samples);
+    commit_stats.commits++;
+}
+
+void ServoService::requestCommit()
+{
+    if (actuator_commit_task)
+        xTaskNotifyGive(actuator_commit_task);
+}
+
+bool ServoService::requestEmergencyStop(EmergencyStopDone done, void *arg)
+{
+    if (!isServiceStarted() || !actuator_stop_task)
+        return false;
+    portENTER_CRITICAL(&estop_request_lock);
+    if (!estop_requested)
+        estop_request_us = micros(); // The first request of a burst starts the latency
+    estop_requested = true;
+    estop_done_fn = done;
+    estop_done_arg = arg;
+    portEXIT_CRITICAL(&estop_request_lock);
+    xTaskNotifyGive(actuator_stop_task);
+    return true;
+}
+
+bool ServoService::emergencyStop(uint32_t requested_us)
+{
+    if (!isServiceStarted())
+        return false;
+    const ActuatorStopImage image = stop_image.read();
+    estop_writes.fetch_add(1, std::memory_order_release);
+    const bool written = servoController.emergencyStop(image) == 0;
+    const uint32_t latency_us = micros() - requested_us;
+
+    // Bus first, bookkeeping after: the same stops through the normal path.
+    // A tick preempted by this task may hold timeline_mutex past its playing
+    // check: wait for it, or its frame would restage the motors after the stops
+    // (the tick only try-takes the mutex, so this cannot deadlock)
+    if (timeline_mutex)
+    {
+        xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+        if (timeline_playing.exchange(false, std::memory_order_relaxed) && timeline_timer)
+            esp_timer_stop(timeline_timer);
+        xSemaphoreGive(timeline_mutex);
+    }
+    portENTER_CRITICAL(&stop_wheel_lock);
+    for (uint8_t id = 0; id <= STOP_TIMER_TWIST; ++id)
+        if (stop_wheel.cancel(id))
+            auto_stop_stats.cancels++;
+    publishActuatorState([&](ActuatorState &state)
+                         {
+        for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+        {
+            if (state.connection(ch) != ServoConnection::ROTATIONAL)
+                continue;
+            stageServoPulse(ch, speedPulse(ch, 0));
+            state.servo_speeds[ch] = 0;
+        }
+        for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
+        {
+            stageMotorSpeed(m, 0);
+            state.motor_speeds[m] = 0;
+        } });
+    portEXIT_CRITICAL(&stop_wheel_lock);
+    estop_epoch.fetch_add(1, std::memory_order_release);
+    requestCommit();
+
+    recordEmergencyStop(latency_us, written);
+    return written;
+}
+
+ServoService::EmergencyStopStats ServoService::getEmergencyStopStats() const
+{
+    const ActuatorStopImage image = stop_image.read();
+    portENTER_CRITICAL(&estop_stats_lock);
+    EmergencyStopStats stats = estop_stats;
+    portEXIT_CRITICAL(&estop_stats_lock);
+    stats.transactions = image.count;
+    stats.bytes = image.used;
+    stats.wire_us = stopImageWireUs(image);
+    return stats;
+}
+
+ServoService::CommitStats ServoService::getCommitStats() const
+{
+    CommitStats stats = commit_stats;
+    stats.commands = commands_staged.load(std::memory_order_relaxed);
+    stats.coalesced = commands_coalesced.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Step every active motion profile by one control period and stage the pulses.
+ * @details Runs on the commit task, right before commitPending(). New targets are picked
+ *          up here; the first target of a channel whose position is unknown is a jump.
+ * @param dt_us Time elapsed since the previous step (µs)
+ */
+void ServoService::stepMotionProfiles(uint32_t dt_us)
+{
+    const uint8_t resync = motion_resync.exchange(0, std::memory_order_acquire);
+    const uint8_t retarget = motion_retarget.exchange(0, std::memory_order_acquire);
+    uint8_t moving = 0;
+    uint8_t reached = 0;
+    const ActuatorState state = actuatorSnapshot();
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+    {
+        MotionProfile &profile = servo_profiles[ch];
+        const uint8_t bit = static_cast<uint8_t>(1u << ch);
+        const MotionLimits &limits = motion_limits[ch];
+        profile.setLimits(limits.max_velocity.load(std::memory_order_relaxed),
+                          limits.max_acceleration.load(std::memory_order_relaxed),
+                          limits.max_jerk.load(std::memory_order_relaxed));
+        const ServoConnection connection = state.connection(ch);
+        if (connection != ANGULAR_180 && connection != ANGULAR_270)
+            continue;
+
+        if (resync & bit)
+        {
+            profile.reset(motion_targets[ch].load(std::memory_order_relaxed));
+        }
+        else if (retarget & bit)
+        {
+            const int32_t target = motion_targets[ch].load(std::memory_order_relaxed);
+            if (!profile.isEnabled())
+            {
+                profile.reset(target); // setter already staged the pulse
+            }
+            else if (!profile.hasPosition())
+            {
+                profile.reset(target);
+                stageServoPulse(ch, anglePulseMilliDegrees(ch, target));
+            }
+            else
+            {
+                profile.setTarget(target);
+            }
+        }
+
+        if (profile.isMoving())
+        {
+            if (profile.step(dt_us))
+                reached |= bit;
+            stageServoPulse(ch, anglePulseMilliDegrees(ch, profile.position()));
+        }
+        if (profile.isMoving())
+            moving |= bit;
+        motion_positions[ch].store(profile.position(), std::memory_order_relaxed);
+        motion_velocities[ch].store(profile.velocity(), std::memory_order_relaxed);
+    }
+    motion_moving_mask.store(moving, std::memory_order_relaxed);
+    if (reached)
+    {
+        motion_moves_completed.fetch_add(__builtin_popcount(reached), std::memory_order_relaxed);
+        notifyTargetReached(moving, reached);
+    }
+}
+
+bool ServoService::setMotionProfile(uint8_t channel, uint16_t max_velocity, uint16_t max_acceleration, uint16_t max_jerk)
+{
+    if (channel >= MAX_SERVO_CHANNELS)
+        return false;
+    motion_limits[channel].max_velocity.store(max_velocity, std::memory_order_relaxed);
+    motion_limits[channel].max_acceleration.store(max_acceleration, std::memory_order_relaxed);
+    motion_limits[channel].max_jerk.store(max_jerk, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Send the unsolicited target-reached event to the peer that started the move.
+ * @details Frame: [0x5B][resp_ok][moving_mask][reached_mask] — same action code as the
+ *          MOTION_STATUS poll, whose reply has no reached_mask byte.
+ */
+void ServoService::notifyTargetReached(uint8_t moving_mask, uint8_t reached_mask)
+{
+    const uint16_t port = motion_event_port.load(std::memory_order_relaxed);
+    if (port == 0)
+        return;
+    const IPAddress ip(motion_event_ip.load(std::memory_order_relaxed));
+    const uint8_t frame[] = {ServoConsts::udp_action_motion_status, UDPProto::udp_resp_ok, moving_mask, reached_mask};
+    if (ip == IPAddress(127, 0, 0, 2))
+    {
+        const uint32_t ws_client = motion_event_ws_client.load(std::memory_order_relaxed);
+        if (ws_client)
+            http_service.sendWebSocketMessage(ws_client, frame, sizeof(frame));
+        return;
+    }
+    udp_service.sendReply(std::string(reinterpret_cast<const char *>(frame), sizeof(frame)), ip, port);
+}
+
+/**
+ * @brief Send an unsolicited obstacle reflex state change to the event receiver.
+ * @details Frame: [0x5F][resp_ok][state][range:int16_LE][cap:u16_LE] — the same layout
+ *          as the OBSTACLE poll reply. Best effort: the reflex itself never waits on it.
+ */
+void ServoService::notifyObstacle(const ReflexStatus &status)
+{
+    const uint16_t port = motion_event_port.load(std::memory_order_relaxed);
+    if (port == 0)
+        return;
+    const IPAddress ip(motion_event_ip.load(std::memory_order_relaxed));
+    const uint8_t frame[] = {ServoConsts::udp_action_obstacle, UDPProto::udp_resp_ok, static_cast<uint8_t>(status.state),
+                             static_cast<uint8_t>(status.range & 0xFF), static_cast<uint8_t>((status.range >> 8) & 0xFF),
+                             static_cast<uint8_t>(status.cap & 0xFF), static_cast<uint8_t>((status.cap >> 8) & 0xFF)};
+    if (ip == IPAddress(127, 0, 0, 2))
+    {
+        const uint32_t ws_client = motion_event_ws_client.load(std::memory_order_relaxed);
+        if (ws_client)
+            http_service.sendWebSocketMessage(ws_client, frame, sizeof(frame));
+        return;
+    }
+    udp_service.sendReply(std::string(reinterpret_cast<const char *>(frame), sizeof(frame)), ip, port);
+}
+
+/**
+ * @brief Validate a timeline and store it in LittleFS as /timelines/<id>.json.
+ */
+bool ServoService::saveTimeline(const JsonDocument &doc, std::string &error)
+{
+    KeyframeTimeline timeline;
+    if (!timeline.parse(doc.as<JsonVariantConst>(), error))
+        return false;
+    if (!LittleFS.exists(TIMELINE_DIR))
+        LittleFS.mkdir(TIMELINE_DIR);
+    File file = LittleFS.open(timelinePath(timeline.id()).c_str(), FILE_WRITE);
+    if (!file)
+    {
+        error = "cannot write timeline file";
+        return false;
+    }
+    serializeJson(doc, file);
+    file.close();
+
+    if (timeline_mutex)
+    {
+        xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+        if (active_timeline.id() == timeline.id())
+            active_timeline_valid = false; // next play reloads the new version
+        xSemaphoreGive(timeline_mutex);
+    }
+    return true;
+}
+
+bool ServoService::deleteTimeline(uint8_t id)
+{
+    if (timeline_mutex)
+    {
+        xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+        if (active_timeline.id() == id)
+            active_timeline_valid = false;
+        xSemaphoreGive(timeline_mutex);
+    }
+    return LittleFS.remove(timelinePath(id).c_str());
+}
+
+/**
+ * @brief Start playing a stored timeline from its first frame.
+ * @param id            Timeline ID (0-255)
+ * @param loop_override 0 = play once, 1 = loop, -1 = use the timeline's own "loop" flag
+ * @return false if the service is not started or the timeline cannot be loaded
+ */
+bool ServoService::playTimeline(uint8_t id, int8_t loop_override)
+{
+    if (!isServiceStarted() || !timeline_mutex || !timeline_timer)
+        return false;
+
+    xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+    const bool cached = active_timeline_valid && !active_timeline.empty() && active_timeline.id() == id;
+    xSemaphoreGive(timeline_mutex);
+
+    // Parse outside the lock so a running timeline keeps ticking meanwhile
+    KeyframeTimeline loaded;
+    std::string error;
+    if (!cached && !loadTimelineFile(id, loaded, error))
+    {
+        logger->warning("Timeline " + std::to_string(id) + ": " + error);
+        return false;
+    }
+
+    esp_timer_stop(timeline_timer);
+    xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+    if (!cached)
+    {
+        std::swap(active_timeline, loaded);
+        active_timeline_valid = true;
+    }
+    timeline_loop = loop_override < 0 ? active_timeline.loop() : (loop_override != 0);
+    timeline_start_us = esp_timer_get_time();
+    timeline_position_ms.store(0, std::memory_order_relaxed);
+    timeline_loops_completed.store(0, std::memory_order_relaxed);
+    timeline_playing.store(true, std::memory_order_relaxed);
+    resyncTimelineProfiles(0); // cancel profiled moves on the channels the timeline drives
+    applyTimelineFrame(0);
+    xSemaphoreGive(timeline_mutex);
+    return esp_timer_start_periodic(timeline_timer, COMMIT_PERIOD_MS * 1000) == ESP_OK;
+}
+
+/**
+ * @brief Stop the running timeline.
+ * @details Angular servos hold their current angle; motors and continuous servos
+ *          driven by the timeline are stopped.
+ */
+bool ServoService::stopTimeline()
+{
+    if (!timeline_mutex || !timeline_timer)
+        return false;
+    esp_timer_stop(timeline_timer);
+    xSemaphoreTake(timeline_mutex, portMAX_DELAY);
+    if (timeline_playing.exchange(false, std::memory_order_relaxed))
+    {
+        const uint32_t position_ms = timeline_position_ms.load(std::memory_order_relaxed);
+        resyncTimelineProfiles(position_ms);
+        publishActuatorState([&](ActuatorState &state)
+                             {
+            for (const KeyframeTimeline::Track &track : active_timeline.tracks())
+            {
+                if (track.target == KeyframeTimeline::Target::MOTOR)
+                {
+                    stageMotorSpeed(track.channel, 0);
+                    state.motor_speeds[track.channel] = 0;
+                }
+                else if (state.connection(track.channel) == ROTATIONAL)
+                {
+                    stageServoPulse(track.channel, speedPulse(track.channel, 0));
+                    state.servo_speeds[track.channel] = 0;
+                }
+            } });
+        requestCommit();
+    }
+    xSemaphoreGive(timeline_mutex);
+    return true;
+}
+
+bool ServoService::stopService()
+{
+    if (timeline_timer)
+    {
+        stopTimeline();
+        esp_timer_delete(timeline_timer);
+        timeline_timer = nullptr;
+    }
+    if (actuator_commit_task)
+    {
+        // Deleting it from here could catch it inside a commit, with the driver's
+        // shadow or bus mutex held: let it finish the period and leave by itself
+        actuator_commit_exit.store(true, std::memory_order_release);
+        xTaskNotifyGive(actuator_commit_task);
+        xSemaphoreTake(actuator_commit_done, portMAX_DELAY);
+        actuator_commit_task = nullptr;
+    }
+    if (actuator_stop_task)
+    {
+        actuator_stop_exit.store(true, std::memory_order_release);
+        xTaskNotifyGive(actuator_stop_task);
+        xSemaphoreTake(actuator_stop_done, portMAX_DELAY);
+        actuator_stop_task = nullptr;
+    }
+    // Stop the auto-stop wheel and drop pending deadlines
+    if (stop_wheel_timer)
+    {
+        esp_timer_stop(stop_wheel_timer);
+        esp_timer_delete(stop_wheel_timer);
+        stop_wheel_timer = nullptr;
+    }
+    portENTER_CRITICAL(&stop_wheel_lock);
+    for (uint8_t id = 0; id <= STOP_TIMER_TWIST; ++id)
+        stop_wheel.cancel(id);
+    portEXIT_CRITICAL(&stop_wheel_lock);
+    setServiceStatus(STOPPED);
+    return false;
+}
+
+/**
+ * @brief Set the same speed on all DC motors.
+ * @param speed Speed value (-100 to +100)
+ * @return true if all motors were set successfully
+ */
+bool ServoService::setAllMotorsSpeed(int8_t speed)
+{
+    if (!isServiceStarted())
+        return false;
+
+#ifdef SERVO_VERBOSE_DEBUG
+    logger->debug("setAllMotorsSpeed " + std::to_string(speed));
+#endif
+    if (speed < -100 || speed > 100)
+    {
+        logger->error(progmem_to_string(ServoConsts::err_speed_range));
+        return false;
+    }
+    bool ok = true;
+    for (uint8_t m = 1; m <= MAX_MOTOR_CHANNELS; m++)
+        ok = ok && setMotorSpeed(m, speed);
+    if (speed == 0)
+        requestCommit(); // stops do not wait for the next control period
+    return ok;
+}
+std::string ServoService::getAllAttachedServos()
+{
+    if (!isServiceStarted())
+    {
+        return {};
+    }
+    JsonDocument doc;
+    JsonArray servosArray = doc[FPSTR(ServoConsts::json_attached_servos)].to<JsonArray>();
+
+    const ActuatorState state = actuatorSnapshot();
+    for (uint8_t channel = 0; channel < MAX_SERVO_CHANNELS; channel++)
+    {
+        const ServoConnection connection = state.connection(channel);
+        const char *status = connection == NOT_CONNECTED ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_not_connected))
+                             : connection == ROTATIONAL  ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_rotational))
+                             : connection == ANGULAR_180 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_180))
+                             : connection == ANGULAR_270 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_270))
+                                                         : reinterpret_cast<const char *>(FPSTR(ServoConsts::status_unknown));
+        JsonObject servoObj = servosArray.add<JsonObject>();
+        servoObj[ServoConsts::servo_channel] = channel;
+        servoObj[ServoConsts::connection] = status;
+    }
+
+    String output;
+    serializeJson(doc, output);
+    return std::string(output.c_str());
 }
 
 std::string ServoService::getAttachedServo(uint8_t channel)
@@ -657,11 +2547,16 @@ std::string ServoService::getAttachedServo(uint8_t channel)
     {
         return {};
     }
-    std::string status = attached_servos.at(channel) == NOT_CONNECTED ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_not_connected))
-                         : attached_servos.at(channel) == ROTATIONAL  ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_rotational))
-                         : attached_servos.at(channel) == ANGULAR_180 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_180))
-                         : attached_servos.at(channel) == ANGULAR_270 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_270))
-                                                                      : reinterpret_cast<const char *>(FPSTR(ServoConsts::status_unknown));
+    if (channel >= MAX_SERVO_CHANNELS)
+    {
+        throw std::out_of_range(progmem_to_string(ServoConsts::err_channel_range));
+    }
+    const ServoConnection connection = attachedConnection(channel);
+    std::string status = connection == NOT_CONNECTED ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_not_connected))
+                         : connection == ROTATIONAL  ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_rotational))
+                         : connection == ANGULAR_180 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_180))
+                         : connection == ANGULAR_270 ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_angular_270))
+                                                     : reinterpret_cast<const char *>(FPSTR(ServoConsts::status_unknown));
     JsonDocument doc = JsonDocument();
     doc[ServoConsts::servo_channel] = channel;
     doc[ServoConsts::connection] = status;
@@ -671,240 +2566,799 @@ std::string ServoService::getAttachedServo(uint8_t channel)
 }
 
 /**
- * @brief Add route for setting servo angle
+ * @brief Add route for setting servo angle
+ */
+bool ServoService::addRouteSetServoAngle(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_angle);
+    logRouteRegistration(path);
+
+    OpenAPIRoute angle_route(path.c_str(), RoutesConsts::method_post,
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_angle)),
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                             false, {}, standard_responses);
+    angle_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_angle_control)),
+                                                 ServoConsts::req_channel_angle_07, true);
+    angle_route.requestBody.example = ServoConsts::ex_channel_angle;
+    registerOpenAPIRoute(angle_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+                       if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            // Parse and validate JSON body
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument& d) {
+                return d[ServoConsts::servo_channel].is<uint8_t>() && 
+                       d[ServoConsts::servo_angle].is<int16_t>();
+            })) return;
+
+            uint8_t ch = doc[ServoConsts::servo_channel].as<uint8_t>();
+            int16_t angle = doc[ServoConsts::servo_angle].as<int16_t>();
+            if (angle > 360 || angle < -360 || ch > 7)
+            {
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
+                return;
+            }
+
+            if (setServoAngle(ch, angle))
+            {
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_angle));
+            }
+            else
+            {
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_angle));
+            } }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for setting servo speed
+ */
+bool ServoService::addRouteSetServoSpeed(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_speed);
+    logRouteRegistration(path);
+
+    OpenAPIRoute speed_route(path.c_str(), RoutesConsts::method_post,
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_speed)),
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                             false, {}, standard_responses);
+    speed_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_speed_control)),
+                                                 ServoConsts::req_channel_speed, true);
+    speed_route.requestBody.example = ServoConsts::ex_channel_speed;
+    registerOpenAPIRoute(speed_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+                      if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            // Parse and validate JSON body
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument& d) {
+                return d[ServoConsts::servo_channel].is<int>() && 
+                       d[ServoConsts::servo_speed].is<int>();
+            })) return;
+            
+            uint8_t channel = doc[ServoConsts::servo_channel].as<uint8_t>();
+            int8_t speed = doc[ServoConsts::servo_speed].as<int>();
+            uint32_t duration_ms = doc[ServoConsts::servo_duration_ms] | 0u;
+            
+            if (channel > 7 || speed < -100 || speed > 100)
+            {
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
+                return;
+            }
+            
+            if (this->setServoSpeed(channel, speed, duration_ms))
+            {
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_speed));
+            }
+            else
+            {
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_speed));
+            } }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for stopping all servos
+ */
+bool ServoService::addRouteStopAll(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_stop_all);
+    logRouteRegistration(path);
+
+    // Note: No request body needed - parameterless POST operation
+    OpenAPIRoute stop_all_route(path.c_str(), RoutesConsts::method_post,
+                                reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_stop_all)),
+                                reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                                false, {}, standard_responses);
+    registerOpenAPIRoute(stop_all_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+        if (this->setAllServoSpeed(0))
+        {
+            ResponseHelper::sendSuccess(request, ServoConsts::action_stop_all);
+        }
+        else
+        {
+            ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, ServoConsts::action_stop_all);
+        } });
+
+    return true;
+}
+
+/**
+ * @brief Add route for getting servo status
+ */
+bool ServoService::addRouteGetStatus(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_get_status);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIParameter> status_params;
+    status_params.push_back(OpenAPIParameter(ServoConsts::param_channel, RoutesConsts::type_integer, RoutesConsts::in_query, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_channel)), true));
+
+    std::vector<OpenAPIResponse> status_responses;
+    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_status_retrieved)));
+    status_ok.schema = ServoConsts::schema_channel_status;
+    status_ok.example = ServoConsts::ex_channel_status;
+    status_responses.push_back(status_ok);
+    status_responses.push_back(createMissingParamsResponse());
+
+    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_status)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              true, status_params, status_responses);
+    registerOpenAPIRoute(status_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+        // Validate channel parameter with range check
+        std::string channel_str = ParamValidator::getValidatedParam(
+            request,
+            ServoConsts::servo_channel,
+            RoutesConsts::msg_invalid_params,
+            [](const std::string& val) {
+                int ch = std::atoi(val.c_str());
+                return ch >= 0 && ch <= 7;
+            }
+        );
+        if (channel_str.empty()) return;
+
+        uint8_t channel = (uint8_t)std::atoi(channel_str.c_str());
+        
+        std::string status = getAttachedServo(channel);
+        request->send(200, RoutesConsts::mime_json, status.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for getting all servos status
+ */
+bool ServoService::addRouteGetAllStatus()
+{
+    std::string path = getPath(ServoConsts::action_get_all_status);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIResponse> all_status_responses;
+    OpenAPIResponse all_status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_all_status_retrieved)));
+    all_status_ok.schema = ServoConsts::schema_all_servos;
+    all_status_ok.example = ServoConsts::ex_all_servos;
+    all_status_responses.push_back(all_status_ok);
+
+    OpenAPIRoute all_status_route(path.c_str(), RoutesConsts::method_get,
+                                  reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_all_status)),
+                                  reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                                  false, {}, all_status_responses);
+    registerOpenAPIRoute(all_status_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+
+        std::string status = getAllAttachedServos();
+        request->send(200, RoutesConsts::mime_json, status.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for getting battery level
+ */
+bool ServoService::addRouteGetBattery()
+{
+    std::string path = getPath(ServoConsts::action_get_battery);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIResponse> battery_responses;
+    OpenAPIResponse battery_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_battery)));
+    battery_ok.schema = ServoConsts::schema_battery;
+    battery_ok.example = ServoConsts::ex_battery;
+    battery_responses.push_back(battery_ok);
+
+    OpenAPIRoute battery_route(path.c_str(), RoutesConsts::method_get,
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_battery)),
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                               false, {}, battery_responses);
+    registerOpenAPIRoute(battery_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+        JsonDocument doc;
+        doc[ServoConsts::json_battery] = servoController.getBattery();
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for reading the actuator driver write counters
+ */
+bool ServoService::addRouteGetDriverStats()
+{
+    std::string path = getPath(ServoConsts::action_get_driver_stats);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIResponse> stats_responses;
+    OpenAPIResponse stats_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_driver_stats)));
+    stats_ok.schema = ServoConsts::schema_driver_stats;
+    stats_ok.example = ServoConsts::ex_driver_stats;
+    stats_responses.push_back(stats_ok);
+    stats_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute stats_route(path.c_str(), RoutesConsts::method_get,
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_driver_stats)),
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                             false, {}, stats_responses);
+    registerOpenAPIRoute(stats_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        const sShadowStats_t stats = servoController.getStats();
+        JsonDocument doc;
+        doc[FPSTR(ServoConsts::json_driver)] = ActuatorBackend::NAME;
+        doc[FPSTR(ServoConsts::json_writes_requested)] = stats.writesRequested;
+        doc[FPSTR(ServoConsts::json_writes_skipped)] = stats.writesSkipped;
+        doc[FPSTR(ServoConsts::json_writes_merged)] = stats.writesMerged;
+        doc[FPSTR(ServoConsts::json_spans_flushed)] = stats.spansFlushed;
+        doc[FPSTR(ServoConsts::json_flush_errors)] = stats.flushErrors;
+        doc[FPSTR(ServoConsts::json_verify_reads)] = stats.verifyReads;
+        doc[FPSTR(ServoConsts::json_verify_errors)] = stats.verifyErrors;
+        doc[FPSTR(ServoConsts::json_registers_repaired)] = stats.registersRepaired;
+        doc[FPSTR(ServoConsts::json_flushes_overtaken)] = stats.flushesOvertaken;
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for reading the actuator commit task counters
  */
-bool ServoService::addRouteSetServoAngle(const std::vector<OpenAPIResponse> &standard_responses)
+bool ServoService::addRouteGetCommitStats()
 {
-    std::string path = getPath(ServoConsts::action_set_angle);
+    std::string path = getPath(ServoConsts::action_get_commit_stats);
     logRouteRegistration(path);
 
-    OpenAPIRoute angle_route(path.c_str(), RoutesConsts::method_post,
-                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_angle)),
+    std::vector<OpenAPIResponse> stats_responses;
+    OpenAPIResponse stats_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_commit_stats)));
+    stats_ok.schema = ServoConsts::schema_commit_stats;
+    stats_ok.example = ServoConsts::ex_commit_stats;
+    stats_responses.push_back(stats_ok);
+    stats_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute stats_route(path.c_str(), RoutesConsts::method_get,
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_commit_stats)),
                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                             false, {}, standard_responses);
-    angle_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_angle_control)),
-                                                 ServoConsts::req_channel_angle_07, true);
-    angle_route.requestBody.example = ServoConsts::ex_channel_angle;
-    registerOpenAPIRoute(angle_route);
+                             false, {}, stats_responses);
+    registerOpenAPIRoute(stats_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        const CommitStats stats = getCommitStats();
+        JsonDocument doc;
+        doc[FPSTR(ServoConsts::json_commands)] = stats.commands;
+        doc[FPSTR(ServoConsts::json_coalesced)] = stats.coalesced;
+        doc[FPSTR(ServoConsts::json_commits)] = stats.commits;
+        doc[FPSTR(ServoConsts::json_slots_committed)] = stats.slots_committed;
+        doc[FPSTR(ServoConsts::json_commit_errors)] = stats.commit_errors;
+        doc[FPSTR(ServoConsts::json_latency_min_us)] = stats.latency_min_us;
+        doc[FPSTR(ServoConsts::json_latency_max_us)] = stats.latency_max_us;
+        doc[FPSTR(ServoConsts::json_latency_avg_us)] = stats.latency_avg_us;
+        doc[FPSTR(ServoConsts::json_latency_last_us)] = stats.latency_last_us;
+        doc[FPSTR(ServoConsts::json_commit_period_ms)] = COMMIT_PERIOD_MS;
+        const AutoStopStats auto_stop = getAutoStopStats();
+        JsonObject auto_stop_obj = doc[FPSTR(ServoConsts::json_auto_stop)].to<JsonObject>();
+        auto_stop_obj[FPSTR(ServoConsts::json_arms)] = auto_stop.arms;
+        auto_stop_obj[FPSTR(ServoConsts::json_rearms)] = auto_stop.rearms;
+        auto_stop_obj[FPSTR(ServoConsts::json_cancels)] = auto_stop.cancels;
+        auto_stop_obj[FPSTR(ServoConsts::json_expired)] = auto_stop.expired;
+        auto_stop_obj[FPSTR(ServoConsts::json_pending)] = auto_stop.pending;
+        auto_stop_obj[FPSTR(ServoConsts::json_arm_cycles_avg)] = auto_stop.arm_cycles_avg;
+        auto_stop_obj[FPSTR(ServoConsts::json_arm_cycles_max)] = auto_stop.arm_cycles_max;
+        auto_stop_obj[FPSTR(ServoConsts::json_tick_ms)] = STOP_WHEEL_TICK_MS;
+        const EmergencyStopStats estop = getEmergencyStopStats();
+        JsonObject estop_obj = doc[FPSTR(ServoConsts::json_emergency_stop)].to<JsonObject>();
+        estop_obj[FPSTR(ServoConsts::json_triggers)] = estop.triggers;
+        estop_obj[FPSTR(ServoConsts::json_failures)] = estop.failures;
+        estop_obj[FPSTR(ServoConsts::json_transactions)] = estop.transactions;
+        estop_obj[FPSTR(ServoConsts::json_bytes)] = estop.bytes;
+        estop_obj[FPSTR(ServoConsts::json_wire_us)] = estop.wire_us;
+        estop_obj[FPSTR(ServoConsts::json_latency_min_us)] = estop.latency_min_us;
+        estop_obj[FPSTR(ServoConsts::json_latency_max_us)] = estop.latency_max_us;
+        estop_obj[FPSTR(ServoConsts::json_latency_avg_us)] = estop.latency_avg_us;
+        estop_obj[FPSTR(ServoConsts::json_latency_last_us)] = estop.latency_last_us;
+        JsonArray hist = estop_obj[FPSTR(ServoConsts::json_hist_log2_us)].to<JsonArray>();
+        for (uint8_t i = 0; i < EmergencyStopStats::HIST_BUCKETS; ++i)
+            hist.add(estop.hist[i]);
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for configuring a channel motion profile
+ */
+bool ServoService::addRouteSetMotionProfile(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_motion_profile);
+    logRouteRegistration(path);
+
+    OpenAPIRoute profile_route(path.c_str(), RoutesConsts::method_post,
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_motion_profile)),
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                               false, {}, standard_responses);
+    profile_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_motion_profile)),
+                                                   ServoConsts::req_motion_profile, true);
+    profile_route.requestBody.example = ServoConsts::ex_motion_profile;
+    registerOpenAPIRoute(profile_route);
 
     webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
                  {
-                       if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-            // Parse and validate JSON body
             JsonDocument doc;
-            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument& d) {
-                return d[ServoConsts::servo_channel].is<uint8_t>() && 
-                       d[ServoConsts::servo_angle].is<int16_t>();
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::servo_channel].is<int>() &&
+                       d[ServoConsts::json_max_velocity].is<int>() &&
+                       d[ServoConsts::json_max_acceleration].is<int>();
             })) return;
 
-            uint8_t ch = doc[ServoConsts::servo_channel].as<uint8_t>();
-            int16_t angle = doc[ServoConsts::servo_angle].as<int16_t>();
-            if (angle > 360 || angle < -360 || ch > 7)
+            const int channel = doc[ServoConsts::servo_channel].as<int>();
+            const long vmax = doc[ServoConsts::json_max_velocity].as<long>();
+            const long amax = doc[ServoConsts::json_max_acceleration].as<long>();
+            const long jerk = doc[ServoConsts::json_max_jerk] | 0L;
+            if (channel < 0 || channel > 7 || vmax < 0 || vmax > 65535 || amax < 0 || amax > 65535 || jerk < 0 || jerk > 65535)
             {
                 ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
                 return;
             }
 
-            if (setServoAngle(ch, angle))
-            {
-                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_angle));
-            }
+            if (setMotionProfile(channel, vmax, amax, jerk))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_motion_profile));
             else
-            {
-                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_angle));
-            } }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_motion_profile)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
                  { JsonBodyParser::storeBody(request, data, len, index, total); });
 
     return true;
 }
 
 /**
- * @brief Add route for setting servo speed
+ * @brief Add route for reading the profiled position of every channel
  */
-bool ServoService::addRouteSetServoSpeed(const std::vector<OpenAPIResponse> &standard_responses)
+bool ServoService::addRouteGetMotionStatus()
 {
-    std::string path = getPath(ServoConsts::action_set_speed);
+    std::string path = getPath(ServoConsts::action_get_motion_status);
     logRouteRegistration(path);
 
-    OpenAPIRoute speed_route(path.c_str(), RoutesConsts::method_post,
-                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_speed)),
-                             reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                             false, {}, standard_responses);
-    speed_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_speed_control)),
-                                                 ServoConsts::req_channel_speed, true);
-    speed_route.requestBody.example = ServoConsts::ex_channel_speed;
-    registerOpenAPIRoute(speed_route);
+    std::vector<OpenAPIResponse> status_responses;
+    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_motion_status)));
+    status_ok.schema = ServoConsts::schema_motion_status;
+    status_ok.example = ServoConsts::ex_motion_status;
+    status_responses.push_back(status_ok);
+    status_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_motion_status)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, status_responses);
+    registerOpenAPIRoute(status_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        const uint8_t moving = motion_moving_mask.load(std::memory_order_relaxed);
+        JsonDocument doc;
+        doc[FPSTR(ServoConsts::json_moves_completed)] = motion_moves_completed.load(std::memory_order_relaxed);
+        JsonArray servos = doc[FPSTR(ServoConsts::servos)].to<JsonArray>();
+        for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+        {
+            JsonObject obj = servos.add<JsonObject>();
+            obj[ServoConsts::servo_channel] = ch;
+            obj[FPSTR(ServoConsts::json_position)] = motion_positions[ch].load(std::memory_order_relaxed) / 1000.0f;
+            obj[FPSTR(ServoConsts::json_target)] = motion_targets[ch].load(std::memory_order_relaxed) / 1000.0f;
+            obj[FPSTR(ServoConsts::json_velocity)] = motion_velocities[ch].load(std::memory_order_relaxed) / 1000.0f;
+            obj[FPSTR(ServoConsts::json_moving)] = (moving & (1u << ch)) != 0;
+            obj[FPSTR(ServoConsts::json_max_velocity)] = motion_limits[ch].max_velocity.load(std::memory_order_relaxed);
+            obj[FPSTR(ServoConsts::json_max_acceleration)] = motion_limits[ch].max_acceleration.load(std::memory_order_relaxed);
+            obj[FPSTR(ServoConsts::json_max_jerk)] = motion_limits[ch].max_jerk.load(std::memory_order_relaxed);
+        }
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for setting the calibration of a channel
+ */
+bool ServoService::addRouteSetCalibration(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_calibration);
+    logRouteRegistration(path);
+
+    OpenAPIRoute calibration_route(path.c_str(), RoutesConsts::method_post,
+                                   reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_calibration)),
+                                   reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                                   false, {}, standard_responses);
+    calibration_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_calibration)),
+                                                       ServoConsts::req_calibration, true);
+    calibration_route.requestBody.example = ServoConsts::ex_calibration;
+    registerOpenAPIRoute(calibration_route);
 
     webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
                  {
-                      if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-            // Parse and validate JSON body
             JsonDocument doc;
-            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument& d) {
-                return d[ServoConsts::servo_channel].is<int>() && 
-                       d[ServoConsts::servo_speed].is<int>();
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::servo_channel].is<uint8_t>();
             })) return;
-            
-            uint8_t channel = doc[ServoConsts::servo_channel].as<uint8_t>();
-            int8_t speed = doc[ServoConsts::servo_speed].as<int>();
-            uint32_t duration_ms = doc[ServoConsts::servo_duration_ms] | 0u;
-            
-            if (channel > 7 || speed < -100 || speed > 100)
+
+            const uint8_t channel = doc[ServoConsts::servo_channel].as<uint8_t>();
+            if (channel >= MAX_SERVO_CHANNELS)
             {
                 ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
                 return;
             }
-            
-            if (this->setServoSpeed(channel, speed, duration_ms))
-            {
-                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_speed));
-            }
+            ServoCalibration calibration = storedCalibration(channel);
+            calibration.min_us = doc[ServoConsts::json_min_us] | calibration.min_us;
+            calibration.max_us = doc[ServoConsts::json_max_us] | calibration.max_us;
+            calibration.trim_us = doc[ServoConsts::json_trim_us] | calibration.trim_us;
+            calibration.deadband_us = doc[ServoConsts::json_deadband_us] | calibration.deadband_us;
+            calibration.expo = doc[ServoConsts::json_expo] | calibration.expo;
+
+            std::string error;
+            if (setServoCalibration(channel, calibration, error))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_calibration));
             else
-            {
-                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_speed));
-            } }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, error); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
                  { JsonBodyParser::storeBody(request, data, len, index, total); });
 
     return true;
 }
 
 /**
- * @brief Add route for stopping all servos
+ * @brief Add route for reading the calibration of every channel
  */
-bool ServoService::addRouteStopAll(const std::vector<OpenAPIResponse> &standard_responses)
+bool ServoService::addRouteGetCalibration()
 {
-    std::string path = getPath(ServoConsts::action_stop_all);
+    std::string path = getPath(ServoConsts::action_get_calibration);
     logRouteRegistration(path);
 
-    // Note: No request body needed - parameterless POST operation
-    OpenAPIRoute stop_all_route(path.c_str(), RoutesConsts::method_post,
-                                reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_stop_all)),
-                                reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                                false, {}, standard_responses);
-    registerOpenAPIRoute(stop_all_route);
+    std::vector<OpenAPIResponse> calibration_responses;
+    OpenAPIResponse calibration_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_calibration)));
+    calibration_ok.schema = ServoConsts::schema_calibration;
+    calibration_ok.example = ServoConsts::ex_calibration_all;
+    calibration_responses.push_back(calibration_ok);
+    calibration_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute calibration_route(path.c_str(), RoutesConsts::method_get,
+                                   reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_calibration)),
+                                   reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                                   false, {}, calibration_responses);
+    registerOpenAPIRoute(calibration_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        JsonDocument doc;
+        JsonArray servos = doc[FPSTR(ServoConsts::servos)].to<JsonArray>();
+        for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+        {
+            const ServoCalibration calibration = getServoCalibration(ch);
+            const bool continuous = pulseModel(attachedConnection(ch)) == ServoPulseTable::Model::CONTINUOUS;
+            JsonObject obj = servos.add<JsonObject>();
+            obj[ServoConsts::servo_channel] = ch;
+            obj[FPSTR(ServoConsts::json_min_us)] = calibration.min_us;
+            obj[FPSTR(ServoConsts::json_max_us)] = calibration.max_us;
+            obj[FPSTR(ServoConsts::json_trim_us)] = calibration.trim_us;
+            obj[FPSTR(ServoConsts::json_deadband_us)] = calibration.deadband_us;
+            obj[FPSTR(ServoConsts::json_expo)] = calibration.expo;
+            obj[FPSTR(ServoConsts::json_centre_us)] = continuous ? speedPulse(ch, 0) : anglePulseMilliDegrees(ch, 0);
+            obj[FPSTR(ServoConsts::json_pulse_us)] = calibration_jog_us[ch];
+        }
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for the calibration routine raw pulse output
+ */
+bool ServoService::addRouteCalibrationJog(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_calibration_jog);
+    logRouteRegistration(path);
+
+    OpenAPIRoute jog_route(path.c_str(), RoutesConsts::method_post,
+                           reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_calibration_jog)),
+                           reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                           false, {}, standard_responses);
+    jog_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_calibration_jog)),
+                                               ServoConsts::req_calibration_jog, true);
+    jog_route.requestBody.example = ServoConsts::ex_calibration_jog;
+    registerOpenAPIRoute(jog_route);
 
     webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
                  {
             if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-        if (this->setAllServoSpeed(0))
-        {
-            ResponseHelper::sendSuccess(request, ServoConsts::action_stop_all);
-        }
-        else
-        {
-            ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, ServoConsts::action_stop_all);
-        } });
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::servo_channel].is<uint8_t>() &&
+                       d[ServoConsts::json_pulse_us].is<uint16_t>();
+            })) return;
+
+            if (calibrationJog(doc[ServoConsts::servo_channel].as<uint8_t>(), doc[ServoConsts::json_pulse_us].as<uint16_t>()))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_calibration_jog));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, FPSTR(ServoConsts::err_pulse_range)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
 
     return true;
 }
 
 /**
- * @brief Add route for getting servo status
+ * @brief Add route for storing the jog pulse as a calibration point
  */
-bool ServoService::addRouteGetStatus(const std::vector<OpenAPIResponse> &standard_responses)
+bool ServoService::addRouteCalibrationCapture(const std::vector<OpenAPIResponse> &standard_responses)
 {
-    std::string path = getPath(ServoConsts::action_get_status);
+    std::string path = getPath(ServoConsts::action_calibration_capture);
     logRouteRegistration(path);
 
-    std::vector<OpenAPIParameter> status_params;
-    status_params.push_back(OpenAPIParameter(ServoConsts::param_channel, RoutesConsts::type_integer, RoutesConsts::in_query, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_servo_channel)), true));
+    OpenAPIRoute capture_route(path.c_str(), RoutesConsts::method_post,
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_calibration_capture)),
+                               reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                               false, {}, standard_responses);
+    capture_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_calibration_capture)),
+                                                   ServoConsts::req_calibration_capture, true);
+    capture_route.requestBody.example = ServoConsts::ex_calibration_capture;
+    registerOpenAPIRoute(capture_route);
 
-    std::vector<OpenAPIResponse> status_responses;
-    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_status_retrieved)));
-    status_ok.schema = ServoConsts::schema_channel_status;
-    status_ok.example = ServoConsts::ex_channel_status;
-    status_responses.push_back(status_ok);
-    status_responses.push_back(createMissingParamsResponse());
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
-                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_status)),
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::servo_channel].is<uint8_t>() &&
+                       d[ServoConsts::json_point].is<const char *>();
+            })) return;
+
+            std::string error;
+            if (captureCalibrationPoint(doc[ServoConsts::servo_channel].as<uint8_t>(), doc[ServoConsts::json_point].as<std::string>(), error))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_calibration_capture));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, error); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for uploading a keyframe timeline
+ */
+bool ServoService::addRouteUploadTimeline(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_upload_timeline);
+    logRouteRegistration(path);
+
+    OpenAPIRoute upload_route(path.c_str(), RoutesConsts::method_post,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_upload_timeline)),
                               reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                              true, status_params, status_responses);
-    registerOpenAPIRoute(status_route);
+                              false, {}, standard_responses);
+    upload_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_upload_timeline)),
+                                                  ServoConsts::req_timeline, true);
+    upload_route.requestBody.example = ServoConsts::ex_timeline;
+    registerOpenAPIRoute(upload_route);
 
-    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
                  {
             if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-        // Validate channel parameter with range check
-        std::string channel_str = ParamValidator::getValidatedParam(
-            request,
-            ServoConsts::servo_channel,
-            RoutesConsts::msg_invalid_params,
-            [](const std::string& val) {
-                int ch = std::atoi(val.c_str());
-                return ch >= 0 && ch <= 7;
-            }
-        );
-        if (channel_str.empty()) return;
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc)) return;
 
-        uint8_t channel = (uint8_t)std::atoi(channel_str.c_str());
-        
-        std::string status = getAttachedServo(channel);
-        request->send(200, RoutesConsts::mime_json, status.c_str()); });
+            std::string error;
+            if (saveTimeline(doc, error))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_upload_timeline));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, error); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
 
     return true;
 }
 
 /**
- * @brief Add route for getting all servos status
+ * @brief Add route for playing a stored timeline
  */
-bool ServoService::addRouteGetAllStatus()
+bool ServoService::addRoutePlayTimeline(const std::vector<OpenAPIResponse> &standard_responses)
 {
-    std::string path = getPath(ServoConsts::action_get_all_status);
+    std::string path = getPath(ServoConsts::action_play_timeline);
     logRouteRegistration(path);
 
-    std::vector<OpenAPIResponse> all_status_responses;
-    OpenAPIResponse all_status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_all_status_retrieved)));
-    all_status_ok.schema = ServoConsts::schema_all_servos;
-    all_status_ok.example = ServoConsts::ex_all_servos;
-    all_status_responses.push_back(all_status_ok);
+    OpenAPIRoute play_route(path.c_str(), RoutesConsts::method_post,
+                            reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_play_timeline)),
+                            reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                            false, {}, standard_responses);
+    play_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_play_timeline)),
+                                                ServoConsts::req_timeline_play, true);
+    play_route.requestBody.example = ServoConsts::ex_timeline_play;
+    registerOpenAPIRoute(play_route);
 
-    OpenAPIRoute all_status_route(path.c_str(), RoutesConsts::method_get,
-                                  reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_all_status)),
-                                  reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                                  false, {}, all_status_responses);
-    registerOpenAPIRoute(all_status_route);
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::json_id].is<uint8_t>();
+            })) return;
+
+            const uint8_t id = doc[ServoConsts::json_id].as<uint8_t>();
+            const int8_t loop = doc[ServoConsts::json_loop].is<bool>() ? (doc[ServoConsts::json_loop].as<bool>() ? 1 : 0) : -1;
+            if (playTimeline(id, loop))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_play_timeline));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_play_timeline)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for stopping the running timeline
+ */
+bool ServoService::addRouteStopTimeline(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_stop_timeline);
+    logRouteRegistration(path);
+
+    OpenAPIRoute stop_route(path.c_str(), RoutesConsts::method_post,
+                            reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_stop_timeline)),
+                            reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                            false, {}, standard_responses);
+    registerOpenAPIRoute(stop_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+        if (stopTimeline())
+            ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_stop_timeline));
+        else
+            ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_stop_timeline)); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for deleting a stored timeline
+ */
+bool ServoService::addRouteDeleteTimeline(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_delete_timeline);
+    logRouteRegistration(path);
 
-    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+    OpenAPIRoute delete_route(path.c_str(), RoutesConsts::method_post,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_delete_timeline)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, standard_responses);
+    delete_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_delete_timeline)),
+                                                  ServoConsts::req_timeline_id, true);
+    delete_route.requestBody.example = ServoConsts::ex_timeline_id;
+    registerOpenAPIRoute(delete_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
                  {
             if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::json_id].is<uint8_t>();
+            })) return;
 
-        std::string status = getAllAttachedServos();
-        request->send(200, RoutesConsts::mime_json, status.c_str()); });
+            if (deleteTimeline(doc[ServoConsts::json_id].as<uint8_t>()))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_delete_timeline));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_delete_timeline)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
 
     return true;
 }
 
 /**
- * @brief Add route for getting battery level
+ * @brief Add route for reading the timeline player state
  */
-bool ServoService::addRouteGetBattery()
+bool ServoService::addRouteGetTimelineStatus()
 {
-    std::string path = getPath(ServoConsts::action_get_battery);
+    std::string path = getPath(ServoConsts::action_get_timeline_status);
     logRouteRegistration(path);
 
-    std::vector<OpenAPIResponse> battery_responses;
-    OpenAPIResponse battery_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_battery)));
-    battery_ok.schema = ServoConsts::schema_battery;
-    battery_ok.example = ServoConsts::ex_battery;
-    battery_responses.push_back(battery_ok);
+    std::vector<OpenAPIResponse> status_responses;
+    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_timeline_status)));
+    status_ok.schema = ServoConsts::schema_timeline_status;
+    status_ok.example = ServoConsts::ex_timeline_status;
+    status_responses.push_back(status_ok);
+    status_responses.push_back(createServiceNotStartedResponse());
 
-    OpenAPIRoute battery_route(path.c_str(), RoutesConsts::method_get,
-                               reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_battery)),
-                               reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
-                               false, {}, battery_responses);
-    registerOpenAPIRoute(battery_route);
+    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_timeline_status)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, status_responses);
+    registerOpenAPIRoute(status_route);
 
     webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
                  {
-            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+            if (!checkServiceStarted(request)) return;
         JsonDocument doc;
-        doc[ServoConsts::json_battery] = servoController.getBattery();
+        doc[FPSTR(ServoConsts::json_playing)] = timeline_playing.load(std::memory_order_relaxed);
+        if (timeline_mutex && xSemaphoreTake(timeline_mutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        {
+            if (!active_timeline.empty())
+            {
+                doc[FPSTR(ServoConsts::json_id)] = active_timeline.id();
+                doc[FPSTR(ServoConsts::json_duration_ms)] = active_timeline.durationMs();
+            }
+            doc[FPSTR(ServoConsts::json_loop)] = timeline_loop;
+            xSemaphoreGive(timeline_mutex);
+        }
+        doc[FPSTR(ServoConsts::json_position_ms)] = timeline_position_ms.load(std::memory_order_relaxed);
+        doc[FPSTR(ServoConsts::json_loops_completed)] = timeline_loops_completed.load(std::memory_order_relaxed);
+        doc[FPSTR(ServoConsts::json_ticks)] = timeline_ticks.load(std::memory_order_relaxed);
+        doc[FPSTR(ServoConsts::json_skipped_ticks)] = timeline_skipped_ticks.load(std::memory_order_relaxed);
+        JsonArray stored = doc[FPSTR(ServoConsts::json_stored)].to<JsonArray>();
+        File dir = LittleFS.open(TIMELINE_DIR);
+        if (dir && dir.isDirectory())
+        {
+            for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+                stored.add(atoi(entry.name()));
+        }
         String output;
         serializeJson(doc, output);
         request->send(200, RoutesConsts::mime_json, output.c_str()); });
@@ -1207,6 +3661,7 @@ bool ServoService::addRouteSetMotorSpeed(const std::vector<OpenAPIResponse> &sta
 
             uint8_t motor = doc[ServoConsts::motor_channel].as<uint8_t>();
             int8_t  speed = doc[ServoConsts::servo_speed].as<int8_t>();
+            uint32_t duration_ms = doc[ServoConsts::servo_duration_ms] | 0u;
 
             if (motor < 1 || motor > 4 || speed < -100 || speed > 100)
             {
@@ -1214,7 +3669,7 @@ bool ServoService::addRouteSetMotorSpeed(const std::vector<OpenAPIResponse> &sta
                 return;
             }
 
-            if (setMotorSpeed(motor, speed))
+            if (setMotorSpeed(motor, speed, duration_ms))
                 ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_motor_speed));
             else
                 ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_motor_speed)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
@@ -1241,9 +3696,7 @@ bool ServoService::addRouteStopAllMotors(const std::vector<OpenAPIResponse> &sta
                  {
             if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
 
-        bool ok = true;
-        for (uint8_t m = 1; m <= MAX_MOTOR_CHANNELS; m++)
-            ok = ok && setMotorSpeed(m, 0);
+        bool ok = setAllMotorsSpeed(0);
 
         if (ok)
             ResponseHelper::sendSuccess(request, ServoConsts::action_stop_all_motors);
@@ -1296,6 +3749,269 @@ bool ServoService::addRouteSetAllMotorsSpeed(const std::vector<OpenAPIResponse>
     return true;
 }
 
+/**
+ * @brief Add route for driving the wheel motors from a twist
+ */
+bool ServoService::addRouteSetTwist(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_twist);
+    logRouteRegistration(path);
+
+    OpenAPIRoute twist_route(path.c_str(), RoutesConsts::method_post,
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_twist)),
+                             reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                             false, {}, standard_responses);
+    twist_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_twist)),
+                                                 ServoConsts::req_twist, true);
+    twist_route.requestBody.example = ServoConsts::ex_twist;
+    registerOpenAPIRoute(twist_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d[ServoConsts::json_linear].is<int>() &&
+                       d[ServoConsts::json_angular].is<int>();
+            })) return;
+
+            const int linear = doc[ServoConsts::json_linear].as<int>();
+            const int angular = doc[ServoConsts::json_angular].as<int>();
+            const uint32_t duration_ms = doc[ServoConsts::servo_duration_ms] | 0u;
+            if (linear < -1000 || linear > 1000 || angular < -1000 || angular > 1000)
+            {
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
+                return;
+            }
+
+            if (setTwist(linear, angular, duration_ms))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_twist));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::OPERATION_FAILED, FPSTR(ServoConsts::action_set_twist)); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for configuring the twist drive
+ */
+bool ServoService::addRouteSetDriveConfig(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_drive_config);
+    logRouteRegistration(path);
+
+    OpenAPIRoute config_route(path.c_str(), RoutesConsts::method_post,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_drive_config)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, standard_responses);
+    config_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_drive_config)),
+                                                  ServoConsts::req_drive_config, true);
+    config_route.requestBody.example = ServoConsts::ex_drive_config;
+    registerOpenAPIRoute(config_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d.is<JsonObjectConst>();
+            })) return;
+
+            // Motors are numbered 1-4 on the API, 0-3 in the configuration
+            DriveConfig config = getDriveConfig();
+            const int left_motor = doc[ServoConsts::json_left_motor] | (config.left_motor + 1);
+            const int right_motor = doc[ServoConsts::json_right_motor] | (config.right_motor + 1);
+            const long deadband = doc[ServoConsts::json_deadband] | static_cast<long>(config.deadband);
+            const long accel_limit = doc[ServoConsts::json_accel_limit] | static_cast<long>(config.accel_limit);
+            if (left_motor < 1 || left_motor > 4 || right_motor < 1 || right_motor > 4 ||
+                deadband < 0 || deadband > 65535 || accel_limit < 0 || accel_limit > 65535)
+            {
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
+                return;
+            }
+            config.left_motor = static_cast<uint8_t>(left_motor - 1);
+            config.right_motor = static_cast<uint8_t>(right_motor - 1);
+            config.invert_left = doc[ServoConsts::json_invert_left] | config.invert_left;
+            config.invert_right = doc[ServoConsts::json_invert_right] | config.invert_right;
+            config.deadband = static_cast<uint16_t>(deadband);
+            config.accel_limit = static_cast<uint16_t>(accel_limit);
+
+            std::string error;
+            if (setDriveConfig(config, error))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_drive_config));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, error); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for reading the twist drive state
+ */
+bool ServoService::addRouteGetDriveStatus()
+{
+    std::string path = getPath(ServoConsts::action_get_drive_status);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIResponse> status_responses;
+    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_drive_status)));
+    status_ok.schema = ServoConsts::schema_drive_status;
+    status_ok.example = ServoConsts::ex_drive_status;
+    status_responses.push_back(status_ok);
+    status_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_drive_status)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, status_responses);
+    registerOpenAPIRoute(status_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        const DriveConfig config = getDriveConfig();
+        const DriveStatus status = getDriveStatus();
+        JsonDocument doc;
+        JsonObject config_obj = doc[FPSTR(ServoConsts::json_config)].to<JsonObject>();
+        config_obj[FPSTR(ServoConsts::json_left_motor)] = config.left_motor + 1;
+        config_obj[FPSTR(ServoConsts::json_right_motor)] = config.right_motor + 1;
+        config_obj[FPSTR(ServoConsts::json_invert_left)] = config.invert_left;
+        config_obj[FPSTR(ServoConsts::json_invert_right)] = config.invert_right;
+        config_obj[FPSTR(ServoConsts::json_deadband)] = config.deadband;
+        config_obj[FPSTR(ServoConsts::json_accel_limit)] = config.accel_limit;
+        doc[FPSTR(ServoConsts::json_engaged)] = status.engaged;
+        doc[FPSTR(ServoConsts::json_linear)] = status.linear;
+        doc[FPSTR(ServoConsts::json_angular)] = status.angular;
+        doc[FPSTR(ServoConsts::json_left)] = status.left;
+        doc[FPSTR(ServoConsts::json_right)] = status.right;
+        doc[FPSTR(ServoConsts::json_target_left)] = status.target_left;
+        doc[FPSTR(ServoConsts::json_target_right)] = status.target_right;
+        doc[FPSTR(ServoConsts::json_left_duty)] = status.left_duty;
+        doc[FPSTR(ServoConsts::json_right_duty)] = status.right_duty;
+        doc[FPSTR(ServoConsts::json_twists)] = status.twists;
+        doc[FPSTR(ServoConsts::json_engagements)] = status.engagements;
+        doc[FPSTR(ServoConsts::json_releases)] = status.releases;
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for configuring the obstacle reflex
+ */
+bool ServoService::addRouteSetObstacleReflex(const std::vector<OpenAPIResponse> &standard_responses)
+{
+    std::string path = getPath(ServoConsts::action_set_obstacle_reflex);
+    logRouteRegistration(path);
+
+    OpenAPIRoute reflex_route(path.c_str(), RoutesConsts::method_post,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_obstacle_reflex)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, standard_responses);
+    reflex_route.requestBody = OpenAPIRequestBody(reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_set_obstacle_reflex)),
+                                                  ServoConsts::req_obstacle_reflex, true);
+    reflex_route.requestBody.example = ServoConsts::ex_obstacle_reflex;
+    registerOpenAPIRoute(reflex_route);
+
+    webserver.on(path.c_str(), HTTP_POST, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request) ||  (!checkIsRequestFromMaster(request, &amakerbot_service))) return;
+
+            JsonDocument doc;
+            if (!JsonBodyParser::parseBody(request, doc, [](const JsonDocument &d) {
+                return d.is<JsonObjectConst>();
+            })) return;
+
+            ReflexConfig config = getObstacleReflex();
+            const long port = doc[ServoConsts::json_port] | static_cast<long>(config.port);
+            const long stop_distance = doc[ServoConsts::json_stop_distance] | static_cast<long>(config.stop_distance);
+            const long speed_margin = doc[ServoConsts::json_speed_margin] | static_cast<long>(config.speed_margin);
+            const long hysteresis = doc[ServoConsts::json_hysteresis] | static_cast<long>(config.hysteresis);
+            const long max_age_ms = doc[ServoConsts::json_max_age_ms] | static_cast<long>(config.max_age_ms);
+            const long ir_scale = doc[ServoConsts::json_ir_scale] | static_cast<long>(config.ir_scale);
+            if (port < 0 || port > 255 || stop_distance < 0 || stop_distance > 65535 || speed_margin < 0 || speed_margin > 65535 ||
+                hysteresis < 0 || hysteresis > 65535 || max_age_ms < 0 || max_age_ms > 65535 || ir_scale < 0 || ir_scale > 65535)
+            {
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, RoutesConsts::msg_invalid_values);
+                return;
+            }
+            config.enabled = doc[ServoConsts::json_enabled] | config.enabled;
+            config.port = static_cast<uint8_t>(port);
+            config.stop_distance = static_cast<uint16_t>(stop_distance);
+            config.speed_margin = static_cast<uint16_t>(speed_margin);
+            config.hysteresis = static_cast<uint16_t>(hysteresis);
+            config.max_age_ms = static_cast<uint16_t>(max_age_ms);
+            config.ir_scale = static_cast<uint16_t>(ir_scale);
+
+            std::string error;
+            if (setObstacleReflex(config, error))
+                ResponseHelper::sendSuccess(request, FPSTR(ServoConsts::action_set_obstacle_reflex));
+            else
+                ResponseHelper::sendError(request, ResponseHelper::INVALID_PARAMS, error); }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+                 { JsonBodyParser::storeBody(request, data, len, index, total); });
+
+    return true;
+}
+
+/**
+ * @brief Add route for reading the obstacle reflex state
+ */
+bool ServoService::addRouteGetObstacleReflex()
+{
+    std::string path = getPath(ServoConsts::action_get_obstacle_reflex);
+    logRouteRegistration(path);
+
+    std::vector<OpenAPIResponse> status_responses;
+    OpenAPIResponse status_ok(200, reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_obstacle_reflex)));
+    status_ok.schema = ServoConsts::schema_obstacle_reflex;
+    status_ok.example = ServoConsts::ex_obstacle_reflex_status;
+    status_responses.push_back(status_ok);
+    status_responses.push_back(createServiceNotStartedResponse());
+
+    OpenAPIRoute status_route(path.c_str(), RoutesConsts::method_get,
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::desc_get_obstacle_reflex)),
+                              reinterpret_cast<const char *>(FPSTR(ServoConsts::tag_servos)),
+                              false, {}, status_responses);
+    registerOpenAPIRoute(status_route);
+
+    webserver.on(path.c_str(), HTTP_GET, [this](AsyncWebServerRequest *request)
+                 {
+            if (!checkServiceStarted(request)) return;
+        const ReflexConfig config = getObstacleReflex();
+        const ReflexStatus status = getObstacleReflexStatus();
+        JsonDocument doc;
+        JsonObject config_obj = doc[FPSTR(ServoConsts::json_config)].to<JsonObject>();
+        config_obj[FPSTR(ServoConsts::json_enabled)] = config.enabled;
+        config_obj[FPSTR(ServoConsts::json_port)] = config.port;
+        config_obj[FPSTR(ServoConsts::json_stop_distance)] = config.stop_distance;
+        config_obj[FPSTR(ServoConsts::json_speed_margin)] = config.speed_margin;
+        config_obj[FPSTR(ServoConsts::json_hysteresis)] = config.hysteresis;
+        config_obj[FPSTR(ServoConsts::json_max_age_ms)] = config.max_age_ms;
+        config_obj[FPSTR(ServoConsts::json_ir_scale)] = config.ir_scale;
+        doc[FPSTR(ServoConsts::json_state)] = ObstacleReflex::stateName(status.state);
+        doc[FPSTR(ServoConsts::json_range)] = status.range;
+        doc[FPSTR(ServoConsts::json_cap)] = status.cap;
+        doc[FPSTR(ServoConsts::json_request)] = status.request;
+        doc[FPSTR(ServoConsts::json_reading_age_ms)] = status.reading_age_ms;
+        doc[FPSTR(ServoConsts::json_trips)] = status.trips;
+        doc[FPSTR(ServoConsts::json_blocks)] = status.blocks;
+        doc[FPSTR(ServoConsts::json_sensor_losses)] = status.sensor_losses;
+        doc[FPSTR(ServoConsts::json_events)] = status.events;
+        doc[FPSTR(ServoConsts::json_last_trip_ms)] = status.last_trip_ms;
+        doc[FPSTR(ServoConsts::json_trip_age_max_ms)] = status.trip_age_max_ms;
+        String output;
+        serializeJson(doc, output);
+        request->send(200, RoutesConsts::mime_json, output.c_str()); });
+
+    return true;
+}
+
 /**
  * @brief Register HTTP routes for servo control.
  * @return true if registration was successful, false otherwise.
@@ -1327,7 +4043,25 @@ bool ServoService::registerRoutes()
     addRouteSetMotorSpeed(standard_responses);
     addRouteStopAllMotors(standard_responses);
     addRouteSetAllMotorsSpeed(standard_responses);
+    addRouteSetTwist(standard_responses);
+    addRouteSetDriveConfig(standard_responses);
+    addRouteGetDriveStatus();
+    addRouteSetObstacleReflex(standard_responses);
+    addRouteGetObstacleReflex();
     addRouteGetBattery();
+    addRouteGetDriverStats();
+    addRouteGetCommitStats();
+    addRouteSetMotionProfile(standard_responses);
+    addRouteGetMotionStatus();
+    addRouteSetCalibration(standard_responses);
+    addRouteGetCalibration();
+    addRouteCalibrationJog(standard_responses);
+    addRouteCalibrationCapture(standard_responses);
+    addRouteUploadTimeline(standard_responses);
+    addRoutePlayTimeline(standard_responses);
+    addRouteStopTimeline(standard_responses);
+    addRouteDeleteTimeline(standard_responses);
+    addRouteGetTimelineStatus();
     registerServiceStatusRoute(this);
     registerSettingsRoutes(this);
 
@@ -1356,7 +4090,36 @@ bool ServoService::saveSettings()
     }
 
     std::string comma = progmem_to_string(ServoConsts::str_comma);
-    return settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_servos)), std::to_string(static_cast<int>(attached_servos[0])) + comma + std::to_string(static_cast<int>(attached_servos[1])) + comma + std::to_string(static_cast<int>(attached_servos[2])) + comma + std::to_string(static_cast<int>(attached_servos[3])) + comma + std::to_string(static_cast<int>(attached_servos[4])) + comma + std::to_string(static_cast<int>(attached_servos[5])) + comma + std::to_string(static_cast<int>(attached_servos[6])) + comma + std::to_string(static_cast<int>(attached_servos[7])));
+
+    // Motion profiles: "vmax:amax:jerk" per channel, comma separated
+    std::string profiles;
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+    {
+        if (ch)
+            profiles += comma;
+        profiles += std::to_string(motion_limits[ch].max_velocity.load()) + ":" +
+                    std::to_string(motion_limits[ch].max_acceleration.load()) + ":" +
+                    std::to_string(motion_limits[ch].max_jerk.load());
+    }
+    const bool profiles_saved = settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_motion)), profiles);
+
+    // Calibrations: "min:max:trim:deadband:expo" per channel, comma separated
+    std::string calibrations;
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+    {
+        if (ch)
+            calibrations += comma;
+        calibrations += storedCalibration(ch).toString();
+    }
+    const bool calibrations_saved = settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_calibration)), calibrations);
+
+    // Twist drive: "left:right:invert_left:invert_right:deadband:accel_limit"
+    const bool drive_saved = settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_drive)), getDriveConfig().toString());
+    // Obstacle reflex: "enabled:port:stop_distance:speed_margin:hysteresis:max_age_ms:ir_scale"
+    const bool reflex_saved = settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_reflex)), getObstacleReflex().toString());
+    const ActuatorState state = actuatorSnapshot();
+
+    return profiles_saved && calibrations_saved && drive_saved && reflex_saved && settings_service_->setSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_servos)), std::to_string(static_cast<int>(state.attached[0])) + comma + std::to_string(static_cast<int>(state.attached[1])) + comma + std::to_string(static_cast<int>(state.attached[2])) + comma + std::to_string(static_cast<int>(state.attached[3])) + comma + std::to_string(static_cast<int>(state.attached[4])) + comma + std::to_string(static_cast<int>(state.attached[5])) + comma + std::to_string(static_cast<int>(state.attached[6])) + comma + std::to_string(static_cast<int>(state.attached[7])));
 }
 
 bool ServoService::loadSettings()
@@ -1370,37 +4133,85 @@ bool ServoService::loadSettings()
         return false;
     }
 
+    std::string motion_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_motion)));
+    const char *cursor = motion_settings.c_str();
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS && *cursor; ++ch)
+    {
+        unsigned vmax = 0, amax = 0, jerk = 0;
+        if (sscanf(cursor, "%u:%u:%u", &vmax, &amax, &jerk) == 3)
+            setMotionProfile(ch, vmax, amax, jerk);
+        const char *next = strchr(cursor, ',');
+        if (!next)
+            break;
+        cursor = next + 1;
+    }
+
+    // Servo types first: a stored calibration is only checked against the model it was made for
     std::string attached_servos_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_servos)));
-    if (attached_servos_settings.empty())
+    std::array<ServoConnection, MAX_SERVO_CHANNELS> stored_connections;
+    stored_connections.fill(NOT_CONNECTED);
+    uint8_t stored_count = 0;
+    cursor = attached_servos_settings.c_str();
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS && *cursor; ++ch)
     {
-        logger->info(progmem_to_string(ServoConsts::msg_no_saved_settings));
-        return true;
+        stored_connections[ch] = static_cast<ServoConnection>(atoi(cursor));
+        stored_count = ch + 1;
+        const char *next = strchr(cursor, ',');
+        if (!next)
+            break;
+        cursor = next + 1;
     }
 
-    // Parse comma-separated values and attach each servo
-    size_t pos = 0;
-    uint8_t channel = 0;
-    std::string token;
-    std::string remaining = attached_servos_settings;
+    // Calibrations before attaching, so each table is compiled once with them. Preferences
+    // can hold anything (older firmware, flash corruption): a calibration that fails the
+    // same checks as setServoCalibration() falls back to the defaults.
+    std::string calibration_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_calibration)));
+    cursor = calibration_settings.c_str();
+    for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS && *cursor; ++ch)
+    {
+        ServoCalibration calibration;
+        std::string error;
+        if (!calibration.fromString(cursor))
+            error = progmem_to_string(ServoConsts::err_calibration_format);
+        else
+            ServoPulseTable::validate(pulseModel(stored_connections[ch]), calibration, error);
+        if (!error.empty())
+        {
+            logger->warning(progmem_to_string(ServoConsts::msg_calibration_reset) + std::to_string(ch) + ": " + error);
+            calibration = ServoCalibration();
+        }
+        installCalibration(ch, pulseModel(attachedConnection(ch)), calibration);
+        const char *next = strchr(cursor, ',');
+        if (!next)
+            break;
+        cursor = next + 1;
+    }
+
+    std::string drive_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_drive)));
+    DriveConfig drive;
+    if (drive.fromString(drive_settings.c_str()))
+    {
+        std::string error;
+        setDriveConfig(drive, error);
+    }
 
-    while ((pos = remaining.find(',')) != std::string::npos && channel < MAX_SERVO_CHANNELS)
+    std::string reflex_settings = settings_service_->getSetting(getServiceName(), reinterpret_cast<const char *>(FPSTR(ServoConsts::settings_key_reflex)));
+    ReflexConfig reflex;
+    if (reflex.fromString(reflex_settings.c_str()))
     {
-        token = remaining.substr(0, pos);
-        int connection_value = atoi(token.c_str());
-        ServoConnection connection = static_cast<ServoConnection>(connection_value);
-        attachServo(channel, connection);
-        remaining.erase(0, pos + 1);
-        channel++;
+        std::string error;
+        setObstacleReflex(reflex, error);
     }
 
-    // Handle last value (no comma after it)
-    if (channel < MAX_SERVO_CHANNELS && !remaining.empty())
+    if (attached_servos_settings.empty())
     {
-        int connection_value = atoi(remaining.c_str());
-        ServoConnection connection = static_cast<ServoConnection>(connection_value);
-        attachServo(channel, connection);
+        logger->info(progmem_to_string(ServoConsts::msg_no_saved_settings));
+        return true;
     }
 
+    for (uint8_t ch = 0; ch < stored_count; ++ch)
+        attachServo(ch, stored_connections[ch]);
+
     logger->info(progmem_to_string(ServoConsts::msg_loaded_settings));
     return true;
 }
@@ -1430,13 +4241,14 @@ std::string ServoService::getAttachedServosMasked(uint8_t mask)
 {
     JsonDocument doc;
     JsonArray arr = doc[FPSTR(ServoConsts::json_attached_servos)].to<JsonArray>();
+    const ActuatorState state = actuatorSnapshot();
     for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
     {
         if (!(mask & (1u << ch)))
             continue;
         JsonObject obj = arr.add<JsonObject>();
         obj[ServoConsts::servo_channel] = ch;
-        const ServoConnection s = attached_servos[ch];
+        const ServoConnection s = state.connection(ch);
         obj[ServoConsts::connection] =
             s == NOT_CONNECTED ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_not_connected))
             : s == ROTATIONAL  ? reinterpret_cast<const char *>(FPSTR(ServoConsts::status_rotational))
@@ -1468,6 +4280,16 @@ std::string ServoService::getAttachedServosMasked(uint8_t mask)
  *   0x07 GET_SERVO_STATUS [mask]                      → [action][ok][JSON]
  *   0x08 GET_ALL_STATUS   (no params)                 → [action][ok][JSON]
  *   0x09 GET_BATTERY      (no params)                 → [action][ok][batt%:1B]
+ *   0x0A SET_MOTION_PROFILE [mask][vmax:u16_LE][amax:u16_LE][jerk:u16_LE]
+ *                          deg/s, deg/s², deg/s³; vmax=0 disables the profile, jerk optional (0 = trapezoidal)
+ *   0x0B MOTION_STATUS    (no params)                 → [action][ok][moving_mask]
+ *                          also sent unsolicited when a profiled move ends:
+ *                          [action][ok][moving_mask][reached_mask] to the peer that sent the target
+ *   0x0C TIMELINE_PLAY    [id][loop:1B optional]      loop: 0 once, 1 loop, absent = stored flag
+ *   0x0D TIMELINE_STOP    (no params)
+ *   0x0E SET_TWIST        [linear:int16_LE][angular:int16_LE][duration_ms:u16_LE optional]
+ *                          1/1000 of full speed (−1000..+1000), angular > 0 turns counter-clockwise;
+ *                          duration_ms ramps back to a stop (0/absent = no timeout)
  *
  * RESPONSE : [action:1B][resp_code:1B][optional_payload]
  *
@@ -1523,6 +4345,9 @@ bool ServoService::messageHandler(const std::string &message,
         const uint8_t n_ch = static_cast<uint8_t>(
             ((len - 1) / 2) < MAX_SERVO_CHANNELS ? (len - 1) / 2 : MAX_SERVO_CHANNELS);
         bool ok = true;
+        const ActuatorState state = actuatorSnapshot();
+        int16_t angles[MAX_SERVO_CHANNELS];
+        uint8_t updated = 0;
         for (uint8_t ch = 0; ch < n_ch; ++ch)
         {
             const size_t off = 1u + ch * 2u;
@@ -1531,20 +4356,25 @@ bool ServoService::messageHandler(const std::string &message,
             if (!(raw & 1))
                 continue;                   // bit0 == 0 → skip
             const int16_t angle = raw >> 1; // bits 15:1 as signed angle (centre-zero °)
-            const ServoConnection sc = attached_servos[ch];
-            uint16_t hw;
-            if (sc == ANGULAR_180 && angle >= -90 && angle <= 90)
-                hw = static_cast<uint16_t>(angle + 90);
-            else if (sc == ANGULAR_270 && angle >= -135 && angle <= 135)
-                hw = static_cast<uint16_t>(angle + 135);
-            else
+            const ServoConnection sc = state.connection(ch);
+            if (!(sc == ANGULAR_180 && angle >= -90 && angle <= 90) &&
+                !(sc == ANGULAR_270 && angle >= -135 && angle <= 135))
             {
                 ok = false;
                 continue;
             }
-            servoController.setServoAngle(static_cast<eServoNumber_t>(ch), hw);
-            servo_angles[ch] = static_cast<int16_t>(hw); // Track angle for UI display
+            if (motionProfileEnabled(ch))
+                setMotionEventReceiver(remoteIP, remotePort);
+            stageServoAngle(ch, angle);
+            angles[ch] = angle;
+            updated |= static_cast<uint8_t>(1u << ch);
         }
+        if (updated) // Track angles for UI display, all channels in one publication
+            publishActuatorState([&](ActuatorState &current)
+                                 {
+                for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+                    if (updated & (1u << ch))
+                        current.servo_angles[ch] = angles[ch]; });
         udp_build(action, ok ? UDPProto::udp_resp_ok : UDPProto::udp_resp_operation_failed, nullptr, resp);
         break;
     }
@@ -1562,6 +4392,8 @@ bool ServoService::messageHandler(const std::string &message,
         }
         const uint8_t mask = d[1];
         bool ok = true;
+        ActuatorState state = actuatorSnapshot();
+        uint8_t updated = 0;
         uint8_t speed_idx = 2; // Start at byte 2 for speed bytes
         for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS && speed_idx < len; ++ch, ++speed_idx)
         {
@@ -1574,25 +4406,28 @@ bool ServoService::messageHandler(const std::string &message,
                 return true;
             }
             // Only apply if speed differs from current tracked speed
-            if (speed == servo_speeds[ch])
+            if (speed == state.servo_speeds[ch])
             {
 #ifdef SERVO_VERBOSE_DEBUG
                 logger->debug("Servo " + std::to_string(ch) + " speed unchanged (" + std::to_string(speed) + "), skipping");
 #endif
                 continue;
             }
-            if (attached_servos[ch] != ROTATIONAL)
+            if (state.connection(ch) != ROTATIONAL)
             {
                 ok = false;
                 continue;
             }
-            servo_speeds[ch] = speed; // Track new speed
-            const eServo360Direction_t dir = speed > 0   ? eServo360Direction_t::eForward
-                                             : speed < 0 ? eServo360Direction_t::eBackward
-                                                         : eServo360Direction_t::eStop;
-            const uint8_t duty = static_cast<uint8_t>(speed < 0 ? -speed : speed);
-            servoController.setServo360(static_cast<eServoNumber_t>(ch), dir, duty);
+            state.servo_speeds[ch] = speed; // Track new speed
+            updated |= static_cast<uint8_t>(1u << ch);
+            stageServoPulse(ch, speedPulse(ch, speed));
         }
+        if (updated)
+            publishActuatorState([&](ActuatorState &current)
+                                 {
+                for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+                    if (updated & (1u << ch))
+                        current.servo_speeds[ch] = state.servo_speeds[ch]; });
         // Optional trailing uint16 LE at bytes 10-11: auto-stop duration_ms
         // The sender must include all 8 speed bytes (total packet len ≥ 10) for this to apply.
         // duration_ms = 0 means no auto-stop.
@@ -1602,10 +4437,10 @@ bool ServoService::messageHandler(const std::string &message,
                 : 0;
             for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
             {
-                if (!(mask & (1u << ch)) || attached_servos[ch] != ROTATIONAL)
+                if (!(mask & (1u << ch)) || state.connection(ch) != ROTATIONAL)
                     continue;
                 // Schedule stop for channels running (cancel stop for channels that were stopped)
-                scheduleChannelStop(ch, (servo_speeds[ch] != 0) ? duration_ms : 0);
+                scheduleChannelStop(ch, (state.servo_speeds[ch] != 0) ? duration_ms : 0);
             }
         }
         udp_build(action, ok ? UDPProto::udp_resp_ok : UDPProto::udp_resp_operation_failed, nullptr, resp);
@@ -1620,9 +4455,15 @@ bool ServoService::messageHandler(const std::string &message,
             break;
         }
         const uint8_t mask = d[1];
-        for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
-            if ((mask & (1u << ch)) && attached_servos[ch] == ROTATIONAL)
-                servoController.setServo360(static_cast<eServoNumber_t>(ch), eServo360Direction_t::eStop, 0);
+        publishActuatorState([&](ActuatorState &state)
+                             {
+            for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+                if ((mask & (1u << ch)) && state.connection(ch) == ROTATIONAL)
+                {
+                    stageServoPulse(ch, speedPulse(ch, 0));
+                    state.servo_speeds[ch] = 0;
+                } });
+        requestCommit();
         udp_build(action, UDPProto::udp_resp_ok, nullptr, resp);
         break;
     }
@@ -1641,13 +4482,14 @@ bool ServoService::messageHandler(const std::string &message,
             break;
         }
         const ServoConnection conn = static_cast<ServoConnection>(type);
+        // Same path as HTTP attach: the channel's pulse table is recompiled for the new type
         for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
             if (mask & (1u << ch))
-                attached_servos[ch] = conn;
+                attachServo(ch, conn);
         udp_build(action, UDPProto::udp_resp_ok, nullptr, resp);
         break;
     }
-    // 0x05 SET_MOTOR_SPEED  [encoded_speeds...][1B each for each motor]
+    // 0x05 SET_MOTOR_SPEED  [encoded_speeds...][1B each for each motor][duration_ms:u16_LE optional]
     //   Variable payload: each byte corresponds to destination motor in order
     //   each uint8 byte encodes: speed = byte - 128  (shifts 28..228 to -100..+100)
     //   Speed -100 → byte 0x1C (28);  Speed 0 → byte 0x80 (128);  Speed +100 → byte 0xE4 (228)
@@ -1659,7 +4501,10 @@ bool ServoService::messageHandler(const std::string &message,
             udp_build(action, UDPProto::udp_resp_invalid_params, nullptr, resp);
             break;
         }
+        setMotionEventReceiver(remoteIP, remotePort); // obstacle reflex events
         bool ok = true;
+        ActuatorState state = actuatorSnapshot();
+        uint8_t updated = 0;
         uint8_t speed_idx = 1; // Start at byte 1 for speed bytes
         for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS && speed_idx < len; ++m, ++speed_idx)
         {
@@ -1670,35 +4515,35 @@ bool ServoService::messageHandler(const std::string &message,
                 return true;
             }
             // Only apply if speed differs from current tracked speed
-            if (speed == motor_speeds[m])
+            if (speed == state.motor_speeds[m])
             {
 #ifdef SERVO_VERBOSE_DEBUG
                 logger->debug("Motor " + std::to_string(m) + " speed unchanged (" + std::to_string(speed) + "), skipping");
 #endif
                 continue;
             }
-            motor_speeds[m] = speed; // Track new speed
-            const uint16_t duty = static_cast<uint16_t>((speed < 0 ? -speed : speed) * 65535 / 100);
+            state.motor_speeds[m] = speed; // Track new speed
+            updated |= static_cast<uint8_t>(1u << m);
 #ifdef SERVO_VERBOSE_DEBUG
-            logger->debug("Motor " + std::to_string(m) + " speed=" + std::to_string(speed) + " duty=" + std::to_string(duty));
+            logger->debug("Motor " + std::to_string(m) + " speed=" + std::to_string(speed));
 #endif
-            const eMotorNumber_t motor_a = static_cast<eMotorNumber_t>(m * 2);
-            const eMotorNumber_t motor_b = static_cast<eMotorNumber_t>(m * 2 + 1);
-            if (speed > 0)
-            {
-                servoController.setMotorDuty(motor_a, duty);
-                servoController.setMotorDuty(motor_b, 0);
-            }
-            else if (speed < 0)
-            {
-                servoController.setMotorDuty(motor_a, 0);
-                servoController.setMotorDuty(motor_b, duty);
-            }
-            else
-            {
-                servoController.setMotorDuty(motor_a, 0);
-                servoController.setMotorDuty(motor_b, 0);
-            }
+            stageMotorSpeed(m, speed);
+        }
+        if (updated)
+            publishActuatorState([&](ActuatorState &current)
+                                 {
+                for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
+                    if (updated & (1u << m))
+                        current.motor_speeds[m] = state.motor_speeds[m]; });
+        // Optional trailing uint16 LE at bytes 5-6: auto-stop duration_ms
+        // The sender must include all 4 speed bytes (total packet len ≥ 5) for this to apply.
+        // duration_ms = 0 means no auto-stop.
+        {
+            const uint32_t duration_ms = (len >= 7)
+                ? (static_cast<uint32_t>(d[5]) | (static_cast<uint32_t>(d[6]) << 8))
+                : 0;
+            for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS && m + 1u < len; ++m)
+                scheduleMotorStop(m, (state.motor_speeds[m] != 0) ? duration_ms : 0);
         }
         udp_build(action, ok ? UDPProto::udp_resp_ok : UDPProto::udp_resp_operation_failed, nullptr, resp);
         break;
@@ -1712,13 +4557,16 @@ bool ServoService::messageHandler(const std::string &message,
             break;
         }
         const uint8_t mask = d[1];
-        for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
-        {
-            if (!(mask & (1u << m)))
-                continue;
-            servoController.setMotorDuty(static_cast<eMotorNumber_t>(m * 2), 0);
-            servoController.setMotorDuty(static_cast<eMotorNumber_t>(m * 2 + 1), 0);
-        }
+        publishActuatorState([&](ActuatorState &state)
+                             {
+            for (uint8_t m = 0; m < MAX_MOTOR_CHANNELS; ++m)
+            {
+                if (!(mask & (1u << m)))
+                    continue;
+                stageMotorSpeed(m, 0);
+                state.motor_speeds[m] = 0;
+            } });
+        requestCommit();
         udp_build(action, UDPProto::udp_resp_ok, nullptr, resp);
         break;
     }
@@ -1745,6 +4593,79 @@ bool ServoService::messageHandler(const std::string &message,
         resp += static_cast<char>(batt);
         break;
     }
+    // 0x0A SET_MOTION_PROFILE  [mask:1B][vmax:u16_LE][amax:u16_LE][jerk:u16_LE (optional)]
+    case ServoConsts::udp_action_set_motion_profile:
+    {
+        if (len < 6)
+        {
+            udp_build(action, UDPProto::udp_resp_invalid_params, nullptr, resp);
+            break;
+        }
+        const uint8_t mask = d[1];
+        const uint16_t vmax = static_cast<uint16_t>(d[2] | (d[3] << 8));
+        const uint16_t amax = static_cast<uint16_t>(d[4] | (d[5] << 8));
+        const uint16_t jerk = (len >= 8) ? static_cast<uint16_t>(d[6] | (d[7] << 8)) : 0;
+        for (uint8_t ch = 0; ch < MAX_SERVO_CHANNELS; ++ch)
+            if (mask & (1u << ch))
+                setMotionProfile(ch, vmax, amax, jerk);
+        udp_build(action, UDPProto::udp_resp_ok, nullptr, resp);
+        break;
+    }
+    // 0x0B MOTION_STATUS  → single byte, bit N set while channel N follows a profile
+    case ServoConsts::udp_action_motion_status:
+        resp.clear();
+        resp += static_cast<char>(action);
+        resp += static_cast<char>(UDPProto::udp_resp_ok);
+        resp += static_cast<char>(motion_moving_mask.load(std::memory_order_relaxed));
+        break;
+    // 0x0C TIMELINE_PLAY  [id:1B][loop:1B optional]
+    case ServoConsts::udp_action_timeline_play:
+    {
+        if (len < 2)
+        {
+            udp_build(action, UDPProto::udp_resp_invalid_params, nullptr, resp);
+            break;
+        }
+        const int8_t loop = (len >= 3) ? (d[2] ? 1 : 0) : -1;
+        udp_build(action, playTimeline(d[1], loop) ? UDPProto::udp_resp_ok : UDPProto::udp_resp_invalid_values, nullptr, resp);
+        break;
+    }
+    // 0x0D TIMELINE_STOP
+    case ServoConsts::udp_action_timeline_stop:
+        udp_build(action, stopTimeline() ? UDPProto::udp_resp_ok : UDPProto::udp_resp_operation_failed, nullptr, resp);
+        break;
+    // 0x0E SET_TWIST  [linear:int16_LE][angular:int16_LE][duration_ms:u16_LE optional]
+    case ServoConsts::udp_action_set_twist:
+    {
+        if (len < 5)
+        {
+            udp_build(action, UDPProto::udp_resp_invalid_params, nullptr, resp);
+            break;
+        }
+        const int16_t linear = static_cast<int16_t>(d[1] | (d[2] << 8));
+        const int16_t angular = static_cast<int16_t>(d[3] | (d[4] << 8));
+        const uint32_t duration_ms = (len >= 7) ? static_cast<uint32_t>(d[5] | (d[6] << 8)) : 0;
+        if (linear < -DifferentialDrive::FULL_SCALE || linear > DifferentialDrive::FULL_SCALE ||
+            angular < -DifferentialDrive::FULL_SCALE || angular > DifferentialDrive::FULL_SCALE)
+        {
+            udp_build(action, UDPProto::udp_resp_invalid_values, nullptr, resp);
+            break;
+        }
+        setMotionEventReceiver(remoteIP, remotePort);
+        udp_build(action, setTwist(linear, angular, duration_ms) ? UDPProto::udp_resp_ok : UDPProto::udp_resp_operation_failed, nullptr, resp);
+        break;
+    }
+    // 0x0F OBSTACLE  → [state][range:int16_LE][cap:u16_LE]  (range -1 = no valid reading)
+    case ServoConsts::udp_action_obstacle:
+    {
+        const ReflexStatus status = getObstacleReflexStatus();
+        const uint8_t payload[] = {static_cast<uint8_t>(status.state),
+                                   static_cast<uint8_t>(status.range & 0xFF), static_cast<uint8_t>((status.range >> 8) & 0xFF),
+                                   static_cast<uint8_t>(status.cap & 0xFF), static_cast<uint8_t>((status.cap >> 8) & 0xFF)};
+        udp_build(action, UDPProto::udp_resp_ok, nullptr, resp);
+        resp.append(reinterpret_cast<const char *>(payload), sizeof(payload));
+        break;
+    }
     default:
         udp_build(action, UDPProto::udp_resp_unknown_cmd, nullptr, resp);
         break;
@@ -116,6 +116,13 @@ bool UDPService::sendReply(const std::string &message, const IPAddress &remoteIP
              remotePort) == message.length();
 }
 
+bool UDPService::sendTo(const uint8_t *data, size_t len, const IPAddress &remoteIP, uint16_t remotePort)
+{
+  if (!udpHandle || !data || !len)
+    return false;
+  return udpHandle->writeTo(data, len, remoteIP, remotePort) == len;
+}
+
 void handleUDPPacket(AsyncUDPPacket packet)
 {
   if (packet.length() == 0)
@@ -323,9 +323,11 @@ void UTB2026::draw_servos()
     tft.setCursor(START_CHAR, UTB2026Consts::line_height * (LINE++));
     tft.print("+----+-----+------+");
 
+    // One consistent snapshot per refresh instead of three getter calls per channel
+    const ServoService::ActuatorState actuators = servo_service.getActuatorState();
     for (uint8_t ch = 0; ch < 6; ++ch)
     {
-        const ServoConnection conn = servo_service.getServoConnection(ch);
+        const ServoConnection conn = actuators.connection(ch);
         char linebuf[41];
 
         switch (conn)
@@ -335,7 +337,7 @@ void UTB2026::draw_servos()
             break;
         case ROTATIONAL:
         {
-            const int8_t spd = servo_service.getServoSpeed(ch);
+            const int8_t spd = actuators.servo_speeds[ch];
             if (spd == -128)
                 snprintf(linebuf, sizeof(linebuf), "| S%u | rot |      |", ch);
             else
@@ -344,7 +346,7 @@ void UTB2026::draw_servos()
         }
         case ANGULAR_180:
         {
-            const int16_t ang = servo_service.getServoAngle(ch);
+            const int16_t ang = actuators.servo_angles[ch];
             if (ang < 0)
                 snprintf(linebuf, sizeof(linebuf), "| S%u | 180 |      |", ch);
             else
@@ -353,7 +355,7 @@ void UTB2026::draw_servos()
         }
         case ANGULAR_270:
         {
-            const int16_t ang = servo_service.getServoAngle(ch);
+            const int16_t ang = actuators.servo_angles[ch];
             if (ang < 0)
                 snprintf(linebuf, sizeof(linebuf), "| S%u | 270 |      |", ch);
             else
@@ -544,9 +546,10 @@ void UTB2026::draw_motors()
     tft.setCursor(START_CHAR, UTB2026Consts::line_height * (LINE++));
     tft.print("+-----+-----+");
 
+    const ServoService::ActuatorState actuators = servo_service.getActuatorState();
     for (uint8_t motor = 1; motor <= 4; ++motor)
     {
-        const int8_t spd = servo_service.getMotorSpeed(motor);
+        const int8_t spd = actuators.motor_speeds[motor - 1];
         char linebuf[41];
 
         if (spd == -128)
@@ -0,0 +1,139 @@
+/**
+ * ActionMask / ActionAcl implementation
+ */
+#include "ActionAcl.h"
+
+void ActionMask::setAll()
+{
+    for (uint8_t i = 0; i < 8; ++i)
+        words[i] = 0xFFFFFFFFu;
+}
+
+ActionMask ActionMask::of(const uint8_t *actions, size_t count)
+{
+    ActionMask mask;
+    for (size_t i = 0; i < count; ++i)
+        mask.set(actions[i]);
+    return mask;
+}
+
+void ActionMask::toBytes(uint8_t out[32]) const
+{
+    for (uint8_t i = 0; i < 32; ++i)
+        out[i] = static_cast<uint8_t>(words[i >> 2] >> ((i & 3) * 8));
+}
+
+ActionMask ActionMask::fromBytes(const uint8_t in[32])
+{
+    ActionMask mask;
+    for (uint8_t i = 0; i < 32; ++i)
+        mask.words[i >> 2] |= static_cast<uint32_t>(in[i]) << ((i & 3) * 8);
+    return mask;
+}
+
+void ActionMask::toHex(char out[65]) const
+{
+    static const char digits[] = "0123456789abcdef";
+    uint8_t bytes[32];
+    toBytes(bytes);
+    for (uint8_t i = 0; i < 32; ++i)
+    {
+        out[2 * i] = digits[bytes[i] >> 4];
+        out[2 * i + 1] = digits[bytes[i] & 0x0F];
+    }
+    out[64] = '\0';
+}
+
+const char *ActionAcl::roleName(PeerRole role)
+{
+    switch (role)
+    {
+    case PeerRole::OBSERVER:
+        return "observer";
+    case PeerRole::STUDENT:
+        return "student";
+    case PeerRole::MASTER:
+        return "master";
+    default:
+        return "guest";
+    }
+}
+
+void ActionAcl::setRoleMask(PeerRole role, const ActionMask &mask)
+{
+    role_masks_[static_cast<uint8_t>(role) & 3] = mask;
+}
+
+const ActionMask &ActionAcl::roleMask(PeerRole role) const
+{
+    return role_masks_[static_cast<uint8_t>(role) & 3];
+}
+
+int8_t ActionAcl::find(uint32_t ipv4) const
+{
+    for (uint8_t i = 0; i < MAX_PEERS; ++i)
+        if (peers_[i].ipv4 == ipv4)
+            return static_cast<int8_t>(i);
+    return -1;
+}
+
+bool ActionAcl::grant(uint32_t ipv4, PeerRole role, const ActionMask *mask)
+{
+    if (ipv4 == 0 || static_cast<uint8_t>(role) >= ROLE_COUNT || role == PeerRole::MASTER)
+        return false;
+    int8_t slot = find(ipv4);
+    if (role == PeerRole::GUEST)
+    {
+        if (slot >= 0)
+            peers_[slot] = Peer();
+        return true;
+    }
+    if (slot < 0)
+        slot = find(0);
+    if (slot < 0)
+        return false;
+    Peer &peer = peers_[slot];
+    peer.ipv4 = ipv4;
+    peer.role = role;
+    peer.mask = mask ? *mask : roleMask(role);
+    peer.denied = 0;
+    return true;
+}
+
+void ActionAcl::clear()
+{
+    for (uint8_t i = 0; i < MAX_PEERS; ++i)
+        peers_[i] = Peer();
+}
+
+PeerRole ActionAcl::roleOf(uint32_t ipv4) const
+{
+    const int8_t slot = ipv4 ? find(ipv4) : -1;
+    return slot >= 0 ? peers_[slot].role : PeerRole::GUEST;
+}
+
+bool ActionAcl::allowed(uint32_t ipv4, bool is_master, uint8_t action)
+{
+    if (is_master)
+        return true;
+    const int8_t slot = ipv4 ? find(ipv4) : -1;
+    if (slot >= 0 && peers_[slot].mask.test(action))
+        return true;
+    if (slot >= 0)
+    {
+        peers_[slot].denied++;
+        denials_[static_cast<uint8_t>(peers_[slot].role)]++;
+    }
+    else
+        denials_[static_cast<uint8_t>(PeerRole::GUEST)]++;
+    return false;
+}
+
+uint8_t ActionAcl::peers(Peer out[], uint8_t max_count) const
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_PEERS && count < max_count; ++i)
+        if (peers_[i].ipv4 != 0)
+            out[count++] = peers_[i];
+    return count;
+}
@@ -0,0 +1,156 @@
+/**
+ * DriveConfig / DifferentialDrive implementation
+ */
+#include "DifferentialDrive.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+std::string DriveConfig::toString() const
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%u:%u:%u:%u:%u:%u", left_motor, right_motor,
+             invert_left ? 1u : 0u, invert_right ? 1u : 0u, deadband, accel_limit);
+    return text;
+}
+
+bool DriveConfig::fromString(const char *text)
+{
+    unsigned left = 0, right = 0, inv_left = 0, inv_right = 0, dead = 0, accel = 0;
+    if (!text || sscanf(text, "%u:%u:%u:%u:%u:%u", &left, &right, &inv_left, &inv_right, &dead, &accel) != 6)
+        return false;
+    DriveConfig parsed;
+    parsed.left_motor = static_cast<uint8_t>(left);
+    parsed.right_motor = static_cast<uint8_t>(right);
+    parsed.invert_left = inv_left != 0;
+    parsed.invert_right = inv_right != 0;
+    parsed.deadband = static_cast<uint16_t>(dead);
+    parsed.accel_limit = static_cast<uint16_t>(accel);
+    std::string error;
+    if (!parsed.validate(error))
+        return false;
+    *this = parsed;
+    return true;
+}
+
+bool DriveConfig::validate(std::string &error) const
+{
+    if (left_motor > 3 || right_motor > 3 || left_motor == right_motor)
+    {
+        error = "left_motor and right_motor must be two different motors (1-4)";
+        return false;
+    }
+    if (deadband > 500)
+    {
+        error = "deadband must be 0-500";
+        return false;
+    }
+    return true;
+}
+
+void DifferentialDrive::mix(int32_t linear, int32_t angular, int32_t &left, int32_t &right)
+{
+    left = linear - angular;
+    right = linear + angular;
+    const int32_t peak = abs(left) > abs(right) ? abs(left) : abs(right);
+    if (peak > FULL_SCALE)
+    {
+        left = left * FULL_SCALE / peak;
+        right = right * FULL_SCALE / peak;
+    }
+}
+
+int32_t DifferentialDrive::compensate(int32_t wheel, uint16_t deadband)
+{
+    if (wheel == 0)
+        return 0;
+    int32_t magnitude = abs(wheel);
+    if (magnitude > FULL_SCALE)
+        magnitude = FULL_SCALE;
+    // Rounded up: the smallest command lands strictly above the deadband
+    const int32_t duty = deadband + (magnitude * (FULL_SCALE - deadband) + FULL_SCALE - 1) / FULL_SCALE;
+    return wheel < 0 ? -duty : duty;
+}
+
+int32_t DifferentialDrive::uncompensate(int32_t duty, uint16_t deadband)
+{
+    const int32_t magnitude = abs(duty);
+    if (magnitude <= deadband)
+        return 0;
+    int32_t wheel = ((magnitude - deadband) * FULL_SCALE + (FULL_SCALE - deadband) / 2) / (FULL_SCALE - deadband);
+    if (wheel > FULL_SCALE)
+        wheel = FULL_SCALE;
+    return duty < 0 ? -wheel : wheel;
+}
+
+void DifferentialDrive::reset(int32_t left, int32_t right)
+{
+    left_ = target_left_ = left;
+    right_ = target_right_ = right;
+    step_rem_ = 0;
+}
+
+void DifferentialDrive::setTarget(int32_t linear, int32_t angular)
+{
+    mix(linear, angular, target_left_, target_right_);
+}
+
+bool DifferentialDrive::step(uint32_t dt_us)
+{
+    const int32_t delta_left = target_left_ - left_;
+    const int32_t delta_right = target_right_ - right_;
+    const int32_t distance = abs(delta_left) > abs(delta_right) ? abs(delta_left) : abs(delta_right);
+    if (distance == 0)
+    {
+        step_rem_ = 0;
+        return false;
+    }
+    if (config_.accel_limit == 0)
+    {
+        left_ = target_left_;
+        right_ = target_right_;
+        return true;
+    }
+
+    const int64_t budget = static_cast<int64_t>(config_.accel_limit) * dt_us + step_rem_;
+    const int32_t max_step = static_cast<int32_t>(budget / 1000000);
+    if (distance <= max_step)
+    {
+        left_ = target_left_;
+        right_ = target_right_;
+        step_rem_ = 0;
+        return true;
+    }
+    step_rem_ = budget - static_cast<int64_t>(max_step) * 1000000;
+    if (max_step == 0)
+        return false;
+    // Both wheels cover the same fraction of their distance: the pair ramps along a straight line
+    left_ += delta_left * max_step / distance;
+    right_ += delta_right * max_step / distance;
+    return true;
+}
+
+bool DifferentialDrive::limitForward(int32_t max)
+{
+    const int32_t peak = left_ > right_ ? left_ : right_;
+    if (peak <= max)
+        return false;
+    // Same factor on both wheels, like the saturation in mix(): the turn keeps its curvature
+    if (max < 0)
+        max = 0;
+    left_ = left_ * max / peak;
+    right_ = right_ * max / peak;
+    step_rem_ = 0;
+    return true;
+}
+
+int32_t DifferentialDrive::leftDuty() const
+{
+    const int32_t duty = compensate(left_, config_.deadband);
+    return config_.invert_left ? -duty : duty;
+}
+
+int32_t DifferentialDrive::rightDuty() const
+{
+    const int32_t duty = compensate(right_, config_.deadband);
+    return config_.invert_right ? -duty : duty;
+}
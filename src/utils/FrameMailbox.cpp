@@ -0,0 +1,53 @@
+/**
+ * FrameMailbox implementation
+ */
+#include "FrameMailbox.h"
+
+void *FrameMailbox::post(void *frame, int64_t capture_us)
+{
+    void *previous = frame_;
+    if (previous)
+        stats_.dropped++;
+    frame_ = frame;
+    capture_us_ = capture_us;
+    stats_.generation++;
+    return previous;
+}
+
+void *FrameMailbox::take(uint32_t &generation, int64_t now_us)
+{
+    // Signed difference: generations wrap around
+    if (!frame_ || static_cast<int32_t>(stats_.generation - generation) <= 0)
+        return nullptr;
+
+    void *frame = frame_;
+    frame_ = nullptr;
+    generation = stats_.generation;
+
+    const uint32_t age = now_us > capture_us_ ? static_cast<uint32_t>(now_us - capture_us_) : 0;
+    if (!stats_.taken || age < stats_.age_us_min)
+        stats_.age_us_min = age;
+    if (age > stats_.age_us_max)
+        stats_.age_us_max = age;
+    stats_.age_us_last = age;
+    age_sum_us_ += age;
+    stats_.taken++;
+    return frame;
+}
+
+void *FrameMailbox::clear()
+{
+    void *previous = frame_;
+    if (previous)
+        stats_.dropped++;
+    frame_ = nullptr;
+    return previous;
+}
+
+FrameMailbox::Stats FrameMailbox::stats() const
+{
+    Stats stats = stats_;
+    stats.age_us_avg = stats_.taken ? static_cast<uint32_t>(age_sum_us_ / stats_.taken) : 0;
+    stats.full = frame_ != nullptr;
+    return stats;
+}
@@ -0,0 +1,173 @@
+/**
+ * FrameTransport implementation
+ */
+#include "FrameTransport.h"
+#include <string.h>
+
+int8_t FrameTransport::slotOf(uint32_t ipv4, uint16_t port, uint32_t ws_client) const
+{
+    for (uint8_t slot = 0; slot < MAX_PEERS; ++slot)
+    {
+        const FramePeer &p = peers_[slot];
+        if (!p.ipv4)
+            continue;
+        // A WebSocket peer is its bridge client, whatever the marker address
+        if (ws_client ? p.ws_client == ws_client : (!p.ws_client && p.ipv4 == ipv4 && p.port == port))
+            return static_cast<int8_t>(slot);
+    }
+    return -1;
+}
+
+bool FrameTransport::subscribe(uint32_t ipv4, uint16_t port, uint32_t ws_client, uint8_t max_fps, int64_t now_us)
+{
+    if (!ipv4)
+        return false;
+    int8_t slot = slotOf(ipv4, port, ws_client);
+    if (slot < 0)
+    {
+        for (uint8_t s = 0; s < MAX_PEERS && slot < 0; ++s)
+            if (!peers_[s].ipv4)
+                slot = static_cast<int8_t>(s);
+        if (slot < 0)
+            return false;
+        peers_[slot] = FramePeer();
+        peers_[slot].ipv4 = ipv4;
+        peers_[slot].port = port;
+        peers_[slot].ws_client = ws_client;
+    }
+    FramePeer &p = peers_[slot];
+    p.min_interval_us = max_fps ? 1000000u / max_fps : 0;
+    p.expires_us = now_us + LEASE_US;
+    return true;
+}
+
+bool FrameTransport::unsubscribe(uint32_t ipv4, uint16_t port, uint32_t ws_client)
+{
+    const int8_t slot = slotOf(ipv4, port, ws_client);
+    if (slot < 0)
+        return false;
+    peers_[slot] = FramePeer();
+    return true;
+}
+
+uint8_t FrameTransport::expire(int64_t now_us)
+{
+    for (FramePeer &p : peers_)
+        if (p.ipv4 && now_us >= p.expires_us)
+            p = FramePeer();
+    return peers();
+}
+
+void FrameTransport::clear()
+{
+    for (FramePeer &p : peers_)
+        p = FramePeer();
+}
+
+uint8_t FrameTransport::peers() const
+{
+    uint8_t count = 0;
+    for (const FramePeer &p : peers_)
+        if (p.ipv4)
+            count++;
+    return count;
+}
+
+const FramePeer *FrameTransport::find(uint32_t ipv4, uint16_t port, uint32_t ws_client) const
+{
+    const int8_t slot = slotOf(ipv4, port, ws_client);
+    return slot < 0 ? nullptr : &peers_[slot];
+}
+
+uint8_t FrameTransport::due(int64_t now_us, Target out[MAX_PEERS])
+{
+    uint8_t count = 0;
+    for (uint8_t slot = 0; slot < MAX_PEERS; ++slot)
+    {
+        FramePeer &p = peers_[slot];
+        if (!p.ipv4)
+            continue;
+        // 1/8 of slack: camera frames do not arrive exactly on the requested period
+        if (p.min_interval_us && p.last_sent_us &&
+            now_us - p.last_sent_us < static_cast<int64_t>(p.min_interval_us - p.min_interval_us / 8))
+        {
+            p.frames_skipped++;
+            continue;
+        }
+        p.last_sent_us = now_us;
+        Target &t = out[count++];
+        t.slot = slot;
+        t.ipv4 = p.ipv4;
+        t.port = p.port;
+        t.ws_client = p.ws_client;
+    }
+    return count;
+}
+
+void FrameTransport::sent(const Target &target, bool complete, uint16_t fragments)
+{
+    FramePeer &p = peers_[target.slot];
+    if (p.ipv4 != target.ipv4 || p.port != target.port || p.ws_client != target.ws_client)
+        return;
+    p.fragments_sent += fragments;
+    if (complete)
+        p.frames_sent++;
+    else
+        p.frames_aborted++;
+}
+
+uint16_t FrameTransport::fragmentCount(size_t frame_len)
+{
+    return static_cast<uint16_t>((frame_len + MAX_PAYLOAD - 1) / MAX_PAYLOAD);
+}
+
+size_t FrameTransport::buildFragment(uint8_t action, uint16_t frame_id, uint64_t capture_us,
+                                     const uint8_t *frame, size_t frame_len, uint16_t index, uint8_t *out)
+{
+    const uint16_t count = fragmentCount(frame_len);
+    if (index >= count)
+        return 0;
+    const size_t offset = static_cast<size_t>(index) * MAX_PAYLOAD;
+    const size_t payload = frame_len - offset < MAX_PAYLOAD ? frame_len - offset : MAX_PAYLOAD;
+
+    size_t n = 0;
+    auto put = [&](uint64_t v, uint8_t bytes)
+    {
+        for (uint8_t i = 0; i < bytes; ++i)
+            out[n++] = static_cast<uint8_t>(v >> (8 * i));
+    };
+    put(action, 1);
+    put(VERSION, 1);
+    put(frame_id, 2);
+    put(index, 2);
+    put(count, 2);
+    put(frame_len, 4);
+    put(capture_us, 8);
+    memcpy(out + n, frame + offset, payload);
+    return n + payload;
+}
+
+bool FrameTransport::parseHeader(const uint8_t *datagram, size_t len, Header &header)
+{
+    if (!datagram || len < HEADER_SIZE)
+        return false;
+    auto get = [&](size_t at, uint8_t bytes)
+    {
+        uint64_t v = 0;
+        for (uint8_t i = 0; i < bytes; ++i)
+            v |= static_cast<uint64_t>(datagram[at + i]) << (8 * i);
+        return v;
+    };
+    Header h;
+    h.action = datagram[0];
+    h.version = datagram[1];
+    h.frame_id = static_cast<uint16_t>(get(2, 2));
+    h.index = static_cast<uint16_t>(get(4, 2));
+    h.count = static_cast<uint16_t>(get(6, 2));
+    h.frame_len = static_cast<uint32_t>(get(8, 4));
+    h.capture_us = get(12, 8);
+    if (h.version != VERSION || !h.count || h.index >= h.count || h.count != fragmentCount(h.frame_len))
+        return false;
+    header = h;
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * HeartbeatWatchdog implementation
+ */
+#include "HeartbeatWatchdog.h"
+
+void HeartbeatWatchdog::reset()
+{
+    armed_ = false;
+    timed_out_ = false;
+    deadline_us_ = 0;
+}
+
+bool HeartbeatWatchdog::feed(uint64_t now_us)
+{
+    const bool restored = timed_out_;
+    deadline_us_ = now_us + timeout_us_;
+    armed_ = true;
+    timed_out_ = false;
+    stats_.heartbeats++;
+    if (restored)
+        stats_.restores++;
+    return restored;
+}
+
+bool HeartbeatWatchdog::expire(uint64_t now_us)
+{
+    if (!armed_ || timed_out_ || now_us < deadline_us_)
+    {
+        stats_.stale_expiries++;
+        return false;
+    }
+    const uint64_t late = now_us - deadline_us_;
+    if (late > stats_.timer_late_max_us)
+        stats_.timer_late_max_us = late > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(late);
+    timed_out_ = true;
+    expired_deadline_us_ = deadline_us_;
+    stats_.expiries++;
+    return true;
+}
+
+void HeartbeatWatchdog::recordStop(uint64_t now_us)
+{
+    // A heartbeat may already have moved the deadline while the stop ran
+    const uint64_t elapsed = now_us > expired_deadline_us_ ? now_us - expired_deadline_us_ : 0;
+    const uint32_t latency_us = elapsed > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(elapsed);
+    const uint8_t bucket = latency_us ? static_cast<uint8_t>(31 - __builtin_clz(latency_us)) : 0;
+    stop_count_++;
+    if (stop_count_ == 1 || latency_us < stats_.latency_min_us)
+        stats_.latency_min_us = latency_us;
+    if (latency_us > stats_.latency_max_us)
+        stats_.latency_max_us = latency_us;
+    stats_.latency_last_us = latency_us;
+    latency_sum_us_ += latency_us;
+    stats_.latency_avg_us = static_cast<uint32_t>(latency_sum_us_ / stop_count_);
+    stats_.hist[bucket < Stats::HIST_BUCKETS ? bucket : Stats::HIST_BUCKETS - 1]++;
+}
+
+void HeartbeatWatchdog::resetStats()
+{
+    stats_ = Stats();
+    latency_sum_us_ = 0;
+    stop_count_ = 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * JpegBufferPool implementation
+ */
+#include "JpegBufferPool.h"
+
+bool JpegBufferPool::begin(const JpegPoolClass *classes, uint8_t count, AllocFn alloc, FreeFn dealloc)
+{
+    if (ready() || !classes || !count || count > MAX_CLASSES || !alloc || !dealloc)
+        return false;
+    uint16_t total = 0;
+    for (uint8_t c = 0; c < count; ++c)
+    {
+        if (!classes[c].size || !classes[c].count || (c && classes[c].size <= classes[c - 1].size))
+            return false;
+        total += classes[c].count;
+    }
+    if (total > MAX_SLOTS)
+        return false;
+
+    Stats stats;
+    uint8_t slot = 0;
+    for (uint8_t c = 0; c < count; ++c)
+    {
+        stats.cls[c].size = classes[c].size;
+        stats.cls[c].count = classes[c].count;
+        for (uint8_t i = 0; i < classes[c].count; ++i, ++slot)
+        {
+            frames_[slot] = JpegFrame();
+            frames_[slot].data = static_cast<uint8_t *>(alloc(classes[c].size));
+            if (!frames_[slot].data)
+            {
+                while (slot--)
+                {
+                    dealloc(frames_[slot].data);
+                    frames_[slot] = JpegFrame();
+                }
+                return false;
+            }
+            frames_[slot].capacity = classes[c].size;
+            class_of_[slot] = c;
+            busy_[slot] = false;
+            stats.bytes += classes[c].size;
+        }
+    }
+    stats.classes = count;
+    stats.slots = slot;
+    stats_ = stats;
+    slots_ = slot;
+    dealloc_ = dealloc;
+    return true;
+}
+
+bool JpegBufferPool::end()
+{
+    if (stats_.in_use)
+        return false;
+    for (uint8_t slot = 0; slot < slots_; ++slot)
+    {
+        dealloc_(frames_[slot].data);
+        frames_[slot] = JpegFrame();
+    }
+    slots_ = 0;
+    return true;
+}
+
+uint32_t JpegBufferPool::largest() const
+{
+    return stats_.classes ? stats_.cls[stats_.classes - 1].size : 0;
+}
+
+JpegFrame *JpegBufferPool::take(size_t expected)
+{
+    // Smallest free buffer that fits, else the largest free one
+    int8_t fit = -1, biggest = -1;
+    for (uint8_t slot = 0; slot < slots_; ++slot)
+    {
+        if (busy_[slot])
+            continue;
+        const uint32_t capacity = frames_[slot].capacity;
+        if (capacity >= expected && (fit < 0 || capacity < frames_[fit].capacity))
+            fit = slot;
+        if (biggest < 0 || capacity > frames_[biggest].capacity)
+            biggest = slot;
+    }
+
+    // The class that should have served it
+    uint8_t wanted = 0;
+    while (wanted + 1 < stats_.classes && stats_.cls[wanted].size < expected)
+        wanted++;
+
+    const int8_t slot = fit >= 0 ? fit : biggest;
+    if (slot < 0 || class_of_[slot] != wanted)
+        stats_.cls[wanted].exhausted++;
+    if (slot < 0)
+    {
+        stats_.exhausted++;
+        return nullptr;
+    }
+
+    busy_[slot] = true;
+    ClassStats &cls = stats_.cls[class_of_[slot]];
+    cls.takes++;
+    if (++cls.in_use > cls.high_water)
+        cls.high_water = cls.in_use;
+    stats_.takes++;
+    if (++stats_.in_use > stats_.high_water)
+        stats_.high_water = stats_.in_use;
+
+    JpegFrame &frame = frames_[slot];
+    uint8_t *data = frame.data;
+    const uint32_t capacity = frame.capacity;
+    frame = JpegFrame();
+    frame.data = data;
+    frame.capacity = capacity;
+    return &frame;
+}
+
+void JpegBufferPool::give(JpegFrame *frame)
+{
+    if (!owns(frame))
+        return;
+    const uint8_t slot = static_cast<uint8_t>(frame - frames_);
+    if (!busy_[slot])
+        return;
+    busy_[slot] = false;
+    stats_.cls[class_of_[slot]].in_use--;
+    stats_.in_use--;
+}
+
+bool JpegBufferPool::owns(const JpegFrame *frame) const
+{
+    return frame >= frames_ && frame < frames_ + slots_;
+}
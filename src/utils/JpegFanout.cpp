@@ -0,0 +1,81 @@
+/**
+ * JpegFanout implementation
+ */
+#include "JpegFanout.h"
+
+void JpegFanout::subscribe()
+{
+    if (stats_.subscribers < 0xFF)
+        stats_.subscribers++;
+}
+
+void JpegFanout::unsubscribe()
+{
+    if (stats_.subscribers)
+        stats_.subscribers--;
+}
+
+JpegFrame *JpegFanout::unref(JpegFrame *frame)
+{
+    if (!frame || frame->refs == 0 || --frame->refs != 0)
+        return nullptr;
+    if (stats_.live)
+        stats_.live--;
+    return frame;
+}
+
+JpegFrame *JpegFanout::publish(JpegFrame *frame)
+{
+    frame->seq = next_seq_++;
+    if (next_seq_ == 0)
+        next_seq_ = 1; // 0 means "no frame yet" to acquire()
+    frame->refs = 1;
+    frame->acquired = false;
+    stats_.live++;
+
+    stats_.encoded++;
+    encode_us_sum_ += frame->encode_us;
+    if (stats_.encoded == 1 || frame->encode_us < stats_.encode_us_min)
+        stats_.encode_us_min = frame->encode_us;
+    if (frame->encode_us > stats_.encode_us_max)
+        stats_.encode_us_max = frame->encode_us;
+    stats_.encode_us_last = frame->encode_us;
+    stats_.encode_us_avg = static_cast<uint32_t>(encode_us_sum_ / stats_.encoded);
+    stats_.last_size = static_cast<uint32_t>(frame->len);
+    stats_.copied_bytes += frame->copied;
+
+    JpegFrame *previous = latest_;
+    latest_ = frame;
+    if (previous && !previous->acquired)
+        stats_.superseded++;
+    return unref(previous);
+}
+
+JpegFrame *JpegFanout::acquire(uint32_t after_seq)
+{
+    if (!latest_ || latest_->seq == after_seq)
+        return nullptr;
+    latest_->refs++;
+    latest_->acquired = true;
+    return latest_;
+}
+
+JpegFrame *JpegFanout::release(JpegFrame *frame)
+{
+    return unref(frame);
+}
+
+void JpegFanout::delivered(uint32_t previous_seq, uint32_t seq, size_t copied)
+{
+    stats_.delivered++;
+    stats_.copied_bytes += copied;
+    if (previous_seq && seq - previous_seq > 1)
+        stats_.skipped += seq - previous_seq - 1;
+}
+
+JpegFrame *JpegFanout::clear()
+{
+    JpegFrame *previous = latest_;
+    latest_ = nullptr;
+    return unref(previous);
+}
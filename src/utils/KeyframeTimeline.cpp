@@ -0,0 +1,164 @@
+/**
+ * KeyframeTimeline implementation
+ */
+#include "KeyframeTimeline.h"
+#include <string.h>
+
+namespace
+{
+    constexpr int32_t SERVO_VALUE_LIMIT = 180; ///< Wide enough for ±135° and ±100 % speed
+    constexpr int32_t MOTOR_VALUE_LIMIT = 100;
+    constexpr uint8_t SERVO_CHANNELS = 8;
+    constexpr uint8_t MOTOR_CHANNELS = 4;
+}
+
+void KeyframeTimeline::clear()
+{
+    tracks_.clear();
+    duration_ms_ = 0;
+    id_ = 0;
+    loop_ = false;
+    interpolation_ = Interpolation::LINEAR;
+}
+
+bool KeyframeTimeline::parse(JsonVariantConst root, std::string &error)
+{
+    if (!root["id"].is<int>() || root["id"].as<int>() < 0 || root["id"].as<int>() > 255)
+    {
+        error = "id must be 0-255";
+        return false;
+    }
+    JsonArrayConst tracks = root["tracks"].as<JsonArrayConst>();
+    if (tracks.isNull() || tracks.size() == 0 || tracks.size() > MAX_TRACKS)
+    {
+        error = "tracks must hold 1-12 entries";
+        return false;
+    }
+    const char *interpolation = root["interpolation"] | "linear";
+    if (strcmp(interpolation, "linear") != 0 && strcmp(interpolation, "cubic") != 0)
+    {
+        error = "interpolation must be linear or cubic";
+        return false;
+    }
+
+    std::vector<Track> parsed;
+    parsed.reserve(tracks.size());
+    uint32_t duration_ms = 0;
+    uint16_t used_channels = 0; // bits 0-7 servos, 8-11 motors
+    for (JsonObjectConst entry : tracks)
+    {
+        Track track;
+        int32_t limit;
+        if (entry["servo"].is<int>())
+        {
+            const int channel = entry["servo"].as<int>();
+            if (channel < 0 || channel >= SERVO_CHANNELS)
+            {
+                error = "servo channel must be 0-7";
+                return false;
+            }
+            track.target = Target::SERVO;
+            track.channel = static_cast<uint8_t>(channel);
+            limit = SERVO_VALUE_LIMIT;
+        }
+        else if (entry["motor"].is<int>())
+        {
+            const int motor = entry["motor"].as<int>();
+            if (motor < 1 || motor > MOTOR_CHANNELS)
+            {
+                error = "motor must be 1-4";
+                return false;
+            }
+            track.target = Target::MOTOR;
+            track.channel = static_cast<uint8_t>(motor - 1);
+            limit = MOTOR_VALUE_LIMIT;
+        }
+        else
+        {
+            error = "track needs a servo or motor field";
+            return false;
+        }
+
+        const uint16_t channel_bit = 1u << (track.target == Target::SERVO ? track.channel : SERVO_CHANNELS + track.channel);
+        if (used_channels & channel_bit)
+        {
+            error = "channel used by two tracks";
+            return false;
+        }
+        used_channels |= channel_bit;
+
+        JsonArrayConst keys = entry["keys"].as<JsonArrayConst>();
+        if (keys.isNull() || keys.size() == 0 || keys.size() > MAX_KEYFRAMES)
+        {
+            error = "keys must hold 1-256 entries";
+            return false;
+        }
+        track.keys.reserve(keys.size());
+        for (JsonArrayConst key : keys)
+        {
+            if (key.size() != 2 || !key[0].is<uint32_t>() || !key[1].is<float>())
+            {
+                error = "key must be [time_ms, value]";
+                return false;
+            }
+            const uint32_t time_ms = key[0].as<uint32_t>();
+            const float value = key[1].as<float>();
+            if (value < -limit || value > limit)
+            {
+                error = "key value out of range";
+                return false;
+            }
+            if (!track.keys.empty() && time_ms <= track.keys.back().time_ms)
+            {
+                error = "key times must increase";
+                return false;
+            }
+            track.keys.push_back({time_ms, static_cast<int32_t>(value * 1000.0f)});
+        }
+        if (track.keys.back().time_ms > duration_ms)
+            duration_ms = track.keys.back().time_ms;
+        parsed.push_back(std::move(track));
+    }
+
+    tracks_ = std::move(parsed);
+    duration_ms_ = duration_ms;
+    id_ = static_cast<uint8_t>(root["id"].as<int>());
+    loop_ = root["loop"] | false;
+    interpolation_ = strcmp(interpolation, "cubic") == 0 ? Interpolation::CUBIC : Interpolation::LINEAR;
+    return true;
+}
+
+int32_t KeyframeTimeline::sample(const Track &track, uint32_t time_ms) const
+{
+    const std::vector<Keyframe> &keys = track.keys;
+    if (time_ms <= keys.front().time_ms)
+        return keys.front().value;
+    if (time_ms >= keys.back().time_ms)
+        return keys.back().value;
+
+    // Segment [i, i+1] containing time_ms (tracks are short: linear scan)
+    size_t i = 0;
+    while (keys[i + 1].time_ms <= time_ms)
+        ++i;
+    const Keyframe &k1 = keys[i];
+    const Keyframe &k2 = keys[i + 1];
+    const int64_t span = static_cast<int64_t>(k2.time_ms) - k1.time_ms;
+    const int64_t u = (static_cast<int64_t>(time_ms - k1.time_ms) << 16) / span; // Q16, 0..1
+
+    if (interpolation_ == Interpolation::LINEAR)
+        return k1.value + static_cast<int32_t>(((static_cast<int64_t>(k2.value) - k1.value) * u) >> 16);
+
+    // Cubic Hermite with Catmull-Rom tangents scaled to the segment length
+    const Keyframe &k0 = i > 0 ? keys[i - 1] : k1;
+    const Keyframe &k3 = i + 2 < keys.size() ? keys[i + 2] : k2;
+    const int64_t t1 = k2.time_ms > k0.time_ms ? (static_cast<int64_t>(k2.value) - k0.value) * span / (static_cast<int64_t>(k2.time_ms) - k0.time_ms) : 0;
+    const int64_t t2 = k3.time_ms > k1.time_ms ? (static_cast<int64_t>(k3.value) - k1.value) * span / (static_cast<int64_t>(k3.time_ms) - k1.time_ms) : 0;
+
+    const int64_t u2 = (u * u) >> 16;
+    const int64_t u3 = (u2 * u) >> 16;
+    const int64_t h00 = 2 * u3 - 3 * u2 + 65536;
+    const int64_t h10 = u3 - 2 * u2 + u;
+    const int64_t h01 = -2 * u3 + 3 * u2;
+    const int64_t h11 = u3 - u2;
+    return static_cast<int32_t>((h00 * k1.value + h10 * t1 + h01 * k2.value + h11 * t2) >> 16);
+}
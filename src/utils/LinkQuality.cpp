@@ -0,0 +1,181 @@
+/**
+ * LinkConfig / LinkQuality implementation
+ */
+#include "LinkQuality.h"
+#include <stdio.h>
+
+std::string LinkConfig::toString() const
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%u:%u:%u:%u", derate ? 1u : 0u, near_timeout_pct, derate_below, min_scale);
+    return text;
+}
+
+bool LinkConfig::fromString(const char *text)
+{
+    unsigned on = 0, pct = 0, below = 0, scale = 0;
+    if (!text || sscanf(text, "%u:%u:%u:%u", &on, &pct, &below, &scale) != 4)
+        return false;
+    if (pct > 0xFF || below > 0xFFFF || scale > 0xFFFF)
+        return false;
+    LinkConfig parsed;
+    parsed.derate = on != 0;
+    parsed.near_timeout_pct = static_cast<uint8_t>(pct);
+    parsed.derate_below = static_cast<uint16_t>(below);
+    parsed.min_scale = static_cast<uint16_t>(scale);
+    std::string error;
+    if (!parsed.validate(error))
+        return false;
+    *this = parsed;
+    return true;
+}
+
+bool LinkConfig::validate(std::string &error) const
+{
+    if (near_timeout_pct < 10 || near_timeout_pct > 99)
+    {
+        error = "near_timeout_pct must be 10-99";
+        return false;
+    }
+    if (derate_below < 1 || derate_below > LinkQuality::FULL_SCALE)
+    {
+        error = "derate_below must be 1-1000";
+        return false;
+    }
+    if (min_scale > LinkQuality::FULL_SCALE)
+    {
+        error = "min_scale must be 0-1000";
+        return false;
+    }
+    return true;
+}
+
+uint16_t LinkQuality::Stats::lossPermille() const
+{
+    const uint64_t sent = static_cast<uint64_t>(heartbeats) + lost;
+    return sent ? static_cast<uint16_t>((static_cast<uint64_t>(lost) * FULL_SCALE) / sent) : 0;
+}
+
+void LinkQuality::reset()
+{
+    stats_ = Stats();
+    last_us_ = 0;
+    gap_sum_us_ = 0;
+    rtt_sum_us_ = 0;
+    gaps_ = 0;
+    prev_gap_us_ = 0;
+    jitter_q4_ = 0;
+    quality_q8_ = static_cast<uint32_t>(FULL_SCALE) << 8;
+    last_seq_ = 0;
+    has_last_ = false;
+    has_seq_ = false;
+}
+
+void LinkQuality::sample(uint32_t value)
+{
+    // q += (value - q) / 8, in 1/256 so that it settles on the sample
+    const int32_t delta = static_cast<int32_t>(value << 8) - static_cast<int32_t>(quality_q8_);
+    quality_q8_ = static_cast<uint32_t>(static_cast<int32_t>(quality_q8_) + delta / 8);
+    stats_.quality = static_cast<uint16_t>((quality_q8_ + 128) >> 8);
+}
+
+void LinkQuality::onHeartbeat(uint64_t now_us, bool has_seq, uint16_t seq)
+{
+    if (has_seq && has_seq_)
+    {
+        uint16_t delta = static_cast<uint16_t>(seq - last_seq_);
+        if (delta == 0)
+        {
+            stats_.duplicates++;
+            return;
+        }
+        if (delta >= static_cast<uint16_t>(-REORDER_WINDOW))
+        {
+            // A late heartbeat fills a gap already counted as lost
+            stats_.reordered++;
+            if (stats_.lost)
+                stats_.lost--;
+            return;
+        }
+        if (delta > MAX_LOSS_RUN)
+            delta = 1; // the master restarted its counter: resynchronise
+        stats_.lost += delta - 1u;
+        // Each loss is a 0 sample; 48 of them already take the quality below 2
+        for (uint16_t missing = 1; missing < delta && missing <= 48; ++missing)
+            sample(0);
+    }
+    if (has_seq)
+    {
+        last_seq_ = seq;
+        has_seq_ = true;
+    }
+    stats_.heartbeats++;
+
+    if (has_last_)
+    {
+        const uint64_t elapsed = now_us > last_us_ ? now_us - last_us_ : 0;
+        const uint32_t gap = elapsed > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(elapsed);
+        gaps_++;
+        gap_sum_us_ += gap;
+        if (gaps_ == 1 || gap < stats_.gap_min_us)
+            stats_.gap_min_us = gap;
+        if (gap > stats_.gap_max_us)
+            stats_.gap_max_us = gap;
+        stats_.gap_avg_us = static_cast<uint32_t>(gap_sum_us_ / gaps_);
+        const uint32_t bucket = gap / HIST_WIDTH_US;
+        stats_.hist[bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1]++;
+
+        if (gaps_ > 1)
+        {
+            // RFC 3550: J += (|D| - J) / 16
+            uint32_t d = gap > prev_gap_us_ ? gap - prev_gap_us_ : prev_gap_us_ - gap;
+            if (d > 0x00FFFFFFu)
+                d = 0x00FFFFFFu; // keeps jitter * 16 within 32 bits
+            jitter_q4_ += d - ((jitter_q4_ + 8) >> 4);
+            stats_.jitter_us = jitter_q4_ >> 4;
+        }
+        prev_gap_us_ = gap;
+
+        // A gap past the timeout was already counted by onTimeout()
+        if (gap < timeout_us_ &&
+            static_cast<uint64_t>(gap) * 100 >= static_cast<uint64_t>(timeout_us_) * config_.near_timeout_pct)
+            stats_.near_timeouts++;
+
+        const uint32_t half = timeout_us_ / 2;
+        if (gap <= half)
+            sample(FULL_SCALE);
+        else if (gap >= timeout_us_)
+            sample(0);
+        else
+            sample(static_cast<uint32_t>((static_cast<uint64_t>(timeout_us_ - gap) * FULL_SCALE) / (timeout_us_ - half)));
+    }
+    last_us_ = now_us;
+    has_last_ = true;
+}
+
+void LinkQuality::onPing(uint32_t rtt_us)
+{
+    stats_.rtt_reports++;
+    rtt_sum_us_ += rtt_us;
+    if (stats_.rtt_reports == 1 || rtt_us < stats_.rtt_min_us)
+        stats_.rtt_min_us = rtt_us;
+    if (rtt_us > stats_.rtt_max_us)
+        stats_.rtt_max_us = rtt_us;
+    stats_.rtt_last_us = rtt_us;
+    stats_.rtt_avg_us = static_cast<uint32_t>(rtt_sum_us_ / stats_.rtt_reports);
+}
+
+void LinkQuality::onTimeout()
+{
+    stats_.timeouts++;
+    quality_q8_ = 0;
+    stats_.quality = 0;
+}
+
+uint16_t LinkQuality::speedScale() const
+{
+    if (!config_.derate || stats_.quality >= config_.derate_below)
+        return FULL_SCALE;
+    return static_cast<uint16_t>(config_.min_scale +
+                                 (static_cast<uint32_t>(FULL_SCALE - config_.min_scale) * stats_.quality) / config_.derate_below);
+}
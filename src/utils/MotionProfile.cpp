@@ -0,0 +1,159 @@
+/**
+ * MotionProfile implementation
+ */
+#include "MotionProfile.h"
+
+namespace
+{
+    constexpr int64_t US_PER_S = 1000000;
+    constexpr uint64_t BRAKE_OFFSET_MAX = 1000000000ULL; ///< Clamp of a²/2j so its square fits in 64 bits
+
+    uint64_t isqrt64(uint64_t value)
+    {
+        uint64_t root = 0;
+        uint64_t bit = 1ULL << 62;
+        while (bit > value)
+            bit >>= 2;
+        while (bit != 0)
+        {
+            if (value >= root + bit)
+            {
+                value -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else
+            {
+                root >>= 1;
+            }
+            bit >>= 2;
+        }
+        return root;
+    }
+
+    inline int64_t clamp64(int64_t value, int64_t limit)
+    {
+        return value > limit ? limit : (value < -limit ? -limit : value);
+    }
+
+    inline int64_t abs64(int64_t value)
+    {
+        return value < 0 ? -value : value;
+    }
+}
+
+void MotionProfile::setLimits(uint16_t max_velocity, uint16_t max_acceleration, uint16_t max_jerk)
+{
+    max_velocity_ = static_cast<int32_t>(max_velocity) * 1000;
+    max_acceleration_ = static_cast<int32_t>(max_acceleration) * 1000;
+    max_jerk_ = static_cast<int32_t>(max_jerk) * 1000;
+}
+
+void MotionProfile::reset(int32_t position_mdeg)
+{
+    position_ = position_mdeg;
+    target_ = position_mdeg;
+    velocity_ = 0;
+    acceleration_ = 0;
+    position_rem_ = 0;
+    velocity_rem_ = 0;
+    moving_ = false;
+    has_position_ = true;
+}
+
+void MotionProfile::setTarget(int32_t target_mdeg)
+{
+    if (!has_position_)
+    {
+        // Nothing known about where the servo is: the first move is a jump
+        reset(target_mdeg);
+        return;
+    }
+    target_ = target_mdeg;
+    moving_ = (target_ != position_) || (velocity_ != 0);
+}
+
+void MotionProfile::settle()
+{
+    position_ = target_;
+    velocity_ = 0;
+    acceleration_ = 0;
+    position_rem_ = 0;
+    velocity_rem_ = 0;
+    moving_ = false;
+}
+
+bool MotionProfile::step(uint32_t dt_us)
+{
+    if (!moving_ || dt_us == 0)
+        return false;
+    if (!isEnabled())
+    {
+        settle();
+        return true;
+    }
+
+    const int64_t dt = dt_us;
+    const int64_t error = static_cast<int64_t>(target_) - position_;
+    const uint64_t accel = static_cast<uint64_t>(max_acceleration_);
+    const uint64_t brake_term = 2 * accel * static_cast<uint64_t>(abs64(error));
+
+    // Fastest speed from which the remaining distance still allows a stop
+    uint64_t stop_velocity;
+    if (max_jerk_ == 0)
+    {
+        stop_velocity = isqrt64(brake_term);
+    }
+    else
+    {
+        // Jerk-limited braking covers about v²/2a + v·a/2j; solve that for v
+        uint64_t offset = accel * accel / (2 * static_cast<uint64_t>(max_jerk_));
+        if (offset > BRAKE_OFFSET_MAX)
+            offset = BRAKE_OFFSET_MAX;
+        stop_velocity = brake_term ? brake_term / (isqrt64(offset * offset + brake_term) + offset) : 0;
+    }
+    if (stop_velocity > static_cast<uint64_t>(max_velocity_))
+        stop_velocity = max_velocity_;
+    const int64_t desired_velocity = error >= 0 ? static_cast<int64_t>(stop_velocity) : -static_cast<int64_t>(stop_velocity);
+
+    if (max_jerk_ == 0)
+    {
+        int64_t dv_max = max_acceleration_ * dt / US_PER_S;
+        if (dv_max < 1)
+            dv_max = 1;
+        velocity_ += static_cast<int32_t>(clamp64(desired_velocity - velocity_, dv_max));
+    }
+    else
+    {
+        // Pick the acceleration that can ramp back to zero exactly when the desired velocity is met
+        const int64_t dv = desired_velocity - velocity_;
+        int64_t desired_accel = static_cast<int64_t>(isqrt64(2 * static_cast<uint64_t>(max_jerk_) * static_cast<uint64_t>(abs64(dv))));
+        if (desired_accel > max_acceleration_)
+            desired_accel = max_acceleration_;
+        if (dv < 0)
+            desired_accel = -desired_accel;
+
+        int64_t da_max = max_jerk_ * dt / US_PER_S;
+        if (da_max < 1)
+            da_max = 1;
+        acceleration_ += static_cast<int32_t>(clamp64(desired_accel - acceleration_, da_max));
+
+        const int64_t dv_step = acceleration_ * dt + velocity_rem_;
+        velocity_ += static_cast<int32_t>(dv_step / US_PER_S);
+        velocity_rem_ = dv_step % US_PER_S;
+        velocity_ = static_cast<int32_t>(clamp64(velocity_, max_velocity_));
+    }
+
+    const int64_t travel = static_cast<int64_t>(velocity_) * dt + position_rem_;
+    position_ += static_cast<int32_t>(travel / US_PER_S);
+    position_rem_ = travel % US_PER_S;
+
+    const int64_t remaining = static_cast<int64_t>(target_) - position_;
+    const bool crossed = (error > 0 && remaining <= 0) || (error < 0 && remaining >= 0);
+    const bool settled = abs64(remaining) <= SETTLE_MDEG && abs64(velocity_) * dt / US_PER_S <= SETTLE_MDEG;
+    if (crossed || settled)
+    {
+        settle();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,132 @@
+/**
+ * ReflexConfig / ObstacleReflex implementation
+ */
+#include "ObstacleReflex.h"
+#include <stdio.h>
+
+std::string ReflexConfig::toString() const
+{
+    char text[56];
+    snprintf(text, sizeof(text), "%u:%u:%u:%u:%u:%u:%u", enabled ? 1u : 0u, port, stop_distance,
+             speed_margin, hysteresis, max_age_ms, ir_scale);
+    return text;
+}
+
+bool ReflexConfig::fromString(const char *text)
+{
+    unsigned on = 0, sensor_port = 0, stop = 0, margin = 0, hyst = 0, age = 0, scale = 0;
+    if (!text || sscanf(text, "%u:%u:%u:%u:%u:%u:%u", &on, &sensor_port, &stop, &margin, &hyst, &age, &scale) != 7)
+        return false;
+    if (stop > 0xFFFF || margin > 0xFFFF || hyst > 0xFFFF || age > 0xFFFF || scale > 0xFFFF)
+        return false;
+    ReflexConfig parsed;
+    parsed.enabled = on != 0;
+    parsed.port = static_cast<uint8_t>(sensor_port);
+    parsed.stop_distance = static_cast<uint16_t>(stop);
+    parsed.speed_margin = static_cast<uint16_t>(margin);
+    parsed.hysteresis = static_cast<uint16_t>(hyst);
+    parsed.max_age_ms = static_cast<uint16_t>(age);
+    parsed.ir_scale = static_cast<uint16_t>(scale);
+    std::string error;
+    if (!parsed.validate(error))
+        return false;
+    *this = parsed;
+    return true;
+}
+
+bool ReflexConfig::validate(std::string &error) const
+{
+    if (port > 6)
+    {
+        error = "port must be 0-5 (analog IR) or 6 (SR04)";
+        return false;
+    }
+    if (stop_distance > 400 || speed_margin > 400 || hysteresis > 100)
+    {
+        error = "stop_distance and speed_margin must be 0-400 cm, hysteresis 0-100 cm";
+        return false;
+    }
+    if (max_age_ms < 20)
+    {
+        error = "max_age_ms must be at least 20";
+        return false;
+    }
+    if (port < 6 && ir_scale == 0)
+    {
+        error = "ir_scale must be set for an analog IR port";
+        return false;
+    }
+    return true;
+}
+
+int32_t ObstacleReflex::forwardCap(const ReflexConfig &config, int32_t range_cm)
+{
+    if (range_cm <= config.stop_distance)
+        return 0;
+    if (config.speed_margin == 0)
+        return FULL_SCALE;
+    const int32_t clearance = range_cm - config.stop_distance;
+    if (clearance >= config.speed_margin)
+        return FULL_SCALE;
+    return clearance * FULL_SCALE / config.speed_margin;
+}
+
+int32_t ObstacleReflex::irRange(uint16_t adc, uint16_t ir_scale)
+{
+    // Nothing is resolved beyond 400 cm: treat weaker readings as an empty path
+    if (adc == 0 || adc < ir_scale / 400)
+        return OUT_OF_RANGE;
+    return ir_scale / adc;
+}
+
+const char *ObstacleReflex::stateName(State state)
+{
+    switch (state)
+    {
+    case State::LIMITING:
+        return "limiting";
+    case State::BLOCKED:
+        return "blocked";
+    case State::NO_SENSOR:
+        return "no_sensor";
+    default:
+        return "clear";
+    }
+}
+
+void ObstacleReflex::configure(const ReflexConfig &config)
+{
+    config_ = config;
+    state_ = State::CLEAR;
+    cap_ = FULL_SCALE;
+}
+
+bool ObstacleReflex::update(int32_t range_cm, int32_t forward_request)
+{
+    State next;
+    if (!config_.enabled)
+    {
+        cap_ = FULL_SCALE;
+        next = State::CLEAR;
+    }
+    else if (range_cm == NO_RANGE)
+    {
+        cap_ = 0;
+        next = State::NO_SENSOR;
+    }
+    else
+    {
+        // While intervening, lifting the cap needs hysteresis cm more room
+        const bool intervening = state_ != State::CLEAR;
+        cap_ = forwardCap(config_, intervening ? range_cm - config_.hysteresis : range_cm);
+        if (cap_ == 0)
+            next = State::BLOCKED;
+        else if (forward_request > cap_)
+            next = State::LIMITING;
+        else
+            next = State::CLEAR;
+    }
+    const bool changed = next != state_;
+    state_ = next;
+    return changed;
+}
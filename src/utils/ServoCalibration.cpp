@@ -0,0 +1,138 @@
+/**
+ * ServoCalibration / ServoPulseTable implementation
+ */
+#include "ServoCalibration.h"
+#include "DFR1216/DFR1216.h"
+#include <stdio.h>
+
+std::string ServoCalibration::toString() const
+{
+    char text[40];
+    snprintf(text, sizeof(text), "%u:%u:%d:%u:%u", min_us, max_us, trim_us, deadband_us, expo);
+    return text;
+}
+
+bool ServoCalibration::fromString(const char *text)
+{
+    unsigned min = 0, max = 0, deadband = 0, curve = 0;
+    int trim = 0;
+    if (!text || sscanf(text, "%u:%u:%d:%u:%u", &min, &max, &trim, &deadband, &curve) != 5)
+        return false;
+    min_us = static_cast<uint16_t>(min);
+    max_us = static_cast<uint16_t>(max);
+    trim_us = static_cast<int16_t>(trim);
+    deadband_us = static_cast<uint16_t>(deadband);
+    expo = static_cast<uint8_t>(curve);
+    return true;
+}
+
+ServoCalibration ServoPulseTable::effective(Model model, const ServoCalibration &calibration)
+{
+    ServoCalibration result = calibration;
+    uint16_t default_min = SERVO180_MIN_US;
+    uint16_t default_max = SERVO180_MAX_US;
+    if (model == Model::ANGULAR_270)
+    {
+        default_min = SERVO270_MIN_US;
+        default_max = SERVO270_MAX_US;
+    }
+    else if (model == Model::CONTINUOUS)
+    {
+        default_min = SERVO360_FORWARD_MIN_US;
+        default_max = SERVO360_BACKWARD_MAX_US;
+    }
+    if (result.min_us == 0)
+        result.min_us = default_min;
+    if (result.max_us == 0)
+        result.max_us = default_max;
+    return result;
+}
+
+bool ServoPulseTable::validate(Model model, const ServoCalibration &calibration, std::string &error)
+{
+    const ServoCalibration cal = effective(model, calibration);
+    if (cal.min_us < PULSE_MIN_US || cal.max_us > PULSE_MAX_US || cal.min_us >= cal.max_us)
+    {
+        error = "endpoints must satisfy 400 <= min_us < max_us <= 3500";
+        return false;
+    }
+    if (cal.trim_us < -TRIM_MAX_US || cal.trim_us > TRIM_MAX_US)
+    {
+        error = "trim_us must be within +/-300";
+        return false;
+    }
+    if (cal.expo > 100)
+    {
+        error = "expo must be 0-100";
+        return false;
+    }
+    const int32_t centre = model == Model::CONTINUOUS
+                               ? SERVO360_STOP_US + cal.trim_us
+                               : (cal.min_us + cal.max_us) / 2 + cal.trim_us;
+    if (centre - static_cast<int32_t>(cal.deadband_us) <= cal.min_us ||
+        centre + static_cast<int32_t>(cal.deadband_us) >= cal.max_us)
+    {
+        error = "centre (+/- deadband) must lie strictly between the endpoints";
+        return false;
+    }
+    return true;
+}
+
+void ServoPulseTable::compile(Model model, const ServoCalibration &calibration)
+{
+    model_ = model;
+    const ServoCalibration cal = effective(model, calibration);
+
+    if (model == Model::ANGULAR_180 || model == Model::ANGULAR_270)
+    {
+        half_travel_deg_ = model == Model::ANGULAR_270 ? 135 : 90;
+        const int32_t centre = (cal.min_us + cal.max_us) / 2 + cal.trim_us;
+        for (int32_t i = 0; i <= 2 * half_travel_deg_; ++i)
+        {
+            const int32_t deg = i - half_travel_deg_;
+            const int32_t pulse = deg < 0
+                                      ? centre + deg * (centre - cal.min_us) / half_travel_deg_
+                                      : centre + deg * (cal.max_us - centre) / half_travel_deg_;
+            table_[i] = static_cast<uint16_t>(pulse);
+        }
+        return;
+    }
+
+    half_travel_deg_ = 0;
+    const int32_t stop = SERVO360_STOP_US + cal.trim_us;
+    table_[100] = static_cast<uint16_t>(stop);
+    for (int32_t speed = 1; speed <= 100; ++speed)
+    {
+        if (model != Model::CONTINUOUS)
+        {
+            table_[100 + speed] = table_[100 - speed] = static_cast<uint16_t>(stop);
+            continue;
+        }
+        // expo curve in 1/1000 000: (1 - e)·x + e·x³ with x = speed / 100
+        const int64_t linear = static_cast<int64_t>(speed) * 10000;
+        const int64_t cubic = static_cast<int64_t>(speed) * speed * speed;
+        const int64_t shaped = ((100 - cal.expo) * linear + cal.expo * cubic) / 100; // 0..1 000 000
+        const int32_t forward_span = stop - cal.deadband_us - cal.min_us;
+        const int32_t backward_span = cal.max_us - stop - static_cast<int32_t>(cal.deadband_us);
+        table_[100 + speed] = static_cast<uint16_t>(stop - cal.deadband_us - forward_span * shaped / 1000000);
+        table_[100 - speed] = static_cast<uint16_t>(stop + cal.deadband_us + backward_span * shaped / 1000000);
+    }
+}
+
+uint16_t ServoPulseTable::anglePulse(int32_t angle_mdeg) const
+{
+    if (half_travel_deg_ == 0)
+        return table_[100];
+    const int32_t limit = half_travel_deg_ * 1000;
+    if (angle_mdeg < -limit)
+        angle_mdeg = -limit;
+    else if (angle_mdeg > limit)
+        angle_mdeg = limit;
+    const int32_t offset = angle_mdeg + limit;
+    const int32_t index = offset / 1000;
+    const int32_t fraction = offset % 1000;
+    if (fraction == 0)
+        return table_[index];
+    const int32_t low = table_[index];
+    return static_cast<uint16_t>(low + (static_cast<int32_t>(table_[index + 1]) - low) * fraction / 1000);
+}
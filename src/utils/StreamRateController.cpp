@@ -0,0 +1,269 @@
+/**
+ * StreamRateConfig / StreamRateController implementation
+ */
+#include "StreamRateController.h"
+#include <stdio.h>
+
+std::string StreamRateConfig::toString() const
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%u:%u:%u:%u:%u:%u", enabled ? 1u : 0u, target_ms,
+             quality_min, quality_max, max_skip, max_downsize);
+    return text;
+}
+
+bool StreamRateConfig::fromString(const char *text)
+{
+    unsigned on = 0, target = 0, qmin = 0, qmax = 0, skip = 0, down = 0;
+    if (!text || sscanf(text, "%u:%u:%u:%u:%u:%u", &on, &target, &qmin, &qmax, &skip, &down) != 6)
+        return false;
+    if (target > 0xFFFF || qmin > 0xFF || qmax > 0xFF || skip > 0xFF || down > 0xFF)
+        return false;
+    StreamRateConfig parsed;
+    parsed.enabled = on != 0;
+    parsed.target_ms = static_cast<uint16_t>(target);
+    parsed.quality_min = static_cast<uint8_t>(qmin);
+    parsed.quality_max = static_cast<uint8_t>(qmax);
+    parsed.max_skip = static_cast<uint8_t>(skip);
+    parsed.max_downsize = static_cast<uint8_t>(down);
+    std::string error;
+    if (!parsed.validate(error))
+        return false;
+    *this = parsed;
+    return true;
+}
+
+bool StreamRateConfig::validate(std::string &error) const
+{
+    if (target_ms < 50 || target_ms > 10000)
+    {
+        error = "target_ms must be 50-10000";
+        return false;
+    }
+    if (quality_min < 1 || quality_max > 100 || quality_min > quality_max)
+    {
+        error = "quality must be 1 <= quality_min <= quality_max <= 100";
+        return false;
+    }
+    if (max_skip > 10)
+    {
+        error = "max_skip must be 0-10";
+        return false;
+    }
+    if (max_downsize > 4)
+    {
+        error = "max_downsize must be 0-4";
+        return false;
+    }
+    return true;
+}
+
+const char *StreamRateController::actionName(Action action)
+{
+    switch (action)
+    {
+    case QUALITY_DOWN:
+        return "quality_down";
+    case SKIP_UP:
+        return "skip_up";
+    case SIZE_DOWN:
+        return "size_down";
+    case SIZE_UP:
+        return "size_up";
+    case SKIP_DOWN:
+        return "skip_down";
+    case QUALITY_UP:
+        return "quality_up";
+    default:
+        return "hold";
+    }
+}
+
+void StreamRateController::configure(const StreamRateConfig &config)
+{
+    config_ = config;
+    if (!config_.enabled)
+    {
+        reset();
+        return;
+    }
+    if (state_.quality > config_.quality_max)
+        state_.quality = config_.quality_max;
+    if (state_.quality < config_.quality_min)
+        state_.quality = config_.quality_min;
+    if (state_.skip > config_.max_skip)
+        state_.skip = config_.max_skip;
+    if (state_.downsize > config_.max_downsize)
+        state_.downsize = config_.max_downsize;
+}
+
+void StreamRateController::reset()
+{
+    state_.quality = config_.quality_max;
+    state_.skip = 0;
+    state_.downsize = 0;
+    state_.last_action = HOLD;
+    skip_count_ = 0;
+    calm_ = 0;
+    floor_ = 0;
+    latency_sum_us_ = 0;
+    latency_max_us_ = 0;
+    encode_sum_us_ = 0;
+    delivered_ = 0;
+    encoded_ = 0;
+    started_ = false;
+}
+
+bool StreamRateController::shouldEncode()
+{
+    if (skip_count_ < state_.skip)
+    {
+        skip_count_++;
+        state_.rate_skipped++;
+        return false;
+    }
+    skip_count_ = 0;
+    return true;
+}
+
+void StreamRateController::onEncoded(uint32_t encode_us)
+{
+    if (encoded_ < 0xFFFF)
+    {
+        encoded_++;
+        encode_sum_us_ += encode_us;
+    }
+}
+
+void StreamRateController::onDelivered(uint32_t latency_us)
+{
+    if (delivered_ < 0xFFFF)
+    {
+        delivered_++;
+        latency_sum_us_ += latency_us;
+    }
+    if (latency_us > latency_max_us_)
+        latency_max_us_ = latency_us;
+}
+
+StreamRateController::Action StreamRateController::degrade(bool encode_bound)
+{
+    const bool at_floor = state_.quality <= config_.quality_min && state_.skip >= config_.max_skip;
+    if (!at_floor)
+        floor_ = 0;
+    else if (floor_ < 0xFF)
+        floor_++;
+
+    if (state_.downsize < config_.max_downsize && (encode_bound || floor_ >= DOWNSIZE_PERIODS))
+    {
+        state_.downsize++;
+        floor_ = 0;
+        return SIZE_DOWN;
+    }
+    if (encode_bound && config_.max_downsize == 0 && state_.skip < config_.max_skip)
+    {
+        // Cannot resize: spend less time encoding by encoding fewer frames
+        state_.skip++;
+        return SKIP_UP;
+    }
+    if (state_.quality > config_.quality_min)
+    {
+        const uint8_t step = state_.quality - config_.quality_min < QUALITY_STEP
+                                 ? state_.quality - config_.quality_min
+                                 : QUALITY_STEP;
+        state_.quality -= step;
+        return QUALITY_DOWN;
+    }
+    if (state_.skip < config_.max_skip)
+    {
+        state_.skip++;
+        return SKIP_UP;
+    }
+    return HOLD;
+}
+
+StreamRateController::Action StreamRateController::improve()
+{
+    if (state_.downsize)
+    {
+        state_.downsize--;
+        return SIZE_UP;
+    }
+    if (state_.skip)
+    {
+        state_.skip--;
+        return SKIP_DOWN;
+    }
+    if (state_.quality < config_.quality_max)
+    {
+        const uint8_t step = config_.quality_max - state_.quality < QUALITY_STEP
+                                 ? config_.quality_max - state_.quality
+                                 : QUALITY_STEP;
+        state_.quality += step;
+        return QUALITY_UP;
+    }
+    return HOLD;
+}
+
+bool StreamRateController::update(uint64_t now_us)
+{
+    if (!started_)
+    {
+        period_start_us_ = now_us;
+        started_ = true;
+        return false;
+    }
+    if (now_us - period_start_us_ < PERIOD_US)
+        return false;
+    period_start_us_ = now_us;
+
+    state_.periods++;
+    state_.delivered = delivered_;
+    state_.encoded = encoded_;
+    state_.latency_avg_ms = delivered_ ? static_cast<uint32_t>(latency_sum_us_ / delivered_ / 1000) : 0;
+    state_.latency_max_ms = latency_max_us_ / 1000;
+    state_.encode_avg_us = encoded_ ? static_cast<uint32_t>(encode_sum_us_ / encoded_) : 0;
+
+    const uint32_t target_us = static_cast<uint32_t>(config_.target_ms) * 1000;
+    const bool stuck = encoded_ && !delivered_;
+    const bool idle = !encoded_ && !delivered_;
+    const bool over = stuck || (delivered_ && latency_max_us_ > target_us);
+    const bool encode_bound = encoded_ && state_.encode_avg_us >= target_us;
+    const bool under = delivered_ && latency_max_us_ < target_us / 100 * LOW_WATER_PCT && !encode_bound;
+
+    latency_sum_us_ = 0;
+    latency_max_us_ = 0;
+    encode_sum_us_ = 0;
+    delivered_ = 0;
+    encoded_ = 0;
+
+    Action action = HOLD;
+    if (config_.enabled && !idle)
+    {
+        if (over || encode_bound)
+        {
+            calm_ = 0;
+            action = degrade(encode_bound);
+        }
+        else
+        {
+            floor_ = 0;
+            if (under && ++calm_ >= CALM_PERIODS)
+            {
+                calm_ = 0;
+                action = improve();
+            }
+            else if (!under)
+            {
+                calm_ = 0;
+            }
+        }
+    }
+
+    state_.last_action = action;
+    if (action == QUALITY_DOWN || action == SKIP_UP || action == SIZE_DOWN)
+        state_.decreases++;
+    else if (action != HOLD)
+        state_.increases++;
+    return action != HOLD;
+}
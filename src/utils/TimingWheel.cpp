@@ -0,0 +1,105 @@
+/**
+ * TimingWheel implementation
+ */
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel()
+{
+    for (uint16_t slot = 0; slot < SLOTS; ++slot)
+        heads_[slot] = NIL;
+}
+
+void TimingWheel::link(uint8_t id)
+{
+    Entry &entry = entries_[id];
+    uint8_t &head = heads_[entry.deadline & SLOT_MASK];
+    entry.prev = NIL;
+    entry.next = head;
+    if (head != NIL)
+        entries_[head].prev = id;
+    head = id;
+}
+
+void TimingWheel::unlink(uint8_t id)
+{
+    Entry &entry = entries_[id];
+    if (entry.prev != NIL)
+        entries_[entry.prev].next = entry.next;
+    else
+        heads_[entry.deadline & SLOT_MASK] = entry.next;
+    if (entry.next != NIL)
+        entries_[entry.next].prev = entry.prev;
+    entry.prev = NIL;
+    entry.next = NIL;
+}
+
+bool TimingWheel::arm(uint8_t id, uint32_t now_tick, uint32_t delay_ticks)
+{
+    if (id >= MAX_TIMERS)
+        return false;
+    if (delay_ticks == 0)
+        delay_ticks = 1;
+    else if (delay_ticks > MAX_DELAY_TICKS)
+        delay_ticks = MAX_DELAY_TICKS;
+
+    Entry &entry = entries_[id];
+    const bool rearm = entry.armed;
+    if (rearm)
+        unlink(id);
+    else
+        armed_count_++;
+    entry.deadline = now_tick + delay_ticks;
+    entry.armed = true;
+    link(id);
+    return rearm;
+}
+
+bool TimingWheel::cancel(uint8_t id)
+{
+    if (id >= MAX_TIMERS || !entries_[id].armed)
+        return false;
+    unlink(id);
+    entries_[id].armed = false;
+    armed_count_--;
+    return true;
+}
+
+uint32_t TimingWheel::advance(uint32_t now_tick)
+{
+    uint32_t steps = now_tick - last_tick_;
+    if (!started_)
+    {
+        started_ = true;
+        steps = SLOTS;
+    }
+    else if (static_cast<int32_t>(steps) <= 0)
+    {
+        return 0;
+    }
+    last_tick_ = now_tick;
+    if (armed_count_ == 0)
+        return 0;
+
+    // A late call covers several ticks; past one turn every slot is visited once
+    if (steps > SLOTS)
+        steps = SLOTS;
+    uint32_t expired = 0;
+    for (uint32_t step = steps; step > 0; --step)
+    {
+        uint8_t id = heads_[(now_tick - step + 1) & SLOT_MASK];
+        while (id != NIL)
+        {
+            Entry &entry = entries_[id];
+            const uint8_t next = entry.next;
+            if (static_cast<int32_t>(entry.deadline - now_tick) <= 0)
+            {
+                unlink(id);
+                entry.armed = false;
+                armed_count_--;
+                expired |= 1UL << id;
+            }
+            id = next;
+        }
+    }
+    return expired;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core (native tests only): what the actuator
+ *        drivers and the DFR1216 simulator use, nothing more.
+ * @details Time is simulated: micros() and millis() only move when delay(),
+ *          delayMicroseconds() or the test (native_clock_us) move them, so a run
+ *          is deterministic and the simulator's bus time is accounted without
+ *          waiting for it.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+inline std::atomic<uint32_t> native_clock_us{0}; ///< Simulated micros()
+
+inline uint32_t micros() { return native_clock_us.load(); }
+inline uint32_t millis() { return native_clock_us.load() / 1000; }
+inline void delayMicroseconds(uint32_t us) { native_clock_us.fetch_add(us); }
+inline void delay(uint32_t ms) { native_clock_us.fetch_add(ms * 1000); }
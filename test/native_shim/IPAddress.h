@@ -0,0 +1,47 @@
+/**
+ * @file IPAddress.h
+ * @brief Host stand-in for the Arduino IPv4 address (native tests only).
+ * @details Stored like the ESP32 core: the first octet in the low byte of the
+ *          32-bit value. toString() returns a std::string where the core returns
+ *          an Arduino String; both allocate and format on every call.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+class IPAddress
+{
+public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : __address(static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 |
+                    static_cast<uint32_t>(d) << 24)
+    {
+    }
+    explicit IPAddress(uint32_t address) : __address(address) {}
+
+    operator uint32_t() const { return __address; }
+    uint8_t operator[](int index) const { return static_cast<uint8_t>(__address >> (index * 8)); }
+
+    bool fromString(const char *text)
+    {
+        unsigned a, b, c, d;
+        char tail;
+        if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+            return false;
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+
+    std::string toString() const
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return text;
+    }
+
+private:
+    uint32_t __address = 0;
+};
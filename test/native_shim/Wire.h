@@ -0,0 +1,103 @@
+/**
+ * @file Wire.h
+ * @brief Host stand-in for the Arduino I2C driver (native tests only): a mock bus.
+ * @details Every address answers with a 256-byte register file: the first byte of
+ *          a write sets the register pointer, the following bytes land from there
+ *          (auto-increment), and reads return the file from the pointer on.
+ *          Transactions are counted and timed at 400 kHz (START, address byte,
+ *          9 clocks per byte, STOP), plus overheadUs per transaction for the
+ *          driver; the time is added to the simulated clock of Arduino.h.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Arduino.h"
+
+class TwoWire
+{
+public:
+    struct Stats
+    {
+        uint32_t transactions = 0; ///< Address phases: writes, and each read request
+        uint32_t bytes = 0;        ///< Bytes on the wire, address bytes included
+        uint64_t busyUs = 0;       ///< Modelled bus time, overhead included
+    };
+
+    uint8_t regs[128][256] = {}; ///< Register file per 7-bit address
+    uint16_t overheadUs = 0;     ///< Driver cost added to every transaction
+    Stats stats;
+
+    bool begin() { return true; }
+    void setClock(uint32_t) {}
+
+    void beginTransmission(uint8_t addr)
+    {
+        __addr = addr & 0x7F;
+        __txLen = 0;
+    }
+
+    size_t write(uint8_t value)
+    {
+        if (__txLen < sizeof(__tx))
+            __tx[__txLen++] = value;
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            write(data[i]);
+        return len;
+    }
+
+    uint8_t endTransmission(bool = true)
+    {
+        if (__txLen)
+            __pointer = __tx[0];
+        for (size_t i = 1; i < __txLen; i++)
+            regs[__addr][__pointer++] = __tx[i];
+        __account(__txLen);
+        return 0;
+    }
+
+    uint8_t requestFrom(uint8_t addr, uint8_t len)
+    {
+        __addr = addr & 0x7F;
+        __rxLeft = len;
+        __account(len);
+        return len;
+    }
+
+    int available() { return __rxLeft; }
+
+    int read()
+    {
+        if (!__rxLeft)
+            return -1;
+        __rxLeft--;
+        return regs[__addr][__pointer++];
+    }
+
+    void resetStats() { stats = Stats(); }
+
+private:
+    uint8_t __addr = 0;
+    uint8_t __pointer = 0;
+    uint8_t __tx[132] = {};
+    size_t __txLen = 0;
+    int __rxLeft = 0;
+
+    void __account(size_t len)
+    {
+        const uint32_t clocks = 2 + 9 * (1 + static_cast<uint32_t>(len));
+        const uint32_t us = (clocks * 5 + 1) / 2 + overheadUs; // 2.5 us per clock
+        stats.transactions++;
+        stats.bytes += 1 + static_cast<uint32_t>(len);
+        stats.busyUs += us;
+        delayMicroseconds(us);
+    }
+};
+
+inline TwoWire Wire;
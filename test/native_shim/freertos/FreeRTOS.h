@@ -0,0 +1,33 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS port types and critical sections (native tests only).
+ * @details portMUX_TYPE is a recursive mutex, so a critical section excludes the
+ *          other host threads like the spinlock excludes the other core.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define IRAM_ATTR
+
+struct portMUX_TYPE
+{
+    std::recursive_mutex mutex;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->mutex.lock()
+#define portEXIT_CRITICAL(mux) (mux)->mutex.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
@@ -0,0 +1,38 @@
+/**
+ * @file semphr.h
+ * @brief Host stand-in for the FreeRTOS mutexes (native tests only).
+ * @details Every kind is a recursive timed mutex; a tick is one millisecond.
+ *          Handles are never freed before the process exits, as on the target.
+ */
+#pragma once
+
+#include <chrono>
+#include "freertos/FreeRTOS.h"
+
+struct NativeSemaphore
+{
+    std::recursive_timed_mutex mutex;
+};
+typedef NativeSemaphore *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeSemaphore(); }
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore(); }
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) { return xSemaphoreTakeRecursive(semaphore, ticks); }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { return xSemaphoreGiveRecursive(semaphore); }
@@ -0,0 +1,123 @@
+/**
+ * ActionAcl host tests: pio test -e native -f test_action_acl
+ */
+#include <unity.h>
+#include <string.h>
+#include "ActionAcl.h"
+
+// Role defaults as AmakerBotService sets them
+static const uint8_t OBSERVER_ACTIONS[] = {0x57, 0x58, 0x59, 0x5B, 0x5F, 0x34, 0x35, 0x36, 0x37};
+static const uint8_t STUDENT_ACTIONS[] = {0x57, 0x58, 0x59, 0x5B, 0x5F, 0x34, 0x35, 0x36,
+                                          0x37, 0x53, 0x56, 0x5D, 0x31, 0x32, 0x33};
+
+static constexpr uint32_t PEER_A = 0x3201a8c0; // 192.168.1.50
+static constexpr uint32_t PEER_B = 0x3301a8c0; // 192.168.1.51
+static constexpr uint32_t MASTER = 0x2a01a8c0; // 192.168.1.42
+
+static ActionAcl acl;
+
+void setUp(void)
+{
+    acl = ActionAcl();
+    acl.setRoleMask(PeerRole::OBSERVER, ActionMask::of(OBSERVER_ACTIONS, sizeof(OBSERVER_ACTIONS)));
+    acl.setRoleMask(PeerRole::STUDENT, ActionMask::of(STUDENT_ACTIONS, sizeof(STUDENT_ACTIONS)));
+}
+
+void tearDown(void) {}
+
+static void test_roles_get_their_default_mask(void)
+{
+    TEST_ASSERT_TRUE(acl.grant(PEER_A, PeerRole::OBSERVER));
+    TEST_ASSERT_TRUE(acl.grant(PEER_B, PeerRole::STUDENT));
+    TEST_ASSERT_TRUE(acl.allowed(PEER_A, false, 0x58));
+    TEST_ASSERT_FALSE(acl.allowed(PEER_A, false, 0x55));
+    TEST_ASSERT_FALSE(acl.allowed(PEER_A, false, 0x31));
+    TEST_ASSERT_TRUE(acl.allowed(PEER_B, false, 0x31));
+    TEST_ASSERT_TRUE(acl.allowed(PEER_B, false, 0x56));
+    TEST_ASSERT_FALSE(acl.allowed(PEER_B, false, 0x5E));
+}
+
+static void test_master_and_guests(void)
+{
+    TEST_ASSERT_FALSE(acl.grant(MASTER, PeerRole::MASTER));
+    TEST_ASSERT_FALSE(acl.grant(0, PeerRole::OBSERVER));
+    TEST_ASSERT_TRUE(acl.allowed(MASTER, true, 0x55));
+    TEST_ASSERT_FALSE(acl.allowed(0x99, false, 0x58));
+    TEST_ASSERT_TRUE(PeerRole::GUEST == acl.roleOf(0x99));
+    TEST_ASSERT_TRUE(PeerRole::GUEST == acl.roleOf(0));
+}
+
+static void test_denials_are_counted_per_role(void)
+{
+    acl.grant(PEER_A, PeerRole::OBSERVER);
+    acl.grant(PEER_B, PeerRole::STUDENT);
+    acl.allowed(PEER_A, false, 0x55);
+    acl.allowed(PEER_A, false, 0x31);
+    acl.allowed(PEER_B, false, 0x5E);
+    acl.allowed(0x99, false, 0x58);
+    acl.allowed(PEER_A, false, 0x58);
+    TEST_ASSERT_EQUAL_UINT32(2, acl.denials(PeerRole::OBSERVER));
+    TEST_ASSERT_EQUAL_UINT32(1, acl.denials(PeerRole::STUDENT));
+    TEST_ASSERT_EQUAL_UINT32(1, acl.denials(PeerRole::GUEST));
+    ActionAcl::Peer peers[ActionAcl::MAX_PEERS];
+    TEST_ASSERT_EQUAL_UINT8(2, acl.peers(peers, ActionAcl::MAX_PEERS));
+    TEST_ASSERT_EQUAL_UINT32(2, peers[0].denied);
+}
+
+static void test_wire_form_round_trip(void)
+{
+    uint8_t bytes[32] = {};
+    bytes[0x55 / 8] |= 1 << (0x55 % 8);
+    bytes[0xFF / 8] |= 1 << (0xFF % 8);
+    const ActionMask mask = ActionMask::fromBytes(bytes);
+    TEST_ASSERT_TRUE(mask.test(0x55));
+    TEST_ASSERT_TRUE(mask.test(0xFF));
+    TEST_ASSERT_FALSE(mask.test(0x54));
+    uint8_t back[32];
+    mask.toBytes(back);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(bytes, back, 32);
+
+    char hex[65];
+    ActionMask::of(OBSERVER_ACTIONS, 1).toHex(hex); // 0x57: byte 10, bit 7
+    TEST_ASSERT_EQUAL_UINT32(64, strlen(hex));
+    TEST_ASSERT_EQUAL_STRING_LEN("0000000000000000000080", hex, 22);
+}
+
+static void test_explicit_mask_and_revoke(void)
+{
+    const uint8_t only[] = {0x55};
+    const ActionMask mask = ActionMask::of(only, 1);
+    TEST_ASSERT_TRUE(acl.grant(PEER_A, PeerRole::STUDENT, &mask));
+    TEST_ASSERT_TRUE(acl.allowed(PEER_A, false, 0x55));
+    TEST_ASSERT_FALSE(acl.allowed(PEER_A, false, 0x58));
+    TEST_ASSERT_TRUE(acl.grant(PEER_A, PeerRole::GUEST));
+    TEST_ASSERT_TRUE(PeerRole::GUEST == acl.roleOf(PEER_A));
+    ActionAcl::Peer peers[ActionAcl::MAX_PEERS];
+    TEST_ASSERT_EQUAL_UINT8(0, acl.peers(peers, ActionAcl::MAX_PEERS));
+}
+
+static void test_table_full_and_clear(void)
+{
+    for (uint32_t i = 1; i <= ActionAcl::MAX_PEERS; ++i)
+        TEST_ASSERT_TRUE(acl.grant(0x1000 + i, PeerRole::OBSERVER));
+    TEST_ASSERT_FALSE(acl.grant(0x2000, PeerRole::OBSERVER));
+    // Re-granting a known peer does not need a free slot
+    TEST_ASSERT_TRUE(acl.grant(0x1001, PeerRole::STUDENT));
+    acl.allowed(0x1002, false, 0x31);
+    acl.clear();
+    ActionAcl::Peer peers[ActionAcl::MAX_PEERS];
+    TEST_ASSERT_EQUAL_UINT8(0, acl.peers(peers, ActionAcl::MAX_PEERS));
+    TEST_ASSERT_EQUAL_UINT32(1, acl.denials(PeerRole::OBSERVER));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_roles_get_their_default_mask);
+    RUN_TEST(test_master_and_guests);
+    RUN_TEST(test_denials_are_counted_per_role);
+    RUN_TEST(test_wire_form_round_trip);
+    RUN_TEST(test_explicit_mask_and_revoke);
+    RUN_TEST(test_table_full_and_clear);
+    return UNITY_END();
+}
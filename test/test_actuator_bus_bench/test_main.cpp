@@ -0,0 +1,163 @@
+/**
+ * DFR1216 vs DFR0548 actuator bus cost: pio test -e native -f test_actuator_bus_bench
+ *
+ * Each scenario runs 1000 commits that change the same outputs every time. It
+ * compares four write paths:
+ * - DFR1216 write-through: one transaction per word
+ * - DFR1216 batch: shadow spans, DFR1216_Sim
+ * - DFR0548 per-register: setPWM(), four one-byte writes per output
+ * - DFR0548 burst: one auto-increment transaction per commit, mock Wire bus
+ * Both bus models count 400 kHz wire time with no driver overhead. The table is
+ * printed; the assertions only pin the transaction counts the designs promise.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include "ActuatorBackend.h"
+
+static constexpr uint32_t COMMITS = 1000;
+
+struct Scenario
+{
+    const char *name;
+    uint8_t motors; ///< Motors 0..motors-1 change (both half-bridges written)
+    uint8_t servos; ///< Servo channels 0..servos-1 change
+};
+
+struct Cost
+{
+    uint32_t transactions = 0;
+    uint64_t bytes = 0;
+    uint64_t busyUs = 0;
+};
+
+static DFR1216Backend dfr1216;
+static DFR0548Backend dfr0548;
+static DFR0548_Controller pca; ///< Same chip address as dfr0548: only the bus cost matters here
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static uint16_t pulse(uint32_t n, uint8_t ch) { return static_cast<uint16_t>(1000 + (n * 7 + ch * 97) % 1000); }
+static uint16_t duty(uint32_t n, uint8_t m) { return static_cast<uint16_t>(1000 + (n * 131 + m * 4099) % 60000); }
+
+template <typename Backend>
+static void stage(Backend &backend, const Scenario &s, uint32_t n)
+{
+    for (uint8_t m = 0; m < s.motors; ++m)
+    {
+        backend.setMotorDuty(m * 2, duty(n, m));
+        backend.setMotorDuty(m * 2 + 1, 0);
+    }
+    for (uint8_t ch = 0; ch < s.servos; ++ch)
+        backend.setServoPulse(ch, pulse(n, ch));
+}
+
+static Cost simCost(const sSimStats_t &sim)
+{
+    Cost cost;
+    cost.transactions = sim.transactions;
+    cost.bytes = sim.wireBytes;
+    cost.busyUs = sim.busyUs;
+    return cost;
+}
+
+static Cost wireCost()
+{
+    Cost cost;
+    cost.transactions = Wire.stats.transactions;
+    cost.bytes = Wire.stats.bytes;
+    cost.busyUs = Wire.stats.busyUs;
+    return cost;
+}
+
+static void report(const char *path, const Cost &cost)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "  %-22s %5.2f transactions %6.1f bytes %7.1f us per commit", path,
+             static_cast<double>(cost.transactions) / COMMITS, static_cast<double>(cost.bytes) / COMMITS,
+             static_cast<double>(cost.busyUs) / COMMITS);
+    TEST_MESSAGE(line);
+}
+
+static void runScenario(const Scenario &s)
+{
+    TEST_MESSAGE(s.name);
+    uint32_t offset = 0;
+
+    DFR1216_Sim::resetSimStats();
+    for (uint32_t n = 0; n < COMMITS; ++n)
+        stage(dfr1216, s, offset + n);
+    const Cost through = simCost(DFR1216_Sim::getSimStats());
+    report("DFR1216 write-through", through);
+    offset += COMMITS;
+
+    DFR1216_Sim::resetSimStats();
+    for (uint32_t n = 0; n < COMMITS; ++n)
+    {
+        dfr1216.beginUpdate();
+        stage(dfr1216, s, offset + n);
+        TEST_ASSERT_EQUAL_HEX8(0, dfr1216.endUpdate());
+    }
+    const Cost batch = simCost(DFR1216_Sim::getSimStats());
+    report("DFR1216 batch", batch);
+
+    Wire.resetStats();
+    for (uint32_t n = 0; n < COMMITS; ++n)
+    {
+        for (uint8_t m = 0; m < s.motors; ++m)
+        {
+            pca.setPWM(m * 2, 0, duty(n, m) >> 4);
+            pca.setPWM(m * 2 + 1, 0, PCA9685_FULL_ON_OFF);
+        }
+        for (uint8_t ch = 0; ch < s.servos; ++ch)
+            pca.setPWM(ch, 0, pulse(n, ch) * 4096UL / 20000);
+    }
+    const Cost bytewise = wireCost();
+    report("DFR0548 per-register", bytewise);
+
+    Wire.resetStats();
+    for (uint32_t n = 0; n < COMMITS; ++n)
+    {
+        dfr0548.beginUpdate();
+        stage(dfr0548, s, offset + n);
+        TEST_ASSERT_EQUAL_HEX8(0, dfr0548.endUpdate());
+    }
+    const Cost burst = wireCost();
+    report("DFR0548 burst", burst);
+
+    // Motor duties and servo pulses are two spans on the DFR1216, one burst on the PCA9685
+    const uint32_t spans = (s.motors ? 1 : 0) + (s.servos ? 1 : 0);
+    TEST_ASSERT_EQUAL_UINT32(spans * COMMITS, batch.transactions);
+    TEST_ASSERT_EQUAL_UINT32(COMMITS, burst.transactions);
+    TEST_ASSERT_EQUAL_UINT32((s.motors * 2 + s.servos) * 4 * COMMITS, bytewise.transactions);
+    TEST_ASSERT_TRUE(batch.busyUs <= through.busyUs);
+    TEST_ASSERT_TRUE(burst.busyUs < bytewise.busyUs);
+}
+
+static void test_two_wheels(void)
+{
+    runScenario({"2 wheel motors", 2, 0});
+}
+
+static void test_two_wheels_two_servos(void)
+{
+    runScenario({"2 wheel motors + 2 servos", 2, 2});
+}
+
+static void test_every_output(void)
+{
+    runScenario({"4 motors + 6 servos", 4, 6});
+}
+
+int main(int argc, char **argv)
+{
+    dfr1216.begin();
+    dfr0548.begin();
+    pca.begin(DFR0548_DEFAULT_I2C_ADDR);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_two_wheels);
+    RUN_TEST(test_two_wheels_two_servos);
+    RUN_TEST(test_every_output);
+    return UNITY_END();
+}
@@ -0,0 +1,171 @@
+/**
+ * Actuator commit path on the virtual DFR1216: pio test -e native -f test_actuator_sim
+ *
+ * Drives DFR1216Backend the way ServoService's commit task does: every 5 ms the
+ * twist is ramped and mixed (DifferentialDrive), the continuous servos get their
+ * pulses from calibrated tables (ServoPulseTable), and all slots go out as one
+ * batch. DFR1216_Sim models the bus on the simulated clock of the native shim,
+ * so the utilisation printed is that of a 400 kHz bus.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include "ActuatorBackend.h"
+#include "DifferentialDrive.h"
+#include "ServoCalibration.h"
+
+static constexpr uint32_t COMMIT_PERIOD_US = 5000;
+static constexpr uint16_t MOTOR_PWM_PERIOD = 1000;
+static constexpr uint8_t SERVOS = 2; ///< Continuous servos on channels 0 and 1
+
+/** @brief Second view of the board, reading its registers over the (simulated) bus. */
+struct Probe : DFR1216_Sim
+{
+    uint16_t word(uint8_t reg)
+    {
+        uint8_t bytes[2] = {};
+        readReg(reg, bytes, 2);
+        return static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+    }
+};
+
+static DFR1216Backend backend;
+static ServoPulseTable tables[SERVOS];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/** @brief Half-bridge duties of one motor, as ServoService::stageHalfBridges() computes them. */
+static void setMotor(uint8_t motor, int32_t duty)
+{
+    const uint16_t magnitude = static_cast<uint16_t>((std::abs(duty) * 65535) / 1000);
+    backend.setMotorDuty(motor * 2, duty > 0 ? magnitude : 0);
+    backend.setMotorDuty(motor * 2 + 1, duty < 0 ? magnitude : 0);
+}
+
+static void buildStopImage(ActuatorStopImage &image)
+{
+    uint16_t stop_pulse_us[eServo5 + 1] = {};
+    for (uint8_t ch = 0; ch < SERVOS; ++ch)
+        stop_pulse_us[ch] = tables[ch].stopPulse();
+    DFR1216Backend::buildStopImage((1u << SERVOS) - 1, stop_pulse_us, image);
+}
+
+static void test_begin_powers_the_board_up_once(void)
+{
+    // ServoService and DFR1216Service both begin() their own instance
+    backend.setMotorDuty(0, 1234);
+    DFR1216_Sim other;
+    TEST_ASSERT_TRUE(other.begin());
+    Probe probe;
+    TEST_ASSERT_EQUAL_UINT16(1234, probe.word(I2C_MOTOR1_Z_DUTY_H));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, DFR1216_Sim::getSimStats().transactions);
+    backend.setMotorDuty(0, 0);
+}
+
+static void test_commit_loop_bus_utilisation(void)
+{
+    DriveConfig config;
+    config.deadband = 80;
+    config.accel_limit = 2000;
+    DifferentialDrive drive;
+    drive.configure(config);
+    drive.reset(0, 0);
+
+    DFR1216_Sim::resetSimStats();
+    DFR1216::resetBusStats();
+    const sShadowStats_t before = backend.getStats();
+    const uint32_t periods = 1000000 / COMMIT_PERIOD_US;
+    uint32_t failed = 0;
+    for (uint32_t n = 0; n < periods; ++n)
+    {
+        const uint32_t start = micros();
+        // Drive forward, turn, then stop; the servos sweep their speed once per second
+        if (n == 0)
+            drive.setTarget(800, 0);
+        else if (n == periods / 3)
+            drive.setTarget(500, 400);
+        else if (n == 2 * periods / 3)
+            drive.setTarget(0, 0);
+        drive.step(COMMIT_PERIOD_US);
+        const int8_t speed = static_cast<int8_t>((n * 200 / periods) - 100);
+
+        backend.beginUpdate();
+        setMotor(config.left_motor, drive.leftDuty());
+        setMotor(config.right_motor, drive.rightDuty());
+        for (uint8_t ch = 0; ch < SERVOS; ++ch)
+            backend.setServoPulse(ch, tables[ch].speedPulse(ch ? -speed : speed));
+        if (backend.endUpdate() != 0)
+            failed++;
+        native_clock_us = start + COMMIT_PERIOD_US;
+    }
+
+    const sSimStats_t sim = DFR1216_Sim::getSimStats();
+    const sBusStats_t bus = DFR1216::getBusStats();
+    const sShadowStats_t after = backend.getStats();
+    char line[160];
+    snprintf(line, sizeof(line), "%u commits: %u transactions, %llu wire bytes, %llu us busy, utilisation %u/1000, worst %u us",
+             static_cast<unsigned>(periods), static_cast<unsigned>(sim.transactions),
+             static_cast<unsigned long long>(sim.wireBytes), static_cast<unsigned long long>(sim.busyUs),
+             sim.utilisationPermille, static_cast<unsigned>(bus.durationMaxUs));
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "shadow: %u writes requested, %u skipped, %u merged into %u spans",
+             static_cast<unsigned>(after.writesRequested - before.writesRequested),
+             static_cast<unsigned>(after.writesSkipped - before.writesSkipped),
+             static_cast<unsigned>(after.writesMerged - before.writesMerged),
+             static_cast<unsigned>(after.spansFlushed - before.spansFlushed));
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(0, failed);
+    TEST_ASSERT_EQUAL_UINT32(sim.transactions, bus.transactions);
+    // Two spans per commit at most: the motor duties, then the servo pulses (their periods sit in between)
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * periods, after.spansFlushed - before.spansFlushed);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, after.writesSkipped - before.writesSkipped);
+    TEST_ASSERT_LESS_THAN_UINT16(200, sim.utilisationPermille);
+}
+
+static void test_emergency_stop_overtakes_an_open_batch(void)
+{
+    ActuatorStopImage image;
+    buildStopImage(image);
+    Probe probe;
+    const uint32_t overtaken = backend.getStats().flushesOvertaken;
+
+    // The commit task is collecting a batch when the stop task writes the image
+    backend.beginUpdate();
+    setMotor(0, 700);
+    backend.setServoPulse(0, tables[0].speedPulse(100));
+    TEST_ASSERT_EQUAL_HEX8(0x00, backend.emergencyStop(image));
+    TEST_ASSERT_EQUAL_HEX8(0xff, backend.endUpdate());
+    TEST_ASSERT_EQUAL_UINT32(overtaken + 1, backend.getStats().flushesOvertaken);
+    TEST_ASSERT_EQUAL_UINT16(0, probe.word(I2C_MOTOR1_Z_DUTY_H));
+    TEST_ASSERT_EQUAL_UINT16(tables[0].stopPulse(), probe.word(I2C_SERVO0_DUTY_H));
+
+    // The stops staged after the image go out with the next commit
+    backend.beginUpdate();
+    setMotor(0, 0);
+    backend.setServoPulse(0, tables[0].stopPulse());
+    TEST_ASSERT_EQUAL_HEX8(0x00, backend.endUpdate());
+    TEST_ASSERT_EQUAL_UINT16(0, probe.word(I2C_MOTOR1_Z_DUTY_H));
+
+    // A batch opened after the stop is written as usual
+    backend.beginUpdate();
+    setMotor(0, 300);
+    TEST_ASSERT_EQUAL_HEX8(0x00, backend.endUpdate());
+    TEST_ASSERT_EQUAL_UINT16(300 * 65535 / 1000, probe.word(I2C_MOTOR1_Z_DUTY_H));
+}
+
+int main(int argc, char **argv)
+{
+    ServoCalibration calibration;
+    calibration.deadband_us = 30;
+    for (ServoPulseTable &table : tables)
+        table.compile(ServoPulseTable::Model::CONTINUOUS, calibration);
+    backend.begin();
+    backend.configure(MOTOR_PWM_PERIOD);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_powers_the_board_up_once);
+    RUN_TEST(test_commit_loop_bus_utilisation);
+    RUN_TEST(test_emergency_stop_overtakes_an_open_batch);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+/**
+ * DifferentialDrive host tests: pio test -e native -f test_differential_drive
+ */
+#include <unity.h>
+#include "DifferentialDrive.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_mix_saturation_keeps_the_ratio(void)
+{
+    int32_t left = 0, right = 0;
+    DifferentialDrive::mix(900, 300, left, right);
+    TEST_ASSERT_EQUAL_INT32(500, left);
+    TEST_ASSERT_EQUAL_INT32(1000, right);
+}
+
+static void test_limit_forward_scales_both_wheels(void)
+{
+    DifferentialDrive drive;
+    drive.reset(800, 400);
+    TEST_ASSERT_TRUE(drive.limitForward(400));
+    TEST_ASSERT_EQUAL_INT32(400, drive.left());
+    TEST_ASSERT_EQUAL_INT32(200, drive.right());
+}
+
+static void test_limit_forward_keeps_a_spin_turning(void)
+{
+    // One wheel forward, one reverse: the reverse wheel slows by the same factor
+    DifferentialDrive drive;
+    drive.reset(-300, 600);
+    TEST_ASSERT_TRUE(drive.limitForward(200));
+    TEST_ASSERT_EQUAL_INT32(-100, drive.left());
+    TEST_ASSERT_EQUAL_INT32(200, drive.right());
+}
+
+static void test_limit_forward_below_the_cap_or_in_reverse_is_untouched(void)
+{
+    DifferentialDrive drive;
+    drive.reset(300, 250);
+    TEST_ASSERT_FALSE(drive.limitForward(300));
+    TEST_ASSERT_EQUAL_INT32(300, drive.left());
+    drive.reset(-700, -900);
+    TEST_ASSERT_FALSE(drive.limitForward(0));
+    TEST_ASSERT_EQUAL_INT32(-900, drive.right());
+}
+
+static void test_limit_forward_to_zero_stops_the_pair(void)
+{
+    DifferentialDrive drive;
+    drive.reset(500, -200);
+    TEST_ASSERT_TRUE(drive.limitForward(0));
+    TEST_ASSERT_EQUAL_INT32(0, drive.left());
+    TEST_ASSERT_EQUAL_INT32(0, drive.right());
+}
+
+static void test_ramp_resumes_from_the_limited_commands(void)
+{
+    DriveConfig config;
+    config.accel_limit = 1000; // full scale per second
+    DifferentialDrive drive;
+    drive.configure(config);
+    drive.reset(600, 300);
+    drive.setTarget(450, -150); // wheels 600 / 300
+    drive.limitForward(200);
+    TEST_ASSERT_EQUAL_INT32(200, drive.left());
+    TEST_ASSERT_EQUAL_INT32(100, drive.right());
+    // 100 ms at 1000/s: 100 towards the target along a straight line
+    TEST_ASSERT_TRUE(drive.step(100000));
+    TEST_ASSERT_EQUAL_INT32(300, drive.left());
+    TEST_ASSERT_EQUAL_INT32(150, drive.right());
+}
+
+static void test_compensate_round_trip(void)
+{
+    for (int32_t wheel = -1000; wheel <= 1000; wheel += 50)
+        TEST_ASSERT_INT_WITHIN(1, wheel, DifferentialDrive::uncompensate(DifferentialDrive::compensate(wheel, 120), 120));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mix_saturation_keeps_the_ratio);
+    RUN_TEST(test_limit_forward_scales_both_wheels);
+    RUN_TEST(test_limit_forward_keeps_a_spin_turning);
+    RUN_TEST(test_limit_forward_below_the_cap_or_in_reverse_is_untouched);
+    RUN_TEST(test_limit_forward_to_zero_stops_the_pair);
+    RUN_TEST(test_ramp_resumes_from_the_limited_commands);
+    RUN_TEST(test_compensate_round_trip);
+    return UNITY_END();
+}
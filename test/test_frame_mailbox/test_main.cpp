@@ -0,0 +1,99 @@
+/**
+ * FrameMailbox host tests: pio test -e native -f test_frame_mailbox
+ */
+#include <unity.h>
+#include "FrameMailbox.h"
+
+static FrameMailbox *mailbox;
+static int frame_a, frame_b, frame_c;
+
+void setUp(void)
+{
+    mailbox = new FrameMailbox();
+}
+
+void tearDown(void)
+{
+    delete mailbox;
+}
+
+static void test_latest_frame_replaces_the_waiting_one(void)
+{
+    uint32_t seen = 0;
+    TEST_ASSERT_NULL(mailbox->take(seen, 0));
+    TEST_ASSERT_NULL(mailbox->post(&frame_a, 100));
+    TEST_ASSERT_EQUAL_UINT32(1, mailbox->generation());
+    // Nobody took frame a: it comes back to the producer as dropped
+    TEST_ASSERT_EQUAL_PTR(&frame_a, mailbox->post(&frame_b, 200));
+    TEST_ASSERT_EQUAL_UINT32(1, mailbox->stats().dropped);
+    TEST_ASSERT_TRUE(mailbox->stats().full);
+
+    TEST_ASSERT_EQUAL_PTR(&frame_b, mailbox->take(seen, 1200));
+    TEST_ASSERT_EQUAL_UINT32(2, seen);
+    TEST_ASSERT_FALSE(mailbox->stats().full);
+    TEST_ASSERT_NULL(mailbox->take(seen, 1300));
+}
+
+static void test_taken_frame_belongs_to_one_consumer(void)
+{
+    uint32_t first = 0;
+    uint32_t second = 0;
+    mailbox->post(&frame_a, 0);
+    TEST_ASSERT_EQUAL_PTR(&frame_a, mailbox->take(first, 10));
+    // The slot is empty until the next post, whatever the other consumer saw
+    TEST_ASSERT_NULL(mailbox->take(second, 20));
+    mailbox->post(&frame_b, 30);
+    TEST_ASSERT_EQUAL_PTR(&frame_b, mailbox->take(second, 40));
+    TEST_ASSERT_EQUAL_UINT32(2, second);
+}
+
+static void test_no_frame_older_than_the_last_one_seen(void)
+{
+    mailbox->post(&frame_a, 0);
+    uint32_t seen = 5; // generation 1 is older
+    TEST_ASSERT_NULL(mailbox->take(seen, 0));
+    TEST_ASSERT_EQUAL_UINT32(5, seen);
+    // Generations compare across the wrap
+    uint32_t before_wrap = 0xFFFFFFFFu;
+    TEST_ASSERT_EQUAL_PTR(&frame_a, mailbox->take(before_wrap, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, before_wrap);
+}
+
+static void test_age_statistics(void)
+{
+    uint32_t seen = 0;
+    mailbox->post(&frame_a, 200);
+    mailbox->take(seen, 1200);
+    mailbox->post(&frame_b, 2000);
+    mailbox->take(seen, 2500);
+    mailbox->post(&frame_c, 3000);
+    mailbox->take(seen, 2900); // clock behind the capture: age 0
+    const FrameMailbox::Stats stats = mailbox->stats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.taken);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.age_us_min);
+    TEST_ASSERT_EQUAL_UINT32(500, stats.age_us_avg);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.age_us_max);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.age_us_last);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+static void test_clear_hands_back_the_frame(void)
+{
+    mailbox->post(&frame_a, 0);
+    TEST_ASSERT_EQUAL_PTR(&frame_a, mailbox->clear());
+    TEST_ASSERT_EQUAL_UINT32(1, mailbox->stats().dropped);
+    TEST_ASSERT_NULL(mailbox->clear());
+    uint32_t seen = 0;
+    TEST_ASSERT_NULL(mailbox->take(seen, 0));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_latest_frame_replaces_the_waiting_one);
+    RUN_TEST(test_taken_frame_belongs_to_one_consumer);
+    RUN_TEST(test_no_frame_older_than_the_last_one_seen);
+    RUN_TEST(test_age_statistics);
+    RUN_TEST(test_clear_hands_back_the_frame);
+    return UNITY_END();
+}
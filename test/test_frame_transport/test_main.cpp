@@ -0,0 +1,149 @@
+/**
+ * FrameTransport host tests: pio test -e native -f test_frame_transport
+ */
+#include <unity.h>
+#include <string.h>
+#include "FrameTransport.h"
+
+static constexpr uint8_t ACTION = 0x62;
+static constexpr uint64_t CAPTURE_US = 123456789012ull;
+static constexpr size_t FRAME_LEN = 5000;
+
+static FrameTransport *transport;
+static uint8_t frame[FRAME_LEN];
+static uint8_t rebuilt[FRAME_LEN];
+static uint8_t datagram[FrameTransport::MAX_DATAGRAM];
+
+void setUp(void)
+{
+    transport = new FrameTransport();
+    for (size_t i = 0; i < FRAME_LEN; ++i)
+        frame[i] = static_cast<uint8_t>(i * 7);
+    memset(rebuilt, 0, sizeof(rebuilt));
+}
+
+void tearDown(void)
+{
+    delete transport;
+}
+
+static void test_fragment_count(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(0, FrameTransport::fragmentCount(0));
+    TEST_ASSERT_EQUAL_UINT16(1, FrameTransport::fragmentCount(FrameTransport::MAX_PAYLOAD));
+    TEST_ASSERT_EQUAL_UINT16(2, FrameTransport::fragmentCount(FrameTransport::MAX_PAYLOAD + 1));
+}
+
+static void test_fragments_rebuild_the_frame(void)
+{
+    const uint16_t count = FrameTransport::fragmentCount(FRAME_LEN);
+    for (uint16_t index = 0; index < count; ++index)
+    {
+        const size_t len = FrameTransport::buildFragment(ACTION, 42, CAPTURE_US, frame, FRAME_LEN, index, datagram);
+        TEST_ASSERT_TRUE(len > FrameTransport::HEADER_SIZE && len <= FrameTransport::MAX_DATAGRAM);
+        FrameTransport::Header header;
+        TEST_ASSERT_TRUE(FrameTransport::parseHeader(datagram, len, header));
+        TEST_ASSERT_EQUAL_UINT8(ACTION, header.action);
+        TEST_ASSERT_EQUAL_UINT16(42, header.frame_id);
+        TEST_ASSERT_EQUAL_UINT16(index, header.index);
+        TEST_ASSERT_EQUAL_UINT16(count, header.count);
+        TEST_ASSERT_EQUAL_UINT32(FRAME_LEN, header.frame_len);
+        TEST_ASSERT_TRUE(header.capture_us == CAPTURE_US);
+        memcpy(rebuilt + index * FrameTransport::MAX_PAYLOAD, datagram + FrameTransport::HEADER_SIZE,
+               len - FrameTransport::HEADER_SIZE);
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, rebuilt, FRAME_LEN);
+    TEST_ASSERT_EQUAL_size_t(0, FrameTransport::buildFragment(ACTION, 42, 0, frame, FRAME_LEN, count, datagram));
+}
+
+static void test_inconsistent_headers_are_refused(void)
+{
+    const size_t len = FrameTransport::buildFragment(ACTION, 1, 0, frame, FRAME_LEN, 0, datagram);
+    FrameTransport::Header header;
+    TEST_ASSERT_FALSE(FrameTransport::parseHeader(datagram, FrameTransport::HEADER_SIZE - 1, header));
+    TEST_ASSERT_FALSE(FrameTransport::parseHeader(nullptr, len, header));
+    datagram[1] = FrameTransport::VERSION + 1;
+    TEST_ASSERT_FALSE(FrameTransport::parseHeader(datagram, len, header));
+    datagram[1] = FrameTransport::VERSION;
+    datagram[4] = 9; // index past the count
+    TEST_ASSERT_FALSE(FrameTransport::parseHeader(datagram, len, header));
+    datagram[4] = 0;
+    datagram[6] = 9; // count not matching frame_len
+    TEST_ASSERT_FALSE(FrameTransport::parseHeader(datagram, len, header));
+}
+
+static void test_subscribers_fill_the_slots(void)
+{
+    TEST_ASSERT_FALSE(transport->subscribe(0, 10, 0, 0, 0));
+    TEST_ASSERT_TRUE(transport->subscribe(1, 10, 0, 0, 0));
+    TEST_ASSERT_TRUE(transport->subscribe(1, 10, 0, 10, 0)); // renewal
+    TEST_ASSERT_EQUAL_UINT8(1, transport->peers());
+    TEST_ASSERT_TRUE(transport->subscribe(2, 10, 0, 0, 0));
+    TEST_ASSERT_TRUE(transport->subscribe(0x0200007f, 0, 5, 0, 0));
+    TEST_ASSERT_TRUE(transport->subscribe(3, 1, 0, 0, 0));
+    TEST_ASSERT_FALSE(transport->subscribe(4, 1, 0, 0, 0));
+    // A WebSocket peer is found by its client id alone
+    TEST_ASSERT_NOT_NULL(transport->find(99, 0, 5));
+    TEST_ASSERT_NULL(transport->find(0x0200007f, 0, 6));
+    TEST_ASSERT_TRUE(transport->unsubscribe(2, 10, 0));
+    TEST_ASSERT_FALSE(transport->unsubscribe(2, 10, 0));
+    TEST_ASSERT_EQUAL_UINT8(3, transport->peers());
+}
+
+static void test_frame_rate_cap(void)
+{
+    FrameTransport::Target targets[FrameTransport::MAX_PEERS];
+    transport->subscribe(1, 10, 0, 10, 0); // 10 fps: 100 ms less 1/8 of slack
+    transport->subscribe(2, 10, 0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(2, transport->due(1000, targets));
+    TEST_ASSERT_EQUAL_UINT8(1, transport->due(50000, targets));
+    TEST_ASSERT_EQUAL_UINT32(2, targets[0].ipv4);
+    TEST_ASSERT_EQUAL_UINT8(1, transport->due(1000 + 87500 - 1, targets));
+    TEST_ASSERT_EQUAL_UINT32(2, transport->peer(0).frames_skipped);
+    TEST_ASSERT_EQUAL_UINT8(2, transport->due(1000 + 87500, targets));
+    TEST_ASSERT_EQUAL_UINT32(0, transport->peer(1).frames_skipped);
+}
+
+static void test_send_outcomes(void)
+{
+    FrameTransport::Target targets[FrameTransport::MAX_PEERS];
+    transport->subscribe(1, 10, 0, 0, 0);
+    transport->subscribe(2, 10, 0, 0, 0);
+    transport->due(0, targets);
+    transport->sent(targets[0], true, 4);
+    transport->sent(targets[1], false, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, transport->peer(0).frames_sent);
+    TEST_ASSERT_EQUAL_UINT32(4, transport->peer(0).fragments_sent);
+    TEST_ASSERT_EQUAL_UINT32(1, transport->peer(1).frames_aborted);
+    // Outcome for a slot that changed hands meanwhile
+    transport->unsubscribe(2, 10, 0);
+    transport->subscribe(3, 10, 0, 0, 0);
+    transport->sent(targets[1], true, 1);
+    TEST_ASSERT_EQUAL_UINT32(0, transport->peer(1).frames_sent);
+}
+
+static void test_lease_expiry(void)
+{
+    transport->subscribe(1, 10, 0, 0, 0);
+    transport->subscribe(2, 10, 0, 0, 1000000);
+    TEST_ASSERT_EQUAL_UINT8(2, transport->expire(FrameTransport::LEASE_US - 1));
+    TEST_ASSERT_EQUAL_UINT8(1, transport->expire(FrameTransport::LEASE_US));
+    TEST_ASSERT_NULL(transport->find(1, 10, 0));
+    // Renewing restarts the lease
+    transport->subscribe(2, 10, 0, 0, FrameTransport::LEASE_US);
+    TEST_ASSERT_EQUAL_UINT8(1, transport->expire(FrameTransport::LEASE_US + 1000000));
+    TEST_ASSERT_EQUAL_UINT8(0, transport->expire(2 * FrameTransport::LEASE_US));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fragment_count);
+    RUN_TEST(test_fragments_rebuild_the_frame);
+    RUN_TEST(test_inconsistent_headers_are_refused);
+    RUN_TEST(test_subscribers_fill_the_slots);
+    RUN_TEST(test_frame_rate_cap);
+    RUN_TEST(test_send_outcomes);
+    RUN_TEST(test_lease_expiry);
+    return UNITY_END();
+}
@@ -0,0 +1,214 @@
+/**
+ * HeartbeatWatchdog host tests: pio test -e native -f test_heartbeat_watchdog
+ *
+ * A simulated clock stands in for esp_timer_get_time(): the tests feed heartbeats,
+ * fire the one-shot timer late or early, and complete the stop whenever they like.
+ */
+#include <unity.h>
+#include "HeartbeatWatchdog.h"
+
+static constexpr uint32_t TIMEOUT_US = 50000;
+
+/** @brief Simulated clock and one-shot timer, as AmakerBotService drives the watchdog. */
+struct SimClock
+{
+    uint64_t now = 1000000;
+    uint64_t timer_due = 0; ///< 0 = timer not armed
+
+    /** @brief A heartbeat arrives: feed and re-arm the timer for the new deadline. */
+    bool heartbeat(HeartbeatWatchdog &watchdog)
+    {
+        const bool restored = watchdog.feed(now);
+        timer_due = watchdog.deadline();
+        return restored;
+    }
+
+    /** @brief Let time pass; the timer callback fires dispatch_us after its due time. */
+    bool run(HeartbeatWatchdog &watchdog, uint64_t us, uint32_t dispatch_us = 0)
+    {
+        const uint64_t end = now + us;
+        bool stopped = false;
+        if (timer_due && timer_due + dispatch_us <= end)
+        {
+            now = timer_due + dispatch_us;
+            timer_due = 0;
+            stopped = watchdog.expire(now);
+        }
+        now = end;
+        return stopped;
+    }
+};
+
+static HeartbeatWatchdog *watchdog;
+static SimClock clock_;
+
+void setUp(void)
+{
+    watchdog = new HeartbeatWatchdog(TIMEOUT_US);
+    clock_ = SimClock();
+}
+
+void tearDown(void)
+{
+    delete watchdog;
+}
+
+static void test_steady_heartbeats_never_stop(void)
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        clock_.heartbeat(*watchdog);
+        TEST_ASSERT_FALSE(clock_.run(*watchdog, 20000));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1000, watchdog->stats().heartbeats);
+    TEST_ASSERT_EQUAL_UINT32(0, watchdog->stats().expiries);
+}
+
+static void test_not_armed_before_the_first_heartbeat(void)
+{
+    TEST_ASSERT_FALSE(watchdog->armed());
+    TEST_ASSERT_FALSE(watchdog->expire(clock_.now + 10 * TIMEOUT_US));
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog->stats().stale_expiries);
+}
+
+static void test_one_stop_per_gap(void)
+{
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_FALSE(clock_.run(*watchdog, TIMEOUT_US - 1));
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, 1));
+    TEST_ASSERT_TRUE(watchdog->timedOut());
+    // Still no heartbeat: a repeated callback does not stop again
+    TEST_ASSERT_FALSE(watchdog->expire(clock_.now + TIMEOUT_US));
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog->stats().expiries);
+}
+
+static void test_next_heartbeat_restores_the_link(void)
+{
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, 80000));
+    TEST_ASSERT_TRUE(clock_.heartbeat(*watchdog));
+    TEST_ASSERT_FALSE(watchdog->timedOut());
+    TEST_ASSERT_FALSE(clock_.heartbeat(*watchdog));
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog->stats().restores);
+    // The next gap stops again
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+    TEST_ASSERT_EQUAL_UINT32(2, watchdog->stats().expiries);
+}
+
+static void test_callback_overtaken_by_a_heartbeat_is_stale(void)
+{
+    clock_.heartbeat(*watchdog);
+    clock_.now += TIMEOUT_US;
+    // The callback was dispatched, then a heartbeat re-armed the timer before it ran
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_FALSE(watchdog->expire(clock_.now + 100));
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog->stats().stale_expiries);
+    TEST_ASSERT_EQUAL_UINT32(0, watchdog->stats().expiries);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+}
+
+static void test_reset_disarms(void)
+{
+    clock_.heartbeat(*watchdog);
+    watchdog->reset();
+    TEST_ASSERT_FALSE(clock_.run(*watchdog, 2 * TIMEOUT_US));
+    TEST_ASSERT_FALSE(watchdog->armed());
+    TEST_ASSERT_EQUAL_UINT32(1, watchdog->stats().stale_expiries);
+}
+
+static void test_timer_lateness_and_stop_latency(void)
+{
+    // Dispatch 300 us late, the stop completes 700 us later: 1000 us from the deadline
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US + 300, 300));
+    watchdog->recordStop(clock_.now + 700);
+    const HeartbeatWatchdog::Stats &stats = watchdog->stats();
+    TEST_ASSERT_EQUAL_UINT32(300, stats.timer_late_max_us);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.latency_last_us);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hist[9]); // [512, 1024)
+}
+
+static void test_latency_distribution(void)
+{
+    // Dispatch latencies from 0 to 3 ms, stop path 200 us
+    const uint32_t dispatch[] = {0, 50, 120, 400, 900, 3000};
+    for (uint32_t late : dispatch)
+    {
+        clock_.heartbeat(*watchdog);
+        TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US + late, late));
+        watchdog->recordStop(clock_.now + 200);
+    }
+    const HeartbeatWatchdog::Stats &stats = watchdog->stats();
+    TEST_ASSERT_EQUAL_UINT32(6, stats.expiries);
+    TEST_ASSERT_EQUAL_UINT32(200, stats.latency_min_us);
+    TEST_ASSERT_EQUAL_UINT32(3200, stats.latency_max_us);
+    TEST_ASSERT_EQUAL_UINT32((200 + 250 + 320 + 600 + 1100 + 3200) / 6, stats.latency_avg_us);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.timer_late_max_us);
+    uint32_t total = 0;
+    for (uint32_t count : stats.hist)
+        total += count;
+    TEST_ASSERT_EQUAL_UINT32(6, total);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.hist[7]);  // 200, 250
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hist[8]);  // 320
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hist[9]);  // 600
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hist[10]); // 1100
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hist[11]); // 3200
+}
+
+static void test_stop_completed_after_a_new_heartbeat(void)
+{
+    // The link came back while the stop was still running: latency stays from the expired deadline
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+    clock_.now += 100;
+    clock_.heartbeat(*watchdog);
+    watchdog->recordStop(clock_.now + 400);
+    TEST_ASSERT_EQUAL_UINT32(500, watchdog->stats().latency_last_us);
+}
+
+static void test_failed_stop_is_not_a_latency(void)
+{
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+    watchdog->recordFailedStop();
+    const HeartbeatWatchdog::Stats &stats = watchdog->stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.expiries);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.failed_stops);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.latency_max_us);
+    uint32_t total = 0;
+    for (uint32_t count : stats.hist)
+        total += count;
+    TEST_ASSERT_EQUAL_UINT32(0, total);
+}
+
+static void test_reset_stats_keeps_the_state(void)
+{
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+    watchdog->recordStop(clock_.now + 10);
+    watchdog->resetStats();
+    TEST_ASSERT_TRUE(watchdog->timedOut());
+    TEST_ASSERT_EQUAL_UINT32(0, watchdog->stats().expiries);
+    TEST_ASSERT_EQUAL_UINT32(0, watchdog->stats().latency_max_us);
+    clock_.heartbeat(*watchdog);
+    TEST_ASSERT_TRUE(clock_.run(*watchdog, TIMEOUT_US));
+    watchdog->recordStop(clock_.now + 30);
+    TEST_ASSERT_EQUAL_UINT32(30, watchdog->stats().latency_avg_us);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_heartbeats_never_stop);
+    RUN_TEST(test_not_armed_before_the_first_heartbeat);
+    RUN_TEST(test_one_stop_per_gap);
+    RUN_TEST(test_next_heartbeat_restores_the_link);
+    RUN_TEST(test_callback_overtaken_by_a_heartbeat_is_stale);
+    RUN_TEST(test_reset_disarms);
+    RUN_TEST(test_timer_lateness_and_stop_latency);
+    RUN_TEST(test_latency_distribution);
+    RUN_TEST(test_stop_completed_after_a_new_heartbeat);
+    RUN_TEST(test_failed_stop_is_not_a_latency);
+    RUN_TEST(test_reset_stats_keeps_the_state);
+    return UNITY_END();
+}
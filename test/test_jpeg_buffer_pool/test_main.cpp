@@ -0,0 +1,137 @@
+/**
+ * JpegBufferPool host tests: pio test -e native -f test_jpeg_buffer_pool
+ *
+ * The pool gets a counting malloc/free pair, so every buffer allocated by begin()
+ * must be freed by end().
+ */
+#include <unity.h>
+#include <stdlib.h>
+#include "JpegBufferPool.h"
+
+static const JpegPoolClass CLASSES[] = {{1000, 2}, {4000, 2}, {8000, 1}};
+
+static int allocations;
+static int fail_at; ///< Allocation number that fails, 0 = none
+
+static void *countingAlloc(size_t size)
+{
+    if (fail_at && allocations + 1 == fail_at)
+        return nullptr;
+    allocations++;
+    return malloc(size);
+}
+
+static void countingFree(void *ptr)
+{
+    allocations--;
+    free(ptr);
+}
+
+static JpegBufferPool *pool;
+
+void setUp(void)
+{
+    allocations = 0;
+    fail_at = 0;
+    pool = new JpegBufferPool();
+}
+
+void tearDown(void)
+{
+    delete pool;
+    TEST_ASSERT_EQUAL_INT(0, allocations);
+}
+
+static void test_begin_allocates_every_buffer(void)
+{
+    TEST_ASSERT_TRUE(pool->begin(CLASSES, 3, countingAlloc, countingFree));
+    TEST_ASSERT_EQUAL_INT(5, allocations);
+    TEST_ASSERT_TRUE(pool->ready());
+    TEST_ASSERT_EQUAL_UINT32(8000, pool->largest());
+    TEST_ASSERT_EQUAL_UINT8(5, pool->stats().slots);
+    TEST_ASSERT_EQUAL_UINT32(2 * 1000 + 2 * 4000 + 8000, pool->stats().bytes);
+}
+
+static void test_take_smallest_fit_then_largest_free(void)
+{
+    pool->begin(CLASSES, 3, countingAlloc, countingFree);
+    JpegFrame *a = pool->take(900);
+    TEST_ASSERT_EQUAL_UINT32(1000, a->capacity);
+    TEST_ASSERT_EQUAL_size_t(0, a->len);
+    JpegFrame *b = pool->take(900);
+    TEST_ASSERT_EQUAL_UINT32(1000, b->capacity);
+    // Class full: the next size up, counted against the wanted class
+    JpegFrame *c = pool->take(900);
+    TEST_ASSERT_EQUAL_UINT32(4000, c->capacity);
+    TEST_ASSERT_EQUAL_UINT32(1, pool->stats().cls[0].exhausted);
+    // Nothing fits: the largest free buffer
+    JpegFrame *d = pool->take(20000);
+    TEST_ASSERT_EQUAL_UINT32(8000, d->capacity);
+    JpegFrame *e = pool->take(20000);
+    TEST_ASSERT_EQUAL_UINT32(4000, e->capacity);
+    TEST_ASSERT_NULL(pool->take(1));
+    TEST_ASSERT_EQUAL_UINT32(1, pool->stats().exhausted);
+    TEST_ASSERT_EQUAL_UINT8(5, pool->stats().high_water);
+    TEST_ASSERT_FALSE(pool->end()); // buffers in use
+
+    JpegFrame *taken[] = {a, b, c, d, e};
+    for (JpegFrame *frame : taken)
+        pool->give(frame);
+    TEST_ASSERT_EQUAL_UINT8(0, pool->stats().in_use);
+    TEST_ASSERT_EQUAL_UINT8(2, pool->stats().cls[1].high_water);
+    TEST_ASSERT_EQUAL_UINT32(5, pool->stats().takes); // the refused take is not counted
+    TEST_ASSERT_TRUE(pool->end());
+    TEST_ASSERT_FALSE(pool->ready());
+}
+
+static void test_give_ignores_foreign_and_repeated_frames(void)
+{
+    pool->begin(CLASSES, 3, countingAlloc, countingFree);
+    JpegFrame *a = pool->take(100);
+    JpegFrame *b = pool->take(100);
+    pool->give(a);
+    pool->give(a);
+    TEST_ASSERT_EQUAL_UINT8(1, pool->stats().in_use);
+    JpegFrame foreign;
+    pool->give(&foreign);
+    TEST_ASSERT_FALSE(pool->owns(&foreign));
+    TEST_ASSERT_TRUE(pool->owns(b));
+    TEST_ASSERT_EQUAL_UINT8(1, pool->stats().in_use);
+    pool->give(b);
+}
+
+static void test_begin_failures_keep_nothing(void)
+{
+    fail_at = 3;
+    TEST_ASSERT_FALSE(pool->begin(CLASSES, 3, countingAlloc, countingFree));
+    TEST_ASSERT_EQUAL_INT(0, allocations);
+    TEST_ASSERT_FALSE(pool->ready());
+
+    fail_at = 0;
+    const JpegPoolClass decreasing[] = {{4000, 2}, {1000, 2}};
+    TEST_ASSERT_FALSE(pool->begin(decreasing, 2, countingAlloc, countingFree));
+    const JpegPoolClass too_many[] = {{1000, 10}, {4000, 10}};
+    TEST_ASSERT_FALSE(pool->begin(too_many, 2, countingAlloc, countingFree));
+    TEST_ASSERT_EQUAL_INT(0, allocations);
+}
+
+static void test_overflow_and_fallback_counters(void)
+{
+    pool->begin(CLASSES, 3, countingAlloc, countingFree);
+    pool->overflowed();
+    pool->fellBack();
+    pool->fellBack();
+    TEST_ASSERT_EQUAL_UINT32(1, pool->stats().overflows);
+    TEST_ASSERT_EQUAL_UINT32(2, pool->stats().fallbacks);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_allocates_every_buffer);
+    RUN_TEST(test_take_smallest_fit_then_largest_free);
+    RUN_TEST(test_give_ignores_foreign_and_repeated_frames);
+    RUN_TEST(test_begin_failures_keep_nothing);
+    RUN_TEST(test_overflow_and_fallback_counters);
+    return UNITY_END();
+}
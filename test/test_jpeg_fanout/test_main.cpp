@@ -0,0 +1,148 @@
+/**
+ * JpegFanout host tests: pio test -e native -f test_jpeg_fanout
+ *
+ * Frames come from a small tracked allocator, so a frame freed twice, or never,
+ * fails the test.
+ */
+#include <unity.h>
+#include "JpegFanout.h"
+
+static constexpr uint8_t MAX_FRAMES = 8;
+
+static JpegFrame frames[MAX_FRAMES];
+static bool alive[MAX_FRAMES];
+static JpegFanout *hub;
+
+static JpegFrame *newFrame(size_t len = 100, uint32_t encode_us = 10)
+{
+    for (uint8_t i = 0; i < MAX_FRAMES; ++i)
+    {
+        if (alive[i])
+            continue;
+        alive[i] = true;
+        frames[i] = JpegFrame();
+        frames[i].len = len;
+        frames[i].encode_us = encode_us;
+        return &frames[i];
+    }
+    return nullptr; // No test holds more than MAX_FRAMES
+}
+
+/** @brief Free what the hub handed back (nullptr: nothing to free). */
+static void freeFrame(JpegFrame *frame)
+{
+    if (!frame)
+        return;
+    const long index = frame - frames;
+    TEST_ASSERT_TRUE(index >= 0 && index < MAX_FRAMES);
+    TEST_ASSERT_TRUE(alive[index]);
+    alive[index] = false;
+}
+
+static uint8_t liveFrames()
+{
+    uint8_t count = 0;
+    for (bool used : alive)
+        count += used;
+    return count;
+}
+
+void setUp(void)
+{
+    for (bool &used : alive)
+        used = false;
+    hub = new JpegFanout();
+    hub->subscribe();
+    hub->subscribe();
+}
+
+void tearDown(void)
+{
+    delete hub;
+}
+
+static void test_consumers_share_the_latest_frame(void)
+{
+    TEST_ASSERT_NULL(hub->acquire(0));
+    freeFrame(hub->publish(newFrame()));
+    JpegFrame *a = hub->acquire(0);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT32(1, a->seq);
+    TEST_ASSERT_EQUAL_UINT16(2, a->refs);
+    // Nothing newer for a consumer that already has it
+    TEST_ASSERT_NULL(hub->acquire(1));
+    JpegFrame *b = hub->acquire(0);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_UINT16(3, a->refs);
+    freeFrame(hub->release(a));
+    freeFrame(hub->release(b));
+    TEST_ASSERT_EQUAL_UINT8(1, liveFrames());
+    freeFrame(hub->clear());
+    TEST_ASSERT_EQUAL_UINT8(0, liveFrames());
+}
+
+static void test_slow_consumer_skips_and_frees_last(void)
+{
+    freeFrame(hub->publish(newFrame()));
+    JpegFrame *slow = hub->acquire(0);
+    JpegFrame *fast = hub->acquire(0);
+    freeFrame(hub->publish(newFrame())); // frame 1 still held
+    freeFrame(hub->publish(newFrame())); // frame 2 nobody acquired: freed
+    TEST_ASSERT_EQUAL_UINT8(2, liveFrames());
+    TEST_ASSERT_EQUAL_UINT32(1, hub->stats().superseded);
+
+    freeFrame(hub->release(fast));
+    hub->delivered(0, 1, 100);
+    JpegFrame *next = hub->acquire(1);
+    TEST_ASSERT_EQUAL_UINT32(3, next->seq);
+    freeFrame(hub->release(slow)); // the last reference of frame 1
+    hub->delivered(0, 1, 100);
+    TEST_ASSERT_EQUAL_UINT8(1, liveFrames());
+    freeFrame(hub->release(next));
+    hub->delivered(1, 3, 100);
+
+    const JpegFanout::Stats &stats = hub->stats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.encoded);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.delivered);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.skipped); // frame 2, for the fast consumer
+    TEST_ASSERT_EQUAL_UINT32(300, static_cast<uint32_t>(stats.copied_bytes));
+    freeFrame(hub->clear());
+    TEST_ASSERT_EQUAL_UINT16(0, hub->stats().live);
+    TEST_ASSERT_EQUAL_UINT8(0, liveFrames());
+}
+
+static void test_encode_statistics(void)
+{
+    freeFrame(hub->publish(newFrame(1000, 30)));
+    freeFrame(hub->publish(newFrame(3000, 10)));
+    freeFrame(hub->publish(newFrame(2000, 20)));
+    const JpegFanout::Stats &stats = hub->stats();
+    TEST_ASSERT_EQUAL_UINT32(10, stats.encode_us_min);
+    TEST_ASSERT_EQUAL_UINT32(20, stats.encode_us_avg);
+    TEST_ASSERT_EQUAL_UINT32(30, stats.encode_us_max);
+    TEST_ASSERT_EQUAL_UINT32(20, stats.encode_us_last);
+    TEST_ASSERT_EQUAL_UINT32(2000, stats.last_size);
+    TEST_ASSERT_EQUAL_UINT32(3, hub->latestSeq());
+    TEST_ASSERT_EQUAL_UINT16(1, stats.live);
+    freeFrame(hub->clear());
+}
+
+static void test_subscribers(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(2, hub->subscribers());
+    hub->unsubscribe();
+    hub->unsubscribe();
+    hub->unsubscribe(); // one too many is ignored
+    TEST_ASSERT_EQUAL_UINT8(0, hub->subscribers());
+    TEST_ASSERT_NULL(hub->clear());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_consumers_share_the_latest_frame);
+    RUN_TEST(test_slow_consumer_skips_and_frees_last);
+    RUN_TEST(test_encode_statistics);
+    RUN_TEST(test_subscribers);
+    return UNITY_END();
+}
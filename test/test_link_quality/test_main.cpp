@@ -0,0 +1,182 @@
+/**
+ * LinkQuality host tests: pio test -e native -f test_link_quality
+ *
+ * The master sends a heartbeat every 20 ms against the 50 ms watchdog; the tests
+ * drop, repeat, delay and reorder them on a simulated clock.
+ */
+#include <unity.h>
+#include "LinkQuality.h"
+
+static constexpr uint32_t TIMEOUT_US = 50000;
+static constexpr uint32_t PERIOD_US = 20000;
+
+static LinkQuality *quality;
+static uint64_t now_us;
+static uint16_t seq;
+
+/** @brief The next heartbeat of the master, after @p gap_us. */
+static void heartbeat(uint32_t gap_us = PERIOD_US)
+{
+    now_us += gap_us;
+    quality->onHeartbeat(now_us, true, seq++);
+}
+
+void setUp(void)
+{
+    quality = new LinkQuality(TIMEOUT_US);
+    LinkConfig config;
+    config.derate = true;
+    quality->configure(config);
+    now_us = 1000000;
+    seq = 0;
+    quality->onHeartbeat(now_us, true, seq++);
+}
+
+void tearDown(void)
+{
+    delete quality;
+}
+
+static void test_steady_link_is_full_quality(void)
+{
+    for (int i = 0; i < 99; ++i)
+        heartbeat();
+    const LinkQuality::Stats &stats = quality->stats();
+    TEST_ASSERT_EQUAL_UINT32(100, stats.heartbeats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(PERIOD_US, stats.gap_avg_us);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.jitter_us);
+    TEST_ASSERT_EQUAL_UINT32(99, stats.hist[PERIOD_US / LinkQuality::HIST_WIDTH_US]);
+    TEST_ASSERT_EQUAL_UINT16(1000, stats.quality);
+    TEST_ASSERT_EQUAL_UINT16(1000, quality->speedScale());
+}
+
+static void test_losses_late_and_duplicate_heartbeats(void)
+{
+    heartbeat();
+    seq += 3; // three heartbeats lost
+    heartbeat();
+    TEST_ASSERT_EQUAL_UINT32(3, quality->stats().lost);
+    TEST_ASSERT_LESS_THAN_UINT16(1000, quality->stats().quality);
+
+    // One of them arrives late: it fills the gap instead of counting
+    quality->onHeartbeat(now_us, true, seq - 3);
+    TEST_ASSERT_EQUAL_UINT32(1, quality->stats().reordered);
+    TEST_ASSERT_EQUAL_UINT32(2, quality->stats().lost);
+
+    quality->onHeartbeat(now_us, true, seq - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, quality->stats().duplicates);
+    TEST_ASSERT_EQUAL_UINT32(3, quality->stats().heartbeats);
+    TEST_ASSERT_EQUAL_UINT16(2 * 1000 / 5, quality->stats().lossPermille());
+}
+
+static void test_counter_wrap_and_restart(void)
+{
+    quality->reset();
+    seq = 0xFFFE;
+    heartbeat();
+    seq = 0x0001; // 0xFFFF and 0x0000 lost across the wrap
+    heartbeat();
+    TEST_ASSERT_EQUAL_UINT32(2, quality->stats().lost);
+    // Jumps past MAX_LOSS_RUN or back past REORDER_WINDOW are counter restarts
+    seq = 0x8000;
+    heartbeat();
+    seq = 5;
+    heartbeat();
+    TEST_ASSERT_EQUAL_UINT32(2, quality->stats().lost);
+    TEST_ASSERT_EQUAL_UINT32(0, quality->stats().reordered);
+}
+
+static void test_near_timeouts(void)
+{
+    heartbeat(25000);
+    heartbeat(45000); // 90 % of the timeout, still in time
+    heartbeat(40000); // 80 %
+    heartbeat(39000);
+    const LinkQuality::Stats &stats = quality->stats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.near_timeouts);
+    TEST_ASSERT_EQUAL_UINT32(45000, stats.gap_max_us);
+    TEST_ASSERT_EQUAL_UINT32(25000, stats.gap_min_us);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.jitter_us);
+}
+
+static void test_timeout_derates_then_recovers(void)
+{
+    quality->onTimeout();
+    TEST_ASSERT_EQUAL_UINT16(0, quality->stats().quality);
+    TEST_ASSERT_EQUAL_UINT16(300, quality->speedScale());
+
+    // The gap past the timeout is not a near-timeout: onTimeout() counted it
+    heartbeat(200000);
+    TEST_ASSERT_EQUAL_UINT32(200000, quality->stats().gap_max_us);
+    TEST_ASSERT_EQUAL_UINT32(1, quality->stats().hist[LinkQuality::HIST_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(0, quality->stats().near_timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, quality->stats().timeouts);
+
+    uint16_t previous = quality->speedScale();
+    int heartbeats = 0;
+    while (quality->stats().quality < 700)
+    {
+        heartbeat();
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT16(previous, quality->speedScale());
+        previous = quality->speedScale();
+        TEST_ASSERT_LESS_THAN(30, ++heartbeats);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1000, quality->speedScale());
+}
+
+static void test_without_derating_the_scale_stays_full(void)
+{
+    LinkConfig config;
+    quality->configure(config);
+    quality->onTimeout();
+    TEST_ASSERT_EQUAL_UINT16(1000, quality->speedScale());
+}
+
+static void test_ping_round_trips(void)
+{
+    quality->onPing(5000);
+    quality->onPing(3000);
+    const LinkQuality::Stats &stats = quality->stats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.rtt_reports);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.rtt_min_us);
+    TEST_ASSERT_EQUAL_UINT32(4000, stats.rtt_avg_us);
+    TEST_ASSERT_EQUAL_UINT32(5000, stats.rtt_max_us);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.rtt_last_us);
+}
+
+static void test_reset_keeps_the_config(void)
+{
+    heartbeat();
+    quality->onTimeout();
+    quality->reset();
+    TEST_ASSERT_EQUAL_UINT32(0, quality->stats().heartbeats);
+    TEST_ASSERT_EQUAL_UINT16(1000, quality->stats().quality);
+    TEST_ASSERT_TRUE(quality->config().derate);
+}
+
+static void test_config_string(void)
+{
+    LinkConfig config;
+    TEST_ASSERT_TRUE(config.fromString("1:85:600:250"));
+    TEST_ASSERT_EQUAL_STRING("1:85:600:250", config.toString().c_str());
+    TEST_ASSERT_FALSE(config.fromString("1:5:600:250"));
+    TEST_ASSERT_FALSE(config.fromString("1:85:0:250"));
+    TEST_ASSERT_FALSE(config.fromString("1:85"));
+    TEST_ASSERT_EQUAL_UINT8(85, config.near_timeout_pct);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_link_is_full_quality);
+    RUN_TEST(test_losses_late_and_duplicate_heartbeats);
+    RUN_TEST(test_counter_wrap_and_restart);
+    RUN_TEST(test_near_timeouts);
+    RUN_TEST(test_timeout_derates_then_recovers);
+    RUN_TEST(test_without_derating_the_scale_stays_full);
+    RUN_TEST(test_ping_round_trips);
+    RUN_TEST(test_reset_keeps_the_config);
+    RUN_TEST(test_config_string);
+    return UNITY_END();
+}
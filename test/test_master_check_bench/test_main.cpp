@@ -0,0 +1,124 @@
+/**
+ * Master identity check cost: pio test -e native -f test_master_check_bench
+ *
+ * Every 0x43 heartbeat and master-gated command asks the registry whether the
+ * sender is the master. Two registries behind IsMasterRegistryInterface:
+ * - string: the check AmakerBotService made before the packed identity, the
+ *   interface default isMasterAddress() (format the address) feeding a
+ *   mutex-guarded string compare
+ * - packed: AmakerBotService's check today, one atomic load of the packed
+ *   (IPv4, port, session) identity and an integer compare
+ * The host wall-clock time per check is printed; on the ESP32-S3 the string
+ * path also goes through the heap allocator and the 64-bit load through a
+ * short critical section, so only the ratio carries over.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include "Arduino.h"
+#include "IsMasterRegistryInterface.h"
+
+static constexpr uint32_t CHECKS = 1000000;
+
+/** @brief Master kept as a string under a mutex, checked through the interface default. */
+struct StringRegistry : IsMasterRegistryInterface
+{
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    std::string master_ip;
+
+    bool isMaster(const std::string &ip) const override
+    {
+        if (xSemaphoreTake(mutex, pdMS_TO_TICKS(10)))
+        {
+            bool result = !master_ip.empty() && master_ip == ip;
+            xSemaphoreGive(mutex);
+            return result;
+        }
+        return false;
+    }
+
+    std::string getMasterIP() const override { return master_ip; }
+};
+
+/** @brief Master kept as AmakerBotService packs it (IPv4 << 32 | port << 16 | session). */
+struct PackedRegistry : IsMasterRegistryInterface
+{
+    std::atomic<uint64_t> identity{0};
+
+    bool isMaster(const std::string &ip) const override
+    {
+        IPAddress address;
+        return address.fromString(ip.c_str()) && isMasterAddress(address);
+    }
+
+    bool isMasterAddress(const IPAddress &ip) const override
+    {
+        const uint64_t current = identity.load(std::memory_order_acquire);
+        return current != 0 && static_cast<uint32_t>(current >> 32) == static_cast<uint32_t>(ip);
+    }
+
+    std::string getMasterIP() const override { return IPAddress(static_cast<uint32_t>(identity.load() >> 32)).toString(); }
+};
+
+static const IPAddress MASTER(192, 168, 1, 42);
+static const IPAddress OTHER(192, 168, 1, 43);
+
+static StringRegistry string_registry;
+static PackedRegistry packed_registry;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/** @brief Wall-clock ns per check; alternates master and non-master senders like a shared link. */
+static double timeChecks(const IsMasterRegistryInterface &registry, uint32_t &hits)
+{
+    hits = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < CHECKS; ++n)
+        hits += registry.isMasterAddress((n & 1) ? OTHER : MASTER);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / CHECKS;
+}
+
+static void test_both_registries_agree(void)
+{
+    for (const IsMasterRegistryInterface *registry : {static_cast<const IsMasterRegistryInterface *>(&string_registry),
+                                                      static_cast<const IsMasterRegistryInterface *>(&packed_registry)})
+    {
+        TEST_ASSERT_TRUE(registry->isMasterAddress(MASTER));
+        TEST_ASSERT_FALSE(registry->isMasterAddress(OTHER));
+        TEST_ASSERT_TRUE(registry->isMaster("192.168.1.42"));
+        TEST_ASSERT_FALSE(registry->isMaster("192.168.1.4"));
+        TEST_ASSERT_EQUAL_STRING("192.168.1.42", registry->getMasterIP().c_str());
+    }
+}
+
+static void test_check_cost(void)
+{
+    uint32_t string_hits = 0;
+    uint32_t packed_hits = 0;
+    const double string_ns = timeChecks(string_registry, string_hits);
+    const double packed_ns = timeChecks(packed_registry, packed_hits);
+
+    char line[128];
+    snprintf(line, sizeof(line), "string (format + mutex + compare): %7.1f ns per check", string_ns);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "packed (atomic load + compare):    %7.1f ns per check", packed_ns);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(CHECKS / 2, string_hits);
+    TEST_ASSERT_EQUAL_UINT32(CHECKS / 2, packed_hits);
+    TEST_ASSERT_TRUE(packed_ns < string_ns);
+}
+
+int main(int argc, char **argv)
+{
+    string_registry.master_ip = MASTER.toString();
+    packed_registry.identity = static_cast<uint64_t>(static_cast<uint32_t>(MASTER)) << 32 | 51234u << 16 | 1;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_both_registries_agree);
+    RUN_TEST(test_check_cost);
+    return UNITY_END();
+}
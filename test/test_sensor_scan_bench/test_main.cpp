@@ -0,0 +1,154 @@
+/**
+ * DFR1216 input scan cost: pio test -e native -f test_sensor_scan_bench
+ *
+ * Reads the same ports on the virtual DFR1216 twice: once with the per-pin
+ * getters (getADCValue(), getGpioState()), once with the block reads
+ * (readADCBlock(), getGpioStates()). DFR1216_Sim times the bus at 400 kHz
+ * plus 60 us of driver overhead per transaction, about what the ESP32 I2C
+ * driver adds. Both scans must return the same values; the table is printed.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include "DFR1216/DFR1216_Sim.h"
+
+static constexpr uint32_t SCANS = 1000;
+static constexpr uint16_t OVERHEAD_US = 60;
+
+struct Cost
+{
+    uint32_t transactions = 0;
+    uint64_t bytes = 0;
+    uint64_t busyUs = 0;
+};
+
+static DFR1216_Sim board;
+
+void setUp(void)
+{
+    DFR1216_Sim::resetSimStats();
+}
+
+void tearDown(void) {}
+
+static Cost simCost(void)
+{
+    const sSimStats_t sim = DFR1216_Sim::getSimStats();
+    Cost cost;
+    cost.transactions = sim.transactions;
+    cost.bytes = sim.wireBytes;
+    cost.busyUs = sim.busyUs;
+    return cost;
+}
+
+static void report(const char *path, const Cost &cost)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "  %-10s %5.2f transactions %6.1f bytes %7.1f us per scan", path,
+             static_cast<double>(cost.transactions) / SCANS, static_cast<double>(cost.bytes) / SCANS,
+             static_cast<double>(cost.busyUs) / SCANS);
+    TEST_MESSAGE(line);
+}
+
+/** @brief Put ports into their mode and wait out the first ADC conversion. */
+static void setModes(uint8_t adcMask, uint8_t gpioMask)
+{
+    for (uint8_t n = 0; n < 6; ++n)
+    {
+        if (adcMask & (1 << n))
+            board.setMode(static_cast<eIONumber_t>(n), eADC);
+        else if (gpioMask & (1 << n))
+            board.setMode(static_cast<eIONumber_t>(n), eReadGpio);
+    }
+    delay(DFR1216_Sim::getConfig().adcConversionUs / 1000 + 1);
+    DFR1216_Sim::resetSimStats();
+}
+
+/** @brief Scan adcMask/gpioMask SCANS times per pin, then as blocks, and compare. */
+static void compareScans(const char *name, uint8_t adcMask, uint8_t gpioMask)
+{
+    TEST_MESSAGE(name);
+    setModes(adcMask, gpioMask);
+
+    uint16_t perPin[6] = {};
+    uint8_t perPinLevels = 0;
+    for (uint32_t s = 0; s < SCANS; ++s)
+    {
+        perPinLevels = 0;
+        for (uint8_t n = 0; n < 6; ++n)
+        {
+            if (adcMask & (1 << n))
+                perPin[n] = board.getADCValue(static_cast<eIONumber_t>(n));
+            else if ((gpioMask & (1 << n)) && board.getGpioState(static_cast<eIONumber_t>(n)) == eHIGH)
+                perPinLevels |= 1 << n;
+        }
+    }
+    const Cost loop = simCost();
+    report("per-pin", loop);
+
+    DFR1216_Sim::resetSimStats();
+    uint16_t block[6] = {};
+    uint8_t ready = 0;
+    uint8_t modeErrors = 0;
+    uint8_t levels = 0;
+    for (uint32_t s = 0; s < SCANS; ++s)
+    {
+        if (adcMask)
+            TEST_ASSERT_EQUAL_HEX8(0x00, board.readADCBlock(adcMask, block, &ready, &modeErrors));
+        if (gpioMask)
+            TEST_ASSERT_EQUAL_HEX8(0x00, board.getGpioStates(&levels));
+    }
+    const Cost batched = simCost();
+    report("batched", batched);
+
+    TEST_ASSERT_EQUAL_HEX8(adcMask, ready);
+    TEST_ASSERT_EQUAL_HEX8(0, modeErrors);
+    for (uint8_t n = 0; n < 6; ++n)
+    {
+        if (adcMask & (1 << n))
+            TEST_ASSERT_EQUAL_UINT16(perPin[n], block[n]);
+    }
+    TEST_ASSERT_EQUAL_HEX8(perPinLevels, levels & gpioMask);
+    TEST_ASSERT_EQUAL_UINT32(((adcMask ? 1 : 0) + (gpioMask ? 1 : 0)) * SCANS, batched.transactions);
+    TEST_ASSERT_TRUE(batched.busyUs < loop.busyUs);
+}
+
+static void test_six_adc_ports(void)
+{
+    compareScans("6 ADC ports", 0x3f, 0);
+}
+
+static void test_four_adc_ports(void)
+{
+    compareScans("4 ADC ports (C0-C3)", 0x0f, 0);
+}
+
+static void test_six_input_levels(void)
+{
+    compareScans("6 input levels", 0, 0x3f);
+}
+
+static void test_four_adc_two_inputs(void)
+{
+    compareScans("4 ADC ports + 2 input levels", 0x0f, 0x30);
+}
+
+int main(int argc, char **argv)
+{
+    sSimConfig_t config = DFR1216_Sim::defaultConfig();
+    config.overheadUs = OVERHEAD_US;
+    DFR1216_Sim::configure(config);
+    board.begin();
+    const uint16_t analog[6] = {0, 512, 1024, 2048, 3000, 4095};
+    for (uint8_t n = 0; n < 6; ++n)
+    {
+        DFR1216_Sim::setAnalog(static_cast<eIONumber_t>(n), analog[n]);
+        DFR1216_Sim::setInput(static_cast<eIONumber_t>(n), n & 1);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_six_adc_ports);
+    RUN_TEST(test_four_adc_ports);
+    RUN_TEST(test_six_input_levels);
+    RUN_TEST(test_four_adc_two_inputs);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+/**
+ * SeqLock host stress test: pio test -e native -f test_seqlock
+ *
+ * Several writers publish blocks whose words all carry the same stamp, serialised
+ * by a mutex standing in for the firmware's portENTER_CRITICAL section; readers
+ * spin on read() and fail on any copy mixing two stamps (a torn snapshot).
+ */
+#include <unity.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SeqLock.h"
+
+struct Block
+{
+    uint32_t stamp;
+    uint32_t words[31]; ///< Each equal to stamp: 128 bytes, far more than one store
+};
+
+static constexpr unsigned WRITERS = 3;
+static constexpr unsigned READERS = 3;
+static constexpr uint32_t WRITES_PER_WRITER = 200000;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_single_thread_round_trip(void)
+{
+    SeqLock<Block> lock;
+    TEST_ASSERT_EQUAL_UINT32(0, lock.version());
+    lock.write([](Block &b)
+               {
+        b.stamp = 7;
+        for (uint32_t &w : b.words)
+            w = 7; });
+    uint32_t retries = 0;
+    const Block copy = lock.read(&retries);
+    TEST_ASSERT_EQUAL_UINT32(7, copy.stamp);
+    TEST_ASSERT_EQUAL_UINT32(7, copy.words[30]);
+    TEST_ASSERT_EQUAL_UINT32(1, lock.version());
+    TEST_ASSERT_EQUAL_UINT32(0, retries);
+}
+
+static void test_concurrent_writers_and_readers_never_tear(void)
+{
+    SeqLock<Block> lock;
+    std::mutex critical; // portENTER_CRITICAL on the target
+    std::atomic<bool> writing{true};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint32_t> backwards{0};
+
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < READERS; ++r)
+        readers.emplace_back([&]
+                             {
+            uint32_t my_retries = 0;
+            uint64_t my_reads = 0;
+            uint32_t last_version = 0;
+            while (writing.load(std::memory_order_relaxed))
+            {
+                const Block copy = lock.read(&my_retries);
+                my_reads++;
+                for (uint32_t w : copy.words)
+                    if (w != copy.stamp)
+                    {
+                        torn.fetch_add(1);
+                        break;
+                    }
+                const uint32_t version = lock.version();
+                if (version < last_version)
+                    backwards.fetch_add(1);
+                last_version = version;
+            }
+            reads.fetch_add(my_reads);
+            retries.fetch_add(my_retries); });
+
+    std::vector<std::thread> writers;
+    for (unsigned w = 0; w < WRITERS; ++w)
+        writers.emplace_back([&, w]
+                             {
+            for (uint32_t i = 0; i < WRITES_PER_WRITER; ++i)
+            {
+                const uint32_t stamp = (w << 24) | i;
+                std::lock_guard<std::mutex> guard(critical);
+                lock.write([stamp, i](Block &b)
+                           {
+                    b.stamp = stamp;
+                    for (uint8_t n = 0; n < 31; ++n)
+                    {
+                        b.words[n] = stamp;
+                        // Now and then give the readers the CPU half-way through a write
+                        if (n == 15 && (i & 1023) == 0)
+                            std::this_thread::yield();
+                    } });
+            } });
+
+    for (std::thread &t : writers)
+        t.join();
+    writing.store(false);
+    for (std::thread &t : readers)
+        t.join();
+
+    char line[128];
+    snprintf(line, sizeof(line), "%llu reads, %llu retried copies, %u writes",
+             static_cast<unsigned long long>(reads.load()), static_cast<unsigned long long>(retries.load()),
+             lock.version());
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(WRITERS * WRITES_PER_WRITER, lock.version());
+    TEST_ASSERT_GREATER_THAN(0, reads.load());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_single_thread_round_trip);
+    RUN_TEST(test_concurrent_writers_and_readers_never_tear);
+    return UNITY_END();
+}
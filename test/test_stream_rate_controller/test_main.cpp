@@ -0,0 +1,169 @@
+/**
+ * StreamRateController host tests: pio test -e native -f test_stream_rate_controller
+ *
+ * Each period feeds a number of encoded and delivered frames at a given latency
+ * on a simulated clock, then runs the control step.
+ */
+#include <unity.h>
+#include "StreamRateController.h"
+
+static StreamRateController *controller;
+static uint64_t now_us;
+
+/** @brief One control period with @p frames frames delivered at @p latency_us. */
+static bool period(uint32_t latency_us, int frames = 5, uint32_t encode_us = 30000)
+{
+    for (int i = 0; i < frames; ++i)
+    {
+        controller->onEncoded(encode_us);
+        controller->onDelivered(latency_us);
+    }
+    now_us += StreamRateController::PERIOD_US;
+    return controller->update(now_us);
+}
+
+static StreamRateController::Action lastAction()
+{
+    return controller->state().last_action;
+}
+
+void setUp(void)
+{
+    controller = new StreamRateController();
+    StreamRateConfig config;
+    config.max_downsize = 1;
+    controller->configure(config);
+    now_us = 0;
+    controller->update(now_us);
+}
+
+void tearDown(void)
+{
+    delete controller;
+}
+
+/** @brief Overload until the controller has lowered the quality, raised the skip and shrunk the frame. */
+static void saturate(void)
+{
+    for (int i = 0; i < 10; ++i)
+        period(800000);
+    for (int i = 0; i < 3; ++i)
+        period(800000);
+    for (int i = 0; i < StreamRateController::DOWNSIZE_PERIODS && controller->downsize() == 0; ++i)
+        period(800000);
+}
+
+static void test_overload_degrades_quality_then_skip_then_size(void)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT_TRUE(period(800000));
+        TEST_ASSERT_EQUAL_UINT8(StreamRateController::QUALITY_DOWN, lastAction());
+    }
+    TEST_ASSERT_EQUAL_UINT8(30, controller->quality());
+    TEST_ASSERT_EQUAL_UINT8(0, controller->state().skip);
+    for (int i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_TRUE(period(800000));
+        TEST_ASSERT_EQUAL_UINT8(StreamRateController::SKIP_UP, lastAction());
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, controller->state().skip);
+    // At the floor, the frame size goes down after DOWNSIZE_PERIODS overloaded periods
+    for (int i = 1; i < StreamRateController::DOWNSIZE_PERIODS; ++i)
+        TEST_ASSERT_FALSE(period(800000));
+    TEST_ASSERT_TRUE(period(800000));
+    TEST_ASSERT_EQUAL_UINT8(StreamRateController::SIZE_DOWN, lastAction());
+    TEST_ASSERT_EQUAL_UINT8(1, controller->downsize());
+    TEST_ASSERT_EQUAL_UINT32(14, controller->state().decreases);
+}
+
+static void test_skip_gate(void)
+{
+    saturate();
+    int encoded = 0;
+    for (int i = 0; i < 8; ++i)
+        encoded += controller->shouldEncode();
+    TEST_ASSERT_EQUAL_INT(2, encoded); // skip 3: one camera frame in four
+    TEST_ASSERT_EQUAL_UINT32(6, controller->state().rate_skipped);
+}
+
+static void test_calm_periods_undo_in_reverse_order(void)
+{
+    saturate();
+    // Between the low water mark and the target: hold
+    TEST_ASSERT_FALSE(period(250000));
+    TEST_ASSERT_EQUAL_UINT8(StreamRateController::HOLD, lastAction());
+    for (int i = 1; i < StreamRateController::CALM_PERIODS; ++i)
+        TEST_ASSERT_FALSE(period(50000));
+    TEST_ASSERT_TRUE(period(50000));
+    TEST_ASSERT_EQUAL_UINT8(StreamRateController::SIZE_UP, lastAction());
+    for (int i = 0; i < StreamRateController::CALM_PERIODS; ++i)
+        period(50000);
+    TEST_ASSERT_EQUAL_UINT8(StreamRateController::SKIP_DOWN, lastAction());
+    TEST_ASSERT_EQUAL_UINT8(2, controller->state().skip);
+}
+
+static void test_stuck_clients_and_idle_periods(void)
+{
+    // Frames encoded, none delivered: every client is stuck
+    controller->onEncoded(1000);
+    now_us += StreamRateController::PERIOD_US;
+    TEST_ASSERT_TRUE(controller->update(now_us));
+    TEST_ASSERT_EQUAL_UINT8(StreamRateController::QUALITY_DOWN, lastAction());
+    // Nothing encoded: nothing to judge
+    now_us += StreamRateController::PERIOD_US;
+    TEST_ASSERT_FALSE(controller->update(now_us));
+    // No step before a period has elapsed
+    period(800000);
+    controller->onDelivered(800000);
+    TEST_ASSERT_FALSE(controller->update(now_us + 1000));
+}
+
+static void test_encode_bound_resizes_first(void)
+{
+    StreamRateConfig config;
+    config.max_downsize = 2;
+    controller->configure(config);
+    controller->onEncoded(400000);
+    controller->onDelivered(450000);
+    now_us += StreamRateController::PERIOD_US;
+    TEST_ASSERT_TRUE(controller->update(now_us));
+    TEST_ASSERT_EQUAL_UINT8(1, controller->downsize());
+    TEST_ASSERT_EQUAL_UINT8(80, controller->quality());
+}
+
+static void test_disabled_holds_the_best_settings(void)
+{
+    saturate();
+    StreamRateConfig config;
+    config.enabled = false;
+    controller->configure(config);
+    TEST_ASSERT_EQUAL_UINT8(80, controller->quality());
+    TEST_ASSERT_EQUAL_UINT8(0, controller->downsize());
+    TEST_ASSERT_EQUAL_UINT8(0, controller->state().skip);
+    TEST_ASSERT_FALSE(period(900000));
+}
+
+static void test_config_string(void)
+{
+    StreamRateConfig config;
+    TEST_ASSERT_TRUE(config.fromString("1:200:20:90:2:1"));
+    TEST_ASSERT_EQUAL_UINT16(200, config.target_ms);
+    TEST_ASSERT_EQUAL_STRING("1:200:20:90:2:1", config.toString().c_str());
+    TEST_ASSERT_FALSE(config.fromString("1:20:20:90:2:1"));
+    TEST_ASSERT_EQUAL_UINT16(200, config.target_ms);
+    TEST_ASSERT_FALSE(config.fromString("1:200:90:20:2:1")); // quality_min > quality_max
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_overload_degrades_quality_then_skip_then_size);
+    RUN_TEST(test_skip_gate);
+    RUN_TEST(test_calm_periods_undo_in_reverse_order);
+    RUN_TEST(test_stuck_clients_and_idle_periods);
+    RUN_TEST(test_encode_bound_resizes_first);
+    RUN_TEST(test_disabled_holds_the_best_settings);
+    RUN_TEST(test_config_string);
+    return UNITY_END();
+}
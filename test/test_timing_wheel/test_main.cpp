@@ -0,0 +1,188 @@
+/**
+ * TimingWheel host tests: pio test -e native -f test_timing_wheel
+ *
+ * The wheel only sees ticks, so the tests drive it with a fake clock and can
+ * jump, stall and wrap time at will.
+ */
+#include <unity.h>
+#include "TimingWheel.h"
+
+/** @brief Fake tick source: the test decides when time passes. */
+struct FakeClock
+{
+    uint32_t tick = 0;
+
+    /** @brief Move time forward one tick at a time, advancing the wheel at each; expired ids are OR-ed. */
+    uint32_t run(TimingWheel &wheel, uint32_t ticks)
+    {
+        uint32_t expired = 0;
+        for (uint32_t i = 0; i < ticks; ++i)
+            expired |= wheel.advance(++tick);
+        return expired;
+    }
+
+    /** @brief Jump ticks ahead with a single (late) advance. */
+    uint32_t jump(TimingWheel &wheel, uint32_t ticks)
+    {
+        tick += ticks;
+        return wheel.advance(tick);
+    }
+};
+
+static TimingWheel *wheel;
+static FakeClock clock_;
+
+void setUp(void)
+{
+    wheel = new TimingWheel();
+    clock_ = FakeClock();
+    wheel->advance(clock_.tick); // first advance sweeps the whole wheel
+}
+
+void tearDown(void)
+{
+    delete wheel;
+}
+
+static void test_expires_on_its_deadline_not_before(void)
+{
+    TEST_ASSERT_FALSE(wheel->arm(3, clock_.tick, 5));
+    TEST_ASSERT_EQUAL_UINT32(0, clock_.run(*wheel, 4));
+    TEST_ASSERT_TRUE(wheel->isArmed(3));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 3, clock_.run(*wheel, 1));
+    TEST_ASSERT_FALSE(wheel->isArmed(3));
+    TEST_ASSERT_EQUAL_UINT8(0, wheel->armedCount());
+}
+
+static void test_zero_delay_waits_one_tick(void)
+{
+    wheel->arm(0, clock_.tick, 0);
+    TEST_ASSERT_EQUAL_HEX32(0, wheel->advance(clock_.tick));
+    TEST_ASSERT_EQUAL_HEX32(1, clock_.run(*wheel, 1));
+}
+
+static void test_rearm_moves_the_deadline(void)
+{
+    wheel->arm(7, clock_.tick, 10);
+    clock_.run(*wheel, 8);
+    // Re-armed each "packet": the deadline keeps moving away
+    TEST_ASSERT_TRUE(wheel->arm(7, clock_.tick, 10));
+    TEST_ASSERT_EQUAL_UINT8(1, wheel->armedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, clock_.run(*wheel, 9));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 7, clock_.run(*wheel, 1));
+}
+
+static void test_rearm_earlier_fires_earlier(void)
+{
+    wheel->arm(2, clock_.tick, 50);
+    wheel->arm(2, clock_.tick, 3);
+    TEST_ASSERT_EQUAL_HEX32(1UL << 2, clock_.run(*wheel, 3));
+    TEST_ASSERT_EQUAL_UINT32(0, clock_.run(*wheel, 100));
+}
+
+static void test_cancel(void)
+{
+    wheel->arm(1, clock_.tick, 4);
+    wheel->arm(2, clock_.tick, 4);
+    TEST_ASSERT_TRUE(wheel->cancel(1));
+    TEST_ASSERT_FALSE(wheel->cancel(1));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 2, clock_.run(*wheel, 4));
+    TEST_ASSERT_FALSE(wheel->cancel(2)); // already expired
+    TEST_ASSERT_FALSE(wheel->cancel(TimingWheel::MAX_TIMERS));
+}
+
+static void test_same_slot_different_turns(void)
+{
+    // Both hash to the same slot; the far one must survive the first pass
+    wheel->arm(4, clock_.tick, 10);
+    wheel->arm(5, clock_.tick, 10 + TimingWheel::SLOTS);
+    TEST_ASSERT_EQUAL_HEX32(1UL << 4, clock_.run(*wheel, 10));
+    TEST_ASSERT_TRUE(wheel->isArmed(5));
+    TEST_ASSERT_EQUAL_UINT32(0, clock_.run(*wheel, TimingWheel::SLOTS - 1));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 5, clock_.run(*wheel, 1));
+}
+
+static void test_delay_of_several_turns(void)
+{
+    const uint32_t delay = 5 * TimingWheel::SLOTS + 17;
+    wheel->arm(9, clock_.tick, delay);
+    TEST_ASSERT_EQUAL_UINT32(0, clock_.run(*wheel, delay - 1));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 9, clock_.run(*wheel, 1));
+}
+
+static void test_late_advance_expires_everything_due(void)
+{
+    // The owner's timer stalled: one advance covers more than a turn
+    wheel->arm(0, clock_.tick, 3);
+    wheel->arm(1, clock_.tick, 40);
+    wheel->arm(2, clock_.tick, 200);
+    wheel->arm(3, clock_.tick, 400);
+    TEST_ASSERT_EQUAL_HEX32(0x7, clock_.jump(*wheel, 300));
+    TEST_ASSERT_TRUE(wheel->isArmed(3));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 3, clock_.jump(*wheel, 100));
+}
+
+static void test_advance_backwards_or_repeated_is_a_no_op(void)
+{
+    clock_.run(*wheel, 10);
+    wheel->arm(6, clock_.tick, 1);
+    TEST_ASSERT_EQUAL_HEX32(0, wheel->advance(clock_.tick));
+    TEST_ASSERT_EQUAL_HEX32(0, wheel->advance(clock_.tick - 5));
+    TEST_ASSERT_EQUAL_UINT32(clock_.tick, wheel->lastTick());
+    TEST_ASSERT_EQUAL_HEX32(1UL << 6, clock_.run(*wheel, 1));
+}
+
+static void test_tick_counter_wraps(void)
+{
+    TimingWheel wrapped;
+    FakeClock clock;
+    clock.tick = 0xFFFFFFF0u;
+    wrapped.advance(clock.tick);
+    wrapped.arm(11, clock.tick, 32); // deadline past the wrap
+    TEST_ASSERT_EQUAL_UINT32(0, clock.run(wrapped, 31));
+    TEST_ASSERT_EQUAL_HEX32(1UL << 11, clock.run(wrapped, 1));
+    TEST_ASSERT_EQUAL_UINT32(0x10u, clock.tick);
+}
+
+static void test_all_timers(void)
+{
+    for (uint8_t id = 0; id < TimingWheel::MAX_TIMERS; ++id)
+        wheel->arm(id, clock_.tick, 1 + id * 7);
+    TEST_ASSERT_EQUAL_UINT8(TimingWheel::MAX_TIMERS, wheel->armedCount());
+    TEST_ASSERT_FALSE(wheel->arm(TimingWheel::MAX_TIMERS, clock_.tick, 1));
+    uint32_t expired = 0;
+    for (uint8_t id = 0; id < TimingWheel::MAX_TIMERS; ++id)
+    {
+        const uint32_t now = clock_.run(*wheel, id ? 7 : 1);
+        TEST_ASSERT_EQUAL_HEX32(1UL << id, now);
+        expired |= now;
+    }
+    TEST_ASSERT_EQUAL_HEX32(0xFFFF, expired);
+    TEST_ASSERT_EQUAL_UINT8(0, wheel->armedCount());
+}
+
+static void test_first_advance_sweeps_every_slot(void)
+{
+    // Armed before the wheel ever ran: the first advance must find it, whatever the slot
+    TimingWheel fresh;
+    fresh.arm(0, 1000, 5);
+    TEST_ASSERT_EQUAL_HEX32(1, fresh.advance(1005));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_expires_on_its_deadline_not_before);
+    RUN_TEST(test_zero_delay_waits_one_tick);
+    RUN_TEST(test_rearm_moves_the_deadline);
+    RUN_TEST(test_rearm_earlier_fires_earlier);
+    RUN_TEST(test_cancel);
+    RUN_TEST(test_same_slot_different_turns);
+    RUN_TEST(test_delay_of_several_turns);
+    RUN_TEST(test_late_advance_expires_everything_due);
+    RUN_TEST(test_advance_backwards_or_repeated_is_a_no_op);
+    RUN_TEST(test_tick_counter_wraps);
+    RUN_TEST(test_all_timers);
+    RUN_TEST(test_first_advance_sweeps_every_slot);
+    return UNITY_END();
+}